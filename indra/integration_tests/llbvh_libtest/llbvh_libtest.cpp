@@ -0,0 +1,278 @@
+/**
+ * @file llbvh_libtest.cpp
+ * @brief Integration test and benchmark of the BVH animation import
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "llbvh_libtest.h"
+
+// Linden library includes
+#include "llapr.h"
+#include "llbvhloader.h"
+#include "lldatapacker.h"
+#include "lldir.h"
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "llformat.h"
+#include "llthreadpool.h"
+#include "llxmltree.h"
+
+// system libraries
+#include <iostream>
+#include <sstream>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllbvh_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -i, --input <file1 .. file2>\n"
+"        List of BVH files or directories of BVH files to convert.\n"
+" -o, --output <dir>\n"
+"        Directory to write each converted animation to, as <name>.anim.\n"
+"        Default is to only report the conversion.\n"
+" -s, --settings <dir>\n"
+"        Viewer data directory holding app_settings/anim.ini and\n"
+"        character/avatar_skeleton.xml, usually indra/newview.\n"
+" -k, --skeleton <file>\n"
+"        Skeleton to take the joint names and aliases from.\n"
+"        Default is character/avatar_skeleton.xml of the settings directory.\n"
+" -t, --threads <n>\n"
+"        Number of thread pool workers reducing keys, 0 to reduce on the\n"
+"        main thread only. Default is one per core but one.\n"
+"\n";
+
+// Adds the name and aliases of a skeleton bone and its child bones, as
+// LLAvatarAppearance::makeJointAliases() does
+void add_joint_aliases(LLXmlTreeNode* node, std::map<std::string, std::string>& joint_alias_map)
+{
+	for (LLXmlTreeNode* child = node->getFirstChild(); child; child = node->getNextChild())
+	{
+		if (!child->hasName("bone"))
+		{
+			continue;
+		}
+		std::string bone_name;
+		if (!child->getAttributeString("name", bone_name))
+		{
+			continue;
+		}
+		joint_alias_map[bone_name] = bone_name;
+
+		std::string aliases;
+		child->getAttributeString("aliases", aliases);
+		std::istringstream alias_stream(aliases);
+		std::string alias;
+		while (alias_stream >> alias)
+		{
+			joint_alias_map[alias] = bone_name;
+		}
+
+		add_joint_aliases(child, joint_alias_map);
+	}
+}
+
+void store_input_file(std::list<std::string> &input_filenames, const std::string &path)
+{
+	if (LLFile::isdir(path))
+	{
+		// Store each BVH file of the directory
+		std::string next_name;
+		LLDirIterator iter(path, "*.bvh");
+		while (iter.next(next_name))
+		{
+			input_filenames.push_back(gDirUtilp->add(path, next_name));
+		}
+	}
+	else if (gDirUtilp->fileExists(path))
+	{
+		input_filenames.push_back(path);
+	}
+	else
+	{
+		std::cout << "store_input_file : the file " << path << " could not be found" << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// List of input files
+	std::list<std::string> input_filenames;
+	// Other optional parsed arguments
+	std::string output_dir;
+	std::string settings_dir;
+	std::string skeleton_file;
+	int threads = -1;
+
+	// Init whatever is necessary
+	ll_init_apr();
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			// Send the usage to standard out
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--input") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			std::string file_name = argv[arg+1];
+			while (file_name[0] != '-')		// if arg starts with '-', we consider it's not a file name but some other argument
+			{
+				store_input_file(input_filenames, file_name);
+				arg += 1;					// Skip that arg now we know it's a file name
+				if ((arg + 1) == argc)		// Break out of the loop if we reach the end of the arg list
+					break;
+				file_name = argv[arg+1];	// Next argument and loop over
+			}
+		}
+		else if ((!strcmp(argv[arg], "--output") || !strcmp(argv[arg], "-o")) && arg < argc-1)
+		{
+			output_dir = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--settings") || !strcmp(argv[arg], "-s")) && arg < argc-1)
+		{
+			settings_dir = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--skeleton") || !strcmp(argv[arg], "-k")) && arg < argc-1)
+		{
+			skeleton_file = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--threads") || !strcmp(argv[arg], "-t")) && arg < argc-1)
+		{
+			threads = atoi(argv[++arg]);
+		}
+	}
+
+	// Check arguments consistency. Exit with proper message if inconsistent.
+	if (input_filenames.size() == 0)
+	{
+		std::cout << "No input file, nothing to do -> exit" << std::endl;
+		return 0;
+	}
+	if (settings_dir.empty())
+	{
+		std::cout << "No settings directory, anim.ini can't be found (use --settings) -> exit" << std::endl;
+		return 0;
+	}
+
+	// The loader reads anim.ini from the app settings
+	gDirUtilp->initAppDirs("SecondLife", settings_dir);
+	if (skeleton_file.empty())
+	{
+		skeleton_file = gDirUtilp->add(gDirUtilp->add(settings_dir, "character"), "avatar_skeleton.xml");
+	}
+
+	std::map<std::string, std::string> joint_alias_map;
+	LLXmlTree skeleton;
+	if (!skeleton.parseFile(skeleton_file, FALSE) || !skeleton.getRoot())
+	{
+		std::cout << "Error: Skeleton " << skeleton_file << " could not be loaded" << std::endl;
+		return 1;
+	}
+	add_joint_aliases(skeleton.getRoot(), joint_alias_map);
+
+	if (threads != 0)
+	{
+		LLThreadPool::initClass(llmax(threads, 0));
+	}
+
+	// Convert each input file
+	S32 converted = 0;
+	S64 total_input = 0;
+	S64 total_output = 0;
+	F64 total_import = 0.0;
+	F64 total_serialize = 0.0;
+	std::list<std::string>::iterator in_file  = input_filenames.begin();
+	std::list<std::string>::iterator in_end = input_filenames.end();
+	for (; in_file != in_end; ++in_file)
+	{
+		S32 file_size = LLAPRFile::size(*in_file);
+		if (file_size <= 0)
+		{
+			std::cout << "Error: BVH " << *in_file << " could not be read" << std::endl;
+			continue;
+		}
+		std::vector<char> file_buffer(file_size + 1);
+		if (LLAPRFile::readEx(*in_file, &file_buffer[0], 0, file_size) != file_size)
+		{
+			std::cout << "Error: BVH " << *in_file << " could not be read" << std::endl;
+			continue;
+		}
+		file_buffer[file_size] = '\0';
+
+		// Parse, translate and reduce the keys
+		LLTimer timer;
+		ELoadStatus load_status = E_ST_OK;
+		S32 line_number = 0;
+		LLBVHLoader loader(&file_buffer[0], load_status, line_number, joint_alias_map);
+		F64 import_secs = timer.getElapsedTimeF64();
+		if (!loader.isInitialized())
+		{
+			std::cout << "Error: BVH " << *in_file << " could not be converted, status " << load_status
+					  << " at line " << line_number << std::endl;
+			continue;
+		}
+
+		// Pack the animation asset
+		timer.reset();
+		S32 output_size = loader.getOutputSize();
+		std::vector<U8> output_buffer(output_size);
+		LLDataPackerBinaryBuffer dp(&output_buffer[0], output_size);
+		loader.serialize(dp);
+		F64 serialize_secs = timer.getElapsedTimeF64();
+
+		std::cout << *in_file << llformat(" : %.2f s, import %.1f ms, serialize %.1f ms, %d -> %d bytes",
+										  loader.getDuration(), import_secs * 1000.0, serialize_secs * 1000.0,
+										  file_size, output_size) << std::endl;
+		converted++;
+		total_input += file_size;
+		total_output += output_size;
+		total_import += import_secs;
+		total_serialize += serialize_secs;
+
+		if (!output_dir.empty())
+		{
+			std::string out_file = gDirUtilp->add(output_dir, gDirUtilp->getBaseFileName(*in_file, true) + ".anim");
+			if (LLAPRFile::writeEx(out_file, &output_buffer[0], 0, output_size) != output_size)
+			{
+				std::cout << "Error: Animation " << out_file << " could not be saved" << std::endl;
+			}
+		}
+	}
+
+	std::cout << llformat("%d of %d files converted, import %.1f ms, serialize %.1f ms, %lld -> %lld bytes",
+						  converted, (S32)input_filenames.size(), total_import * 1000.0, total_serialize * 1000.0,
+						  (long long)total_input, (long long)total_output) << std::endl;
+
+	// Cleanup and exit
+	LLThreadPool::cleanupClass();
+	ll_cleanup_apr();
+
+	return converted == (S32)input_filenames.size() ? 0 : 1;
+}
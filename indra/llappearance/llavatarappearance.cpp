@@ -34,7 +34,9 @@
 
 #include "llavatarappearance.h"
 #include "llavatarappearancedefines.h"
+#include "llavatardefinitioncache.h"
 #include "llavatarjointmesh.h"
+#include "llavatarskeletoninfo.h"
 #include "llstl.h"
 #include "lldir.h"
 #include "llpolymorph.h"
@@ -43,8 +45,10 @@
 #include "llstl.h"
 #include "lltexglobalcolor.h"
 #include "llwearabledata.h"
+#include "llfasttimer.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
 #include "boost/bind.hpp"
-#include "boost/tokenizer.hpp"
 
 
 #if LL_MSVC
@@ -69,64 +73,6 @@ const LLColor4 DUMMY_COLOR = LLColor4(0.5,0.5,0.5,1.0);
  **
  **/
 
-//------------------------------------------------------------------------
-// LLAvatarBoneInfo
-// Trans/Scale/Rot etc. info about each avatar bone.  Used by LLVOAvatarSkeleton.
-//------------------------------------------------------------------------
-class LLAvatarBoneInfo
-{
-	friend class LLAvatarAppearance;
-	friend class LLAvatarSkeletonInfo;
-public:
-	LLAvatarBoneInfo() : mIsJoint(FALSE) {}
-	~LLAvatarBoneInfo()
-	{
-		std::for_each(mChildList.begin(), mChildList.end(), DeletePointer());
-		mChildList.clear();
-	}
-	BOOL parseXml(LLXmlTreeNode* node);
-	
-private:
-	std::string mName;
-    std::string mSupport;
-    std::string mAliases;
-	BOOL mIsJoint;
-	LLVector3 mPos;
-    LLVector3 mEnd;
-	LLVector3 mRot;
-	LLVector3 mScale;
-	LLVector3 mPivot;
-	typedef std::vector<LLAvatarBoneInfo*> child_list_t;
-	child_list_t mChildList;
-};
-
-//------------------------------------------------------------------------
-// LLAvatarSkeletonInfo
-// Overall avatar skeleton
-//------------------------------------------------------------------------
-class LLAvatarSkeletonInfo
-{
-	friend class LLAvatarAppearance;
-public:
-	LLAvatarSkeletonInfo() :
-		mNumBones(0), mNumCollisionVolumes(0) {}
-	~LLAvatarSkeletonInfo()
-	{
-		std::for_each(mBoneInfoList.begin(), mBoneInfoList.end(), DeletePointer());
-		mBoneInfoList.clear();
-	}
-	BOOL parseXml(LLXmlTreeNode* node);
-	S32 getNumBones() const { return mNumBones; }
-	S32 getNumCollisionVolumes() const { return mNumCollisionVolumes; }
-	
-private:
-	S32 mNumBones;
-	S32 mNumCollisionVolumes;
-    LLAvatarAppearance::joint_alias_map_t mJointAliasMap;
-	typedef std::vector<LLAvatarBoneInfo*> bone_info_list_t;
-	bone_info_list_t mBoneInfoList;
-};
-
 //-----------------------------------------------------------------------------
 // LLAvatarXmlInfo
 //-----------------------------------------------------------------------------
@@ -173,6 +119,8 @@ LLAvatarAppearance::LLAvatarXmlInfo::~LLAvatarXmlInfo()
 //-----------------------------------------------------------------------------
 LLXmlTree LLAvatarAppearance::sXMLTree;
 LLXmlTree LLAvatarAppearance::sSkeletonXMLTree;
+LLAvatarDefinitionCache LLAvatarAppearance::sDefinitionCache;
+bool LLAvatarAppearance::sSaveDefinitionCache = false;
 LLAvatarSkeletonInfo* LLAvatarAppearance::sAvatarSkeletonInfo = NULL;
 LLAvatarAppearance::LLAvatarXmlInfo* LLAvatarAppearance::sAvatarXmlInfo = NULL;
 
@@ -343,7 +291,8 @@ void LLAvatarAppearance::initClass(const std::string& avatar_file_name_arg, cons
     {
         avatar_file_name = gDirUtilp->getExpandedFilename(LL_PATH_CHARACTER,AVATAR_DEFAULT_CHAR + "_lad.xml");
     }
-	BOOL success = sXMLTree.parseFile( avatar_file_name, FALSE );
+	sSaveDefinitionCache = true;
+	BOOL success = sDefinitionCache.parseXml( avatar_file_name, sXMLTree, FALSE );
 	if (!success)
 	{
 		LL_ERRS() << "Problem reading avatar configuration file:" << avatar_file_name << LL_ENDL;
@@ -453,6 +402,15 @@ void LLAvatarAppearance::cleanupClass()
 	// *TODO: What about sAvatarSkeletonInfo ???
 	sSkeletonXMLTree.cleanup();
 	sXMLTree.cleanup();
+	// drop the cached data if no avatar got as far as its meshes
+	sDefinitionCache.load(LLStringUtil::null);
+	sSaveDefinitionCache = false;
+}
+
+//static
+LLAvatarDefinitionCache& LLAvatarAppearance::getDefinitionCache()
+{
+	return sDefinitionCache;
 }
 
 using namespace LLAvatarAppearanceDefines;
@@ -579,7 +537,7 @@ BOOL LLAvatarAppearance::parseSkeletonFile(const std::string& filename)
 	//-------------------------------------------------------------------------
 	// parse the file
 	//-------------------------------------------------------------------------
-	BOOL parsesuccess = sSkeletonXMLTree.parseFile( filename, FALSE );
+	BOOL parsesuccess = sDefinitionCache.parseXml( filename, sSkeletonXMLTree, FALSE );
 
 	if (!parsesuccess)
 	{
@@ -612,83 +570,6 @@ BOOL LLAvatarAppearance::parseSkeletonFile(const std::string& filename)
 	return TRUE;
 }
 
-//-----------------------------------------------------------------------------
-// setupBone()
-//-----------------------------------------------------------------------------
-BOOL LLAvatarAppearance::setupBone(const LLAvatarBoneInfo* info, LLJoint* parent, S32 &volume_num, S32 &joint_num)
-{
-	LLJoint* joint = NULL;
-
-    LL_DEBUGS("BVH") << "bone info: name " << info->mName
-                     << " isJoint " << info->mIsJoint
-                     << " volume_num " << volume_num
-                     << " joint_num " << joint_num
-                     << LL_ENDL;
-
-	if (info->mIsJoint)
-	{
-		joint = getCharacterJoint(joint_num);
-		if (!joint)
-		{
-			LL_WARNS() << "Too many bones" << LL_ENDL;
-			return FALSE;
-		}
-		joint->setName( info->mName );
-	}
-	else // collision volume
-	{
-		if (volume_num >= (S32)mNumCollisionVolumes)
-		{
-			LL_WARNS() << "Too many collision volumes" << LL_ENDL;
-			return FALSE;
-		}
-		joint = (&mCollisionVolumes[volume_num]);
-		joint->setName( info->mName );
-	}
-
-	// add to parent
-	if (parent && (joint->getParent()!=parent))
-	{
-		parent->addChild( joint );
-	}
-
-	// SL-315
-	joint->setPosition(info->mPos);
-    joint->setDefaultPosition(info->mPos);
-	joint->setRotation(mayaQ(info->mRot.mV[VX], info->mRot.mV[VY],
-							 info->mRot.mV[VZ], LLQuaternion::XYZ));
-	joint->setScale(info->mScale);
-	joint->setDefaultScale(info->mScale);
-    joint->setSupport(info->mSupport);
-	joint->setEnd(info->mEnd);
-
-	if (info->mIsJoint)
-	{
-		joint->setSkinOffset( info->mPivot );
-        joint->setJointNum(joint_num);
-		joint_num++;
-	}
-	else // collision volume
-	{
-        joint->setJointNum(mNumBones+volume_num);
-		volume_num++;
-	}
-
-
-	// setup children
-	LLAvatarBoneInfo::child_list_t::const_iterator iter;
-	for (iter = info->mChildList.begin(); iter != info->mChildList.end(); ++iter)
-	{
-		LLAvatarBoneInfo *child_info = *iter;
-		if (!setupBone(child_info, joint, volume_num, joint_num))
-		{
-			return FALSE;
-		}
-	}
-
-	return TRUE;
-}
-
 //-----------------------------------------------------------------------------
 // allocateCharacterJoints()
 //-----------------------------------------------------------------------------
@@ -710,36 +591,41 @@ BOOL LLAvatarAppearance::allocateCharacterJoints( U32 num )
 //-----------------------------------------------------------------------------
 BOOL LLAvatarAppearance::buildSkeleton(const LLAvatarSkeletonInfo *info)
 {
-    LL_DEBUGS("BVH") << "numBones " << info->mNumBones << " numCollisionVolumes " << info->mNumCollisionVolumes << LL_ENDL;
+    LL_DEBUGS("BVH") << "numBones " << info->getNumBones() << " numCollisionVolumes " << info->getNumCollisionVolumes() << LL_ENDL;
 
 	// allocate joints
-	if (!allocateCharacterJoints(info->mNumBones))
+	if (!allocateCharacterJoints(info->getNumBones()))
 	{
-		LL_ERRS() << "Can't allocate " << info->mNumBones << " joints" << LL_ENDL;
+		LL_ERRS() << "Can't allocate " << info->getNumBones() << " joints" << LL_ENDL;
 		return FALSE;
 	}
 	
 	// allocate volumes
-	if (info->mNumCollisionVolumes)
+	if (info->getNumCollisionVolumes())
 	{
-		if (!allocateCollisionVolumes(info->mNumCollisionVolumes))
+		if (!allocateCollisionVolumes(info->getNumCollisionVolumes()))
 		{
-			LL_ERRS() << "Can't allocate " << info->mNumCollisionVolumes << " collision volumes" << LL_ENDL;
+			LL_ERRS() << "Can't allocate " << info->getNumCollisionVolumes() << " collision volumes" << LL_ENDL;
 			return FALSE;
 		}
 	}
 
-	S32 current_joint_num = 0;
-	S32 current_volume_num = 0;
-	LLAvatarSkeletonInfo::bone_info_list_t::const_iterator iter;
-	for (iter = info->mBoneInfoList.begin(); iter != info->mBoneInfoList.end(); ++iter)
+	// copy the shared skeleton's values to our joints
+	std::vector<LLJoint*> bones(info->getNumBones(), NULL);
+	for (S32 i = 0; i < info->getNumBones(); ++i)
 	{
-		LLAvatarBoneInfo *bone_info = *iter;
-		if (!setupBone(bone_info, NULL, current_volume_num, current_joint_num))
-		{
-			LL_ERRS() << "Error parsing bone in skeleton file" << LL_ENDL;
-			return FALSE;
-		}
+		bones[i] = getCharacterJoint(i);
+	}
+	std::vector<LLJoint*> volumes(mNumCollisionVolumes, NULL);
+	for (S32 i = 0; i < mNumCollisionVolumes; ++i)
+	{
+		volumes[i] = &mCollisionVolumes[i];
+	}
+	if (!info->setupJoints(bones.empty() ? NULL : &bones[0], (S32)bones.size(),
+						   volumes.empty() ? NULL : &volumes[0], (S32)volumes.size()))
+	{
+		LL_ERRS() << "Error parsing bone in skeleton file" << LL_ENDL;
+		return FALSE;
 	}
 
 	return TRUE;
@@ -754,6 +640,27 @@ void LLAvatarAppearance::clearSkeleton()
 	mSkeleton.clear();
 }
 
+//-----------------------------------------------------------------------------
+// findSkeletonJoint()
+//-----------------------------------------------------------------------------
+LLJoint* LLAvatarAppearance::findSkeletonJoint(const std::string& name)
+{
+	S32 index = sAvatarSkeletonInfo ? sAvatarSkeletonInfo->findBone(name) : -1;
+	if (index >= 0)
+	{
+		const LLAvatarSkeletonInfo::BoneTemplate& bone = sAvatarSkeletonInfo->getBones()[index];
+		if (bone.mIsJoint && bone.mIndex < (S32)mSkeleton.size() && mSkeleton[bone.mIndex])
+		{
+			return mSkeleton[bone.mIndex];
+		}
+		if (!bone.mIsJoint && bone.mIndex < mNumCollisionVolumes)
+		{
+			return &mCollisionVolumes[bone.mIndex];
+		}
+	}
+	return mRoot->findJoint(name);
+}
+
 //------------------------------------------------------------------------
 // addPelvisFixup
 //------------------------------------------------------------------------
@@ -851,24 +758,24 @@ void LLAvatarAppearance::buildCharacter()
 	//-------------------------------------------------------------------------
 	// initialize "well known" joint pointers
 	//-------------------------------------------------------------------------
-	mPelvisp		= mRoot->findJoint("mPelvis");
-	mTorsop			= mRoot->findJoint("mTorso");
-	mChestp			= mRoot->findJoint("mChest");
-	mNeckp			= mRoot->findJoint("mNeck");
-	mHeadp			= mRoot->findJoint("mHead");
-	mSkullp			= mRoot->findJoint("mSkull");
-	mHipLeftp		= mRoot->findJoint("mHipLeft");
-	mHipRightp		= mRoot->findJoint("mHipRight");
-	mKneeLeftp		= mRoot->findJoint("mKneeLeft");
-	mKneeRightp		= mRoot->findJoint("mKneeRight");
-	mAnkleLeftp		= mRoot->findJoint("mAnkleLeft");
-	mAnkleRightp	= mRoot->findJoint("mAnkleRight");
-	mFootLeftp		= mRoot->findJoint("mFootLeft");
-	mFootRightp		= mRoot->findJoint("mFootRight");
-	mWristLeftp		= mRoot->findJoint("mWristLeft");
-	mWristRightp	= mRoot->findJoint("mWristRight");
-	mEyeLeftp		= mRoot->findJoint("mEyeLeft");
-	mEyeRightp		= mRoot->findJoint("mEyeRight");
+	mPelvisp		= findSkeletonJoint("mPelvis");
+	mTorsop			= findSkeletonJoint("mTorso");
+	mChestp			= findSkeletonJoint("mChest");
+	mNeckp			= findSkeletonJoint("mNeck");
+	mHeadp			= findSkeletonJoint("mHead");
+	mSkullp			= findSkeletonJoint("mSkull");
+	mHipLeftp		= findSkeletonJoint("mHipLeft");
+	mHipRightp		= findSkeletonJoint("mHipRight");
+	mKneeLeftp		= findSkeletonJoint("mKneeLeft");
+	mKneeRightp		= findSkeletonJoint("mKneeRight");
+	mAnkleLeftp		= findSkeletonJoint("mAnkleLeft");
+	mAnkleRightp	= findSkeletonJoint("mAnkleRight");
+	mFootLeftp		= findSkeletonJoint("mFootLeft");
+	mFootRightp		= findSkeletonJoint("mFootRight");
+	mWristLeftp		= findSkeletonJoint("mWristLeft");
+	mWristRightp	= findSkeletonJoint("mWristRight");
+	mEyeLeftp		= findSkeletonJoint("mEyeLeft");
+	mEyeRightp		= findSkeletonJoint("mEyeRight");
 
 	//-------------------------------------------------------------------------
 	// Make sure "well known" pointers exist
@@ -926,11 +833,28 @@ BOOL LLAvatarAppearance::loadAvatar()
 	}
 	
 	// avatar_lad.xml : <mesh>
+	LLTimer mesh_timer;
 	if( !loadMeshNodes() )
 	{
 		LL_ERRS() << "avatar file: loadNodeMesh() failed" << LL_ENDL;
 		return FALSE;
 	}
+	if (sSaveDefinitionCache)
+	{
+		// all files the avatars need have been read by now
+		sSaveDefinitionCache = false;
+		F32 mesh_ms = mesh_timer.getElapsedTimeF32() * 1000.f;
+		if (sDefinitionCache.isEnabled())
+		{
+			LL_INFOS("Avatar") << "First avatar meshes loaded in " << mesh_ms << " ms, avatar definition cache hits "
+							   << sDefinitionCache.getNumHits() << ", misses " << sDefinitionCache.getNumMisses() << LL_ENDL;
+		}
+		else
+		{
+			LL_INFOS("Avatar") << "First avatar meshes loaded in " << mesh_ms << " ms, avatar definition cache off" << LL_ENDL;
+		}
+		sDefinitionCache.save();
+	}
 	
 	// avatar_lad.xml : <global_color>
 	if( sAvatarXmlInfo->mTexSkinColorInfo )
@@ -1039,6 +963,7 @@ BOOL LLAvatarAppearance::loadAvatar()
 		}
 	}
 
+	trimVisualParamWeights();
 	
 	return TRUE;
 }
@@ -1067,19 +992,19 @@ BOOL LLAvatarAppearance::loadSkeletonNode ()
 	mRoot->addChild(mMeshLOD[MESH_ID_SKIRT]);
 	mRoot->addChild(mMeshLOD[MESH_ID_HEAD]);
 
-	LLAvatarJoint *skull = (LLAvatarJoint*)mRoot->findJoint("mSkull");
+	LLAvatarJoint *skull = (LLAvatarJoint*)findSkeletonJoint("mSkull");
 	if (skull)
 	{
 		skull->addChild(mMeshLOD[MESH_ID_HAIR] );
 	}
 
-	LLAvatarJoint *eyeL = (LLAvatarJoint*)mRoot->findJoint("mEyeLeft");
+	LLAvatarJoint *eyeL = (LLAvatarJoint*)findSkeletonJoint("mEyeLeft");
 	if (eyeL)
 	{
 		eyeL->addChild( mMeshLOD[MESH_ID_EYEBALL_LEFT] );
 	}
 
-	LLAvatarJoint *eyeR = (LLAvatarJoint*)mRoot->findJoint("mEyeRight");
+	LLAvatarJoint *eyeR = (LLAvatarJoint*)findSkeletonJoint("mEyeRight");
 	if (eyeR)
 	{
 		eyeR->addChild( mMeshLOD[MESH_ID_EYEBALL_RIGHT] );
@@ -1389,6 +1314,59 @@ LLPolyMesh*	LLAvatarAppearance::getUpperBodyMesh()
 }
 
 
+//-----------------------------------------------------------------------------
+// LLAvatarAppearance::beginMorphBatch()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::beginMorphBatch()
+{
+	for (polymesh_map_t::iterator iter = mPolyMeshes.begin(); iter != mPolyMeshes.end(); ++iter)
+	{
+		iter->second->beginMorphBatch();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// LLAvatarAppearance::endMorphBatch()
+//-----------------------------------------------------------------------------
+static LLTrace::BlockTimerStatHandle FTM_APPLY_MORPH_BATCH("Apply Morph Batch");
+
+void LLAvatarAppearance::endMorphBatch()
+{
+	std::vector<LLPolyMesh*> meshes;
+	for (polymesh_map_t::iterator iter = mPolyMeshes.begin(); iter != mPolyMeshes.end(); ++iter)
+	{
+		LLPolyMesh* mesh = iter->second;
+		mesh->endMorphBatch();
+		if (mesh->hasQueuedMorphs())
+		{
+			meshes.push_back(mesh);
+		}
+	}
+	if (meshes.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_APPLY_MORPH_BATCH);
+	LLThreadPool* pool = LLThreadPool::getInstance();
+	if (pool && meshes.size() > 1)
+	{
+		pool->parallelFor(meshes.size(), boost::bind(&LLAvatarAppearance::applyQueuedMorphs, &meshes, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < meshes.size(); ++i)
+		{
+			meshes[i]->applyQueuedMorphs();
+		}
+	}
+}
+
+//static
+void LLAvatarAppearance::applyQueuedMorphs(std::vector<LLPolyMesh*>* meshes, U32 index)
+{
+	(*meshes)[index]->applyQueuedMorphs();
+}
 
 // virtual
 BOOL LLAvatarAppearance::isValid() const
@@ -1578,175 +1556,12 @@ BOOL LLAvatarAppearance::allocateCollisionVolumes( U32 num )
 }
 
 //-----------------------------------------------------------------------------
-// LLAvatarBoneInfo::parseXml()
-//-----------------------------------------------------------------------------
-BOOL LLAvatarBoneInfo::parseXml(LLXmlTreeNode* node)
-{
-	if (node->hasName("bone"))
-	{
-		mIsJoint = TRUE;
-		static LLStdStringHandle name_string = LLXmlTree::addAttributeString("name");
-		if (!node->getFastAttributeString(name_string, mName))
-		{
-			LL_WARNS() << "Bone without name" << LL_ENDL;
-			return FALSE;
-		}
-        
-        static LLStdStringHandle aliases_string = LLXmlTree::addAttributeString("aliases");
-        node->getFastAttributeString(aliases_string, mAliases ); //Aliases are not required.
-	}
-	else if (node->hasName("collision_volume"))
-	{
-		mIsJoint = FALSE;
-		static LLStdStringHandle name_string = LLXmlTree::addAttributeString("name");
-		if (!node->getFastAttributeString(name_string, mName))
-		{
-			mName = "Collision Volume";
-		}
-	}
-	else
-	{
-		LL_WARNS() << "Invalid node " << node->getName() << LL_ENDL;
-		return FALSE;
-	}
-
-	static LLStdStringHandle pos_string = LLXmlTree::addAttributeString("pos");
-	if (!node->getFastAttributeVector3(pos_string, mPos))
-	{
-		LL_WARNS() << "Bone without position" << LL_ENDL;
-		return FALSE;
-	}
-
-	static LLStdStringHandle rot_string = LLXmlTree::addAttributeString("rot");
-	if (!node->getFastAttributeVector3(rot_string, mRot))
-	{
-		LL_WARNS() << "Bone without rotation" << LL_ENDL;
-		return FALSE;
-	}
-	
-	static LLStdStringHandle scale_string = LLXmlTree::addAttributeString("scale");
-	if (!node->getFastAttributeVector3(scale_string, mScale))
-	{
-		LL_WARNS() << "Bone without scale" << LL_ENDL;
-		return FALSE;
-	}
-
-	static LLStdStringHandle end_string = LLXmlTree::addAttributeString("end");
-	if (!node->getFastAttributeVector3(end_string, mEnd))
-	{
-		LL_WARNS() << "Bone without end " << mName << LL_ENDL;
-        mEnd = LLVector3(0.0f, 0.0f, 0.0f);
-	}
-
-	static LLStdStringHandle support_string = LLXmlTree::addAttributeString("support");
-    if (!node->getFastAttributeString(support_string,mSupport))
-    {
-        LL_WARNS() << "Bone without support " << mName << LL_ENDL;
-        mSupport = "base";
-    }
-
-	if (mIsJoint)
-	{
-		static LLStdStringHandle pivot_string = LLXmlTree::addAttributeString("pivot");
-		if (!node->getFastAttributeVector3(pivot_string, mPivot))
-		{
-			LL_WARNS() << "Bone without pivot" << LL_ENDL;
-			return FALSE;
-		}
-	}
-
-	// parse children
-	LLXmlTreeNode* child;
-	for( child = node->getFirstChild(); child; child = node->getNextChild() )
-	{
-		LLAvatarBoneInfo *child_info = new LLAvatarBoneInfo;
-		if (!child_info->parseXml(child))
-		{
-			delete child_info;
-			return FALSE;
-		}
-		mChildList.push_back(child_info);
-	}
-	return TRUE;
-}
-
-//-----------------------------------------------------------------------------
-// LLAvatarSkeletonInfo::parseXml()
+// getJointAliases()
 //-----------------------------------------------------------------------------
-BOOL LLAvatarSkeletonInfo::parseXml(LLXmlTreeNode* node)
-{
-	static LLStdStringHandle num_bones_string = LLXmlTree::addAttributeString("num_bones");
-	if (!node->getFastAttributeS32(num_bones_string, mNumBones))
-	{
-		LL_WARNS() << "Couldn't find number of bones." << LL_ENDL;
-		return FALSE;
-	}
-
-	static LLStdStringHandle num_collision_volumes_string = LLXmlTree::addAttributeString("num_collision_volumes");
-	node->getFastAttributeS32(num_collision_volumes_string, mNumCollisionVolumes);
-
-	LLXmlTreeNode* child;
-	for( child = node->getFirstChild(); child; child = node->getNextChild() )
-	{
-		LLAvatarBoneInfo *info = new LLAvatarBoneInfo;
-		if (!info->parseXml(child))
-		{
-			delete info;
-			LL_WARNS() << "Error parsing bone in skeleton file" << LL_ENDL;
-			return FALSE;
-		}
-		mBoneInfoList.push_back(info);
-	}
-	return TRUE;
-}
-
-//Make aliases for joint and push to map.
-void LLAvatarAppearance::makeJointAliases(LLAvatarBoneInfo *bone_info)
-{
-    if (! bone_info->mIsJoint )
-    {
-        return;
-    }
-    
-    std::string bone_name = bone_info->mName;
-    mJointAliasMap[bone_name] = bone_name; //Actual name is a valid alias.
-    
-    std::string aliases = bone_info->mAliases;
-    
-    boost::char_separator<char> sep(" ");
-    boost::tokenizer<boost::char_separator<char> > tok(aliases, sep);
-    for(boost::tokenizer<boost::char_separator<char> >::iterator i = tok.begin(); i != tok.end(); ++i)
-    {
-        if ( mJointAliasMap.find(*i) != mJointAliasMap.end() )
-        {
-            LL_WARNS() << "avatar skeleton:  Joint alias \"" << *i << "\" remapped from " << mJointAliasMap[*i] << " to " << bone_name << LL_ENDL;
-        }
-        mJointAliasMap[*i] = bone_name;
-    }
-    
-    LLAvatarBoneInfo::child_list_t::const_iterator iter;
-    for (iter = bone_info->mChildList.begin(); iter != bone_info->mChildList.end(); ++iter)
-    {
-        makeJointAliases( *iter );
-    }
-}
-
 const LLAvatarAppearance::joint_alias_map_t& LLAvatarAppearance::getJointAliases ()
 {
-    LLAvatarAppearance::joint_alias_map_t alias_map;
-    if (mJointAliasMap.empty())
-    {
-        
-        LLAvatarSkeletonInfo::bone_info_list_t::const_iterator iter;
-        for (iter = sAvatarSkeletonInfo->mBoneInfoList.begin(); iter != sAvatarSkeletonInfo->mBoneInfoList.end(); ++iter)
-        {
-            //LLAvatarBoneInfo *bone_info = *iter;
-            makeJointAliases( *iter );
-        }
-    }
-    
-    return mJointAliasMap;
-} 
+	return sAvatarSkeletonInfo->getJointAliases();
+}
 
 
 //-----------------------------------------------------------------------------
@@ -39,8 +39,8 @@ class LLTexLayerSet;
 class LLTexGlobalColor;
 class LLTexGlobalColorInfo;
 class LLWearableData;
-class LLAvatarBoneInfo;
 class LLAvatarSkeletonInfo;
+class LLAvatarDefinitionCache;
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // LLAvatarAppearance
@@ -69,6 +69,8 @@ public:
 	static void			initClass(const std::string& avatar_file_name, const std::string& skeleton_file_name); // initializes static members
 	static void			initClass();
 	static void			cleanupClass();	// Cleanup data that's only init'd once per class.
+	// Load the cache before initClass(), it is written after the first avatar loaded its meshes
+	static LLAvatarDefinitionCache& getDefinitionCache();
 	virtual void 		initInstance(); // Called after construction to initialize the instance.
 	virtual BOOL		loadSkeletonNode();
 	BOOL				loadMeshNodes();
@@ -127,7 +129,6 @@ protected:
 	virtual LLAvatarJoint*	createAvatarJoint() = 0;
     virtual LLAvatarJoint*  createAvatarJoint(S32 joint_num) = 0;
 	virtual LLAvatarJointMesh*	createAvatarJointMesh() = 0;
-    void makeJointAliases(LLAvatarBoneInfo *bone_info);
 
 
 public:
@@ -159,15 +160,15 @@ protected:
 	virtual void		buildCharacter();
 	virtual BOOL		loadAvatar();
 
-	BOOL				setupBone(const LLAvatarBoneInfo* info, LLJoint* parent, S32 &current_volume_num, S32 &current_joint_num);
 	BOOL				allocateCharacterJoints(U32 num);
 	BOOL				buildSkeleton(const LLAvatarSkeletonInfo *info);
 
 	void				clearSkeleton();
+	// A bone or collision volume by name, through the shared skeleton
+	LLJoint*			findSkeletonJoint(const std::string& name);
 	BOOL				mIsBuilt; // state of deferred character building
 	avatar_joint_list_t	mSkeleton;
 	LLVector3OverrideMap	mPelvisFixups;
-    joint_alias_map_t   mJointAliasMap;
 
 	//--------------------------------------------------------------------
 	// Pelvis height adjustment members.
@@ -216,6 +217,9 @@ protected:
 	static LLAvatarSkeletonInfo* 					sAvatarSkeletonInfo;
 	static LLAvatarXmlInfo* 						sAvatarXmlInfo;
 
+	static LLAvatarDefinitionCache					sDefinitionCache;
+	static bool										sSaveDefinitionCache; // until the first avatar loaded its meshes
+
 
 /**                    Skeleton
  **                                                                            **
@@ -257,6 +261,14 @@ public:
 protected:
 	virtual void	dirtyMesh(S32 priority) = 0; // Dirty the avatar mesh, with priority
 
+public:
+	// Morph targets applied in between are added to the meshes together when
+	// the batch ends, the meshes on the thread pool, see LLPolyMesh::queueMorph()
+	void			beginMorphBatch();
+	void			endMorphBatch();
+private:
+	static void		applyQueuedMorphs(std::vector<LLPolyMesh*>* meshes, U32 index);
+
 protected:
 	typedef std::multimap<std::string, LLPolyMesh*> polymesh_map_t;
 	polymesh_map_t 									mPolyMeshes;
@@ -0,0 +1,371 @@
+/**
+ * @file llavatardefinitioncache.cpp
+ * @brief Binary cache of the avatar definition files read at startup
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llavatardefinitioncache.h"
+
+#include "llfile.h"
+#include "llmd5.h"
+#include "llxmltree.h"
+
+// File layout, all numbers in the byte order of the viewer that wrote it:
+//   CACHE_MAGIC, CACHE_VERSION, CACHE_BYTE_ORDER, the number of entries, then
+//   for each entry its type, path, size, modification time, MD5 hash and data,
+//   where strings are a U32 length followed by their bytes.
+static const char CACHE_MAGIC[8] = { 'L', 'L', 'A', 'V', 'D', 'E', 'F', '\0' };
+static const U32 CACHE_BYTE_ORDER = 0x01020304;
+const U32 LLAvatarDefinitionCache::CACHE_VERSION = 1;
+
+namespace
+{
+	template<typename T>
+	void write_value(std::string& buffer, const T& value)
+	{
+		buffer.append((const char*)&value, sizeof(T));
+	}
+
+	void write_string(std::string& buffer, const std::string& str)
+	{
+		write_value(buffer, (U32)str.size());
+		buffer.append(str);
+	}
+
+	template<typename T>
+	bool read_value(const char*& data, const char* end, T& value)
+	{
+		if (end - data < (S32)sizeof(T))
+		{
+			return false;
+		}
+		memcpy(&value, data, sizeof(T));
+		data += sizeof(T);
+		return true;
+	}
+
+	bool read_string(const char*& data, const char* end, std::string& str)
+	{
+		U32 length = 0;
+		if (!read_value(data, end, length) || (U32)(end - data) < length)
+		{
+			return false;
+		}
+		str.assign(data, length);
+		data += length;
+		return true;
+	}
+}
+
+LLAvatarDefinitionCache::Entry::Entry()
+:	mType(TYPE_FILE),
+	mSize(0),
+	mModified(0),
+	mUsed(false)
+{
+	memset(mHash, 0, sizeof(mHash));
+}
+
+LLAvatarDefinitionCache::LLAvatarDefinitionCache()
+:	mDirty(false),
+	mHits(0),
+	mMisses(0)
+{
+}
+
+LLAvatarDefinitionCache::~LLAvatarDefinitionCache()
+{
+}
+
+void LLAvatarDefinitionCache::load(const std::string& cache_path)
+{
+	mCachePath = cache_path;
+	mEntries.clear();
+	mDirty = false;
+	mHits = 0;
+	mMisses = 0;
+	if (mCachePath.empty())
+	{
+		return;
+	}
+
+	std::string buffer;
+	if (!readSource(mCachePath, buffer))
+	{
+		// first run, or the cache directory was cleared
+		return;
+	}
+
+	const char* data = buffer.data();
+	const char* end = data + buffer.size();
+	char magic[sizeof(CACHE_MAGIC)];
+	U32 version = 0, byte_order = 0, num_entries = 0;
+	if (!read_value(data, end, magic) || memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC))
+		|| !read_value(data, end, version) || version != CACHE_VERSION
+		|| !read_value(data, end, byte_order) || byte_order != CACHE_BYTE_ORDER
+		|| !read_value(data, end, num_entries))
+	{
+		LL_INFOS("Avatar") << "Ignoring avatar definition cache " << mCachePath << " of another version" << LL_ENDL;
+		return;
+	}
+
+	for (U32 i = 0; i < num_entries; ++i)
+	{
+		std::string path;
+		Entry entry;
+		if (!read_string(data, end, path)
+			|| !read_value(data, end, entry.mType)
+			|| !read_value(data, end, entry.mSize)
+			|| !read_value(data, end, entry.mModified)
+			|| !read_value(data, end, entry.mHash)
+			|| !read_string(data, end, entry.mData))
+		{
+			LL_WARNS("Avatar") << "Avatar definition cache " << mCachePath << " is truncated, ignoring it" << LL_ENDL;
+			mEntries.clear();
+			return;
+		}
+		mEntries[path] = entry;
+	}
+}
+
+void LLAvatarDefinitionCache::save()
+{
+	if (mCachePath.empty())
+	{
+		return;
+	}
+
+	// entries of files no longer read are dropped
+	for (entry_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); )
+	{
+		if (iter->second.mUsed)
+		{
+			++iter;
+		}
+		else
+		{
+			mEntries.erase(iter++);
+			mDirty = true;
+		}
+	}
+
+	if (mDirty)
+	{
+		std::string buffer;
+		buffer.append(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+		write_value(buffer, CACHE_VERSION);
+		write_value(buffer, CACHE_BYTE_ORDER);
+		write_value(buffer, (U32)mEntries.size());
+		for (entry_map_t::const_iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+		{
+			const Entry& entry = iter->second;
+			write_string(buffer, iter->first);
+			write_value(buffer, entry.mType);
+			write_value(buffer, entry.mSize);
+			write_value(buffer, entry.mModified);
+			write_value(buffer, entry.mHash);
+			write_string(buffer, entry.mData);
+		}
+
+		// written aside and moved over, so that a crash never leaves half a cache
+		std::string temp_path = mCachePath + ".tmp";
+		LLFILE* fp = LLFile::fopen(temp_path, "wb");
+		bool written = false;
+		if (fp)
+		{
+			written = fwrite(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+			written = (fclose(fp) == 0) && written;
+		}
+		if (written)
+		{
+			LLFile::remove(mCachePath, ENOENT);
+			written = LLFile::rename(temp_path, mCachePath) == 0;
+		}
+		if (!written)
+		{
+			LL_WARNS("Avatar") << "Unable to write avatar definition cache " << mCachePath << LL_ENDL;
+			LLFile::remove(temp_path, ENOENT);
+		}
+		else
+		{
+			LL_INFOS("Avatar") << "Wrote avatar definition cache " << mCachePath << ", "
+							   << mEntries.size() << " files, " << buffer.size() << " bytes" << LL_ENDL;
+		}
+	}
+
+	mCachePath.clear();
+	mEntries.clear();
+	mDirty = false;
+}
+
+BOOL LLAvatarDefinitionCache::parseXml(const std::string& path, LLXmlTree& tree, BOOL keep_contents)
+{
+	if (mCachePath.empty())
+	{
+		return tree.parseFile(path, keep_contents);
+	}
+
+	U32 type = keep_contents ? TYPE_XML : TYPE_XML_NO_CONTENTS;
+	std::string contents;
+	bool read = false;
+	Entry* entry = findEntry(path, type, contents, read);
+	if (entry)
+	{
+		if (tree.readBinary((const U8*)entry->mData.data(), entry->mData.size()))
+		{
+			mHits++;
+			return TRUE;
+		}
+		LL_WARNS("Avatar") << "Cached copy of " << path << " is corrupt, parsing the file" << LL_ENDL;
+		mEntries.erase(path);
+		mDirty = true;
+	}
+
+	mMisses++;
+	if (!tree.parseFile(path, keep_contents))
+	{
+		return FALSE;
+	}
+	if (read || readSource(path, contents))
+	{
+		std::string data;
+		tree.writeBinary(data);
+		addEntry(path, type, contents, data);
+	}
+	return TRUE;
+}
+
+BOOL LLAvatarDefinitionCache::readFile(const std::string& path, std::string& data)
+{
+	if (mCachePath.empty())
+	{
+		return readSource(path, data);
+	}
+
+	std::string contents;
+	bool read = false;
+	Entry* entry = findEntry(path, TYPE_FILE, contents, read);
+	if (entry)
+	{
+		mHits++;
+		data = entry->mData;
+		return TRUE;
+	}
+
+	mMisses++;
+	if (!read && !readSource(path, contents))
+	{
+		return FALSE;
+	}
+	addEntry(path, TYPE_FILE, contents, contents);
+	data.swap(contents);
+	return TRUE;
+}
+
+LLAvatarDefinitionCache::Entry* LLAvatarDefinitionCache::findEntry(const std::string& path, U32 type,
+																   std::string& contents, bool& read)
+{
+	read = false;
+	entry_map_t::iterator iter = mEntries.find(path);
+	if (iter == mEntries.end() || iter->second.mType != type)
+	{
+		return NULL;
+	}
+	Entry& entry = iter->second;
+
+	llstat stat_data;
+	if (LLFile::stat(path, &stat_data))
+	{
+		return NULL;
+	}
+	if (entry.mSize != (S64)stat_data.st_size || entry.mModified != (S64)stat_data.st_mtime)
+	{
+		// touched or copied over, only a different hash means a different file
+		if (!readSource(path, contents))
+		{
+			return NULL;
+		}
+		read = true;
+		U8 hash[16];
+		hashContents(contents, hash);
+		if (memcmp(hash, entry.mHash, sizeof(hash)))
+		{
+			return NULL;
+		}
+		entry.mSize = stat_data.st_size;
+		entry.mModified = stat_data.st_mtime;
+		mDirty = true;
+	}
+	entry.mUsed = true;
+	return &entry;
+}
+
+void LLAvatarDefinitionCache::addEntry(const std::string& path, U32 type, const std::string& contents, const std::string& data)
+{
+	llstat stat_data;
+	if (LLFile::stat(path, &stat_data))
+	{
+		return;
+	}
+
+	Entry& entry = mEntries[path];
+	entry.mType = type;
+	entry.mSize = stat_data.st_size;
+	entry.mModified = stat_data.st_mtime;
+	hashContents(contents, entry.mHash);
+	entry.mData = data;
+	entry.mUsed = true;
+	mDirty = true;
+}
+
+// static
+BOOL LLAvatarDefinitionCache::readSource(const std::string& path, std::string& contents)
+{
+	LLFILE* fp = LLFile::fopen(path, "rb");
+	if (!fp)
+	{
+		return FALSE;
+	}
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	BOOL success = size >= 0;
+	if (success)
+	{
+		contents.resize(size);
+		success = size == 0 || fread(&contents[0], 1, size, fp) == (size_t)size;
+	}
+	fclose(fp);
+	return success;
+}
+
+// static
+void LLAvatarDefinitionCache::hashContents(const std::string& contents, U8* hash)
+{
+	LLMD5 md5;
+	md5.update((const U8*)contents.data(), contents.size());
+	md5.finalize();
+	md5.raw_digest(hash);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file llavatardefinitioncache.h
+ * @brief Binary cache of the avatar definition files read at startup
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARDEFINITIONCACHE_H
+#define LL_LLAVATARDEFINITIONCACHE_H
+
+#include <map>
+#include <string>
+
+class LLXmlTree;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLAvatarDefinitionCache
+//
+// avatar_lad.xml and avatar_skeleton.xml as parsed trees, and the bytes of the
+// .llm meshes, kept together in one file in the cache directory.  load() reads
+// the whole file at once, parseXml() then builds a tree from its binary copy
+// instead of parsing the XML, and readFile() hands out a mesh file without
+// opening it.
+//
+// Each entry records the MD5 hash of the file it came from, along with its
+// size and modification time.  When the size or time of the file differ, the
+// file is hashed again and the entry is replaced unless the hash still
+// matches, so edited or updated files are picked up on their own.  save()
+// writes the entries used since load() back, when any of them changed.
+//
+// When the cache is disabled both calls simply read the files.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLAvatarDefinitionCache
+{
+public:
+	// Change whenever the file layout or LLXmlTree::writeBinary() changes
+	static const U32 CACHE_VERSION;
+
+	LLAvatarDefinitionCache();
+	~LLAvatarDefinitionCache();
+
+	// Uses the cache file at the path, an empty path disables the cache
+	void load(const std::string& cache_path);
+	// Writes the cache file if anything changed and drops the cached data
+	void save();
+
+	bool isEnabled() const		{ return !mCachePath.empty(); }
+
+	// The XML file parsed into the tree, as LLXmlTree::parseFile() would
+	BOOL parseXml(const std::string& path, LLXmlTree& tree, BOOL keep_contents = TRUE);
+	// The contents of the file
+	BOOL readFile(const std::string& path, std::string& data);
+
+	U32 getNumHits() const		{ return mHits; }
+	U32 getNumMisses() const	{ return mMisses; }
+
+private:
+	enum EType
+	{
+		TYPE_XML = 0,
+		TYPE_XML_NO_CONTENTS,
+		TYPE_FILE
+	};
+
+	struct Entry
+	{
+		Entry();
+
+		U32			mType;
+		S64			mSize;
+		S64			mModified;
+		U8			mHash[16];
+		std::string	mData;
+		bool		mUsed;
+	};
+	typedef std::map<std::string, Entry> entry_map_t;
+
+	// the entry of the path and type if it still matches the file, the file
+	// is read into contents when it had to be hashed
+	Entry* findEntry(const std::string& path, U32 type, std::string& contents, bool& read);
+	// records a file read from disk, along with the data kept for it
+	void addEntry(const std::string& path, U32 type, const std::string& contents, const std::string& data);
+
+	static BOOL readSource(const std::string& path, std::string& contents);
+	static void hashContents(const std::string& contents, U8* hash);
+
+	std::string		mCachePath;
+	entry_map_t		mEntries;
+	bool			mDirty;
+	U32				mHits;
+	U32				mMisses;
+};
+
+#endif // LL_LLAVATARDEFINITIONCACHE_H
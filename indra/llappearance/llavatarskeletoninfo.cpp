@@ -0,0 +1,277 @@
+/**
+ * @file llavatarskeletoninfo.cpp
+ * @brief The avatar skeleton shared by all avatars, as avatar_skeleton.xml describes it
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llavatarskeletoninfo.h"
+
+#include "llxmltree.h"
+#include "boost/tokenizer.hpp"
+
+LLAvatarSkeletonInfo::LLAvatarSkeletonInfo() :
+	mNumBones(0),
+	mNumCollisionVolumes(0)
+{
+}
+
+LLAvatarSkeletonInfo::~LLAvatarSkeletonInfo()
+{
+}
+
+//-----------------------------------------------------------------------------
+// parseXml()
+//-----------------------------------------------------------------------------
+BOOL LLAvatarSkeletonInfo::parseXml(LLXmlTreeNode* node)
+{
+	static LLStdStringHandle num_bones_string = LLXmlTree::addAttributeString("num_bones");
+	if (!node->getFastAttributeS32(num_bones_string, mNumBones))
+	{
+		LL_WARNS() << "Couldn't find number of bones." << LL_ENDL;
+		return FALSE;
+	}
+
+	static LLStdStringHandle num_collision_volumes_string = LLXmlTree::addAttributeString("num_collision_volumes");
+	node->getFastAttributeS32(num_collision_volumes_string, mNumCollisionVolumes);
+
+	S32 joint_num = 0;
+	S32 volume_num = 0;
+	LLXmlTreeNode* child;
+	for( child = node->getFirstChild(); child; child = node->getNextChild() )
+	{
+		if (!parseBone(child, -1, joint_num, volume_num))
+		{
+			LL_WARNS() << "Error parsing bone in skeleton file" << LL_ENDL;
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// parseBone(): adds a bone or collision volume and its children
+//-----------------------------------------------------------------------------
+BOOL LLAvatarSkeletonInfo::parseBone(LLXmlTreeNode* node, S32 parent, S32& joint_num, S32& volume_num)
+{
+	BoneTemplate bone;
+	bone.mParent = parent;
+	std::string name;
+	std::string aliases;
+	if (node->hasName("bone"))
+	{
+		bone.mIsJoint = TRUE;
+		static LLStdStringHandle name_string = LLXmlTree::addAttributeString("name");
+		if (!node->getFastAttributeString(name_string, name))
+		{
+			LL_WARNS() << "Bone without name" << LL_ENDL;
+			return FALSE;
+		}
+
+		static LLStdStringHandle aliases_string = LLXmlTree::addAttributeString("aliases");
+		node->getFastAttributeString(aliases_string, aliases); //Aliases are not required.
+	}
+	else if (node->hasName("collision_volume"))
+	{
+		bone.mIsJoint = FALSE;
+		static LLStdStringHandle name_string = LLXmlTree::addAttributeString("name");
+		if (!node->getFastAttributeString(name_string, name))
+		{
+			name = "Collision Volume";
+		}
+	}
+	else
+	{
+		LL_WARNS() << "Invalid node " << node->getName() << LL_ENDL;
+		return FALSE;
+	}
+	bone.mName = LLJoint::addName(name);
+
+	static LLStdStringHandle pos_string = LLXmlTree::addAttributeString("pos");
+	if (!node->getFastAttributeVector3(pos_string, bone.mPos))
+	{
+		LL_WARNS() << "Bone without position" << LL_ENDL;
+		return FALSE;
+	}
+
+	static LLStdStringHandle rot_string = LLXmlTree::addAttributeString("rot");
+	LLVector3 rot;
+	if (!node->getFastAttributeVector3(rot_string, rot))
+	{
+		LL_WARNS() << "Bone without rotation" << LL_ENDL;
+		return FALSE;
+	}
+	bone.mRot = mayaQ(rot.mV[VX], rot.mV[VY], rot.mV[VZ], LLQuaternion::XYZ);
+
+	static LLStdStringHandle scale_string = LLXmlTree::addAttributeString("scale");
+	if (!node->getFastAttributeVector3(scale_string, bone.mScale))
+	{
+		LL_WARNS() << "Bone without scale" << LL_ENDL;
+		return FALSE;
+	}
+
+	static LLStdStringHandle end_string = LLXmlTree::addAttributeString("end");
+	if (!node->getFastAttributeVector3(end_string, bone.mEnd))
+	{
+		LL_WARNS() << "Bone without end " << name << LL_ENDL;
+		bone.mEnd = LLVector3(0.0f, 0.0f, 0.0f);
+	}
+
+	static LLStdStringHandle support_string = LLXmlTree::addAttributeString("support");
+	std::string support;
+	if (!node->getFastAttributeString(support_string, support))
+	{
+		LL_WARNS() << "Bone without support " << name << LL_ENDL;
+		support = "base";
+	}
+	if (support == "extended")
+	{
+		bone.mSupport = LLJoint::SUPPORT_EXTENDED;
+	}
+	else
+	{
+		if (support != "base")
+		{
+			LL_WARNS() << "unknown support string " << support << LL_ENDL;
+		}
+		bone.mSupport = LLJoint::SUPPORT_BASE;
+	}
+
+	if (bone.mIsJoint)
+	{
+		static LLStdStringHandle pivot_string = LLXmlTree::addAttributeString("pivot");
+		if (!node->getFastAttributeVector3(pivot_string, bone.mPivot))
+		{
+			LL_WARNS() << "Bone without pivot" << LL_ENDL;
+			return FALSE;
+		}
+		bone.mIndex = joint_num++;
+		bone.mJointNum = bone.mIndex;
+		addJointAliases(name, aliases);
+	}
+	else
+	{
+		bone.mIndex = volume_num++;
+		bone.mJointNum = mNumBones + bone.mIndex;
+	}
+
+	S32 index = (S32)mBones.size();
+	mBoneIndex.insert(std::make_pair(name, index));
+	mBones.push_back(bone);
+
+	// parse children
+	LLXmlTreeNode* child;
+	for( child = node->getFirstChild(); child; child = node->getNextChild() )
+	{
+		if (!parseBone(child, index, joint_num, volume_num))
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// addJointAliases()
+//-----------------------------------------------------------------------------
+void LLAvatarSkeletonInfo::addJointAliases(const std::string& bone_name, const std::string& aliases)
+{
+	mJointAliasMap[bone_name] = bone_name; //Actual name is a valid alias.
+
+	boost::char_separator<char> sep(" ");
+	boost::tokenizer<boost::char_separator<char> > tok(aliases, sep);
+	for(boost::tokenizer<boost::char_separator<char> >::iterator i = tok.begin(); i != tok.end(); ++i)
+	{
+		if ( mJointAliasMap.find(*i) != mJointAliasMap.end() )
+		{
+			LL_WARNS() << "avatar skeleton:  Joint alias \"" << *i << "\" remapped from " << mJointAliasMap[*i] << " to " << bone_name << LL_ENDL;
+		}
+		mJointAliasMap[*i] = bone_name;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// findBone()
+//-----------------------------------------------------------------------------
+S32 LLAvatarSkeletonInfo::findBone(const std::string& name) const
+{
+	bone_index_map_t::const_iterator iter = mBoneIndex.find(name);
+	return iter != mBoneIndex.end() ? iter->second : -1;
+}
+
+//-----------------------------------------------------------------------------
+// setupJoints()
+//-----------------------------------------------------------------------------
+BOOL LLAvatarSkeletonInfo::setupJoints(LLJoint* const* bones, S32 num_bones, LLJoint* const* volumes, S32 num_volumes) const
+{
+	// the joints of the bones set up so far, by index in mBones
+	std::vector<LLJoint*> joints(mBones.size(), NULL);
+	for (U32 i = 0; i < mBones.size(); ++i)
+	{
+		const BoneTemplate& bone = mBones[i];
+		LLJoint* joint = NULL;
+		if (bone.mIsJoint)
+		{
+			if (bone.mIndex >= num_bones || !bones[bone.mIndex])
+			{
+				LL_WARNS() << "Too many bones" << LL_ENDL;
+				return FALSE;
+			}
+			joint = bones[bone.mIndex];
+		}
+		else
+		{
+			if (bone.mIndex >= num_volumes)
+			{
+				LL_WARNS() << "Too many collision volumes" << LL_ENDL;
+				return FALSE;
+			}
+			joint = volumes[bone.mIndex];
+		}
+		joints[i] = joint;
+		joint->setName(bone.mName);
+
+		// add to parent
+		LLJoint* parent = bone.mParent >= 0 ? joints[bone.mParent] : NULL;
+		if (parent && (joint->getParent()!=parent))
+		{
+			parent->addChild( joint );
+		}
+
+		// SL-315
+		joint->setPosition(bone.mPos);
+		joint->setDefaultPosition(bone.mPos);
+		joint->setRotation(bone.mRot);
+		joint->setScale(bone.mScale);
+		joint->setDefaultScale(bone.mScale);
+		joint->setSupport(bone.mSupport);
+		joint->setEnd(bone.mEnd);
+		if (bone.mIsJoint)
+		{
+			joint->setSkinOffset(bone.mPivot);
+		}
+		joint->setJointNum(bone.mJointNum);
+	}
+	return TRUE;
+}
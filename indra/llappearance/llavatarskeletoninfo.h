@@ -0,0 +1,100 @@
+/**
+ * @file llavatarskeletoninfo.h
+ * @brief The avatar skeleton shared by all avatars, as avatar_skeleton.xml describes it
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARSKELETONINFO_H
+#define LL_LLAVATARSKELETONINFO_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lljoint.h"
+#include "llquaternion.h"
+#include "v3math.h"
+
+class LLXmlTreeNode;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLAvatarSkeletonInfo
+//
+// The bones and collision volumes of avatar_skeleton.xml, parsed once and
+// shared by every avatar.  Each one is kept in a flat list in the order of
+// the file, parents before their children, with everything an avatar sets
+// on its joint already worked out, so that building a skeleton is a single
+// pass copying the values to the avatar's own joints.  The joints keep the
+// names the template has, not copies of them.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLAvatarSkeletonInfo
+{
+public:
+	struct BoneTemplate
+	{
+		LLStdStringHandle			mName;		// the joints' shared copy
+		S32							mParent;	// index in the bone list, -1 for a root
+		BOOL						mIsJoint;	// bone, or collision volume
+		S32							mIndex;		// bone number, or collision volume number
+		S32							mJointNum;	// collision volumes follow the bones
+		LLJoint::SupportCategory	mSupport;
+		LLVector3					mPos;
+		LLQuaternion				mRot;
+		LLVector3					mScale;
+		LLVector3					mEnd;
+		LLVector3					mPivot;		// bones only
+	};
+	typedef std::vector<BoneTemplate> bone_list_t;
+	typedef std::map<std::string, std::string> joint_alias_map_t;
+
+	LLAvatarSkeletonInfo();
+	~LLAvatarSkeletonInfo();
+
+	BOOL parseXml(LLXmlTreeNode* node);
+
+	S32 getNumBones() const { return mNumBones; }
+	S32 getNumCollisionVolumes() const { return mNumCollisionVolumes; }
+	const bone_list_t& getBones() const { return mBones; }
+	// Index in getBones() of the bone or collision volume, -1 if none has the name
+	S32 findBone(const std::string& name) const;
+	// Name and aliases of every bone, to the bone name
+	const joint_alias_map_t& getJointAliases() const { return mJointAliasMap; }
+
+	// Sets up an avatar's joints as the file describes them, joining them
+	// to their parents.  The arrays are the avatar's joints by bone number
+	// and by collision volume number.
+	BOOL setupJoints(LLJoint* const* bones, S32 num_bones, LLJoint* const* volumes, S32 num_volumes) const;
+
+private:
+	BOOL parseBone(LLXmlTreeNode* node, S32 parent, S32& joint_num, S32& volume_num);
+	void addJointAliases(const std::string& bone_name, const std::string& aliases);
+
+	S32					mNumBones;
+	S32					mNumCollisionVolumes;
+	bone_list_t			mBones;
+	typedef std::map<std::string, S32> bone_index_map_t;
+	bone_index_map_t	mBoneIndex;
+	joint_alias_map_t	mJointAliasMap;
+};
+
+#endif // LL_LLAVATARSKELETONINFO_H
@@ -213,14 +213,22 @@ void LLDriverParam::setWeight(F32 weight)
 {
 	F32 min_weight = getMinWeight();
 	F32 max_weight = getMaxWeight();
-	if (mIsAnimating)
+	const BOOL is_animating = isAnimating();
+	LLVisualParamWeight& slot = getWeightSlot();
+	F32 old_weight = slot.mCur;
+	if (is_animating)
 	{
 		// allow overshoot when animating
-		mCurWeight = weight;
+		slot.mCur = weight;
 	}
 	else
 	{
-		mCurWeight = llclamp(weight, min_weight, max_weight);
+		slot.mCur = llclamp(weight, min_weight, max_weight);
+	}
+	const F32 cur_weight = slot.mCur;
+	if (cur_weight != old_weight)
+	{
+		markDirty();
 	}
 
 	//	driven    ________
@@ -241,14 +249,14 @@ void LLDriverParam::setWeight(F32 weight)
 		F32 driven_min = driven->mParam->getMinWeight();
 		F32 driven_max = driven->mParam->getMaxWeight();
 
-		if (mIsAnimating)
+		if (is_animating)
 		{
 			// driven param doesn't interpolate (textures, for example)
 			if (!driven->mParam->getAnimating())
 			{
 				continue;
 			}
-			if( mCurWeight < info->mMin1 )
+			if( cur_weight < info->mMin1 )
 			{
 				if (info->mMin1 == min_weight)
 				{
@@ -259,7 +267,7 @@ void LLDriverParam::setWeight(F32 weight)
 					else
 					{
 						//up slope extrapolation
-						F32 t = (mCurWeight - info->mMin1) / (info->mMax1 - info->mMin1 );
+						F32 t = (cur_weight - info->mMin1) / (info->mMax1 - info->mMin1 );
 						driven_weight = driven_min + t * (driven_max - driven_min);
 					}
 				}
@@ -272,7 +280,7 @@ void LLDriverParam::setWeight(F32 weight)
 				continue;
 			}
 			else 
-			if ( mCurWeight > info->mMin2 )
+			if ( cur_weight > info->mMin2 )
 			{
 				if (info->mMin2 == max_weight)
 				{
@@ -283,7 +291,7 @@ void LLDriverParam::setWeight(F32 weight)
 					else
 					{
 						//down slope extrapolation					
-						F32 t = (mCurWeight - info->mMax2) / (info->mMin2 - info->mMax2 );
+						F32 t = (cur_weight - info->mMax2) / (info->mMin2 - info->mMax2 );
 						driven_weight = driven_max + t * (driven_min - driven_max);
 					}
 				}
@@ -297,7 +305,7 @@ void LLDriverParam::setWeight(F32 weight)
 			}
 		}
 
-		driven_weight = getDrivenWeight(driven, mCurWeight);
+		driven_weight = getDrivenWeight(driven, cur_weight);
 		setDrivenWeight(driven,driven_weight);
 	}
 }
@@ -451,7 +459,7 @@ void LLDriverParam::setAnimationTarget( F32 target_value)
 	for( entry_list_t::iterator iter = mDriven.begin(); iter != mDriven.end(); iter++ )
 	{
 		LLDrivenEntry* driven = &(*iter);
-		F32 driven_weight = getDrivenWeight(driven, mTargetWeight);
+		F32 driven_weight = getDrivenWeight(driven, getWeightSlot().mTarget);
 
 		// this isn't normally necessary, as driver params handle interpolation of their driven params
 		// but texture params need to know to assume their final value at beginning of interpolation
@@ -35,6 +35,7 @@
 //#include "llviewercontrol.h"
 #include "llxmltree.h"
 #include "llavatarappearance.h"
+#include "llavatardefinitioncache.h"
 #include "llwearable.h"
 #include "lldir.h"
 #include "llvolume.h"
@@ -273,25 +274,26 @@ BOOL LLPolyMeshSharedData::allocateJointNames( U32 numJointNames )
 BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 {
         //-------------------------------------------------------------------------
-        // Open the file
+        // Read the file, from the avatar definition cache when it has it
         //-------------------------------------------------------------------------
         if(fileName.empty())
         {
                 LL_ERRS() << "Filename is Empty!" << LL_ENDL;
                 return FALSE;
         }
-        LLFILE* fp = LLFile::fopen(fileName, "rb");                     /*Flawfinder: ignore*/
-        if (!fp)
+        std::string data;
+        if (!LLAvatarAppearance::getDefinitionCache().readFile(fileName, data))
         {
                 LL_ERRS() << "can't open: " << fileName << LL_ENDL;
                 return FALSE;
         }
+        LLPolyMeshReader reader((const U8*)data.data(), data.size());
 
         //-------------------------------------------------------------------------
         // Read a chunk
         //-------------------------------------------------------------------------
         char header[128];               /*Flawfinder: ignore*/
-        if (fread(header, sizeof(char), 128, fp) != 128)
+        if (reader.read(header, sizeof(char), 128) != 128)
         {
                 LL_WARNS() << "Short read" << LL_ENDL;
         }
@@ -307,13 +309,13 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 //----------------------------------------------------------------
                 // File Header (seek past it)
                 //----------------------------------------------------------------
-                fseek(fp, 24, SEEK_SET);
+                reader.seek(24);
 
                 //----------------------------------------------------------------
                 // HasWeights
                 //----------------------------------------------------------------
                 U8 hasWeights;
-                size_t numRead = fread(&hasWeights, sizeof(U8), 1, fp);
+                size_t numRead = reader.read(&hasWeights, sizeof(U8), 1);
                 if (numRead != 1)
                 {
                         LL_ERRS() << "can't read HasWeights flag from " << fileName << LL_ENDL;
@@ -328,7 +330,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 // HasDetailTexCoords
                 //----------------------------------------------------------------
                 U8 hasDetailTexCoords;
-                numRead = fread(&hasDetailTexCoords, sizeof(U8), 1, fp);
+                numRead = reader.read(&hasDetailTexCoords, sizeof(U8), 1);
                 if (numRead != 1)
                 {
                         LL_ERRS() << "can't read HasDetailTexCoords flag from " << fileName << LL_ENDL;
@@ -339,7 +341,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 // Position
                 //----------------------------------------------------------------
                 LLVector3 position;
-                numRead = fread(position.mV, sizeof(float), 3, fp);
+                numRead = reader.read(position.mV, sizeof(float), 3);
                 llendianswizzle(position.mV, sizeof(float), 3);
                 if (numRead != 3)
                 {
@@ -352,7 +354,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 // Rotation
                 //----------------------------------------------------------------
                 LLVector3 rotationAngles;
-                numRead = fread(rotationAngles.mV, sizeof(float), 3, fp);
+                numRead = reader.read(rotationAngles.mV, sizeof(float), 3);
                 llendianswizzle(rotationAngles.mV, sizeof(float), 3);
                 if (numRead != 3)
                 {
@@ -361,7 +363,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 }
 
                 U8 rotationOrder;
-                numRead = fread(&rotationOrder, sizeof(U8), 1, fp);
+                numRead = reader.read(&rotationOrder, sizeof(U8), 1);
 
                 if (numRead != 1)
                 {
@@ -380,7 +382,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 // Scale
                 //----------------------------------------------------------------
                 LLVector3 scale;
-                numRead = fread(scale.mV, sizeof(float), 3, fp);
+                numRead = reader.read(scale.mV, sizeof(float), 3);
                 llendianswizzle(scale.mV, sizeof(float), 3);
                 if (numRead != 3)
                 {
@@ -401,7 +403,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 //----------------------------------------------------------------
                 if (!isLOD())
                 {
-                        numRead = fread(&numVertices, sizeof(U16), 1, fp);
+                        numRead = reader.read(&numVertices, sizeof(U16), 1);
                         llendianswizzle(&numVertices, sizeof(U16), 1);
                         if (numRead != 1)
                         {
@@ -416,7 +418,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 							//----------------------------------------------------------------
 							// Coords
 							//----------------------------------------------------------------
-							numRead = fread(&mBaseCoords[i], sizeof(float), 3, fp);
+							numRead = reader.read(&mBaseCoords[i], sizeof(float), 3);
 							llendianswizzle(&mBaseCoords[i], sizeof(float), 3);
 							if (numRead != 3)
 							{
@@ -430,7 +432,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 							//----------------------------------------------------------------
 							// Normals
 							//----------------------------------------------------------------
-							numRead = fread(&mBaseNormals[i], sizeof(float), 3, fp);
+							numRead = reader.read(&mBaseNormals[i], sizeof(float), 3);
 							llendianswizzle(&mBaseNormals[i], sizeof(float), 3);
 							if (numRead != 3)
 							{
@@ -444,7 +446,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 							//----------------------------------------------------------------
 							// Binormals
 							//----------------------------------------------------------------
-							numRead = fread(&mBaseBinormals[i], sizeof(float), 3, fp);
+							numRead = reader.read(&mBaseBinormals[i], sizeof(float), 3);
 							llendianswizzle(&mBaseBinormals[i], sizeof(float), 3);
 							if (numRead != 3)
 							{
@@ -456,7 +458,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         //----------------------------------------------------------------
                         // TexCoords
                         //----------------------------------------------------------------
-                        numRead = fread(mTexCoords, 2*sizeof(float), numVertices, fp);
+                        numRead = reader.read(mTexCoords, 2*sizeof(float), numVertices);
                         llendianswizzle(mTexCoords, sizeof(float), 2*numVertices);
                         if (numRead != numVertices)
                         {
@@ -469,7 +471,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         //----------------------------------------------------------------
                         if (mHasDetailTexCoords)
                         {
-                                numRead = fread(mDetailTexCoords, 2*sizeof(float), numVertices, fp);
+                                numRead = reader.read(mDetailTexCoords, 2*sizeof(float), numVertices);
                                 llendianswizzle(mDetailTexCoords, sizeof(float), 2*numVertices);
                                 if (numRead != numVertices)
                                 {
@@ -483,7 +485,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         //----------------------------------------------------------------
                         if (mHasWeights)
                         {
-                                numRead = fread(mWeights, sizeof(float), numVertices, fp);
+                                numRead = reader.read(mWeights, sizeof(float), numVertices);
                                 llendianswizzle(mWeights, sizeof(float), numVertices);
                                 if (numRead != numVertices)
                                 {
@@ -497,7 +499,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 // NumFaces
                 //----------------------------------------------------------------
                 U16 numFaces;
-                numRead = fread(&numFaces, sizeof(U16), 1, fp);
+                numRead = reader.read(&numFaces, sizeof(U16), 1);
                 llendianswizzle(&numFaces, sizeof(U16), 1);
                 if (numRead != 1)
                 {
@@ -515,7 +517,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 for (i = 0; i < numFaces; i++)
                 {
                         S16 face[3];
-                        numRead = fread(face, sizeof(U16), 3, fp);
+                        numRead = reader.read(face, sizeof(U16), 3);
                         llendianswizzle(face, sizeof(U16), 3);
                         if (numRead != 3)
                         {
@@ -572,7 +574,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         U16 numSkinJoints = 0;
                         if ( mHasWeights )
                         {
-                                numRead = fread(&numSkinJoints, sizeof(U16), 1, fp);
+                                numRead = reader.read(&numSkinJoints, sizeof(U16), 1);
                                 llendianswizzle(&numSkinJoints, sizeof(U16), 1);
                                 if (numRead != 1)
                                 {
@@ -588,7 +590,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         for (i=0; i < numSkinJoints; i++)
                         {
                                 char jointName[64+1];
-                                numRead = fread(jointName, sizeof(jointName)-1, 1, fp);
+                                numRead = reader.read(jointName, sizeof(jointName)-1, 1);
                                 jointName[sizeof(jointName)-1] = '\0'; // ensure nul-termination
                                 if (numRead != 1)
                                 {
@@ -605,7 +607,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         //-------------------------------------------------------------------------
                         char morphName[64+1];
                         morphName[sizeof(morphName)-1] = '\0'; // ensure nul-termination
-                        while(fread(&morphName, sizeof(char), 64, fp) == 64)
+                        while(reader.read(&morphName, sizeof(char), 64) == 64)
                         {
                                 if (!strcmp(morphName, "End Morphs"))
                                 {
@@ -614,7 +616,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                                 }
                                 LLPolyMorphData* morph_data = new LLPolyMorphData(std::string(morphName));
 
-                                BOOL result = morph_data->loadBinary(fp, this);
+                                BOOL result = morph_data->loadBinary(reader, this);
 
                                 if (!result)
                                 {
@@ -678,19 +680,19 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                         }
 
                         S32 numRemaps;
-                        if (fread(&numRemaps, sizeof(S32), 1, fp) == 1)
+                        if (reader.read(&numRemaps, sizeof(S32), 1) == 1)
                         {
                                 llendianswizzle(&numRemaps, sizeof(S32), 1);
                                 for (S32 i = 0; i < numRemaps; i++)
                                 {
                                         S32 remapSrc;
                                         S32 remapDst;
-                                        if (fread(&remapSrc, sizeof(S32), 1, fp) != 1)
+                                        if (reader.read(&remapSrc, sizeof(S32), 1) != 1)
                                         {
                                                 LL_ERRS() << "can't read source vertex in vertex remap data" << LL_ENDL;
                                                 break;
                                         }
-                                        if (fread(&remapDst, sizeof(S32), 1, fp) != 1)
+                                        if (reader.read(&remapDst, sizeof(S32), 1) != 1)
                                         {
                                                 LL_ERRS() << "can't read destination vertex in vertex remap data" << LL_ENDL;
                                                 break;
@@ -716,8 +718,6 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 allocateJointNames(1);
         }
 
-        fclose( fp );
-
         return status;
 }
 
@@ -756,6 +756,8 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
 	mAvatarp = NULL;
 	mVertexData = NULL;
 
+	mBatchingMorphs = false;
+
 	mCurVertexCount = 0;
 	mFaceIndexCount = 0;
 	mFaceIndexOffset = 0;
@@ -988,6 +990,117 @@ void LLPolyMesh::initializeForMorph()
 	}
 }
 
+//-----------------------------------------------------------------------------
+// queueMorph()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::queueMorph(LLPolyMorphData* morph_data, const F32* mask_weights, BOOL is_clothing_morph, F32 delta_weight)
+{
+	QueuedMorph morph;
+	morph.mMorphData = morph_data;
+	morph.mMaskWeights = mask_weights;
+	morph.mIsClothingMorph = is_clothing_morph;
+	morph.mDeltaWeight = delta_weight;
+	mQueuedMorphs.push_back(morph);
+
+	if (!mBatchingMorphs)
+	{
+		applyQueuedMorphs();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// applyQueuedMorphs()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::applyQueuedMorphs()
+{
+	if (mQueuedMorphs.empty())
+	{
+		return;
+	}
+
+	if (mVertexMorphed.size() < mSharedData->mNumVertices)
+	{
+		mVertexMorphed.resize(mSharedData->mNumVertices, 0);
+	}
+
+	// add up the deltas, in the order the morphs were applied
+	for (U32 m = 0; m < mQueuedMorphs.size(); ++m)
+	{
+		const QueuedMorph& morph = mQueuedMorphs[m];
+		const LLPolyMorphData* morph_data = morph.mMorphData;
+		F32 delta_weight = morph.mDeltaWeight;
+
+		for (U32 vert_index_morph = 0; vert_index_morph < morph_data->mNumIndices; vert_index_morph++)
+		{
+			S32 vert_index_mesh = morph_data->mVertexIndices[vert_index_morph];
+
+			F32 maskWeight = 1.f;
+			if (morph.mMaskWeights)
+			{
+				maskWeight = morph.mMaskWeights[vert_index_morph];
+			}
+
+			LLVector4a pos = morph_data->mCoords[vert_index_morph];
+			pos.mul(delta_weight*maskWeight);
+			mCoords[vert_index_mesh].add(pos);
+
+			if (morph.mIsClothingMorph && mClothingWeights)
+			{
+				LLVector4a clothing_offset = morph_data->mCoords[vert_index_morph];
+				clothing_offset.mul(delta_weight * maskWeight);
+				LLVector4a* clothing_weight = &mClothingWeights[vert_index_mesh];
+				clothing_weight->add(clothing_offset);
+				clothing_weight->getF32ptr()[VW] = maskWeight;
+			}
+
+			LLVector4a norm = morph_data->mNormals[vert_index_morph];
+			norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+			mScaledNormals[vert_index_mesh].add(norm);
+
+			LLVector4a binorm = morph_data->mBinormals[vert_index_morph];
+
+			// guard against degenerate input data before we create NaNs below!
+			//
+			if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+			{
+				binorm.set(1,0,0,1);
+			}
+
+			binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+			mScaledBinormals[vert_index_mesh].add(binorm);
+
+			mTexCoords[vert_index_mesh] += morph_data->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
+
+			if (!mVertexMorphed[vert_index_mesh])
+			{
+				mVertexMorphed[vert_index_mesh] = 1;
+				mMorphedVertices.push_back(vert_index_mesh);
+			}
+		}
+	}
+	mQueuedMorphs.clear();
+
+	// then calculate new normals based on half angles, and new binormals,
+	// once per vertex
+	for (U32 i = 0; i < mMorphedVertices.size(); ++i)
+	{
+		U32 vert_index_mesh = mMorphedVertices[i];
+		mVertexMorphed[vert_index_mesh] = 0;
+
+		LLVector4a norm = mScaledNormals[vert_index_mesh];
+		norm.normalize3fast();
+		mNormals[vert_index_mesh] = norm;
+
+		LLVector4a tangent;
+		tangent.setCross3(mScaledBinormals[vert_index_mesh], norm);
+		LLVector4a& normalized_binormal = mBinormals[vert_index_mesh];
+
+		normalized_binormal.setCross3(norm, tangent); 
+		normalized_binormal.normalize3fast();
+	}
+	mMorphedVertices.clear();
+}
+
 //-----------------------------------------------------------------------------
 // getMorphData()
 //-----------------------------------------------------------------------------
@@ -37,6 +37,9 @@
 #include "llpolymorph.h"
 #include "lljoint.h"
 
+// scales the morph target normal and binormal deltas, see LLPolyMesh::queueMorph()
+const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
+
 class LLSkinJoint;
 class LLAvatarAppearance;
 class LLWearable;
@@ -109,6 +112,10 @@ public:
 	LLPolyMeshSharedData();
 	~LLPolyMeshSharedData();
 
+	// Cleared vertices, as loadMesh() starts from, also for meshes built
+	// without a file
+	BOOL allocateVertexData( U32 numVertices );
+
 private:
 	void setupLOD(LLPolyMeshSharedData* reference_data);
 
@@ -119,8 +126,6 @@ private:
 	void setRotation( const LLQuaternion &rot ) { mRotation = rot; }
 	void setScale( const LLVector3 &scale ) { mScale = scale; }
 
-	BOOL allocateVertexData( U32 numVertices );
-
 	BOOL allocateFaceData( U32 numFaces );
 
 	BOOL allocateJointNames( U32 numJointNames );
@@ -321,6 +326,19 @@ public:
 	void setAvatar(LLAvatarAppearance* avatarp) { mAvatarp = avatarp; }
 	LLAvatarAppearance* getAvatar() { return mAvatarp; }
 
+	// Morph target deltas for this mesh, see LLPolyMorphTarget::apply().  A
+	// queued morph is applied right away, unless a batch is open: then the
+	// deltas of all the morphs queued until endMorphBatch() are added in
+	// queue order, and each touched vertex has its normal and binormal
+	// renormalized once instead of once per morph.  The results are the same
+	// either way.  applyQueuedMorphs() only touches this mesh's vertex data,
+	// the meshes of an avatar can be flushed on different threads.
+	void	queueMorph(LLPolyMorphData* morph_data, const F32* mask_weights, BOOL is_clothing_morph, F32 delta_weight);
+	void	beginMorphBatch() { mBatchingMorphs = true; }
+	void	endMorphBatch() { mBatchingMorphs = false; }
+	bool	hasQueuedMorphs() const { return !mQueuedMorphs.empty(); }
+	void	applyQueuedMorphs();
+
 	std::vector<LLJointRenderData*>	mJointRenderData;
 
 	U32				mFaceVertexOffset;
@@ -331,6 +349,18 @@ public:
 private:
 	void initializeForMorph();
 
+	struct QueuedMorph
+	{
+		LLPolyMorphData*	mMorphData;
+		const F32*			mMaskWeights;
+		BOOL				mIsClothingMorph;
+		F32					mDeltaWeight;
+	};
+	std::vector<QueuedMorph>	mQueuedMorphs;
+	std::vector<U32>			mMorphedVertices;	// touched by the queued morphs
+	std::vector<U8>				mVertexMorphed;
+	bool						mBatchingMorphs;
+
 	// Dumps diagnostic information about the global mesh table
 	static void dumpDiagInfo();
 
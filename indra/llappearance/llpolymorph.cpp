@@ -39,7 +39,6 @@
 
 //#include "../tools/imdebug/imdebug.h"
 
-const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
 
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
@@ -104,12 +103,12 @@ LLPolyMorphData::~LLPolyMorphData()
 //-----------------------------------------------------------------------------
 // loadBinary()
 //-----------------------------------------------------------------------------
-BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
+BOOL LLPolyMorphData::loadBinary(LLPolyMeshReader& reader, LLPolyMeshSharedData *mesh)
 {
 	S32 numVertices;
 	S32 numRead;
 
-	numRead = fread(&numVertices, sizeof(S32), 1, fp);
+	numRead = reader.read(&numVertices, sizeof(S32), 1);
 	llendianswizzle(&numVertices, sizeof(S32), 1);
 	if (numRead != 1)
 	{
@@ -146,7 +145,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 	//-------------------------------------------------------------------------
 	for(S32 v = 0; v < numVertices; v++)
 	{
-		numRead = fread(&mVertexIndices[v], sizeof(U32), 1, fp);
+		numRead = reader.read(&mVertexIndices[v], sizeof(U32), 1);
 		llendianswizzle(&mVertexIndices[v], sizeof(U32), 1);
 		if (numRead != 1)
 		{
@@ -160,7 +159,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 		}
 
 
-		numRead = fread(&mCoords[v], sizeof(F32), 3, fp);
+		numRead = reader.read(&mCoords[v], sizeof(F32), 3);
 		llendianswizzle(&mCoords[v], sizeof(F32), 3);
 		if (numRead != 3)
 		{
@@ -180,7 +179,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 			mMaxDistortion = magnitude;
 		}
 
-		numRead = fread(&mNormals[v], sizeof(F32), 3, fp);
+		numRead = reader.read(&mNormals[v], sizeof(F32), 3);
 		llendianswizzle(&mNormals[v], sizeof(F32), 3);
 		if (numRead != 3)
 		{
@@ -188,7 +187,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 			return FALSE;
 		}
 
-		numRead = fread(&mBinormals[v], sizeof(F32), 3, fp);
+		numRead = reader.read(&mBinormals[v], sizeof(F32), 3);
 		llendianswizzle(&mBinormals[v], sizeof(F32), 3);
 		if (numRead != 3)
 		{
@@ -197,7 +196,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 		}
 
 
-		numRead = fread(&mTexCoords[v].mV, sizeof(F32), 2, fp);
+		numRead = reader.read(&mTexCoords[v].mV, sizeof(F32), 2);
 		llendianswizzle(&mTexCoords[v].mV, sizeof(F32), 2);
 		if (numRead != 2)
 		{
@@ -553,92 +552,26 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 	mLastSex = avatar_sex;
 
 	// Check for NaN condition (NaN is detected if a variable doesn't equal itself.
-	if (mCurWeight != mCurWeight)
+	LLVisualParamWeight& slot = getWeightSlot();
+	if (slot.mCur != slot.mCur)
 	{
-		mCurWeight = 0.0;
+		slot.mCur = 0.0;
 	}
-	if (mLastWeight != mLastWeight)
+	if (slot.mLast != slot.mLast)
 	{
-		mLastWeight = mCurWeight+.001;
+		slot.mLast = slot.mCur+.001;
 	}
 
 	// perform differential update of morph
-	F32 delta_weight = ( getSex() & avatar_sex ) ? (mCurWeight - mLastWeight) : (getDefaultWeight() - mLastWeight);
+	F32 delta_weight = ( getSex() & avatar_sex ) ? (slot.mCur - slot.mLast) : (getDefaultWeight() - slot.mLast);
 	// store last weight
-	mLastWeight += delta_weight;
+	slot.mLast += delta_weight;
 
 	if (delta_weight != 0.f)
 	{
 		llassert(!mMesh->isLOD());
-		LLVector4a *coords = mMesh->getWritableCoords();
-
-		LLVector4a *scaled_normals = mMesh->getScaledNormals();
-		LLVector4a *normals = mMesh->getWritableNormals();
-
-		LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
-		LLVector4a *binormals = mMesh->getWritableBinormals();
-
-		LLVector4a *clothing_weights = mMesh->getWritableClothingWeights();
-		LLVector2 *tex_coords = mMesh->getWritableTexCoords();
-
 		F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
-
-		for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
-		{
-			S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
-
-			F32 maskWeight = 1.f;
-			if (maskWeightArray)
-			{
-				maskWeight = maskWeightArray[vert_index_morph];
-			}
-
-
-			LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-			pos.mul(delta_weight*maskWeight);
-			coords[vert_index_mesh].add(pos);
-
-			if (getInfo()->mIsClothingMorph && clothing_weights)
-			{
-				LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-				clothing_offset.mul(delta_weight * maskWeight);
-				LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-				clothing_weight->add(clothing_offset);
-				clothing_weight->getF32ptr()[VW] = maskWeight;
-			}
-
-			// calculate new normals based on half angles
-			LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-			norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-			scaled_normals[vert_index_mesh].add(norm);
-			norm = scaled_normals[vert_index_mesh];
-
-			// guard against degenerate input data before we create NaNs below!
-			//
-			norm.normalize3fast();
-			normals[vert_index_mesh] = norm;
-
-			// calculate new binormals
-			LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
-
-			// guard against degenerate input data before we create NaNs below!
-			//
-			if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
-			{
-				binorm.set(1,0,0,1);
-			}
-
-			binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-			scaled_binormals[vert_index_mesh].add(binorm);
-			LLVector4a tangent;
-			tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-			LLVector4a& normalized_binormal = binormals[vert_index_mesh];
-
-			normalized_binormal.setCross3(norm, tangent); 
-			normalized_binormal.normalize3fast();
-			
-			tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
-		}
+		mMesh->queueMorph(mMorphData, maskWeightArray, getInfo()->mIsClothingMorph, delta_weight);
 
 		// now apply volume changes
 		for( volume_list_t::iterator iter = mVolumeMorphs.begin(); iter != mVolumeMorphs.end(); iter++ )
@@ -664,6 +597,9 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 //-----------------------------------------------------------------------------
 void	LLPolyMorphTarget::applyMask(U8 *maskTextureData, S32 width, S32 height, S32 num_components, BOOL invert)
 {
+	// morphs still queued were scaled by the old mask weights
+	mMesh->applyQueuedMorphs();
+
 	LLVector4a *clothing_weights = getInfo()->mIsClothingMorph ? mMesh->getWritableClothingWeights() : NULL;
 
 	if (!mVertMask)
@@ -690,9 +626,10 @@ void	LLPolyMorphTarget::applyMask(U8 *maskTextureData, S32 width, S32 height, S3
 			clothing_mask.setElement<2>();
 
 
+			const F32 last_weight = getLastWeight();
 			for(U32 vert = 0; vert < mMorphData->mNumIndices; vert++)
 			{
-				F32 lastMaskWeight = mLastWeight * maskWeights[vert];
+				F32 lastMaskWeight = last_weight * maskWeights[vert];
 				S32 out_vert = mMorphData->mVertexIndices[vert];
 
 				// remove effect of existing masked morph
@@ -725,7 +662,7 @@ void	LLPolyMorphTarget::applyMask(U8 *maskTextureData, S32 width, S32 height, S3
 	}
 
 	// set last weight to 0, since we've removed the effect of this morph
-	mLastWeight = 0.f;
+	setLastWeight(0.f);
 
 	mVertMask->generateMask(maskTextureData, width, height, num_components, invert, clothing_weights);
 
@@ -38,6 +38,36 @@ class LLVector2;
 class LLAvatarJointCollisionVolume;
 class LLWearable;
 
+//-----------------------------------------------------------------------------
+// LLPolyMeshReader
+// Reads a .llm mesh file already in memory, the way fread() and fseek() read
+// it from disk.
+//-----------------------------------------------------------------------------
+class LLPolyMeshReader
+{
+public:
+	LLPolyMeshReader(const U8* data, size_t size)
+	:	mData(data), mSize(size), mOffset(0)
+	{}
+
+	// number of whole items of size bytes read, as fread()
+	size_t read(void* dest, size_t size, size_t count)
+	{
+		size_t available = size ? (mSize - mOffset) / size : 0;
+		count = llmin(count, available);
+		memcpy(dest, mData + mOffset, size * count);
+		mOffset += size * count;
+		return count;
+	}
+
+	void seek(size_t offset)	{ mOffset = llmin(offset, mSize); }
+
+private:
+	const U8*	mData;
+	size_t		mSize;
+	size_t		mOffset;
+};
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -59,7 +89,7 @@ public:
 		ll_aligned_free_16(ptr);
 	}
 
-	BOOL			loadBinary(LLFILE* fp, LLPolyMeshSharedData *mesh);
+	BOOL			loadBinary(LLPolyMeshReader& reader, LLPolyMeshSharedData *mesh);
 	const std::string& getName() { return mName; }
 
 public:
@@ -194,7 +194,8 @@ void LLPolySkeletalDistortion::apply( ESex avatar_sex )
 {
     LL_RECORD_BLOCK_TIME(FTM_POLYSKELETAL_DISTORTION_APPLY);
 
-    F32 effective_weight = ( getSex() & avatar_sex ) ? mCurWeight : getDefaultWeight();
+    LLVisualParamWeight& slot = getWeightSlot();
+    F32 effective_weight = ( getSex() & avatar_sex ) ? slot.mCur : getDefaultWeight();
 
     LLJoint* joint;
     joint_vec_map_t::iterator iter;
@@ -206,7 +207,7 @@ void LLPolySkeletalDistortion::apply( ESex avatar_sex )
         joint = iter->first;
         LLVector3 newScale = joint->getScale();
         LLVector3 scaleDelta = iter->second;
-        LLVector3 offset = (effective_weight - mLastWeight) * scaleDelta;
+        LLVector3 offset = (effective_weight - slot.mLast) * scaleDelta;
         newScale = newScale + offset;
         //An aspect of attached mesh objects (which contain joint offsets) that need to be cleaned up when detached
         // needed? 
@@ -214,7 +215,7 @@ void LLPolySkeletalDistortion::apply( ESex avatar_sex )
 
         // BENTO for detailed stack tracing of params.
         std::stringstream ostr;
-        ostr << "LLPolySkeletalDistortion::apply, id " << getID() << " " << getName() << " effective wt " << effective_weight << " last wt " << mLastWeight << " scaleDelta " << scaleDelta << " offset " << offset;
+        ostr << "LLPolySkeletalDistortion::apply, id " << getID() << " " << getName() << " effective wt " << effective_weight << " last wt " << slot.mLast << " scaleDelta " << scaleDelta << " offset " << offset;
         LLScopedContextString str(ostr.str());
 
         joint->setScale(newScale, true);
@@ -227,17 +228,17 @@ void LLPolySkeletalDistortion::apply( ESex avatar_sex )
         joint = iter->first;
         LLVector3 newPosition = joint->getPosition();
         LLVector3 positionDelta = iter->second;				
-        newPosition = newPosition + (effective_weight * positionDelta) - (mLastWeight * positionDelta);		
+        newPosition = newPosition + (effective_weight * positionDelta) - (slot.mLast * positionDelta);		
         // SL-315
         bool allow_attachment_pos_overrides = true;
         joint->setPosition(newPosition, allow_attachment_pos_overrides);
     }
 
-    if (mLastWeight != effective_weight && !mIsAnimating)
+    if (slot.mLast != effective_weight && !isAnimating())
     {
         mAvatar->setSkeletonSerialNum(mAvatar->getSkeletonSerialNum() + 1);
     }
-    mLastWeight = effective_weight;
+    slot.mLast = effective_weight;
 }
 
 
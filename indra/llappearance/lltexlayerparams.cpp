@@ -185,21 +185,22 @@ BOOL LLTexLayerParamAlpha::getMultiplyBlend() const
 
 void LLTexLayerParamAlpha::setWeight(F32 weight)
 {
-	if (mIsAnimating || mTexLayer == NULL)
+	if (isAnimating() || mTexLayer == NULL)
 	{
 		return;
 	}
 	F32 min_weight = getMinWeight();
 	F32 max_weight = getMaxWeight();
 	F32 new_weight = llclamp(weight, min_weight, max_weight);
-	U8 cur_u8 = F32_to_U8(mCurWeight, min_weight, max_weight);
+	U8 cur_u8 = F32_to_U8(getCurrentWeight(), min_weight, max_weight);
 	U8 new_u8 = F32_to_U8(new_weight, min_weight, max_weight);
 	if (cur_u8 != new_u8)
 	{
-		mCurWeight = new_weight;
+		getWeightSlot().mCur = new_weight;
+		markDirty();
 
 		if ((mAvatarAppearance->getSex() & getSex()) &&
-			(mAvatarAppearance->isSelf() && !mIsDummy)) // only trigger a baked texture update if we're changing a wearable's visual param.
+			(mAvatarAppearance->isSelf() && !hasFlag(DUMMY))) // only trigger a baked texture update if we're changing a wearable's visual param.
 		{
 			mAvatarAppearance->invalidateComposite(mTexLayer->getTexLayerSet());
 			mTexLayer->invalidateMorphMasks();
@@ -210,15 +211,15 @@ void LLTexLayerParamAlpha::setWeight(F32 weight)
 void LLTexLayerParamAlpha::setAnimationTarget(F32 target_value)
 { 
 	// do not animate dummy parameters
-	if (mIsDummy)
+	if (hasFlag(DUMMY))
 	{
 		setWeight(target_value);
 		return;
 	}
 
-	mTargetWeight = target_value; 
+	getWeightSlot().mTarget = target_value;
 	setWeight(target_value); 
-	mIsAnimating = TRUE;
+	setFlag(ANIMATING, TRUE);
 	if (mNext)
 	{
 		mNext->setAnimationTarget(target_value);
@@ -244,7 +245,7 @@ BOOL LLTexLayerParamAlpha::getSkip() const
 
 	if (((LLTexLayerParamAlphaInfo *)getInfo())->mSkipIfZeroWeight)
 	{
-		F32 effective_weight = (appearance->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+		F32 effective_weight = (appearance->getSex() & getSex()) ? getCurrentWeight() : getDefaultWeight();
 		if (is_approx_zero(effective_weight)) 
 		{
 			return TRUE;
@@ -272,7 +273,7 @@ BOOL LLTexLayerParamAlpha::render(S32 x, S32 y, S32 width, S32 height)
 		return success;
 	}
 
-	F32 effective_weight = (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+	F32 effective_weight = (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? getCurrentWeight() : getDefaultWeight();
 	BOOL weight_changed = effective_weight != mCachedEffectiveWeight;
 	if (getSkip())
 	{
@@ -454,7 +455,7 @@ LLColor4 LLTexLayerParamColor::getNetColor() const
 	
 	llassert(info->mNumColors >= 1);
 
-	F32 effective_weight = (mAvatarAppearance && (mAvatarAppearance->getSex() & getSex())) ? mCurWeight : getDefaultWeight();
+	F32 effective_weight = (mAvatarAppearance && (mAvatarAppearance->getSex() & getSex())) ? getCurrentWeight() : getDefaultWeight();
 
 	S32 index_last = info->mNumColors - 1;
 	F32 scaled_weight = effective_weight * index_last;
@@ -479,7 +480,7 @@ LLColor4 LLTexLayerParamColor::getNetColor() const
 
 void LLTexLayerParamColor::setWeight(F32 weight)
 {
-	if (mIsAnimating)
+	if (isAnimating())
 	{
 		return;
 	}
@@ -487,11 +488,12 @@ void LLTexLayerParamColor::setWeight(F32 weight)
 	F32 min_weight = getMinWeight();
 	F32 max_weight = getMaxWeight();
 	F32 new_weight = llclamp(weight, min_weight, max_weight);
-	U8 cur_u8 = F32_to_U8(mCurWeight, min_weight, max_weight);
+	U8 cur_u8 = F32_to_U8(getCurrentWeight(), min_weight, max_weight);
 	U8 new_u8 = F32_to_U8(new_weight, min_weight, max_weight);
 	if (cur_u8 != new_u8)
 	{
-		mCurWeight = new_weight;
+		getWeightSlot().mCur = new_weight;
+		markDirty();
 
                 const LLTexLayerParamColorInfo *info = (LLTexLayerParamColorInfo *)getInfo();
 
@@ -501,7 +503,7 @@ void LLTexLayerParamColor::setWeight(F32 weight)
 			return;
 		}
 
-		if ((mAvatarAppearance->getSex() & getSex()) && (mAvatarAppearance->isSelf() && !mIsDummy)) // only trigger a baked texture update if we're changing a wearable's visual param.
+		if ((mAvatarAppearance->getSex() & getSex()) && (mAvatarAppearance->isSelf() && !hasFlag(DUMMY))) // only trigger a baked texture update if we're changing a wearable's visual param.
 		{
 			onGlobalColorChanged();
 			if (mTexLayer)
@@ -517,9 +519,9 @@ void LLTexLayerParamColor::setWeight(F32 weight)
 void LLTexLayerParamColor::setAnimationTarget(F32 target_value)
 { 
 	// set value first then set interpolating flag to ignore further updates
-	mTargetWeight = target_value; 
+	getWeightSlot().mTarget = target_value;
 	setWeight(target_value);
-	mIsAnimating = TRUE;
+	setFlag(ANIMATING, TRUE);
 	if (mNext)
 	{
 		mNext->setAnimationTarget(target_value);
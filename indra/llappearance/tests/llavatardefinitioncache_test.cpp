@@ -0,0 +1,289 @@
+/**
+ * @file llavatardefinitioncache_test.cpp
+ * @brief Tests and startup benchmark of LLAvatarDefinitionCache
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <sstream>
+
+#include "../llavatardefinitioncache.h"
+#include "llfile.h"
+#include "llformat.h"
+#include "lltimer.h"
+#include "llxmltree.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// About the size of avatar_lad.xml: params with a few attributes each and
+	// a list of targets, some of them with a comment as contents
+	std::string make_definitions(S32 num_params, const std::string& label)
+	{
+		std::ostringstream xml;
+		xml << "<linden_avatar version=\"2.0\" label=\"" << label << "\">\n";
+		for (S32 i = 0; i < num_params; ++i)
+		{
+			xml << "  <param id=\"" << i << "\" group=\"" << i % 3 << "\" name=\"Param_" << i
+				<< "\" value_min=\"-1\" value_max=\"" << i % 7 << ".5\" camera_distance=\"1.2\">\n"
+				<< "    <param_morph>\n";
+			for (S32 j = 0; j < 4; ++j)
+			{
+				xml << "      <volume_morph name=\"BELLY\" scale=\"0." << j << " 0.02 0\" pos=\"0 0 0." << i % 10 << "\"/>\n";
+			}
+			if (i % 5 == 0)
+			{
+				xml << "      <comment>driven by param " << i - 1 << "</comment>\n";
+			}
+			xml << "    </param_morph>\n"
+				<< "  </param>\n";
+		}
+		xml << "</linden_avatar>\n";
+		return xml.str();
+	}
+
+	// Something shaped like a .llm mesh, a header and then vertex data
+	std::string make_mesh(U32 num_floats, U32 seed)
+	{
+		std::string mesh("Linden Binary Mesh 1.0");
+		mesh.resize(24, '\0');
+		for (U32 i = 0; i < num_floats; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			F32 value = (F32)(seed >> 8) / (F32)(1 << 24);
+			mesh.append((const char*)&value, sizeof(F32));
+		}
+		return mesh;
+	}
+
+	struct TestFile
+	{
+		TestFile(const std::string& name)
+		:	mPath(llformat("%sllavatardefinitioncache_test_%s", LLFile::tmpdir(), name.c_str()))
+		{
+			LLFile::remove(mPath, ENOENT);
+		}
+
+		~TestFile()
+		{
+			LLFile::remove(mPath, ENOENT);
+		}
+
+		void write(const std::string& contents)
+		{
+			LLFILE* fp = LLFile::fopen(mPath, "wb");
+			tut::ensure("write " + mPath, fp != NULL);
+			fwrite(contents.data(), 1, contents.size(), fp);
+			fclose(fp);
+		}
+
+		std::string	mPath;
+	};
+
+	std::string binary_copy(LLXmlTree& tree)
+	{
+		std::string data;
+		tree.writeBinary(data);
+		return data;
+	}
+}
+
+namespace tut
+{
+	struct avatardefinitioncache_data
+	{
+		avatardefinitioncache_data()
+		:	mCache("cache.bin"),
+			mLad("lad.xml"),
+			mMesh("mesh.llm")
+		{
+			mLad.write(make_definitions(300, "first"));
+			mMesh.write(make_mesh(20000, 1));
+		}
+
+		TestFile	mCache;
+		TestFile	mLad;
+		TestFile	mMesh;
+	};
+	typedef test_group<avatardefinitioncache_data> avatardefinitioncache_group;
+	typedef avatardefinitioncache_group::object avatardefinitioncache_object;
+	avatardefinitioncache_group avatardefinitioncache_test("LLAvatarDefinitionCache");
+
+	template<> template<>
+	void avatardefinitioncache_object::test<1>()
+	{
+		set_test_name("files come back from the cache as they were read");
+
+		LLXmlTree parsed;
+		ensure("parse", parsed.parseFile(mLad.mPath, FALSE));
+		std::string mesh = make_mesh(20000, 1);
+
+		LLAvatarDefinitionCache cache;
+		cache.load(mCache.mPath);
+		LLXmlTree first;
+		std::string first_mesh;
+		ensure("first parse", cache.parseXml(mLad.mPath, first, FALSE));
+		ensure("first read", cache.readFile(mMesh.mPath, first_mesh));
+		ensure_equals("first misses", cache.getNumMisses(), 2U);
+		ensure_equals("first hits", cache.getNumHits(), 0U);
+		ensure("first tree", binary_copy(first) == binary_copy(parsed));
+		ensure("first mesh", first_mesh == mesh);
+		cache.save();
+		ensure("saved", LLFile::isfile(mCache.mPath));
+		ensure("disabled after save", !cache.isEnabled());
+
+		cache.load(mCache.mPath);
+		LLXmlTree second;
+		std::string second_mesh;
+		ensure("second parse", cache.parseXml(mLad.mPath, second, FALSE));
+		ensure("second read", cache.readFile(mMesh.mPath, second_mesh));
+		ensure_equals("second hits", cache.getNumHits(), 2U);
+		ensure_equals("second misses", cache.getNumMisses(), 0U);
+		ensure("second tree", binary_copy(second) == binary_copy(parsed));
+		ensure("second mesh", second_mesh == mesh);
+
+		LLXmlTreeNode* param = second.getRoot()->getChildByName("param");
+		std::string name;
+		ensure("attribute", param && param->getAttributeString("name", name));
+		ensure_equals("attribute value", name, std::string("Param_0"));
+
+		// kept as parsed, the contents were not asked for
+		LLXmlTree with_contents;
+		ensure("parse with contents", cache.parseXml(mLad.mPath, with_contents, TRUE));
+		ensure_equals("a different entry", cache.getNumMisses(), 1U);
+	}
+
+	template<> template<>
+	void avatardefinitioncache_object::test<2>()
+	{
+		set_test_name("changed files and other versions are not used");
+
+		LLAvatarDefinitionCache cache;
+		cache.load(mCache.mPath);
+		LLXmlTree tree;
+		std::string mesh;
+		cache.parseXml(mLad.mPath, tree, FALSE);
+		cache.readFile(mMesh.mPath, mesh);
+		cache.save();
+
+		mLad.write(make_definitions(301, "second"));
+		mMesh.write(make_mesh(20001, 2));
+		LLXmlTree parsed;
+		ensure("parse", parsed.parseFile(mLad.mPath, FALSE));
+
+		cache.load(mCache.mPath);
+		ensure("changed parse", cache.parseXml(mLad.mPath, tree, FALSE));
+		ensure("changed read", cache.readFile(mMesh.mPath, mesh));
+		ensure_equals("changed misses", cache.getNumMisses(), 2U);
+		ensure("changed tree", binary_copy(tree) == binary_copy(parsed));
+		ensure("changed mesh", mesh == make_mesh(20001, 2));
+		cache.save();
+
+		cache.load(mCache.mPath);
+		ensure("updated parse", cache.parseXml(mLad.mPath, tree, FALSE));
+		ensure_equals("updated hits", cache.getNumHits(), 1U);
+		cache.save();
+
+		// a cache of another version, or cut short, is read as empty
+		std::string contents;
+		LLFILE* fp = LLFile::fopen(mCache.mPath, "rb");
+		ensure("cache file", fp != NULL);
+		fseek(fp, 0, SEEK_END);
+		contents.resize(ftell(fp));
+		fseek(fp, 0, SEEK_SET);
+		fread(&contents[0], 1, contents.size(), fp);
+		fclose(fp);
+
+		std::string other_version(contents);
+		other_version[8]++;
+		mCache.write(other_version);
+		cache.load(mCache.mPath);
+		ensure("other version parse", cache.parseXml(mLad.mPath, tree, FALSE));
+		ensure_equals("other version misses", cache.getNumMisses(), 1U);
+		cache.load(LLStringUtil::null);
+
+		mCache.write(contents.substr(0, contents.size() - 10));
+		cache.load(mCache.mPath);
+		ensure("truncated parse", cache.parseXml(mLad.mPath, tree, FALSE));
+		ensure_equals("truncated misses", cache.getNumMisses(), 1U);
+		ensure("truncated tree", binary_copy(tree) == binary_copy(parsed));
+		cache.load(LLStringUtil::null);
+	}
+
+	template<> template<>
+	void avatardefinitioncache_object::test<3>()
+	{
+		set_test_name("benchmark startup with and without the cache");
+
+		// avatar_lad.xml, avatar_skeleton.xml and about 50 meshes
+		const S32 MESHES = 50;
+		TestFile skeleton("skeleton.xml");
+		skeleton.write(make_definitions(40, "skeleton"));
+		mLad.write(make_definitions(1500, "lad"));
+		std::vector<TestFile*> meshes;
+		for (S32 i = 0; i < MESHES; ++i)
+		{
+			meshes.push_back(new TestFile(llformat("mesh_%d.llm", i)));
+			meshes.back()->write(make_mesh(8000 + i * 100, i));
+		}
+
+		F64 secs[3];
+		LLAvatarDefinitionCache cache;
+		for (S32 run = 0; run < 3; ++run)
+		{
+			// without the cache, filling it and from the cache
+			LLTimer timer;
+			cache.load(run == 0 ? LLStringUtil::null : mCache.mPath);
+			LLXmlTree lad, skel;
+			ensure("lad", cache.parseXml(mLad.mPath, lad, FALSE));
+			ensure("skeleton", cache.parseXml(skeleton.mPath, skel, FALSE));
+			for (S32 i = 0; i < MESHES; ++i)
+			{
+				std::string mesh;
+				ensure("mesh", cache.readFile(meshes[i]->mPath, mesh));
+			}
+			cache.save();
+			secs[run] = timer.getElapsedTimeF64();
+			if (run == 2)
+			{
+				ensure_equals("all from the cache", cache.getNumHits(), (U32)MESHES + 2);
+			}
+		}
+
+		for (S32 i = 0; i < MESHES; ++i)
+		{
+			delete meshes[i];
+		}
+
+		if (benchmarks_enabled())
+		{
+			std::cout << "\nLoading the avatar definitions and " << MESHES << " meshes\n"
+					  << llformat("  without the cache: %.2f ms\n", secs[0] * 1000.0)
+					  << llformat("  filling the cache: %.2f ms\n", secs[1] * 1000.0)
+					  << llformat("  from the cache:    %.2f ms\n", secs[2] * 1000.0)
+					  << std::flush;
+		}
+	}
+}
@@ -0,0 +1,386 @@
+/**
+ * @file llavatarskeletoninfo_test.cpp
+ * @brief Tests and joint setup benchmark of the shared avatar skeleton
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "../llavatarskeletoninfo.h"
+#include "llfile.h"
+#include "llformat.h"
+#include "llstl.h"
+#include "lltimer.h"
+#include "llxmltree.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// As many bones and collision volumes as avatar_skeleton.xml has
+	const S32 NUM_BONES = 133;
+	const S32 NUM_VOLUMES = 26;
+
+	// A skeleton of chains of bones hanging from the first, with a
+	// collision volume on one bone in five
+	std::string make_skeleton(S32 num_bones, S32 num_volumes)
+	{
+		std::ostringstream xml;
+		xml << "<linden_skeleton num_bones=\"" << num_bones << "\" num_collision_volumes=\"" << num_volumes
+			<< "\" version=\"2.0\">\n";
+		S32 volume = 0;
+		S32 open = 0;
+		for (S32 bone = 0; bone < num_bones; ++bone)
+		{
+			// start a new chain from the root every 12 bones
+			if (bone > 0 && bone % 12 == 0)
+			{
+				for (; open > 1; --open)
+				{
+					xml << "</bone>\n";
+				}
+			}
+			xml << llformat("<bone name=\"mBone%d\" aliases=\"bone%d b%d\" pos=\"%.3f %.3f %.3f\" rot=\"%d %d %d\""
+							" scale=\"1 1 1\" end=\"0 0 %.3f\" pivot=\"%.3f 0 %.3f\" support=\"%s\">\n",
+							bone, bone, bone, 0.01f * (bone % 7), -0.02f * (bone % 3), 0.1f, (bone * 7) % 90,
+							(bone * 13) % 45, (bone * 3) % 30, 0.05f, 0.01f * (bone % 5), 0.1f,
+							bone % 4 == 3 ? "extended" : "base");
+			open++;
+			if (bone % 5 == 0 && volume < num_volumes)
+			{
+				xml << llformat("<collision_volume name=\"Volume%d\" pos=\"0 0 %.3f\" rot=\"0 %d 0\""
+								" scale=\"0.1 0.1 0.2\" end=\"0 0 0.05\" support=\"base\"/>\n",
+								volume, 0.05f, volume * 10);
+				volume++;
+			}
+		}
+		for (; open > 0; --open)
+		{
+			xml << "</bone>\n";
+		}
+		xml << "</linden_skeleton>\n";
+		return xml.str();
+	}
+
+	// Parses the skeleton text as LLAvatarAppearance::initClass() parses the file
+	struct SkeletonFile
+	{
+		SkeletonFile(const std::string& text)
+		{
+			static S32 sFileNum = 0;
+			mPath = llformat("%sllavatarskeletoninfo_test_%d.xml", LLFile::tmpdir(), sFileNum++);
+			llofstream file(mPath.c_str());
+			file << text;
+			file.close();
+			mParsed = mTree.parseFile(mPath, FALSE) && mTree.getRoot();
+		}
+
+		~SkeletonFile()
+		{
+			LLFile::remove(mPath);
+		}
+
+		std::string	mPath;
+		LLXmlTree	mTree;
+		bool		mParsed;
+	};
+
+	// The joints of one avatar
+	struct TestSkeleton
+	{
+		TestSkeleton(S32 num_bones, S32 num_volumes) :
+			mBones(num_bones),
+			mVolumes(num_volumes)
+		{
+			for (S32 i = 0; i < num_bones; ++i)
+			{
+				mBonePtrs.push_back(&mBones[i]);
+			}
+			for (S32 i = 0; i < num_volumes; ++i)
+			{
+				mVolumePtrs.push_back(&mVolumes[i]);
+			}
+		}
+
+		std::vector<LLJoint>	mBones;
+		std::vector<LLJoint>	mVolumes;
+		std::vector<LLJoint*>	mBonePtrs;
+		std::vector<LLJoint*>	mVolumePtrs;
+	};
+
+	// A bone as each avatar set up its joints from before the skeleton was
+	// shared: rotation in degrees, support by name
+	struct ReferenceBone
+	{
+		ReferenceBone(LLXmlTreeNode* node)
+		{
+			mIsJoint = node->hasName("bone");
+			node->getAttributeString("name", mName);
+			node->getAttributeVector3("pos", mPos);
+			node->getAttributeVector3("rot", mRot);
+			node->getAttributeVector3("scale", mScale);
+			node->getAttributeVector3("end", mEnd);
+			node->getAttributeVector3("pivot", mPivot);
+			node->getAttributeString("support", mSupport);
+			for (LLXmlTreeNode* child = node->getFirstChild(); child; child = node->getNextChild())
+			{
+				mChildren.push_back(new ReferenceBone(child));
+			}
+		}
+
+		~ReferenceBone()
+		{
+			std::for_each(mChildren.begin(), mChildren.end(), DeletePointer());
+		}
+
+		// LLAvatarAppearance::setupBone()
+		void setup(LLJoint* parent, TestSkeleton& skeleton, S32& joint_num, S32& volume_num) const
+		{
+			LLJoint* joint = mIsJoint ? skeleton.mBonePtrs[joint_num] : skeleton.mVolumePtrs[volume_num];
+			joint->setName(mName);
+			if (parent && joint->getParent() != parent)
+			{
+				parent->addChild(joint);
+			}
+			joint->setPosition(mPos);
+			joint->setDefaultPosition(mPos);
+			joint->setRotation(mayaQ(mRot.mV[VX], mRot.mV[VY], mRot.mV[VZ], LLQuaternion::XYZ));
+			joint->setScale(mScale);
+			joint->setDefaultScale(mScale);
+			joint->setSupport(mSupport);
+			joint->setEnd(mEnd);
+			if (mIsJoint)
+			{
+				joint->setSkinOffset(mPivot);
+				joint->setJointNum(joint_num++);
+			}
+			else
+			{
+				joint->setJointNum((S32)skeleton.mBones.size() + volume_num++);
+			}
+			for (U32 i = 0; i < mChildren.size(); ++i)
+			{
+				mChildren[i]->setup(joint, skeleton, joint_num, volume_num);
+			}
+		}
+
+		bool						mIsJoint;
+		std::string					mName;
+		std::string					mSupport;
+		LLVector3					mPos;
+		LLVector3					mRot;
+		LLVector3					mScale;
+		LLVector3					mEnd;
+		LLVector3					mPivot;
+		std::vector<ReferenceBone*>	mChildren;
+	};
+
+	struct ReferenceSkeleton
+	{
+		ReferenceSkeleton(LLXmlTreeNode* root)
+		{
+			for (LLXmlTreeNode* child = root->getFirstChild(); child; child = root->getNextChild())
+			{
+				mRoots.push_back(new ReferenceBone(child));
+			}
+		}
+
+		~ReferenceSkeleton()
+		{
+			std::for_each(mRoots.begin(), mRoots.end(), DeletePointer());
+		}
+
+		void setup(TestSkeleton& skeleton) const
+		{
+			S32 joint_num = 0;
+			S32 volume_num = 0;
+			for (U32 i = 0; i < mRoots.size(); ++i)
+			{
+				mRoots[i]->setup(NULL, skeleton, joint_num, volume_num);
+			}
+		}
+
+		std::vector<ReferenceBone*>	mRoots;
+	};
+
+	void ensure_same_joint(const std::string& msg, LLJoint& a, LLJoint& b)
+	{
+		tut::ensure_equals(msg + " name", a.getName(), b.getName());
+		tut::ensure_equals(msg + " parent", a.getParent() ? a.getParent()->getName() : "", b.getParent() ? b.getParent()->getName() : "");
+		tut::ensure_equals(msg + " children", (S32)a.mChildren.size(), (S32)b.mChildren.size());
+		tut::ensure_equals(msg + " joint num", a.getJointNum(), b.getJointNum());
+		tut::ensure_equals(msg + " support", a.getSupport(), b.getSupport());
+		tut::ensure(msg + " position", a.getPosition() == b.getPosition());
+		tut::ensure(msg + " default position", a.getDefaultPosition() == b.getDefaultPosition());
+		tut::ensure(msg + " rotation", a.getRotation() == b.getRotation());
+		tut::ensure(msg + " scale", a.getScale() == b.getScale());
+		tut::ensure(msg + " end", a.getEnd() == b.getEnd());
+		tut::ensure(msg + " skin offset", a.getSkinOffset() == b.getSkinOffset());
+	}
+}
+
+namespace tut
+{
+	struct avatarskeletoninfo_data
+	{
+	};
+	typedef test_group<avatarskeletoninfo_data> avatarskeletoninfo_group;
+	typedef avatarskeletoninfo_group::object avatarskeletoninfo_object;
+	avatarskeletoninfo_group avatarskeletoninfo_test("LLAvatarSkeletonInfo");
+
+	template<> template<>
+	void avatarskeletoninfo_object::test<1>()
+	{
+		set_test_name("bones are listed parents first, with their aliases");
+
+		SkeletonFile file(make_skeleton(30, 5));
+		ensure("parsed", file.mParsed);
+		LLAvatarSkeletonInfo info;
+		ensure("skeleton", info.parseXml(file.mTree.getRoot()));
+		ensure_equals("bones", info.getNumBones(), 30);
+		ensure_equals("volumes", info.getNumCollisionVolumes(), 5);
+		ensure_equals("listed", (S32)info.getBones().size(), 35);
+
+		for (U32 i = 0; i < info.getBones().size(); ++i)
+		{
+			const LLAvatarSkeletonInfo::BoneTemplate& bone = info.getBones()[i];
+			ensure(llformat("parent of %d first", i), bone.mParent < (S32)i);
+			ensure_equals(llformat("found %d", i), info.findBone(*bone.mName), (S32)i);
+		}
+
+		S32 bone = info.findBone("mBone13");
+		ensure_equals("bone index", info.getBones()[bone].mIndex, 13);
+		ensure_equals("root of the second chain", *info.getBones()[info.getBones()[bone].mParent].mName, std::string("mBone12"));
+		ensure_equals("rooted at the first bone", info.getBones()[info.findBone("mBone12")].mParent, info.findBone("mBone0"));
+		ensure_equals("extended", info.getBones()[info.findBone("mBone3")].mSupport, LLJoint::SUPPORT_EXTENDED);
+		S32 volume = info.findBone("Volume2");
+		ensure("volume", !info.getBones()[volume].mIsJoint);
+		ensure_equals("volume joint num", info.getBones()[volume].mJointNum, 32);
+		ensure_equals("unknown", info.findBone("mBone30"), -1);
+
+		ensure_equals("name", info.getJointAliases().find("mBone7")->second, std::string("mBone7"));
+		ensure_equals("alias", info.getJointAliases().find("bone7")->second, std::string("mBone7"));
+		ensure_equals("short alias", info.getJointAliases().find("b29")->second, std::string("mBone29"));
+		ensure_equals("aliases", (S32)info.getJointAliases().size(), 90);
+	}
+
+	template<> template<>
+	void avatarskeletoninfo_object::test<2>()
+	{
+		set_test_name("joints are set up as they were bone by bone");
+
+		SkeletonFile file(make_skeleton(NUM_BONES, NUM_VOLUMES));
+		LLAvatarSkeletonInfo info;
+		ensure("skeleton", info.parseXml(file.mTree.getRoot()));
+
+		TestSkeleton reference(NUM_BONES, NUM_VOLUMES);
+		ReferenceSkeleton(file.mTree.getRoot()).setup(reference);
+
+		TestSkeleton skeleton(NUM_BONES, NUM_VOLUMES);
+		ensure("set up", info.setupJoints(&skeleton.mBonePtrs[0], NUM_BONES, &skeleton.mVolumePtrs[0], NUM_VOLUMES));
+		for (S32 i = 0; i < NUM_BONES; ++i)
+		{
+			ensure_same_joint(llformat("bone %d", i), skeleton.mBones[i], reference.mBones[i]);
+		}
+		for (S32 i = 0; i < NUM_VOLUMES; ++i)
+		{
+			ensure_same_joint(llformat("volume %d", i), skeleton.mVolumes[i], reference.mVolumes[i]);
+		}
+
+		// every avatar's joints keep the one copy of each name
+		ensure("shared bone name", &skeleton.mBones[20].getName() == &reference.mBones[20].getName());
+		ensure("template bone name", &skeleton.mBones[20].getName() == info.getBones()[info.findBone("mBone20")].mName);
+		ensure("shared volume name", &skeleton.mVolumes[3].getName() == &reference.mVolumes[3].getName());
+
+		// as when the avatar resets its skeleton
+		ensure("set up again", info.setupJoints(&skeleton.mBonePtrs[0], NUM_BONES, &skeleton.mVolumePtrs[0], NUM_VOLUMES));
+		ensure_same_joint("bone again", skeleton.mBones[20], reference.mBones[20]);
+
+		TestSkeleton too_small(NUM_BONES - 1, NUM_VOLUMES);
+		ensure("too many bones", !info.setupJoints(&too_small.mBonePtrs[0], NUM_BONES - 1, &too_small.mVolumePtrs[0], NUM_VOLUMES));
+	}
+
+	template<> template<>
+	void avatarskeletoninfo_object::test<3>()
+	{
+		set_test_name("benchmark instantiating avatar skeletons");
+		// Each avatar's joints are made, set up and freed again, as when an
+		// avatar arrives and leaves.  Meshes and visual params are not part
+		// of it.
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		SkeletonFile file(make_skeleton(NUM_BONES, NUM_VOLUMES));
+		LLAvatarSkeletonInfo info;
+		ensure("skeleton", info.parseXml(file.mTree.getRoot()));
+		ReferenceSkeleton reference(file.mTree.getRoot());
+
+		const S32 AVATARS = 200;
+		LLTimer timer;
+		for (S32 i = 0; i < AVATARS; ++i)
+		{
+			TestSkeleton* skeleton = new TestSkeleton(NUM_BONES, NUM_VOLUMES);
+			reference.setup(*skeleton);
+			delete skeleton;
+		}
+		F64 reference_secs = timer.getElapsedTimeF64();
+
+		timer.reset();
+		for (S32 i = 0; i < AVATARS; ++i)
+		{
+			TestSkeleton* skeleton = new TestSkeleton(NUM_BONES, NUM_VOLUMES);
+			info.setupJoints(&skeleton->mBonePtrs[0], NUM_BONES, &skeleton->mVolumePtrs[0], NUM_VOLUMES);
+			delete skeleton;
+		}
+		F64 shared_secs = timer.getElapsedTimeF64();
+
+		// Each joint kept a string of its own before, with the longer names
+		// on the heap.  Now it keeps a pointer to the template's.
+		const U32 name_capacity = std::string().capacity();
+		U32 name_bytes = 0;
+		for (U32 i = 0; i < info.getBones().size(); ++i)
+		{
+			const std::string& name = *info.getBones()[i].mName;
+			name_bytes += sizeof(std::string) - sizeof(LLStdStringHandle);
+			if (name.size() > name_capacity)
+			{
+				name_bytes += name.size() + 1;
+			}
+		}
+		U32 joint_bytes = sizeof(LLJoint) * (NUM_BONES + NUM_VOLUMES);
+
+		std::cout << "\nInstantiating " << AVATARS << " skeletons of " << NUM_BONES << " bones and "
+				  << NUM_VOLUMES << " collision volumes\n"
+				  << llformat("  bone by bone:    %.2f ms, %.1f us each\n", reference_secs * 1000.0, reference_secs * 1000000.0 / AVATARS)
+				  << llformat("  shared skeleton: %.2f ms, %.1f us each\n", shared_secs * 1000.0, shared_secs * 1000000.0 / AVATARS)
+				  << llformat("  joints: %d bytes each avatar, %d before the names were shared\n",
+							  joint_bytes, joint_bytes + name_bytes)
+				  << std::flush;
+	}
+}
@@ -0,0 +1,266 @@
+/**
+ * @file llpolymesh_test.cpp
+ * @brief Tests and benchmark of the batched morph target application of LLPolyMesh
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <vector>
+
+#include "../llpolymesh.h"
+#include "../llavatarappearance.h"
+#include "../llavatardefinitioncache.h"
+#include "../llwearabletype.h"
+#include "llformat.h"
+#include "llstl.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// Notes:
+// * llpolymesh.cpp and llpolymorph.cpp are built without the rest of llappearance,
+//   these are the few functions they use from it
+
+LLAvatarDefinitionCache& LLAvatarAppearance::getDefinitionCache()
+{
+	static LLAvatarDefinitionCache cache;
+	return cache;
+}
+
+LLWearableType::EType LLWearableType::typeNameToType(const std::string& type_name)
+{
+	return LLWearableType::WT_INVALID;
+}
+
+namespace
+{
+	// About the size of the upper body mesh and the number of morphs on it
+	const U32 NUM_VERTICES = 4000;
+	const U32 NUM_MORPHS = 40;
+
+	U32 sSeed = 1;
+
+	F32 random_value()
+	{
+		sSeed = sSeed * 1664525 + 1013904223;
+		return (F32)(sSeed >> 8) / (F32)(1 << 24) * 2.f - 1.f;
+	}
+
+	LLVector4a random_vector()
+	{
+		LLVector4a v;
+		v.set(random_value(), random_value(), random_value(), 0.f);
+		return v;
+	}
+
+	// A morph moving one vertex in every few, some of them masked and some
+	// clothing morphs, as the morphs of avatar_lad.xml are
+	struct TestMorph
+	{
+		TestMorph(U32 index)
+		:	mData(llformat("morph_%d", index)),
+			mIsClothingMorph(index % 4 == 0)
+		{
+			U32 step = 3 + index % 7;
+			U32 count = NUM_VERTICES / step;
+			mData.mNumIndices = count;
+			mData.mVertexIndices = new U32[count];
+			mData.mCoords = (LLVector4a*)ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mData.mNormals = (LLVector4a*)ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mData.mBinormals = (LLVector4a*)ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mData.mTexCoords = new LLVector2[count];
+			for (U32 i = 0; i < count; ++i)
+			{
+				mData.mVertexIndices[i] = (index * 13 + i * step) % NUM_VERTICES;
+				mData.mCoords[i] = random_vector();
+				mData.mCoords[i].mul(0.05f);
+				mData.mNormals[i] = random_vector();
+				mData.mBinormals[i] = random_vector();
+				mData.mTexCoords[i].set(random_value() * 0.01f, random_value() * 0.01f);
+			}
+			if (index % 3 == 0)
+			{
+				mMaskWeights.resize(count);
+				for (U32 i = 0; i < count; ++i)
+				{
+					mMaskWeights[i] = random_value() * 0.5f + 0.5f;
+				}
+			}
+		}
+
+		const F32* getMaskWeights() const	{ return mMaskWeights.empty() ? NULL : &mMaskWeights[0]; }
+
+		LLPolyMorphData		mData;
+		std::vector<F32>	mMaskWeights;
+		BOOL				mIsClothingMorph;
+	};
+
+	// The same vertices in every mesh made from the shared data
+	void init_mesh(LLPolyMesh& mesh)
+	{
+		sSeed = 7;
+		for (U32 i = 0; i < NUM_VERTICES; ++i)
+		{
+			LLVector4a normal = random_vector();
+			normal.normalize3fast();
+			LLVector4a binormal = random_vector();
+			binormal.normalize3fast();
+			mesh.getWritableCoords()[i] = random_vector();
+			mesh.getWritableNormals()[i] = normal;
+			mesh.getScaledNormals()[i] = normal;
+			mesh.getWritableBinormals()[i] = binormal;
+			mesh.getScaledBinormals()[i] = binormal;
+			mesh.getWritableTexCoords()[i].set(random_value(), random_value());
+		}
+	}
+
+	void apply_morphs(LLPolyMesh& mesh, std::vector<TestMorph*>& morphs, bool batched, F32 delta_weight)
+	{
+		if (batched)
+		{
+			mesh.beginMorphBatch();
+		}
+		for (U32 m = 0; m < morphs.size(); ++m)
+		{
+			// the weights of morph targets differ, as do their signs
+			F32 weight = delta_weight * (m % 2 ? 0.75f : -0.5f);
+			mesh.queueMorph(&morphs[m]->mData, morphs[m]->getMaskWeights(), morphs[m]->mIsClothingMorph, weight);
+		}
+		if (batched)
+		{
+			mesh.endMorphBatch();
+			mesh.applyQueuedMorphs();
+		}
+	}
+
+	template<typename T>
+	void ensure_same(const char* msg, const T* actual, const T* expected)
+	{
+		tut::ensure_memory_matches(msg, actual, NUM_VERTICES * sizeof(T), expected, NUM_VERTICES * sizeof(T));
+	}
+}
+
+namespace tut
+{
+	struct polymesh_data
+	{
+		polymesh_data()
+		{
+			mSharedData.allocateVertexData(NUM_VERTICES);
+			sSeed = 1;
+			for (U32 m = 0; m < NUM_MORPHS; ++m)
+			{
+				mMorphs.push_back(new TestMorph(m));
+			}
+		}
+
+		~polymesh_data()
+		{
+			delete_and_clear(mMorphs);
+		}
+
+		LLPolyMeshSharedData		mSharedData;
+		std::vector<TestMorph*>		mMorphs;
+	};
+	typedef test_group<polymesh_data> polymesh_group;
+	typedef polymesh_group::object polymesh_object;
+	polymesh_group polymesh_test("LLPolyMesh");
+
+	template<> template<>
+	void polymesh_object::test<1>()
+	{
+		set_test_name("batched morphs match morphs applied one at a time");
+
+		LLPolyMesh single(&mSharedData, NULL);
+		LLPolyMesh batched(&mSharedData, NULL);
+		init_mesh(single);
+		init_mesh(batched);
+
+		apply_morphs(single, mMorphs, false, 1.f);
+		ensure("nothing left queued", !single.hasQueuedMorphs());
+
+		// nothing moves until the batch is applied
+		std::vector<LLVector4a> coords(batched.getCoords(), batched.getCoords() + NUM_VERTICES);
+		batched.beginMorphBatch();
+		for (U32 m = 0; m < mMorphs.size(); ++m)
+		{
+			F32 weight = m % 2 ? 0.75f : -0.5f;
+			batched.queueMorph(&mMorphs[m]->mData, mMorphs[m]->getMaskWeights(), mMorphs[m]->mIsClothingMorph, weight);
+		}
+		batched.endMorphBatch();
+		ensure("queued", batched.hasQueuedMorphs());
+		ensure_same("deferred", batched.getCoords(), &coords[0]);
+		batched.applyQueuedMorphs();
+		ensure("applied", !batched.hasQueuedMorphs());
+
+		ensure_same("coords", batched.getCoords(), single.getCoords());
+		ensure_same("normals", batched.getNormals(), single.getNormals());
+		ensure_same("scaled normals", batched.getScaledNormals(), single.getScaledNormals());
+		ensure_same("binormals", batched.getBinormals(), single.getBinormals());
+		ensure_same("scaled binormals", batched.getScaledBinormals(), single.getScaledBinormals());
+		ensure_same("texcoords", batched.getTexCoords(), single.getTexCoords());
+		ensure_same("clothing weights", batched.getClothingWeights(), single.getClothingWeights());
+
+		// and back again, as when a shape is taken off
+		apply_morphs(single, mMorphs, false, -1.f);
+		apply_morphs(batched, mMorphs, true, -1.f);
+		ensure_same("coords back", batched.getCoords(), single.getCoords());
+		ensure_same("normals back", batched.getNormals(), single.getNormals());
+		ensure_same("binormals back", batched.getBinormals(), single.getBinormals());
+		ensure_same("texcoords back", batched.getTexCoords(), single.getTexCoords());
+	}
+
+	template<> template<>
+	void polymesh_object::test<2>()
+	{
+		set_test_name("benchmark morphs applied one at a time and batched");
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		const S32 ITERATIONS = 200;
+		LLPolyMesh mesh(&mSharedData, NULL);
+		init_mesh(mesh);
+
+		// every morph swung to its maximum and back, as when a shape is worn
+		F64 secs[2];
+		for (S32 batched = 0; batched < 2; ++batched)
+		{
+			LLTimer timer;
+			for (S32 i = 0; i < ITERATIONS; ++i)
+			{
+				apply_morphs(mesh, mMorphs, batched, i % 2 ? -1.f : 1.f);
+			}
+			secs[batched] = timer.getElapsedTimeF64();
+		}
+
+		std::cout << "\nApplying " << NUM_MORPHS << " morph targets to " << NUM_VERTICES << " vertices\n"
+				  << llformat("  one at a time: %.1f shapes/s\n", ITERATIONS / secs[0])
+				  << llformat("  batched:       %.1f shapes/s\n", ITERATIONS / secs[1])
+				  << std::flush;
+	}
+}
@@ -28,8 +28,7 @@
 
 #include "llbvhloader.h"
 
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
 
 #include "lldatapacker.h"
 #include "lldir.h"
@@ -38,14 +37,19 @@
 #include "llstl.h"
 #include "llapr.h"
 #include "llsdserialize.h"
+#include "llthreadpool.h"
 
 
 using namespace std;
 
 #define INCHES_TO_METERS 0.02540005f
 
-const F32 POSITION_KEYFRAME_THRESHOLD_SQUARED = 0.03f * 0.03f;
-const F32 ROTATION_KEYFRAME_THRESHOLD = 0.01f;
+// The most any frame may play away from the source once keys are dropped.
+// The frame by frame reduction these replace tested against half of these,
+// but let frames drift from about two to five times as far as that, so this
+// is about the least error it ever had.
+const F32 POSITION_KEYFRAME_THRESHOLD_SQUARED = 0.06f * 0.06f;
+const F32 ROTATION_KEYFRAME_THRESHOLD = 0.02f;
 
 const F32 POSITION_MOTION_THRESHOLD_SQUARED = 0.001f * 0.001f;
 const F32 ROTATION_MOTION_THRESHOLD = 0.001f;
@@ -100,6 +104,55 @@ const char *find_next_whitespace(const char *p)
 	return p;
 }
 
+//------------------------------------------------------------------------
+// next_line()
+//
+// Reads the next non-empty line of the buffer into line and advances the
+// cursor past it.  Returns false at the end of the buffer.
+//------------------------------------------------------------------------
+static bool next_line(const char*& cursor, std::string& line)
+{
+	while (*cursor == '\r' || *cursor == '\n')
+	{
+		cursor++;
+	}
+	if (!*cursor)
+	{
+		return false;
+	}
+	const char* end = cursor + strcspn(cursor, "\r\n");
+	line.assign(cursor, end);
+	cursor = end;
+	return true;
+}
+
+//------------------------------------------------------------------------
+// parse_floats()
+//
+// Replaces the contents of values with the whitespace separated numbers
+// of a frame line.  Returns false if any of them isn't a number.
+//------------------------------------------------------------------------
+static bool parse_floats(const char* p, std::vector<F32>& values)
+{
+	values.clear();
+	while (true)
+	{
+		while (*p && isspace(*p)) p++;
+		if (!*p)
+		{
+			return true;
+		}
+		char* end;
+		F32 value = strtof(p, &end);
+		if (end == p || (*end && !isspace(*end)))
+		{
+			return false;
+		}
+		values.push_back(value);
+		p = end;
+	}
+}
+
 
 //------------------------------------------------------------------------
 // bvhStringToOrder()
@@ -574,11 +627,7 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	err_line = 0;
 	error_text[127] = '\0';
 
-	std::string str(buffer);
-	typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
-	boost::char_separator<char> sep("\r\n");
-	tokenizer tokens(str, sep);
-	tokenizer::iterator iter = tokens.begin();
+	const char* cursor = buffer;
 
 	mLineNumber = 0;
 	mJoints.clear();
@@ -588,9 +637,8 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// consume  hierarchy
 	//--------------------------------------------------------------------
-	if (iter == tokens.end())
+	if (!next_line(cursor, line))
 		return E_ST_EOF;
-	line = (*(iter++));
 	err_line++;
 
 	if ( !strstr(line.c_str(), "HIERARCHY") )
@@ -607,9 +655,8 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+		if (!next_line(cursor, line))
 			return E_ST_EOF;
-		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -641,9 +688,9 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		}
 		else if ( strstr(line.c_str(), "End Site") )
 		{
-			iter++; // {
-			iter++; //     OFFSET
-			iter++; // }
+			next_line(cursor, line); // {
+			next_line(cursor, line); //     OFFSET
+			next_line(cursor, line); // }
 			S32 depth = 0;
 			for (S32 j = (S32)parent_joints.size() - 1; j >= 0; j--)
 			{
@@ -713,11 +760,10 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+		if (!next_line(cursor, line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -736,11 +782,10 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+		if (!next_line(cursor, line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -755,11 +800,10 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 		//----------------------------------------------------------------
 		// get next line
 		//----------------------------------------------------------------
-		if (iter == tokens.end())
+		if (!next_line(cursor, line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
 		err_line++;
 
 		//----------------------------------------------------------------
@@ -824,11 +868,10 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// get number of frames
 	//--------------------------------------------------------------------
-	if (iter == tokens.end())
+	if (!next_line(cursor, line))
 	{
 		return E_ST_EOF;
 	}
-	line = (*(iter++));
 	err_line++;
 
 	if ( !strstr(line.c_str(), "Frames:") )
@@ -846,11 +889,10 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// get frame time
 	//--------------------------------------------------------------------
-	if (iter == tokens.end())
+	if (!next_line(cursor, line))
 	{
 		return E_ST_EOF;
 	}
-	line = (*(iter++));
 	err_line++;
 
 	if ( !strstr(line.c_str(), "Frame Time:") )
@@ -874,43 +916,38 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 	//--------------------------------------------------------------------
 	// load frames
 	//--------------------------------------------------------------------
+	// a bogus frame count can't reserve more keys than the text has room for
+	S32 reserve_frames = llmin(mNumFrames, (S32)(strlen(cursor) / 2));
+	for (U32 j=0; j<mJoints.size(); j++)
+	{
+		mJoints[j]->mKeys.reserve(reserve_frames);
+	}
+
+	std::vector<F32> floats;
 	for (S32 i=0; i<mNumFrames; i++)
 	{
 		// get next line
-		if (iter == tokens.end())
+		if (!next_line(cursor, line))
 		{
 			return E_ST_EOF;
 		}
-		line = (*(iter++));
 		err_line++;
 
 		// Split line into a collection of floats.
-		std::deque<F32> floats;
-		boost::char_separator<char> whitespace_sep("\t ");
-		tokenizer float_tokens(line, whitespace_sep);
-		tokenizer::iterator float_token_iter = float_tokens.begin();
-		while (float_token_iter != float_tokens.end())
+		if (!parse_floats(line.c_str(), floats))
 		{
-            try
-            {
-                F32 val = boost::lexical_cast<float>(*float_token_iter);
-                floats.push_back(val);
-            }
-            catch (const boost::bad_lexical_cast&)
-            {
-				strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
-				return E_ST_NO_POS;
-            }
-            float_token_iter++;
+			strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
+			return E_ST_NO_POS;
 		}
 		LL_DEBUGS("BVH") << "Got " << floats.size() << " floats " << LL_ENDL;
+		U32 next = 0;
 		for (U32 j=0; j<mJoints.size(); j++)
 		{
 			Joint *joint = mJoints[j];
 			joint->mKeys.push_back( Key() );
 			Key &key = joint->mKeys.back();
 
-			if (floats.size() < joint->mNumChannels)
+			if (floats.size() - next < (U32)joint->mNumChannels)
 			{
 				strncpy(error_text, line.c_str(), 127);	/*Flawfinder: ignore*/
 				return E_ST_NO_POS;
@@ -920,13 +957,13 @@ ELoadStatus LLBVHLoader::loadBVHFile(const char *buffer, char* error_text, S32 &
 			// or numChannels == 3, in which case we have only rot.
 			if (joint->mNumChannels == 6)
 			{
-				key.mPos[0] = floats.front(); floats.pop_front();
-				key.mPos[1] = floats.front(); floats.pop_front();
-				key.mPos[2] = floats.front(); floats.pop_front();
+				key.mPos[0] = floats[next++];
+				key.mPos[1] = floats[next++];
+				key.mPos[2] = floats[next++];
 			}
-			key.mRot[ joint->mOrder[0]-'X' ] = floats.front(); floats.pop_front();
-			key.mRot[ joint->mOrder[1]-'X' ] = floats.front(); floats.pop_front();
-			key.mRot[ joint->mOrder[2]-'X' ] = floats.front(); floats.pop_front();
+			key.mRot[ joint->mOrder[0]-'X' ] = floats[next++];
+			key.mRot[ joint->mOrder[1]-'X' ] = floats[next++];
+			key.mRot[ joint->mOrder[2]-'X' ] = floats[next++];
 		}
 	}
 
@@ -1055,178 +1092,208 @@ void LLBVHLoader::optimize()
 		mEaseOut *= factor;
 	}
 
-	JointVector::iterator ji;
-	for (ji = mJoints.begin(); ji != mJoints.end(); ++ji)
+	// joints are reduced independently of each other
+	LLThreadPool* pool = LLThreadPool::getInstance();
+	if (pool && mJoints.size() > 1)
 	{
-		Joint *joint = *ji;
-		BOOL pos_changed = FALSE;
-		BOOL rot_changed = FALSE;
+		pool->parallelFor(mJoints.size(), boost::bind(&LLBVHLoader::optimizeJoint, this, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < mJoints.size(); ++i)
+		{
+			optimizeJoint(i);
+		}
+	}
+}
 
-		if ( ! joint->mIgnore )
+// The axes nlerp(t, p, q) turns x and y to when p and q are in the same
+// hemisphere, the first two rows of its rotation matrix.  The lerped
+// quaternion is not normalized, the rows are scaled by 2 / |q|^2 instead.
+static void lerp_axes(F32 t, const LLQuaternion& p, const LLQuaternion& q, LLVector3& x_axis, LLVector3& y_axis)
+{
+	F32 inv_t = 1.f - t;
+	F32 x = t * q.mQ[VX] + inv_t * p.mQ[VX];
+	F32 y = t * q.mQ[VY] + inv_t * p.mQ[VY];
+	F32 z = t * q.mQ[VZ] + inv_t * p.mQ[VZ];
+	F32 w = t * q.mQ[VW] + inv_t * p.mQ[VW];
+	F32 s = 2.f / (x * x + y * y + z * z + w * w);
+	x_axis.set(1.f - s * (y * y + z * z), s * (x * y + z * w), s * (x * z - y * w));
+	y_axis.set(s * (x * y - z * w), 1.f - s * (x * x + z * z), s * (y * z + x * w));
+}
+
+//-----------------------------------------------------------------------------
+// LLBVHLoader::optimizeJoint()
+//-----------------------------------------------------------------------------
+void LLBVHLoader::optimizeJoint(U32 index)
+{
+	Joint *joint = mJoints[index];
+	if (joint->mIgnore)
+	{
+		return;
+	}
+
+	S32 num_keys = joint->mKeys.size();
+	// no keys?
+	if (num_keys == 0)
+	{
+		joint->mIgnore = TRUE;
+		return;
+	}
+
+	// the axes the rotations turn x and y to, which the error is measured on
+	LLQuaternion::Order order = bvhStringToOrder( joint->mOrder );
+	std::vector<LLQuaternion> rots(num_keys);
+	std::vector<LLVector3> x_axes(num_keys);
+	std::vector<LLVector3> y_axes(num_keys);
+	for (S32 i = 0; i < num_keys; ++i)
+	{
+		const Key& key = joint->mKeys[i];
+		rots[i] = mayaQ( key.mRot[0], key.mRot[1], key.mRot[2], order);
+		x_axes[i] = LLVector3::x_axis * rots[i];
+		y_axes[i] = LLVector3::y_axis * rots[i];
+	}
+
+	BOOL pos_changed = FALSE;
+	BOOL rot_changed = FALSE;
+	S32 first = 0;
+	if (num_keys == 1)
+	{
+		// *FIX: use single frame to move pelvis
+		// if only one keyframe force output for this joint
+		rot_changed = TRUE;
+	}
+	else
+	{
+		// if more than one keyframe, use first frame as reference and skip to second
+		joint->mKeys[0].mIgnorePos = TRUE;
+		joint->mKeys[0].mIgnoreRot = TRUE;
+		first = 1;
+	}
+
+	// Test if the joint moves noticeably from the very first frame.  If it
+	// doesn't, we'll just throw out this joint entirely.
+	LLVector3 first_frame_pos(joint->mKeys[0].mPos);
+	for (S32 i = first; i < num_keys && !(pos_changed && rot_changed); ++i)
+	{
+		if (dist_vec_squared(LLVector3(joint->mKeys[i].mPos), first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
 		{
-			joint->mNumPosKeys = 0;
-			joint->mNumRotKeys = 0;
-			LLQuaternion::Order order = bvhStringToOrder( joint->mOrder );
+			pos_changed = TRUE;
+		}
+		if (dist_vec(x_axes[0], x_axes[i]) + dist_vec(y_axes[0], y_axes[i]) > ROTATION_MOTION_THRESHOLD)
+		{
+			rot_changed = TRUE;
+		}
+	}
 
-			KeyVector::iterator first_key = joint->mKeys.begin();
+	// don't output joints with no motion
+	if (!(pos_changed || rot_changed))
+	{
+		joint->mIgnore = TRUE;
+		return;
+	}
 
-			// no keys?
-			if (first_key == joint->mKeys.end())
-			{
-				joint->mIgnore = TRUE;
-				continue;
-			}
+	// Keep the first and last key and, as long as any key in between is
+	// further from the line between two kept keys than the threshold, the
+	// one furthest from it (Douglas-Peucker).  Every frame then plays within
+	// the threshold of the source, whereas skipping ahead one frame at a
+	// time can both miss slow drifts and keep redundant keys.
+	F32 rot_threshold = ROTATION_KEYFRAME_THRESHOLD / llmax((F32)joint->mChildTreeMaxDepth * 0.33f, 1.f);
+	F32 rot_threshold_squared = rot_threshold * rot_threshold;
+	for (S32 i = first + 1; i < num_keys - 1; ++i)
+	{
+		joint->mKeys[i].mIgnorePos = TRUE;
+		joint->mKeys[i].mIgnoreRot = TRUE;
+	}
 
-			LLVector3 first_frame_pos(first_key->mPos);
-			LLQuaternion first_frame_rot = mayaQ( first_key->mRot[0], first_key->mRot[1], first_key->mRot[2], order);
-	
-			// skip first key
-			KeyVector::iterator ki = joint->mKeys.begin();
-			if (joint->mKeys.size() == 1)
+	std::vector<std::pair<S32, S32> > spans;
+	spans.push_back(std::make_pair(first, num_keys - 1));
+	while (!spans.empty())
+	{
+		S32 a = spans.back().first;
+		S32 b = spans.back().second;
+		spans.pop_back();
+
+		S32 max_key = -1;
+		F32 max_error = 0.f;
+		const BOOL lerped = dot(rots[a], rots[b]) >= 0.f;
+		for (S32 i = a + 1; i < b; ++i)
+		{
+			F32 t = (F32)(i - a) / (F32)(b - a);
+			LLVector3 x_interp, y_interp;
+			if (lerped)
 			{
-				// *FIX: use single frame to move pelvis
-				// if only one keyframe force output for this joint
-				rot_changed = TRUE;
+				lerp_axes(t, rots[a], rots[b], x_interp, y_interp);
 			}
 			else
 			{
-				// if more than one keyframe, use first frame as reference and skip to second
-				first_key->mIgnorePos = TRUE;
-				first_key->mIgnoreRot = TRUE;
-				++ki;
+				LLQuaternion interp_rot = nlerp(t, rots[a], rots[b]);
+				x_interp = LLVector3::x_axis * interp_rot;
+				y_interp = LLVector3::y_axis * interp_rot;
 			}
-
-			KeyVector::iterator ki_prev = ki;
-			KeyVector::iterator ki_last_good_pos = ki;
-			KeyVector::iterator ki_last_good_rot = ki;
-			S32 numPosFramesConsidered = 2;
-			S32 numRotFramesConsidered = 2;
-
-			F32 rot_threshold = ROTATION_KEYFRAME_THRESHOLD / llmax((F32)joint->mChildTreeMaxDepth * 0.33f, 1.f);
-
-			double diff_max = 0;
-			KeyVector::iterator ki_max = ki;
-			for (; ki != joint->mKeys.end(); ++ki)
+			// |dx| + |dy| is at most sqrt(2 (|dx|^2 + |dy|^2)).  Most frames
+			// are well within the threshold and need no square root.
+			F32 dx = dist_vec_squared(x_interp, x_axes[i]);
+			F32 dy = dist_vec_squared(y_interp, y_axes[i]);
+			if (2.f * (dx + dy) < rot_threshold_squared)
 			{
-				if (ki_prev == ki_last_good_pos)
-				{
-					joint->mNumPosKeys++;
-					if (dist_vec_squared(LLVector3(ki_prev->mPos), first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
-					{
-						pos_changed = TRUE;
-					}
-				}
-				else
-				{
-					//check position for noticeable effect
-					LLVector3 test_pos(ki_prev->mPos);
-					LLVector3 last_good_pos(ki_last_good_pos->mPos);
-					LLVector3 current_pos(ki->mPos);
-					LLVector3 interp_pos = lerp(current_pos, last_good_pos, 1.f / (F32)numPosFramesConsidered);
-
-					if (dist_vec_squared(current_pos, first_frame_pos) > POSITION_MOTION_THRESHOLD_SQUARED)
-					{
-						pos_changed = TRUE;
-					}
-
-					if (dist_vec_squared(interp_pos, test_pos) < POSITION_KEYFRAME_THRESHOLD_SQUARED)
-					{
-						ki_prev->mIgnorePos = TRUE;
-						numPosFramesConsidered++;
-					}
-					else
-					{
-						numPosFramesConsidered = 2;
-						ki_last_good_pos = ki_prev;
-						joint->mNumPosKeys++;
-					}
-				}
-
-				if (ki_prev == ki_last_good_rot)
-				{
-					joint->mNumRotKeys++;
-					LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
-					F32 x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
-					F32 y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
-					F32 rot_test = x_delta + y_delta;
-
-					if (rot_test > ROTATION_MOTION_THRESHOLD)
-					{
-						rot_changed = TRUE;
-					}
-				}
-				else
-				{
-					//check rotation for noticeable effect
-					LLQuaternion test_rot = mayaQ( ki_prev->mRot[0], ki_prev->mRot[1], ki_prev->mRot[2], order);
-					LLQuaternion last_good_rot = mayaQ( ki_last_good_rot->mRot[0], ki_last_good_rot->mRot[1], ki_last_good_rot->mRot[2], order);
-					LLQuaternion current_rot = mayaQ( ki->mRot[0], ki->mRot[1], ki->mRot[2], order);
-					LLQuaternion interp_rot = lerp(1.f / (F32)numRotFramesConsidered, current_rot, last_good_rot);
-
-					F32 x_delta;
-					F32 y_delta;
-					F32 rot_test;
-					
-					// Test if the rotation has changed significantly since the very first frame.  If false
-					// for all frames, then we'll just throw out this joint's rotation entirely.
-					x_delta = dist_vec(LLVector3::x_axis * first_frame_rot, LLVector3::x_axis * test_rot);
-					y_delta = dist_vec(LLVector3::y_axis * first_frame_rot, LLVector3::y_axis * test_rot);
-					rot_test = x_delta + y_delta;
-					if (rot_test > ROTATION_MOTION_THRESHOLD)
-					{
-						rot_changed = TRUE;
-					}
-					x_delta = dist_vec(LLVector3::x_axis * interp_rot, LLVector3::x_axis * test_rot);
-					y_delta = dist_vec(LLVector3::y_axis * interp_rot, LLVector3::y_axis * test_rot);
-					rot_test = x_delta + y_delta;
-
-					// Draw a line between the last good keyframe and current.  Test the distance between the last frame (current-1, i.e. ki_prev)
-					// and the line.  If it's greater than some threshold, then it represents a significant frame and we want to include it.
-					if (rot_test >= rot_threshold ||
-						(ki+1 == joint->mKeys.end() && numRotFramesConsidered > 2))
-					{
-						// Add the current test keyframe (which is technically the previous key, i.e. ki_prev).
-						numRotFramesConsidered = 2;
-						ki_last_good_rot = ki_prev;
-						joint->mNumRotKeys++;
-
-						// Add another keyframe between the last good keyframe and current, at whatever point was the most "significant" (i.e.
-						// had the largest deviation from the earlier tests).  Note that a more robust approach would be test all intermediate
-						// keyframes against the line between the last good keyframe and current, but we're settling for this other method
-						// because it's significantly faster.
-						if (diff_max > 0)
-						{
-							if (ki_max->mIgnoreRot == TRUE)
-							{
-								ki_max->mIgnoreRot = FALSE;
-								joint->mNumRotKeys++;
-							}
-							diff_max = 0;
-						}
-					}
-					else
-					{
-						// This keyframe isn't significant enough, throw it away.
-						ki_prev->mIgnoreRot = TRUE;
-						numRotFramesConsidered++;
-						// Store away the keyframe that has the largest deviation from the interpolated line, for insertion later.
-						if (rot_test > diff_max)
-						{
-							diff_max = rot_test;
-							ki_max = ki;
-						}
-					}
-				}
+				continue;
+			}
+			F32 error = sqrtf(dx) + sqrtf(dy);
+			if (error >= rot_threshold && error > max_error)
+			{
+				max_error = error;
+				max_key = i;
+			}
+		}
+		if (max_key >= 0)
+		{
+			joint->mKeys[max_key].mIgnoreRot = FALSE;
+			spans.push_back(std::make_pair(a, max_key));
+			spans.push_back(std::make_pair(max_key, b));
+		}
+	}
 
-				ki_prev = ki;
+	spans.push_back(std::make_pair(first, num_keys - 1));
+	while (!spans.empty())
+	{
+		S32 a = spans.back().first;
+		S32 b = spans.back().second;
+		spans.pop_back();
+
+		LLVector3 pos_a(joint->mKeys[a].mPos);
+		LLVector3 pos_b(joint->mKeys[b].mPos);
+		S32 max_key = -1;
+		F32 max_error = 0.f;
+		for (S32 i = a + 1; i < b; ++i)
+		{
+			LLVector3 interp_pos = lerp(pos_a, pos_b, (F32)(i - a) / (F32)(b - a));
+			F32 error = dist_vec_squared(interp_pos, LLVector3(joint->mKeys[i].mPos));
+			if (error >= POSITION_KEYFRAME_THRESHOLD_SQUARED && error > max_error)
+			{
+				max_error = error;
+				max_key = i;
 			}
-		}	
+		}
+		if (max_key >= 0)
+		{
+			joint->mKeys[max_key].mIgnorePos = FALSE;
+			spans.push_back(std::make_pair(a, max_key));
+			spans.push_back(std::make_pair(max_key, b));
+		}
+	}
 
-		// don't output joints with no motion
-		if (!(pos_changed || rot_changed))
+	joint->mNumPosKeys = 0;
+	joint->mNumRotKeys = 0;
+	for (S32 i = first; i < num_keys; ++i)
+	{
+		if (!joint->mKeys[i].mIgnorePos)
 		{
-			//LL_INFOS() << "Ignoring joint " << joint->mName << LL_ENDL;
-			joint->mIgnore = TRUE;
+			joint->mNumPosKeys++;
+		}
+		if (!joint->mKeys[i].mIgnoreRot)
+		{
+			joint->mNumRotKeys++;
 		}
 	}
 }
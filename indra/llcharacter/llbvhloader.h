@@ -310,6 +310,9 @@ protected:
 	// Consumes one line of input from file.
 	BOOL getLine(apr_file_t *fp);
 
+	// flags the redundant keys of one joint, and the joint if it doesn't move
+	void optimizeJoint(U32 index);
+
 	// parser state
 	char		mLine[BVH_PARSER_LINE_SIZE];		/* Flawfinder: ignore */
 	S32			mLineNumber;
@@ -30,6 +30,8 @@
 
 #include "linden_common.h"
 
+#include <algorithm>
+
 #include "llcharacter.h"
 #include "llstring.h"
 #include "llfasttimer.h"
@@ -50,7 +52,9 @@ LLCharacter::LLCharacter()
 	mPreferredPelvisHeight( 0.f ),
 	mSex( SEX_FEMALE ),
 	mAppearanceSerialNum( 0 ),
-	mSkeletonSerialNum( 0 )
+	mSkeletonSerialNum( 0 ),
+	mAppliedSex( SEX_BOTH ),
+	mVisualParamWeights( this )
 {
 	llassert_always(sAllowInstancesChange) ;
 	sInstances.push_back(this);
@@ -66,6 +70,12 @@ LLCharacter::LLCharacter()
 //-----------------------------------------------------------------------------
 LLCharacter::~LLCharacter()
 {	
+	for (U32 i = 0; i < mDirtyVisualParams.size(); ++i)
+	{
+		mDirtyVisualParams[i]->setDirty(FALSE);
+	}
+	mDirtyVisualParams.clear();
+
 	for (LLVisualParam *param = getFirstVisualParam(); 
 		param;
 		param = getNextVisualParam())
@@ -201,20 +211,37 @@ void LLCharacter::updateMotions(e_update_t update_type)
 	}
 	else
 	{
-		LL_RECORD_BLOCK_TIME(FTM_UPDATE_ANIMATION);
-		// unpause if the number of outstanding pause requests has dropped to the initial one
-		if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
-		{
-			mMotionController.unpauseAllMotions();
-		}
-		bool force_update = (update_type == FORCE_UPDATE);
-		{
-			LL_RECORD_BLOCK_TIME(FTM_UPDATE_MOTIONS);
-			mMotionController.updateMotions(force_update);
-		}
+		beginUpdateMotions(update_type);
+		evaluateMotions();
 	}
 }
 
+//-----------------------------------------------------------------------------
+// beginUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLCharacter::beginUpdateMotions(e_update_t update_type)
+{
+	llassert(update_type != HIDDEN_UPDATE);
+
+	LL_RECORD_BLOCK_TIME(FTM_UPDATE_ANIMATION);
+	// unpause if the number of outstanding pause requests has dropped to the initial one
+	if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
+	{
+		mMotionController.unpauseAllMotions();
+	}
+	bool force_update = (update_type == FORCE_UPDATE);
+	mMotionController.beginUpdateMotions(force_update);
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLCharacter::evaluateMotions()
+{
+	LL_RECORD_BLOCK_TIME(FTM_UPDATE_MOTIONS);
+	mMotionController.evaluateMotions();
+}
+
 
 //-----------------------------------------------------------------------------
 // deactivateAllMotions()
@@ -459,6 +486,8 @@ void LLCharacter::addVisualParam(LLVisualParam *param)
 		visual_param_index_map_t::iterator index_iter = idxres.first;
 		index_iter->second = param;
 	}
+	param->setWeights(&mVisualParamWeights);
+	markVisualParamDirty(param);
 
 	if (param->getInfo())
 	{
@@ -478,26 +507,121 @@ void LLCharacter::addVisualParam(LLVisualParam *param)
 	//LL_INFOS() << "Adding Visual Param '" << param->getName() << "' ( " << index << " )" << LL_ENDL;
 }
 
+//-----------------------------------------------------------------------------
+// getVisualParamMemory()
+//-----------------------------------------------------------------------------
+void LLCharacter::getVisualParamMemory(LLVisualParamMemory& memory) const
+{
+	// a red-black tree node holds its color and three links besides the value
+	const size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+
+	memory.mNumParams = mVisualParamIndexMap.size();
+	memory.mNumWeights = mVisualParamWeights.getNumSlots();
+	memory.mWeightBytes = mVisualParamWeights.getMemoryUsage();
+	memory.mParamBaseBytes = mVisualParamIndexMap.size() * sizeof(LLVisualParam);
+	memory.mIndexBytes = mVisualParamIndexMap.size() * (sizeof(visual_param_index_map_t::value_type) + MAP_NODE_OVERHEAD)
+		+ mVisualParamNameMap.size() * (sizeof(visual_param_name_map_t::value_type) + MAP_NODE_OVERHEAD)
+		+ mDirtyVisualParams.capacity() * sizeof(LLVisualParam*);
+}
+
+//-----------------------------------------------------------------------------
+// markVisualParamDirty()
+//-----------------------------------------------------------------------------
+void LLCharacter::markVisualParamDirty(LLVisualParam *param)
+{
+	if (!param->isDirty())
+	{
+		param->setDirty(TRUE);
+		mDirtyVisualParams.push_back(param);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// clearVisualParamDirty()
+//-----------------------------------------------------------------------------
+void LLCharacter::clearVisualParamDirty(LLVisualParam *param)
+{
+	if (param->isDirty())
+	{
+		param->setDirty(FALSE);
+		std::vector<LLVisualParam *>::iterator iter = std::find(mDirtyVisualParams.begin(), mDirtyVisualParams.end(), param);
+		if (iter != mDirtyVisualParams.end())
+		{
+			mDirtyVisualParams.erase(iter);
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 // updateVisualParams()
 //-----------------------------------------------------------------------------
 void LLCharacter::updateVisualParams()
 {
-	for (LLVisualParam *param = getFirstVisualParam(); 
-		param;
-		param = getNextVisualParam())
+	applyVisualParams();
+}
+
+static bool visual_param_id_less(const LLVisualParam *a, const LLVisualParam *b)
+{
+	return a->getID() < b->getID();
+}
+
+//-----------------------------------------------------------------------------
+// applyVisualParams()
+//-----------------------------------------------------------------------------
+S32 LLCharacter::applyVisualParams()
+{
+	S32 applied = 0;
+	if (mSex != mAppliedSex)
 	{
-		if (param->isAnimating())
+		// the effective weight of every param of one sex changes
+		mAppliedSex = mSex;
+		for (U32 i = 0; i < mDirtyVisualParams.size(); ++i)
 		{
-			continue;
+			mDirtyVisualParams[i]->setDirty(FALSE);
 		}
-		// only apply parameters whose effective weight has changed
-		F32 effective_weight = ( param->getSex() & mSex ) ? param->getWeight() : param->getDefaultWeight();
-		if (effective_weight != param->getLastWeight())
+		mDirtyVisualParams.clear();
+
+		for (visual_param_index_map_t::iterator iter = mVisualParamIndexMap.begin();
+			 iter != mVisualParamIndexMap.end();
+			 ++iter)
 		{
-			param->apply( mSex );
+			applied += applyVisualParam(iter->second);
 		}
+		return applied;
 	}
+
+	// in id order, as the full pass goes.  Params dirtied while applying
+	// are applied too.
+	std::sort(mDirtyVisualParams.begin(), mDirtyVisualParams.end(), visual_param_id_less);
+	for (U32 i = 0; i < mDirtyVisualParams.size(); ++i)
+	{
+		LLVisualParam *param = mDirtyVisualParams[i];
+		param->setDirty(FALSE);
+		applied += applyVisualParam(param);
+	}
+	mDirtyVisualParams.clear();
+	return applied;
+}
+
+//-----------------------------------------------------------------------------
+// applyVisualParam()
+//-----------------------------------------------------------------------------
+BOOL LLCharacter::applyVisualParam(LLVisualParam *param)
+{
+	// animating params are applied by their owner as they animate, and
+	// dirtied again when they stop
+	if (param->isAnimating())
+	{
+		return FALSE;
+	}
+	// only apply parameters whose effective weight has changed
+	F32 effective_weight = ( param->getSex() & mSex ) ? param->getWeight() : param->getDefaultWeight();
+	if (effective_weight != param->getLastWeight())
+	{
+		param->apply( mSex );
+		return TRUE;
+	}
+	return FALSE;
 }
  
 LLAnimPauseRequest LLCharacter::requestPause()
@@ -114,7 +114,7 @@ public:
 	// gets agent local coordinates from global coordinates
 	virtual LLVector3	getPosAgentFromGlobal(const LLVector3d &position) = 0;
 
-	// updates all visual parameters for this character
+	// applies the visual parameters of this character whose weights changed
 	virtual void updateVisualParams();
 
 	virtual void addDebugText( const std::string& text ) = 0;
@@ -155,6 +155,12 @@ public:
 	enum e_update_t { NORMAL_UPDATE, HIDDEN_UPDATE, FORCE_UPDATE };
 	void updateMotions(e_update_t update_type);
 
+	// updateMotions() split for callers that evaluate several characters
+	// at once, see LLMotionController::beginUpdateMotions().  Not for
+	// HIDDEN_UPDATE.
+	void beginUpdateMotions(e_update_t update_type);
+	void evaluateMotions();
+
 	LLAnimPauseRequest requestPause();
 	BOOL areAnimationsPaused() const { return mMotionController.isPaused(); }
 	void setAnimTimeFactor(F32 factor) { mMotionController.setTimeFactor(factor); }
@@ -189,6 +195,14 @@ public:
 	
 	void addVisualParam(LLVisualParam *param);
 	void addSharedVisualParam(LLVisualParam *param);
+	// call when all the params are added
+	void trimVisualParamWeights() { mVisualParamWeights.trim(); }
+
+	// params whose weights changed since updateVisualParams() last ran,
+	// kept by LLVisualParam::setWeight() and its overrides
+	void markVisualParamDirty(LLVisualParam *param);
+	void clearVisualParamDirty(LLVisualParam *param);
+	BOOL hasDirtyVisualParams() const { return !mDirtyVisualParams.empty() || mSex != mAppliedSex; }
 
 	virtual BOOL setVisualParamWeight(const LLVisualParam *which_param, F32 weight);
 	virtual BOOL setVisualParamWeight(const char* param_name, F32 weight);
@@ -248,6 +262,19 @@ public:
 	S32				getVisualParamCount() const { return (S32)mVisualParamIndexMap.size(); }
 	LLVisualParam*	getVisualParam(const char *name);
 
+	// what the visual params of the character take, for the per avatar
+	// memory report
+	struct LLVisualParamMemory
+	{
+		U32		mNumParams;			// added to the character
+		U32		mNumWeights;		// slots in the weights array
+		size_t	mWeightBytes;		// the weights array
+		size_t	mParamBaseBytes;	// sizeof(LLVisualParam) per param, the base class part only,
+									// without the morph, driver or layer data of the derived params
+		size_t	mIndexBytes;		// the id and name maps and the dirty list
+	};
+	void getVisualParamMemory(LLVisualParamMemory& memory) const;
+
 
 	ESex getSex() const			{ return mSex; }
 	void setSex( ESex sex )		{ mSex = sex; }
@@ -276,7 +303,13 @@ protected:
 	U32					mSkeletonSerialNum;
 	LLAnimPauseRequest	mPauseRequest;
 
+	// applies the dirty params, all of them when the sex changed, and
+	// returns how many were applied
+	S32 applyVisualParams();
+
 private:
+	BOOL applyVisualParam(LLVisualParam *param);
+
 	// visual parameter stuff
 	typedef std::map<S32, LLVisualParam *> 		visual_param_index_map_t;
 	typedef std::map<char *, LLVisualParam *> 	visual_param_name_map_t;
@@ -284,6 +317,9 @@ private:
 	visual_param_index_map_t::iterator 			mCurIterator;
 	visual_param_index_map_t 					mVisualParamIndexMap;
 	visual_param_name_map_t  					mVisualParamNameMap;
+	std::vector<LLVisualParam *>				mDirtyVisualParams;
+	ESex										mAppliedSex;	// mSex when the params were last applied
+	LLVisualParamWeights						mVisualParamWeights;	// of the params added
 
 	static LLStringTable sVisualParamNames;	
 
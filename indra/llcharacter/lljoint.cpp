@@ -35,8 +35,22 @@
 #include "llcallstack.h"
 #include <boost/algorithm/string.hpp>
 
-S32 LLJoint::sNumUpdates = 0;
-S32 LLJoint::sNumTouches = 0;
+LLAtomicS32 LLJoint::sNumUpdates(0);
+LLAtomicS32 LLJoint::sNumTouches(0);
+U32 LLJoint::sHierarchySerial = 0;
+
+// Every avatar has the same few hundred joint names
+static LLStdStringTable& joint_names()
+{
+	static LLStdStringTable sJointNames(512);
+	return sJointNames;
+}
+
+//static
+LLStdStringHandle LLJoint::addName(const std::string& name)
+{
+	return joint_names().addString(name);
+}
 
 template <class T> 
 bool attachment_map_iter_compare_key(const T& a, const T& b)
@@ -104,7 +118,8 @@ void LLVector3OverrideMap::clear()
 
 void LLJoint::init()
 {
-	mName = "unnamed";
+	static LLStdStringHandle unnamed = addName("unnamed");
+	mName = unnamed;
 	mParent = NULL;
 	mXform.setScaleChildOffset(TRUE);
 	mXform.setScale(LLVector3(1.0f, 1.0f, 1.0f));
@@ -278,6 +293,7 @@ void LLJoint::addChild(LLJoint* joint)
 	joint->mXform.setParent(&mXform);
 	joint->mParent = this;	
 	joint->touch();
+	sHierarchySerial++;
 }
 
 
@@ -294,6 +310,7 @@ void LLJoint::removeChild(LLJoint* joint)
 		joint->mXform.setParent(NULL);
 		joint->mParent = NULL;
 		joint->touch();
+		sHierarchySerial++;
 	}
 }
 
@@ -312,6 +329,7 @@ void LLJoint::removeAllChildren()
 		joint->mXform.setParent(NULL);
 		joint->mParent = NULL;
 		joint->touch();
+		sHierarchySerial++;
 	}
 }
 
@@ -38,6 +38,8 @@
 #include "m4math.h"
 #include "llquaternion.h"
 #include "xform.h"
+#include "llapr.h"
+#include "llstringtable.h"
 
 const S32 LL_CHARACTER_MAX_JOINTS_PER_MESH = 15;
 // Need to set this to count of animate-able joints,
@@ -102,7 +104,8 @@ public:
         SUPPORT_EXTENDED
     };
 protected:
-	std::string	mName;
+	// the name table's copy, shared by every joint of that name
+	LLStdStringHandle	mName;
 
 	SupportCategory mSupport;
 
@@ -132,9 +135,12 @@ public:
 	typedef std::list<LLJoint*> child_list_t;
 	child_list_t mChildren;
 
-	// debug statics
-	static S32		sNumTouches;
-	static S32		sNumUpdates;
+	// bumped whenever any joint gains or loses a child, see LLJointHierarchy
+	static U32		sHierarchySerial;
+
+	// debug statics, bumped by the motion updates on any thread
+	static LLAtomicS32	sNumTouches;
+	static LLAtomicS32	sNumUpdates;
     typedef std::set<std::string> debug_joint_name_t;
     static debug_joint_name_t s_debugJointNames;
     static void setDebugJointNames(const debug_joint_name_t& names);
@@ -183,8 +189,13 @@ public:
 	void touch(U32 flags = ALL_DIRTY);
 
 	// get/set name
-	const std::string& getName() const { return mName; }
-	void setName( const std::string &name ) { mName = name; }
+	const std::string& getName() const { return *mName; }
+	void setName( const std::string &name ) { mName = addName(name); }
+	void setName( LLStdStringHandle name ) { mName = name; }
+
+	// The one copy of a joint name that all joints of that name keep,
+	// added the first time it is used.  Joints are named on the main thread.
+	static LLStdStringHandle addName( const std::string &name );
 
     // joint num
 	S32 getJointNum() const { return mJointNum; }
@@ -0,0 +1,304 @@
+/**
+ * @file lljointhierarchy.cpp
+ * @brief Flat, topologically ordered world transforms of a joint tree
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lljointhierarchy.h"
+
+#include "lljoint.h"
+#include "llmemory.h"
+
+// Lane shuffles of one vector, and the sign bit of some lanes flipped.  Negating
+// a product is exact, so x + (-(y*z)) rounds like the x - y*z of the scalar code.
+#define LL_SHUFFLE(v, a, b, c, d) _mm_shuffle_ps(v, v, _MM_SHUFFLE(d, c, b, a))
+
+static LL_FORCE_INLINE LLQuad sign_mask(bool x, bool y, bool z, bool w)
+{
+	return _mm_castsi128_ps(_mm_set_epi32(w ? 0x80000000 : 0, z ? 0x80000000 : 0, y ? 0x80000000 : 0, x ? 0x80000000 : 0));
+}
+
+// a * b as LLQuaternion operator*() computes it
+static LL_FORCE_INLINE LLQuad quat_mul(const LLQuad& a, const LLQuad& b)
+{
+	const LLQuad neg_w = sign_mask(false, false, false, true);
+
+	LLQuad t1 = _mm_mul_ps(LL_SHUFFLE(b, 3, 3, 3, 3), a);
+	LLQuad t2 = _mm_xor_ps(_mm_mul_ps(LL_SHUFFLE(b, 0, 1, 2, 0), LL_SHUFFLE(a, 3, 3, 3, 0)), neg_w);
+	LLQuad t3 = _mm_xor_ps(_mm_mul_ps(LL_SHUFFLE(b, 1, 2, 0, 1), LL_SHUFFLE(a, 2, 0, 1, 1)), neg_w);
+	LLQuad t4 = _mm_mul_ps(LL_SHUFFLE(b, 2, 0, 1, 2), LL_SHUFFLE(a, 1, 2, 0, 2));
+
+	return _mm_sub_ps(_mm_add_ps(_mm_add_ps(t1, t2), t3), t4);
+}
+
+// v * q as LLVector3 operator*=(const LLQuaternion&) computes it, w is garbage
+static LL_FORCE_INLINE LLQuad quat_rotate(const LLQuad& v, const LLQuad& q)
+{
+	const LLQuad neg_w = sign_mask(false, false, false, true);
+
+	// (rx, ry, rz, rw)
+	LLQuad t1 = _mm_mul_ps(_mm_xor_ps(LL_SHUFFLE(q, 3, 3, 3, 0), neg_w), LL_SHUFFLE(v, 0, 1, 2, 0));
+	LLQuad t2 = _mm_xor_ps(_mm_mul_ps(LL_SHUFFLE(q, 1, 2, 0, 1), LL_SHUFFLE(v, 2, 0, 1, 1)), neg_w);
+	LLQuad t3 = _mm_mul_ps(LL_SHUFFLE(q, 2, 0, 1, 2), LL_SHUFFLE(v, 1, 2, 0, 2));
+	LLQuad r = _mm_sub_ps(_mm_add_ps(t1, t2), t3);
+
+	LLQuad u1 = _mm_mul_ps(_mm_xor_ps(LL_SHUFFLE(r, 3, 3, 3, 3), sign_mask(true, true, true, true)), q);
+	LLQuad u2 = _mm_mul_ps(r, LL_SHUFFLE(q, 3, 3, 3, 3));
+	LLQuad u3 = _mm_mul_ps(LL_SHUFFLE(r, 1, 2, 0, 3), LL_SHUFFLE(q, 2, 0, 1, 3));
+	LLQuad u4 = _mm_mul_ps(LL_SHUFFLE(r, 2, 0, 1, 3), LL_SHUFFLE(q, 1, 2, 0, 3));
+
+	return _mm_add_ps(_mm_sub_ps(_mm_add_ps(u1, u2), u3), u4);
+}
+
+// One row of LLMatrix4::initAll(): 2 * (a +/- b), one minus that on the diagonal,
+// times the scale, zero in w
+static LL_FORCE_INLINE LLQuad init_row(const LLQuad& a, const LLQuad& b, const LLQuad& b_sign,
+									   const LLQuad& diagonal, const LLQuad& scale)
+{
+	const LLQuad two = _mm_set1_ps(2.f);
+	const LLQuad one = _mm_set1_ps(1.f);
+	const LLQuad xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+	LLQuad c = _mm_mul_ps(two, _mm_add_ps(a, _mm_xor_ps(b, b_sign)));
+	c = _mm_or_ps(_mm_and_ps(diagonal, _mm_sub_ps(one, c)), _mm_andnot_ps(diagonal, c));
+	return _mm_and_ps(_mm_mul_ps(c, scale), xyz);
+}
+
+static LL_FORCE_INLINE void init_all(const LLQuad& scale, const LLQuad& q, const LLQuad& pos, LLMatrix4a& mat)
+{
+	const LLQuad diag_x = _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1));
+	const LLQuad diag_y = _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, 0));
+	const LLQuad diag_z = _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, 0));
+
+	// (yy, xy, xz) +  (zz, zw, yw) with the last one subtracted, and so on
+	mat.mMatrix[0] = init_row(_mm_mul_ps(LL_SHUFFLE(q, 1, 0, 0, 3), LL_SHUFFLE(q, 1, 1, 2, 3)),
+							  _mm_mul_ps(LL_SHUFFLE(q, 2, 2, 1, 3), LL_SHUFFLE(q, 2, 3, 3, 3)),
+							  sign_mask(false, false, true, false), diag_x, LL_SHUFFLE(scale, 0, 0, 0, 0));
+	mat.mMatrix[1] = init_row(_mm_mul_ps(LL_SHUFFLE(q, 0, 0, 1, 3), LL_SHUFFLE(q, 1, 0, 2, 3)),
+							  _mm_mul_ps(LL_SHUFFLE(q, 2, 2, 0, 3), LL_SHUFFLE(q, 3, 2, 3, 3)),
+							  sign_mask(true, false, false, false), diag_y, LL_SHUFFLE(scale, 1, 1, 1, 1));
+	mat.mMatrix[2] = init_row(_mm_mul_ps(LL_SHUFFLE(q, 0, 1, 0, 3), LL_SHUFFLE(q, 2, 2, 0, 3)),
+							  _mm_mul_ps(LL_SHUFFLE(q, 1, 0, 1, 3), LL_SHUFFLE(q, 3, 3, 1, 3)),
+							  sign_mask(false, true, false, false), diag_z, LL_SHUFFLE(scale, 2, 2, 2, 2));
+
+	LLVector4a trans(pos);
+	trans.getF32ptr()[3] = 1.f;
+	mat.mMatrix[3] = trans;
+}
+
+LLJointHierarchy::LLJointHierarchy()
+:	mRoot(NULL),
+	mSerial(0),
+	mWorldPosition(NULL),
+	mWorldRotation(NULL),
+	mScale(NULL),
+	mWorldMatrix(NULL),
+	mCapacity(0)
+{
+}
+
+LLJointHierarchy::~LLJointHierarchy()
+{
+	// the joints may already be gone, only the arrays are ours
+	ll_aligned_free_16(mWorldPosition);
+	ll_aligned_free_16(mWorldRotation);
+	ll_aligned_free_16(mScale);
+	ll_aligned_free_16(mWorldMatrix);
+}
+
+void LLJointHierarchy::allocate(U32 count)
+{
+	if (count <= mCapacity)
+	{
+		return;
+	}
+
+	ll_aligned_free_16(mWorldPosition);
+	ll_aligned_free_16(mWorldRotation);
+	ll_aligned_free_16(mScale);
+	ll_aligned_free_16(mWorldMatrix);
+
+	mCapacity = count;
+	mWorldPosition = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+	mWorldRotation = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+	mScale = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+	mWorldMatrix = (LLMatrix4a*) ll_aligned_malloc_16(count * sizeof(LLMatrix4a));
+}
+
+void LLJointHierarchy::build(LLJoint* root)
+{
+	mRoot = root;
+	mSerial = LLJoint::sHierarchySerial;
+	mJoints.clear();
+	mParents.clear();
+	mSubtreeEnd.clear();
+
+	// depth first with an explicit stack, children in list order like the recursion
+	std::vector<std::pair<LLJoint*, S32> > stack;
+	stack.push_back(std::make_pair(root, -1));
+	while (!stack.empty())
+	{
+		LLJoint* joint = stack.back().first;
+		S32 parent = stack.back().second;
+		stack.pop_back();
+
+		// a joint whose xform hangs off something else reads its parent from the
+		// xform, as the root does
+		if (parent >= 0 && joint->getXform()->getParent() != mJoints[parent]->getXform())
+		{
+			parent = -1;
+		}
+
+		S32 index = mJoints.size();
+		mJoints.push_back(joint);
+		mParents.push_back(parent);
+		mSubtreeEnd.push_back(0);
+
+		for (LLJoint::child_list_t::reverse_iterator iter = joint->mChildren.rbegin();
+			 iter != joint->mChildren.rend(); ++iter)
+		{
+			stack.push_back(std::make_pair(*iter, index));
+		}
+	}
+
+	// a subtree ends where the next joint that is not a descendant starts
+	std::vector<S32> open;
+	for (U32 i = 0; i < mJoints.size(); ++i)
+	{
+		LLJoint* parent = mJoints[i]->getParent();
+		while (!open.empty() && mJoints[open.back()] != parent)
+		{
+			mSubtreeEnd[open.back()] = i;
+			open.pop_back();
+		}
+		open.push_back(i);
+	}
+	while (!open.empty())
+	{
+		mSubtreeEnd[open.back()] = mJoints.size();
+		open.pop_back();
+	}
+
+	allocate(mJoints.size());
+}
+
+void LLJointHierarchy::update(LLJoint* root)
+{
+	if (root != mRoot || mSerial != LLJoint::sHierarchySerial)
+	{
+		build(root);
+	}
+
+	const LLQuad one = _mm_set1_ps(1.f);
+	LL_ALIGN_16(F32 pos[4]);
+	LL_ALIGN_16(F32 rot[4]);
+
+	S32 updates = 0;
+	U32 count = mJoints.size();
+	U32 i = 0;
+	while (i < count)
+	{
+		LLJoint* joint = mJoints[i];
+		if (!joint->mUpdateXform)
+		{
+			i = mSubtreeEnd[i];
+			continue;
+		}
+
+		LLXformMatrix* xform = joint->getXform();
+
+		// what the children need from this joint, computed or not
+		mScale[i].load3(xform->getScale().mV);
+		if (!xform->getScaleChildOffset())
+		{
+			mScale[i] = one;
+		}
+
+		if (joint->mDirtyFlags & LLJoint::MATRIX_DIRTY)
+		{
+			LLVector4a local_pos;
+			LLVector4a local_rot;
+			local_pos.load3(xform->getPosition().mV);
+			local_rot.loadua(xform->getRotation().mQ);
+
+			LLQuad world_pos = local_pos;
+			LLQuad world_rot = local_rot;
+
+			S32 parent = mParents[i];
+			LLXform* parent_xform = xform->getParent();
+			if (parent >= 0 && parent_xform == mJoints[parent]->getXform())
+			{
+				world_pos = _mm_mul_ps(world_pos, mScale[parent]);
+				world_pos = _mm_add_ps(quat_rotate(world_pos, mWorldRotation[parent]), mWorldPosition[parent]);
+				world_rot = quat_mul(world_rot, mWorldRotation[parent]);
+			}
+			else if (parent_xform)
+			{
+				LLVector4a parent_pos;
+				LLVector4a parent_rot;
+				parent_pos.load3(parent_xform->getWorldPosition().mV);
+				parent_rot.loadua(parent_xform->getWorldRotation().mQ);
+				if (parent_xform->getScaleChildOffset())
+				{
+					LLVector4a parent_scale;
+					parent_scale.load3(parent_xform->getScale().mV);
+					world_pos = _mm_mul_ps(world_pos, parent_scale);
+				}
+				world_pos = _mm_add_ps(quat_rotate(world_pos, parent_rot), parent_pos);
+				world_rot = quat_mul(world_rot, parent_rot);
+			}
+
+			mWorldPosition[i] = world_pos;
+			mWorldRotation[i] = world_rot;
+
+			LLVector4a scale;
+			scale.load3(xform->getScale().mV);
+			init_all(scale, world_rot, world_pos, mWorldMatrix[i]);
+
+			mWorldPosition[i].store4a(pos);
+			mWorldRotation[i].store4a(rot);
+			LLMatrix4 world_mat;
+			for (U32 row = 0; row < 4; ++row)
+			{
+				_mm_storeu_ps(world_mat.mMatrix[row], mWorldMatrix[i].mMatrix[row]);
+			}
+			xform->setWorldTransform(LLVector3(pos), LLQuaternion(rot[0], rot[1], rot[2], rot[3]), world_mat);
+
+			joint->mDirtyFlags = 0x0;
+			++updates;
+		}
+		else
+		{
+			// current already, possibly from a getWorldMatrix() since the last pass
+			mWorldPosition[i].load3(xform->getWorldPosition().mV);
+			mWorldRotation[i].loadua(xform->getWorldRotation().mQ);
+			mWorldMatrix[i].loadu(xform->getWorldMatrix());
+		}
+
+		++i;
+	}
+
+	LLJoint::sNumUpdates += updates;
+}
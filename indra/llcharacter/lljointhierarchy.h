@@ -0,0 +1,85 @@
+/**
+ * @file lljointhierarchy.h
+ * @brief Flat, topologically ordered world transforms of a joint tree
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLJOINTHIERARCHY_H
+#define LL_LLJOINTHIERARCHY_H
+
+#include <vector>
+
+#include "llmath.h"	// LLVector4a
+#include "llmatrix4a.h"
+
+class LLJoint;
+
+// The joints of a skeleton in depth first order, each after its parent, with
+// their world positions, rotations and matrices in flat arrays.
+//
+// update() does what LLJoint::updateWorldMatrixChildren() does on the root,
+// with the same dirty flags and mUpdateXform subtree skipping, as one linear
+// pass over the arrays instead of a recursion over the child lists.  Each
+// joint's world transform is computed in SSE registers from its local
+// transform and its parent's entry, using the operations of
+// LLXformMatrix::update() and LLMatrix4::initAll() in the same order, so the
+// results are the same bits.  They are stored back into the joint, which
+// stays the interface everything else reads, and kept here for the children
+// and for callers that want the whole skeleton's matrices at once.
+//
+// The order is rebuilt by update() when it is given another root or when any
+// joint has been added or removed since, see LLJoint::sHierarchySerial.
+class LLJointHierarchy
+{
+public:
+	LLJointHierarchy();
+	~LLJointHierarchy();
+
+	void update(LLJoint* root);
+
+	U32 getNumJoints() const						{ return mJoints.size(); }
+	LLJoint* getJoint(U32 index) const				{ return mJoints[index]; }
+	S32 getParentIndex(U32 index) const				{ return mParents[index]; }
+
+	// valid for the joints the last update() reached
+	const LLMatrix4a& getWorldMatrix(U32 index) const	{ return mWorldMatrix[index]; }
+
+private:
+	void build(LLJoint* root);
+	void allocate(U32 count);
+
+	LLJoint*				mRoot;
+	U32						mSerial;
+
+	std::vector<LLJoint*>	mJoints;
+	std::vector<S32>		mParents;		// index of the parent joint, -1 for the root
+	std::vector<U32>		mSubtreeEnd;	// index one past the last descendant
+
+	LLVector4a*				mWorldPosition;
+	LLVector4a*				mWorldRotation;	// quaternion
+	LLVector4a*				mScale;			// local, scales the children's offsets
+	LLMatrix4a*				mWorldMatrix;
+	U32						mCapacity;
+};
+
+#endif // LL_LLJOINTHIERARCHY_H
@@ -321,12 +321,14 @@ public:
 		ScaleCurve();
 		~ScaleCurve();
 		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+		LLVector3 getValue(F32 time, F32 duration, U32& cursor);
+		LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after);
+		void addKey(const ScaleKey& key);
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, ScaleKey> key_map_t;
-		key_map_t 			mKeys;
+		std::vector<F32>	mKeyTimes;		// ascending, one key per time
+		std::vector<LLVector3> mKeyScales;
 		ScaleKey			mLoopInKey;
 		ScaleKey			mLoopOutKey;
 	};
@@ -340,12 +342,14 @@ public:
 		RotationCurve();
 		~RotationCurve();
 		LLQuaternion getValue(F32 time, F32 duration);
-		LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+		LLQuaternion getValue(F32 time, F32 duration, U32& cursor);
+		LLQuaternion interp(F32 u, const LLQuaternion& before, const LLQuaternion& after);
+		void addKey(const RotationKey& key);
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, RotationKey> key_map_t;
-		key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;		// ascending, one key per time
+		std::vector<LLQuaternion> mKeyRotations;
 		RotationKey		mLoopInKey;
 		RotationKey		mLoopOutKey;
 	};
@@ -359,16 +363,33 @@ public:
 		PositionCurve();
 		~PositionCurve();
 		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+		LLVector3 getValue(F32 time, F32 duration, U32& cursor);
+		LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after);
+		void addKey(const PositionKey& key);
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, PositionKey> key_map_t;
-		key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;		// ascending, one key per time
+		std::vector<LLVector3> mKeyPositions;
 		PositionKey		mLoopInKey;
 		PositionKey		mLoopOutKey;
 	};
 
+	//-------------------------------------------------------------------------
+	// KeyCursors
+	// Where the curves of one joint were last sampled.  The curves are shared
+	// by every motion playing the same animation, the cursors are per motion.
+	//-------------------------------------------------------------------------
+	class KeyCursors
+	{
+	public:
+		KeyCursors() : mScaleKey(0), mRotationKey(0), mPositionKey(0) {}
+
+		U32				mScaleKey;
+		U32				mRotationKey;
+		U32				mPositionKey;
+	};
+
 	//-------------------------------------------------------------------------
 	// JointMotion
 	//-------------------------------------------------------------------------
@@ -382,7 +403,7 @@ public:
 		U32				mUsage;
 		LLJoint::JointPriority	mPriority;
 
-		void update(LLJointState* joint_state, F32 time, F32 duration);
+		void update(LLJointState* joint_state, F32 time, F32 duration, KeyCursors& cursors);
 	};
 	
 	//-------------------------------------------------------------------------
@@ -425,6 +446,7 @@ protected:
 	//-------------------------------------------------------------------------
 	JointMotionList*				mJointMotionList;
 	std::vector<LLPointer<LLJointState> > mJointStates;
+	std::vector<KeyCursors>			mKeyCursors;
 	LLJoint*						mPelvisp;
 	LLCharacter*					mCharacter;
 	typedef std::list<JointConstraint*>	constraint_list_t;
@@ -41,11 +41,21 @@
 const S32 NUM_JOINT_SIGNATURE_STRIDES = LL_CHARACTER_MAX_ANIMATED_JOINTS / 4;
 const U32 MAX_MOTION_INSTANCES = 32;
 
+// Pixel areas below which characters drop to LOD_REDUCED and LOD_CORE.  To
+// come back up, the area has to exceed them by LOD_HYSTERESIS.
+const F32 REDUCED_LOD_PIXEL_AREA = 20000.f;
+const F32 CORE_LOD_PIXEL_AREA = 2500.f;
+const F32 LOD_HYSTERESIS = 1.25f;
+
 //-----------------------------------------------------------------------------
 // Constants and statics
 //-----------------------------------------------------------------------------
 F32 LLMotionController::sCurrentTimeFactor = 1.f;
 LLMotionRegistry LLMotionController::sRegistry;
+const F32 LLMotionController::REDUCED_LOD_TIME_STEP = 1.f / 15.f;
+const F32 LLMotionController::CORE_LOD_TIME_STEP = 1.f / 8.f;
+LLAtomicS32 LLMotionController::sFrameMotionsEvaluated(0);
+LLAtomicS32 LLMotionController::sFrameMotionsSkipped(0);
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -131,17 +141,25 @@ LLMotionController::LLMotionController()
 	: mTimeFactor(sCurrentTimeFactor),
 	  mCharacter(NULL),
 	  mAnimTime(0.f),
+	  mUnsteppedAnimTime(0.f),
 	  mPrevTimerElapsed(0.f),
 	  mLastTime(0.0f),
 	  mHasRunOnce(FALSE),
+	  mEvaluatePending(FALSE),
+	  mForceEvaluate(FALSE),
 	  mPaused(FALSE),
 	  mPauseTime(0.f),
 	  mTimeStep(0.f),
 	  mTimeStepCount(0),
 	  mLastInterp(0.f),
+	  mLOD(LOD_FULL),
+	  mCoreJointMaskSerial(0),
+	  mMotionsEvaluated(0),
+	  mMotionsSkipped(0),
 	  mIsSelf(FALSE),
 	  mLastCountAfterPurge(0)
 {
+	memset(mCoreJointMask, 0, sizeof(mCoreJointMask));
 }
 
 
@@ -289,6 +307,108 @@ void LLMotionController::setTimeStep(F32 step)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// updateLOD()
+//-----------------------------------------------------------------------------
+void LLMotionController::updateLOD(F32 pixel_area)
+{
+	ELOD lod;
+	if (pixel_area < CORE_LOD_PIXEL_AREA)
+	{
+		lod = LOD_CORE;
+	}
+	else if (pixel_area < REDUCED_LOD_PIXEL_AREA)
+	{
+		lod = (mLOD == LOD_CORE && pixel_area < CORE_LOD_PIXEL_AREA * LOD_HYSTERESIS) ? LOD_CORE : LOD_REDUCED;
+	}
+	else
+	{
+		lod = (mLOD != LOD_FULL && pixel_area < REDUCED_LOD_PIXEL_AREA * LOD_HYSTERESIS) ? LOD_REDUCED : LOD_FULL;
+	}
+	setLOD(lod);
+}
+
+//-----------------------------------------------------------------------------
+// setLOD()
+//-----------------------------------------------------------------------------
+void LLMotionController::setLOD(ELOD lod)
+{
+	if (lod == LOD_CORE && (mLOD != LOD_CORE || mCharacter->getSkeletonSerialNum() != mCoreJointMaskSerial))
+	{
+		updateCoreJointMask();
+	}
+	mLOD = lod;
+	mPoseBlender.setJointMask(lod == LOD_CORE ? mCoreJointMask : NULL);
+}
+
+//-----------------------------------------------------------------------------
+// getLODTimeStep()
+//-----------------------------------------------------------------------------
+F32 LLMotionController::getLODTimeStep() const
+{
+	switch (mLOD)
+	{
+	case LOD_REDUCED:
+		return REDUCED_LOD_TIME_STEP;
+	case LOD_CORE:
+		return CORE_LOD_TIME_STEP;
+	default:
+		return 0.f;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// updateCoreJointMask()
+//-----------------------------------------------------------------------------
+void LLMotionController::updateCoreJointMask()
+{
+	memset(mCoreJointMask, 0, sizeof(mCoreJointMask));
+	for (U32 i = 0; i < LL_CHARACTER_MAX_ANIMATED_JOINTS; ++i)
+	{
+		LLJoint* joint = mCharacter->getCharacterJoint(i);
+		if (!joint)
+		{
+			break;
+		}
+		if (joint->getSupport() == LLJoint::SUPPORT_BASE)
+		{
+			mCoreJointMask[i] = 0xff;
+		}
+	}
+	mCoreJointMaskSerial = mCharacter->getSkeletonSerialNum();
+}
+
+//-----------------------------------------------------------------------------
+// animatesCoreJoints()
+// Motions that don't animate any joint, like emotes, count as core
+//-----------------------------------------------------------------------------
+bool LLMotionController::animatesCoreJoints(LLMotion* motionp) const
+{
+	bool animates_joints = false;
+	for (S32 i = 0; i < NUM_JOINT_SIGNATURE_STRIDES; i++)
+	{
+		U32 used = *(U32*)&(motionp->mJointSignature[0][i * 4])
+			| *(U32*)&(motionp->mJointSignature[1][i * 4])
+			| *(U32*)&(motionp->mJointSignature[2][i * 4]);
+		if (used & *(const U32*)&mCoreJointMask[i * 4])
+		{
+			return true;
+		}
+		animates_joints |= (used != 0);
+	}
+	return !animates_joints;
+}
+
+//-----------------------------------------------------------------------------
+// resetFrameStats()
+//-----------------------------------------------------------------------------
+//static
+void LLMotionController::resetFrameStats()
+{
+	sFrameMotionsEvaluated = 0;
+	sFrameMotionsSkipped = 0;
+}
+
 //-----------------------------------------------------------------------------
 // setTimeFactor()
 //-----------------------------------------------------------------------------
@@ -572,6 +692,14 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 			continue;
 		}
 
+		if (mLOD == LOD_CORE && mHasRunOnce && !animatesCoreJoints(motionp))
+		{
+			// none of its joints are animated at this distance
+			updateIdleMotion(motionp);
+			mMotionsSkipped++;
+			continue;
+		}
+
 		BOOL update_motion = FALSE;
 
 		if (motionp->getPose()->getWeight() < 1.f)
@@ -759,6 +887,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 
 		// even if onupdate returns FALSE, add this motion in to the blend one last time
 		mPoseBlender.addMotion(motionp);
+		mMotionsEvaluated++;
 	}
 }
 
@@ -813,9 +942,22 @@ void LLMotionController::updateLoadingMotions()
 // updateMotion()
 //-----------------------------------------------------------------------------
 void LLMotionController::updateMotions(bool force_update)
+{
+	beginUpdateMotions(force_update);
+	evaluateMotions();
+}
+
+//-----------------------------------------------------------------------------
+// beginUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::beginUpdateMotions(bool force_update)
 {
 	BOOL use_quantum = (mTimeStep != 0.f);
 
+	mEvaluatePending = FALSE;
+	mMotionsEvaluated = 0;
+	mMotionsSkipped = 0;
+
 	// Always update mPrevTimerElapsed
 	F32 cur_time = mTimer.getElapsedTimeF32();
 	F32 delta_time = cur_time - mPrevTimerElapsed;
@@ -828,7 +970,9 @@ void LLMotionController::updateMotions(bool force_update)
 	// Update timing info for this time step.
 	if (!mPaused)
 	{
-		F32 update_time = mAnimTime + delta_time * mTimeFactor;
+		// stepped from the elapsed time, mAnimTime is already a step ahead
+		F32 update_time = mUnsteppedAnimTime + delta_time * mTimeFactor;
+		mUnsteppedAnimTime = update_time;
 		if (use_quantum)
 		{
 			F32 time_interval = fmodf(update_time, mTimeStep);
@@ -845,6 +989,9 @@ void LLMotionController::updateMotions(bool force_update)
 					mLastInterp = interp;
 				}
 
+				mMotionsSkipped = (S32)mActiveMotions.size();
+				sFrameMotionsSkipped += mMotionsSkipped;
+
 				updateLoadingMotions();
 				
 				return;
@@ -860,15 +1007,33 @@ void LLMotionController::updateMotions(bool force_update)
 		}
 		else
 		{
-			mAnimTime = update_time;
+			// no going back when the time step is turned off
+			mAnimTime = llmax(mAnimTime, update_time);
 		}
 	}
 
 	updateLoadingMotions();
-	
+
+	mEvaluatePending = TRUE;
+	mForceEvaluate = force_update;
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::evaluateMotions()
+{
+	if (!mEvaluatePending)
+	{
+		return;
+	}
+	mEvaluatePending = FALSE;
+
+	BOOL use_quantum = (mTimeStep != 0.f);
+
 	resetJointSignatures();
 
-	if (mPaused && !force_update)
+	if (mPaused && !mForceEvaluate)
 	{
 		updateIdleActiveMotions();
 	}
@@ -892,6 +1057,9 @@ void LLMotionController::updateMotions(bool force_update)
 		}
 	}
 
+	sFrameMotionsEvaluated += mMotionsEvaluated;
+	sFrameMotionsSkipped += mMotionsSkipped;
+
 	mHasRunOnce = TRUE;
 //	LL_INFOS() << "Motion controller time " << motionTimer.getElapsedTimeF32() << LL_ENDL;
 }
@@ -39,6 +39,7 @@
 #include "llframetimer.h"
 #include "llstatemachine.h"
 #include "llstring.h"
+#include "llapr.h"
 
 //-----------------------------------------------------------------------------
 // Class predeclaration
@@ -132,6 +133,15 @@ public:
 	// deactivates terminated motions`
 	void updateMotions(bool force_update = false);
 
+	// updateMotions() in two steps.  beginUpdateMotions() advances the
+	// animation time and loads and purges motions, which must happen on
+	// the main thread.  evaluateMotions() then runs the active motions and
+	// blends the pose; it only touches this controller, its motions and
+	// the character's joints, so the motions of different characters can
+	// be evaluated concurrently.
+	void beginUpdateMotions(bool force_update = false);
+	void evaluateMotions();
+
 	// minimal update (e.g. while hidden)
 	void updateMotionsMinimal();
 
@@ -151,6 +161,47 @@ public:
 
 	void setTimeStep(F32 step);
 
+	// Animation level of detail.  Characters small on screen evaluate their
+	// motions less often, interpolating the pose in between, and far away
+	// only animate the joints of the base skeleton.
+	enum ELOD
+	{
+		LOD_FULL,		// every joint, every frame
+		LOD_REDUCED,	// every joint, REDUCED_LOD_TIME_STEP apart
+		LOD_CORE,		// base skeleton joints only, CORE_LOD_TIME_STEP apart
+		NUM_LODS
+	};
+	static const F32 REDUCED_LOD_TIME_STEP;
+	static const F32 CORE_LOD_TIME_STEP;
+
+	// Picks the LOD for the character's pixel area, with some hysteresis
+	void updateLOD(F32 pixel_area);
+	void setLOD(ELOD lod);
+	ELOD getLOD() const { return mLOD; }
+	// The time step to evaluate motions at for the LOD, 0 for every frame.
+	// The character passes it, or a longer one, to setTimeStep().
+	F32 getLODTimeStep() const;
+	// Whether motions animate the joint at the current LOD
+	bool isJointInLOD(const LLJoint* joint) const
+	{
+		if (mLOD != LOD_CORE || !joint)
+		{
+			return true;
+		}
+		S32 joint_num = joint->getJointNum();
+		return joint_num < 0 || joint_num >= (S32)LL_CHARACTER_MAX_ANIMATED_JOINTS
+			|| mCoreJointMask[joint_num];
+	}
+
+	// Motions run, and motions left idle by the LOD or between time steps,
+	// in the last update
+	S32 getMotionsEvaluated() const { return mMotionsEvaluated; }
+	S32 getMotionsSkipped() const { return mMotionsSkipped; }
+	// Totals over all controllers since the last resetFrameStats()
+	static S32 getFrameMotionsEvaluated() { return sFrameMotionsEvaluated.CurrentValue(); }
+	static S32 getFrameMotionsSkipped() { return sFrameMotionsSkipped.CurrentValue(); }
+	static void resetFrameStats();
+
 	void setTimeFactor(F32 time_factor);
 	F32 getTimeFactor() const { return mTimeFactor; }
 
@@ -185,6 +236,8 @@ protected:
 	void updateMotionsByType(LLMotion::LLMotionBlendType motion_type);
 	void updateIdleMotion(LLMotion* motionp);
 	void updateIdleActiveMotions();
+	void updateCoreJointMask();
+	bool animatesCoreJoints(LLMotion* motionp) const;
 	void purgeExcessMotions();
 	void deactivateStoppedMotions();
 
@@ -215,8 +268,11 @@ protected:
 	LLFrameTimer		mTimer;
 	F32					mPrevTimerElapsed;
 	F32					mAnimTime;
+	F32					mUnsteppedAnimTime;	// mAnimTime before rounding up to mTimeStep
 	F32					mLastTime;
 	BOOL				mHasRunOnce;
+	BOOL				mEvaluatePending;	// beginUpdateMotions() left a new pose to evaluate
+	BOOL				mForceEvaluate;
 	BOOL				mPaused;
 	F32					mPauseTime;
 	F32					mTimeStep;
@@ -224,6 +280,14 @@ protected:
 	F32					mLastInterp;
 
 	U8					mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
+
+	ELOD				mLOD;
+	U8					mCoreJointMask[LL_CHARACTER_MAX_ANIMATED_JOINTS];	// 0xff for base skeleton joints
+	U32					mCoreJointMaskSerial;	// skeleton serial number the mask was built for
+	S32					mMotionsEvaluated;
+	S32					mMotionsSkipped;
+	static LLAtomicS32	sFrameMotionsEvaluated;
+	static LLAtomicS32	sFrameMotionsSkipped;
 private:
 	U32					mLastCountAfterPurge; //for logging and debugging purposes
 };
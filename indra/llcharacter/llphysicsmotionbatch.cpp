@@ -0,0 +1,283 @@
+/**
+ * @file llphysicsmotionbatch.cpp
+ * @brief Avatar physics of many motions integrated together, four at a time
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llphysicsmotionbatch.h"
+
+#include "llmath.h"	// LLQuad
+#include "llmemory.h"
+
+const F32 LLPhysicsMotionBatch::TIME_ITERATION_STEP = 0.1f;
+
+// the joint velocity is measured over this many times the time delta
+static const F32 JOINT_TIME_SCALE = 30.f;
+// how much of the last acceleration is kept, 1 / smoothing of the new one
+static const F32 ACCELERATION_SMOOTHING = 3.f;
+static const F32 MAX_VELOCITY = 100.f;
+
+static LL_FORCE_INLINE LLQuad select(const LLQuad& mask, const LLQuad& a, const LLQuad& b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static LL_FORCE_INLINE LLQuad clamp01(const LLQuad& v)
+{
+	return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.f));
+}
+
+// Steps four lanes.  The same math as the scalar LLPhysicsMotion::onUpdate()
+// had, with the forces that do not change over the frame summed once and
+// the lanes that are done masked off until the longest time delta is used up.
+//static
+void LLPhysicsMotionBatch::integrateLanes(F32* const* f, U32* flags, U32 i)
+{
+	const LLQuad zero = _mm_setzero_ps();
+	const LLQuad one = _mm_set1_ps(1.f);
+	const LLQuad abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const LLQuad step_max = _mm_set1_ps(TIME_ITERATION_STEP);
+
+	const LLQuad time_delta = _mm_load_ps(f[TIME_DELTA] + i);
+	const LLQuad user = _mm_load_ps(f[POSITION_USER] + i);
+	const LLQuad joint_motion = _mm_load_ps(f[JOINT_MOTION] + i);
+	const LLQuad up = _mm_load_ps(f[UP] + i);
+	const LLQuad mass = _mm_load_ps(f[MASS] + i);
+	const LLQuad gravity = _mm_load_ps(f[GRAVITY] + i);
+	const LLQuad spring = _mm_load_ps(f[SPRING] + i);
+	const LLQuad gain = _mm_load_ps(f[GAIN] + i);
+	const LLQuad damping = _mm_load_ps(f[DAMPING] + i);
+	const LLQuad drag = _mm_load_ps(f[DRAG] + i);
+	const LLQuad max_effect = _mm_load_ps(f[MAX_EFFECT] + i);
+	const LLQuad min_delta = _mm_load_ps(f[MIN_DELTA] + i);
+	LLQuad position = _mm_load_ps(f[POSITION] + i);
+	LLQuad velocity = _mm_load_ps(f[VELOCITY] + i);
+	LLQuad velocity_joint_last = _mm_load_ps(f[VELOCITY_JOINT] + i);
+	LLQuad acceleration_joint_last = _mm_load_ps(f[ACCELERATION_JOINT] + i);
+	LLQuad position_last_update = _mm_load_ps(f[POSITION_LAST_UPDATE] + i);
+	LLQuad value = _mm_load_ps(f[VALUE] + i);
+
+	// velocity and smoothed acceleration of the joint in parameter space
+	const LLQuad joint_time = _mm_mul_ps(time_delta, _mm_set1_ps(JOINT_TIME_SCALE));
+	const LLQuad velocity_joint = _mm_div_ps(joint_motion, joint_time);
+	const LLQuad acceleration_joint =
+		_mm_add_ps(_mm_mul_ps(_mm_div_ps(_mm_sub_ps(velocity_joint, velocity_joint_last), joint_time),
+							  _mm_set1_ps(1.f / ACCELERATION_SMOOTHING)),
+				   _mm_mul_ps(acceleration_joint_last, _mm_set1_ps((ACCELERATION_SMOOTHING - 1.f) / ACCELERATION_SMOOTHING)));
+
+	// F = ma from the torso, F = mg, and drag F = .5kv^2 against the joint velocity
+	const LLQuad force_accel = _mm_mul_ps(gain, _mm_mul_ps(acceleration_joint, mass));
+	const LLQuad force_gravity = _mm_mul_ps(_mm_mul_ps(up, gravity), mass);
+	const LLQuad force_drag = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), drag), velocity_joint),
+										 _mm_and_ps(velocity_joint, abs_mask));
+	const LLQuad force_frame = _mm_add_ps(_mm_add_ps(force_accel, force_gravity), force_drag);
+
+	const LLQuad no_effect = _mm_cmpeq_ps(max_effect, zero);
+
+	LLQuad stepped = zero;
+	LLQuad update = zero;
+	LLQuad stopped = zero;
+	LLQuad time_iteration = zero;
+	LLQuad active = _mm_cmple_ps(time_iteration, time_delta);
+	while (_mm_movemask_ps(active))
+	{
+		LLQuad next = _mm_add_ps(time_iteration, step_max);
+		LLQuad step = select(_mm_cmpgt_ps(next, time_delta), _mm_sub_ps(time_delta, time_iteration), step_max);
+
+		// with the effect turned off, stop once back at the user's position
+		LLQuad current = clamp01(position);
+		LLQuad stop = _mm_and_ps(active, _mm_and_ps(no_effect, _mm_cmpeq_ps(current, user)));
+		stopped = _mm_or_ps(stopped, stop);
+		active = _mm_andnot_ps(stop, active);
+
+		// spring F = -kx towards the user's position, damping F = -kv
+		LLQuad force = _mm_sub_ps(_mm_sub_ps(force_frame, _mm_mul_ps(_mm_sub_ps(current, user), spring)),
+								  _mm_mul_ps(damping, velocity));
+
+		LLQuad velocity_new = _mm_add_ps(velocity, _mm_mul_ps(_mm_div_ps(force, mass), step));
+		velocity_new = _mm_min_ps(_mm_max_ps(velocity_new, _mm_set1_ps(-MAX_VELOCITY)), _mm_set1_ps(MAX_VELOCITY));
+		LLQuad position_new = select(no_effect, user, _mm_add_ps(current, _mm_mul_ps(velocity_new, step)));
+
+		// no velocity pushing the param beyond its limits
+		LLQuad beyond = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(position_new, zero), _mm_cmplt_ps(velocity_new, zero)),
+								  _mm_and_ps(_mm_cmpgt_ps(position_new, one), _mm_cmpgt_ps(velocity_new, zero)));
+		velocity_new = _mm_andnot_ps(beyond, velocity_new);
+
+		// start over from rest after a NaN
+		LLQuad nan = _mm_or_ps(_mm_or_ps(_mm_cmpunord_ps(position, position), _mm_cmpunord_ps(velocity, velocity)),
+							   _mm_cmpunord_ps(position_new, position_new));
+		position_new = _mm_andnot_ps(nan, position_new);
+		velocity_new = _mm_andnot_ps(nan, velocity_new);
+
+		LLQuad clamped = clamp01(position_new);
+		LLQuad moved = _mm_and_ps(active, _mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(position_last_update, clamped), abs_mask),
+													   min_delta));
+		position_last_update = select(moved, position_new, position_last_update);
+		update = _mm_or_ps(update, moved);
+
+		position = select(active, position_new, position);
+		velocity = select(active, velocity_new, velocity);
+		value = select(active, clamped, value);
+		stepped = _mm_or_ps(stepped, active);
+
+		time_iteration = next;
+		active = _mm_and_ps(active, _mm_cmple_ps(time_iteration, time_delta));
+	}
+
+	_mm_store_ps(f[POSITION] + i, position);
+	_mm_store_ps(f[VELOCITY] + i, velocity);
+	_mm_store_ps(f[VELOCITY_JOINT] + i, select(stopped, velocity_joint_last, velocity_joint));
+	_mm_store_ps(f[ACCELERATION_JOINT] + i, select(stepped, acceleration_joint, acceleration_joint_last));
+	_mm_store_ps(f[POSITION_LAST_UPDATE] + i, position_last_update);
+	_mm_store_ps(f[VALUE] + i, value);
+
+	// padding lanes never start, leave them without FINISHED
+	LLQuad started = _mm_cmple_ps(zero, time_delta);
+	__m128i lane_flags = _mm_or_si128(_mm_or_si128(
+		_mm_and_si128(_mm_castps_si128(stepped), _mm_set1_epi32(STEPPED)),
+		_mm_and_si128(_mm_castps_si128(update), _mm_set1_epi32(UPDATE_VISUALS))),
+		_mm_and_si128(_mm_castps_si128(_mm_andnot_ps(stopped, started)), _mm_set1_epi32(FINISHED)));
+	_mm_store_si128((__m128i*)(flags + i), lane_flags);
+}
+
+LLPhysicsMotionBatch::Lane::Lane()
+:	mTimeDelta(0.f),
+	mPositionUser(0.f),
+	mJointMotion(0.f),
+	mUp(0.f),
+	mMass(1.f),
+	mGravity(0.f),
+	mSpring(0.f),
+	mGain(0.f),
+	mDamping(0.f),
+	mDrag(0.f),
+	mMaxEffect(0.f),
+	mMinDelta(F32_MAX),
+	mPosition(0.f),
+	mVelocity(0.f),
+	mVelocityJoint(0.f),
+	mAccelerationJoint(0.f),
+	mPositionLastUpdate(0.f),
+	mValue(0.f),
+	mFlags(0)
+{
+}
+
+LLPhysicsMotionBatch::LLPhysicsMotionBatch()
+:	mFlags(NULL),
+	mCapacity(0)
+{
+	for (U32 i = 0; i < NUM_FIELDS; ++i)
+	{
+		mFields[i] = NULL;
+	}
+}
+
+LLPhysicsMotionBatch::~LLPhysicsMotionBatch()
+{
+	ll_aligned_free_16(mFields[0]);
+	ll_aligned_free_16(mFlags);
+}
+
+void LLPhysicsMotionBatch::allocate(U32 count)
+{
+	if (count <= mCapacity)
+	{
+		return;
+	}
+
+	ll_aligned_free_16(mFields[0]);
+	ll_aligned_free_16(mFlags);
+
+	mCapacity = count;
+	F32* fields = (F32*) ll_aligned_malloc_16(NUM_FIELDS * count * sizeof(F32));
+	for (U32 i = 0; i < NUM_FIELDS; ++i)
+	{
+		mFields[i] = fields + i * count;
+	}
+	mFlags = (U32*) ll_aligned_malloc_16(count * sizeof(U32));
+}
+
+void LLPhysicsMotionBatch::integrate()
+{
+	const U32 count = mLanes.size();
+	if (!count)
+	{
+		return;
+	}
+	const U32 padded = (count + 3) & ~3;
+	allocate(padded);
+
+	F32* const* f = mFields;
+	for (U32 i = 0; i < count; ++i)
+	{
+		const Lane* lane = mLanes[i];
+		f[TIME_DELTA][i] = lane->mTimeDelta;
+		f[POSITION_USER][i] = lane->mPositionUser;
+		f[JOINT_MOTION][i] = lane->mJointMotion;
+		f[UP][i] = lane->mUp;
+		f[MASS][i] = lane->mMass;
+		f[GRAVITY][i] = lane->mGravity;
+		f[SPRING][i] = lane->mSpring;
+		f[GAIN][i] = lane->mGain;
+		f[DAMPING][i] = lane->mDamping;
+		f[DRAG][i] = lane->mDrag;
+		f[MAX_EFFECT][i] = lane->mMaxEffect;
+		f[MIN_DELTA][i] = lane->mMinDelta;
+		f[POSITION][i] = lane->mPosition;
+		f[VELOCITY][i] = lane->mVelocity;
+		f[VELOCITY_JOINT][i] = lane->mVelocityJoint;
+		f[ACCELERATION_JOINT][i] = lane->mAccelerationJoint;
+		f[POSITION_LAST_UPDATE][i] = lane->mPositionLastUpdate;
+		f[VALUE][i] = lane->mValue;
+	}
+	// padding lanes with a negative time delta, which never step
+	for (U32 i = count; i < padded; ++i)
+	{
+		for (U32 field = 0; field < NUM_FIELDS; ++field)
+		{
+			f[field][i] = 0.f;
+		}
+		f[TIME_DELTA][i] = -1.f;
+		f[MASS][i] = 1.f;
+	}
+
+	for (U32 i = 0; i < padded; i += 4)
+	{
+		integrateLanes(f, mFlags, i);
+	}
+
+	for (U32 i = 0; i < count; ++i)
+	{
+		Lane* lane = mLanes[i];
+		lane->mPosition = f[POSITION][i];
+		lane->mVelocity = f[VELOCITY][i];
+		lane->mVelocityJoint = f[VELOCITY_JOINT][i];
+		lane->mAccelerationJoint = f[ACCELERATION_JOINT][i];
+		lane->mPositionLastUpdate = f[POSITION_LAST_UPDATE][i];
+		lane->mValue = f[VALUE][i];
+		lane->mFlags = mFlags[i];
+	}
+}
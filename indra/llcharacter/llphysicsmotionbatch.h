@@ -0,0 +1,130 @@
+/**
+ * @file llphysicsmotionbatch.h
+ * @brief Avatar physics of many motions integrated together, four at a time
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPHYSICSMOTIONBATCH_H
+#define LL_LLPHYSICSMOTIONBATCH_H
+
+#include <vector>
+
+// The spring, mass and drag integration of the avatar physics params (breast,
+// belly and butt motion) for any number of motions at once.
+//
+// Each motion fills in a Lane with what it read from its avatar this frame
+// and keeps the lane between frames, as it carries the motion's state.
+// integrate() copies the lanes it was given into one array per field and
+// steps four lanes at a time in SSE registers, each lane over its own time
+// delta in TIME_ITERATION_STEP slices, then copies the results back.  The
+// motions then set the param values and update the visuals of the avatars
+// that need it.
+class LLPhysicsMotionBatch
+{
+public:
+	// slices of a frame integrated separately, so that all frame rates
+	// show about the same behavior
+	static const F32 TIME_ITERATION_STEP;
+
+	enum
+	{
+		STEPPED			= 1 << 0,	// at least one slice ran, set the driven params to mValue
+		UPDATE_VISUALS	= 1 << 1,	// the value moved by more than mMinDelta
+		FINISHED		= 1 << 2	// ran to the end of the time delta, otherwise the param
+									// came to rest with no effect and the frame stays open
+	};
+
+	struct Lane
+	{
+		Lane();
+
+		// read by the motion each frame
+		F32		mTimeDelta;			// seconds since the motion's last finished step
+		F32		mPositionUser;		// the param as the user set it, normalized to [0, 1]
+		F32		mJointMotion;		// how far the joint moved since, in the motion direction
+		F32		mUp;				// the motion direction's world up component
+		F32		mMass;
+		F32		mGravity;
+		F32		mSpring;
+		F32		mGain;
+		F32		mDamping;
+		F32		mDrag;
+		F32		mMaxEffect;
+		F32		mMinDelta;			// F32_MAX when the visuals should not follow
+
+		// kept between frames
+		F32		mPosition;			// of the param, normalized
+		F32		mVelocity;			// of the param
+		F32		mVelocityJoint;		// of the joint in the motion direction
+		F32		mAccelerationJoint;	// of the joint, smoothed
+		F32		mPositionLastUpdate;
+
+		// results
+		F32		mValue;				// normalized value for the driven params
+		U32		mFlags;
+	};
+
+	LLPhysicsMotionBatch();
+	~LLPhysicsMotionBatch();
+
+	// the lane has to stay put until integrate() returns
+	void addLane(Lane* lane)		{ mLanes.push_back(lane); }
+	U32 getNumLanes() const			{ return mLanes.size(); }
+	void clear()					{ mLanes.clear(); }
+
+	void integrate();
+
+private:
+	enum
+	{
+		TIME_DELTA = 0,
+		POSITION_USER,
+		JOINT_MOTION,
+		UP,
+		MASS,
+		GRAVITY,
+		SPRING,
+		GAIN,
+		DAMPING,
+		DRAG,
+		MAX_EFFECT,
+		MIN_DELTA,
+		POSITION,
+		VELOCITY,
+		VELOCITY_JOINT,
+		ACCELERATION_JOINT,
+		POSITION_LAST_UPDATE,
+		VALUE,
+		NUM_FIELDS
+	};
+
+	void allocate(U32 count);
+	static void integrateLanes(F32* const* fields, U32* flags, U32 first);
+
+	std::vector<Lane*>	mLanes;
+	F32*				mFields[NUM_FIELDS];	// one array per field, in lane order
+	U32*				mFlags;
+	U32					mCapacity;
+};
+
+#endif // LL_LLPHYSICSMOTIONBATCH_H
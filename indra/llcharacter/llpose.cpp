@@ -457,7 +457,8 @@ void LLJointStateBlender::resetCachedJoint()
 //-----------------------------------------------------------------------------
 
 LLPoseBlender::LLPoseBlender()
-	: mNextPoseSlot(0)
+	: mNextPoseSlot(0),
+	  mJointMask(NULL)
 {
 }
 
@@ -477,6 +478,15 @@ BOOL LLPoseBlender::addMotion(LLMotion* motion)
 	for(LLJointState* jsp = pose->getFirstJointState(); jsp; jsp = pose->getNextJointState())
 	{
 		LLJoint *jointp = jsp->getJoint();
+		if (mJointMask && jointp)
+		{
+			S32 joint_num = jointp->getJointNum();
+			if (joint_num >= 0 && joint_num < LL_CHARACTER_MAX_ANIMATED_JOINTS && !mJointMask[joint_num])
+			{
+				continue;
+			}
+		}
+
 		LLJointStateBlender* joint_blender;
 		if (mJointStateBlenderPool.find(jointp) == mJointStateBlenderPool.end())
 		{
@@ -111,6 +111,7 @@ protected:
 
 	S32			mNextPoseSlot;
 	LLPose		mBlendedPose;
+	const U8*	mJointMask;
 public:
 	// Constructor
 	LLPoseBlender();
@@ -132,6 +133,10 @@ public:
 	// interpolate all joints towards cached values
 	void interpolate(F32 u);
 
+	// Only blend the joints whose joint number is set in the mask, an array
+	// of LL_CHARACTER_MAX_ANIMATED_JOINTS, NULL for all of them
+	void setJointMask(const U8* mask) { mJointMask = mask; }
+
 	LLPose* getBlendedPose() { return &mBlendedPose; }
 };
 
@@ -31,6 +31,8 @@
 
 #include "llvisualparam.h"
 
+#include "llcharacter.h"
+
 //-----------------------------------------------------------------------------
 // LLVisualParamInfo()
 //-----------------------------------------------------------------------------
@@ -156,36 +158,66 @@ void LLVisualParamInfo::toStream(std::ostream &out)
 	out <<  mSex << "\t";
 }
 
+//-----------------------------------------------------------------------------
+// LLVisualParamWeights()
+//-----------------------------------------------------------------------------
+LLVisualParamWeights::LLVisualParamWeights(LLCharacter* character)
+	: mCharacter(character)
+{
+}
+
+//-----------------------------------------------------------------------------
+// addSlot()
+//-----------------------------------------------------------------------------
+U32 LLVisualParamWeights::addSlot(const LLVisualParamWeight& weight)
+{
+	mSlots.push_back(weight);
+	return mSlots.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// trim()
+//-----------------------------------------------------------------------------
+void LLVisualParamWeights::trim()
+{
+	// params keep slot indices, not pointers, so the array may move
+	std::vector<LLVisualParamWeight>(mSlots).swap(mSlots);
+}
+
+//-----------------------------------------------------------------------------
+// getMemoryUsage()
+//-----------------------------------------------------------------------------
+size_t LLVisualParamWeights::getMemoryUsage() const
+{
+	return sizeof(LLVisualParamWeights) + mSlots.capacity() * sizeof(LLVisualParamWeight);
+}
+
 //-----------------------------------------------------------------------------
 // LLVisualParam()
 //-----------------------------------------------------------------------------
 LLVisualParam::LLVisualParam()
-	: mCurWeight( 0.f ),
-	mLastWeight( 0.f ),
-	mNext( NULL ),
-	mTargetWeight( 0.f ),
-	mIsAnimating( FALSE ),
-	mIsDummy(FALSE),
-	mID( -1 ),
+	: mNext( NULL ),
 	mInfo( 0 ),
+	mID( -1 ),
+	mFlags( 0 ),
 	mParamLocation(LOC_UNKNOWN)
 {
+	mLocalWeight.mCur = 0.f;
+	mLocalWeight.mLast = 0.f;
+	mLocalWeight.mTarget = 0.f;
 }
 
 //-----------------------------------------------------------------------------
 // LLVisualParam()
 //-----------------------------------------------------------------------------
 LLVisualParam::LLVisualParam(const LLVisualParam& pOther)
-	: mCurWeight(pOther.mCurWeight),
-	mLastWeight(pOther.mLastWeight),
-	mNext(pOther.mNext),
-	mTargetWeight(pOther.mTargetWeight),
-	mIsAnimating(pOther.mIsAnimating),
-	mIsDummy(pOther.mIsDummy),
-	mID(pOther.mID),
+	: mNext(pOther.mNext),
 	mInfo(pOther.mInfo),
+	mID(pOther.mID),
+	mFlags(pOther.mFlags & ~(DIRTY | ATTACHED)),
 	mParamLocation(pOther.mParamLocation)
 {
+	mLocalWeight = pOther.getWeightSlot();
 }
 
 //-----------------------------------------------------------------------------
@@ -193,10 +225,53 @@ LLVisualParam::LLVisualParam(const LLVisualParam& pOther)
 //-----------------------------------------------------------------------------
 LLVisualParam::~LLVisualParam()
 {
+	LLCharacter* character = getCharacter();
+	if (character && isDirty())
+	{
+		character->clearVisualParamDirty(this);
+	}
 	delete mNext;
 	mNext = NULL;
 }
 
+//-----------------------------------------------------------------------------
+// setWeights()
+//-----------------------------------------------------------------------------
+void LLVisualParam::setWeights(LLVisualParamWeights* weights)
+{
+	if (hasFlag(ATTACHED) && weights == mAttached.mWeights)
+	{
+		return;
+	}
+	const LLVisualParamWeight weight = getWeightSlot();
+	LLCharacter* character = getCharacter();
+	if (character && isDirty())
+	{
+		character->clearVisualParamDirty(this);
+	}
+	setDirty(FALSE);
+	// the slot in a character's store is not reused, params stay with the
+	// character they were added to
+	mAttached.mWeights = weights;
+	mAttached.mSlot = weights->addSlot(weight);
+	mFlags |= ATTACHED;
+}
+
+//-----------------------------------------------------------------------------
+// setFlag()
+//-----------------------------------------------------------------------------
+void LLVisualParam::setFlag(U32 flag, BOOL set)
+{
+	if (set)
+	{
+		mFlags |= flag;
+	}
+	else
+	{
+		mFlags &= ~flag;
+	}
+}
+
 /*
 //=============================================================================
 // These virtual functions should always be overridden,
@@ -238,18 +313,24 @@ BOOL LLVisualParam::parseData(LLXmlTreeNode *node)
 //-----------------------------------------------------------------------------
 void LLVisualParam::setWeight(F32 weight)
 {
-	if (mIsAnimating)
+	LLVisualParamWeight& slot = getWeightSlot();
+	F32 old_weight = slot.mCur;
+	if (mFlags & ANIMATING)
 	{
 		//RN: allow overshoot
-		mCurWeight = weight;
+		slot.mCur = weight;
 	}
 	else if (mInfo)
 	{
-		mCurWeight = llclamp(weight, mInfo->mMinWeight, mInfo->mMaxWeight);
+		slot.mCur = llclamp(weight, mInfo->mMinWeight, mInfo->mMaxWeight);
 	}
 	else
 	{
-		mCurWeight = weight;
+		slot.mCur = weight;
+	}
+	if (slot.mCur != old_weight)
+	{
+		markDirty();
 	}
 	
 	if (mNext)
@@ -264,25 +345,26 @@ void LLVisualParam::setWeight(F32 weight)
 void LLVisualParam::setAnimationTarget(F32 target_value)
 {
 	// don't animate dummy parameters
-	if (mIsDummy)
+	if (hasFlag(DUMMY))
 	{
 		setWeight(target_value);
-		mTargetWeight = mCurWeight;
+		getWeightSlot().mTarget = getWeightSlot().mCur;
 		return;
 	}
 
+	LLVisualParamWeight& slot = getWeightSlot();
 	if (mInfo)
 	{
 		if (isTweakable())
 		{
-			mTargetWeight = llclamp(target_value, mInfo->mMinWeight, mInfo->mMaxWeight);
+			slot.mTarget = llclamp(target_value, mInfo->mMinWeight, mInfo->mMaxWeight);
 		}
 	}
 	else
 	{
-		mTargetWeight = target_value;
+		slot.mTarget = target_value;
 	}
-	mIsAnimating = TRUE;
+	mFlags |= ANIMATING;
 
 	if (mNext)
 	{
@@ -290,6 +372,18 @@ void LLVisualParam::setAnimationTarget(F32 target_value)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// markDirty()
+//-----------------------------------------------------------------------------
+void LLVisualParam::markDirty()
+{
+	LLCharacter* character = getCharacter();
+	if (character && !isDirty())
+	{
+		character->markVisualParamDirty(this);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // setNextParam()
 //-----------------------------------------------------------------------------
@@ -313,9 +407,10 @@ void LLVisualParam::clearNextParam()
 //-----------------------------------------------------------------------------
 void LLVisualParam::animate( F32 delta)
 {
-	if (mIsAnimating)
+	const LLVisualParamWeight& slot = getWeightSlot();
+	if (mFlags & ANIMATING)
 	{
-		F32 new_weight = ((mTargetWeight - mCurWeight) * delta) + mCurWeight;
+		F32 new_weight = ((slot.mTarget - slot.mCur) * delta) + slot.mCur;
 		setWeight(new_weight);
 	}
 }
@@ -325,10 +420,10 @@ void LLVisualParam::animate( F32 delta)
 //-----------------------------------------------------------------------------
 void LLVisualParam::stopAnimating()
 { 
-	if (mIsAnimating && isTweakable())
+	if (isAnimating() && isTweakable())
 	{
-		mIsAnimating = FALSE; 
-		setWeight(mTargetWeight);
+		setFlag(ANIMATING, FALSE);
+		setWeight(getWeightSlot().mTarget);
 	}
 }
 
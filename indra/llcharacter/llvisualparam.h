@@ -31,7 +31,9 @@
 #include "llstring.h"
 #include "llxmltree.h"
 #include <boost/function.hpp>
+#include <vector>
 
+class LLCharacter;
 class LLPolyMesh;
 class LLXmlTreeNode;
 
@@ -94,6 +96,41 @@ protected:
 	ESex				mSex;				// Which gender(s) this param applies to.
 };
 
+//-----------------------------------------------------------------------------
+// LLVisualParamWeights
+// The weights of a character's visual params, one slot per param in the order
+// they were added, so that an avatar's weights sit in one array instead of
+// being spread over hundreds of param objects.  A param that was not added to
+// a character yet keeps its weights in the param itself.
+//-----------------------------------------------------------------------------
+struct LLVisualParamWeight
+{
+	F32					mCur;				// current weight
+	F32					mLast;				// last weight applied
+	F32					mTarget;			// interpolation target
+};
+
+class LLVisualParamWeights
+{
+public:
+	LLVisualParamWeights(LLCharacter* character = NULL);
+
+	LLCharacter*			getCharacter() const { return mCharacter; }
+
+	U32						addSlot(const LLVisualParamWeight& weight);
+	LLVisualParamWeight&	getSlot(U32 slot) { return mSlots[slot]; }
+	const LLVisualParamWeight& getSlot(U32 slot) const { return mSlots[slot]; }
+	U32						getNumSlots() const { return mSlots.size(); }
+	// gives back the spare capacity once the character has all its params
+	void					trim();
+
+	size_t					getMemoryUsage() const;
+
+private:
+	LLCharacter*						mCharacter;
+	std::vector<LLVisualParamWeight>	mSlots;
+};
+
 //-----------------------------------------------------------------------------
 // LLVisualParam
 // VIRTUAL CLASS
@@ -147,39 +184,74 @@ public:
 	F32						getDefaultWeight() const 	{ return mInfo->mDefaultWeight; }
 	ESex					getSex() const			{ return mInfo->mSex; }
 
-	F32						getWeight() const		{ return mIsAnimating ? mTargetWeight : mCurWeight; }
-	F32						getCurrentWeight() const 	{ return mCurWeight; }
-	F32						getLastWeight() const	{ return mLastWeight; }
-	void					setLastWeight(F32 val) { mLastWeight = val; }
-	BOOL					isAnimating() const	{ return mIsAnimating; }
+	F32						getWeight() const
+	{
+		const LLVisualParamWeight& weight = getWeightSlot();
+		return (mFlags & ANIMATING) ? weight.mTarget : weight.mCur;
+	}
+	F32						getCurrentWeight() const 	{ return getWeightSlot().mCur; }
+	F32						getLastWeight() const	{ return getWeightSlot().mLast; }
+	void					setLastWeight(F32 val) { getWeightSlot().mLast = val; }
+	BOOL					isAnimating() const	{ return hasFlag(ANIMATING); }
 	BOOL					isTweakable() const { return (getGroup() == VISUAL_PARAM_GROUP_TWEAKABLE)  || (getGroup() == VISUAL_PARAM_GROUP_TWEAKABLE_NO_TRANSMIT); }
 
 	LLVisualParam*			getNextParam()		{ return mNext; }
 	void					setNextParam( LLVisualParam *next );
 	void					clearNextParam();
 	
-	virtual void			setAnimating(BOOL is_animating) { mIsAnimating = is_animating && !mIsDummy; }
-	BOOL					getAnimating() const { return mIsAnimating; }
+	virtual void			setAnimating(BOOL is_animating) { setFlag(ANIMATING, is_animating && !hasFlag(DUMMY)); }
+	BOOL					getAnimating() const { return isAnimating(); }
 
-	void					setIsDummy(BOOL is_dummy) { mIsDummy = is_dummy; }
+	void					setIsDummy(BOOL is_dummy) { setFlag(DUMMY, is_dummy); }
 
 	void					setParamLocation(EParamLocation loc);
-	EParamLocation			getParamLocation() const { return mParamLocation; }
+	EParamLocation			getParamLocation() const { return (EParamLocation)mParamLocation; }
+
+	// The character the param was added to, told when the weight changes so
+	// that LLCharacter::updateVisualParams() only applies the changed params
+	LLCharacter*			getCharacter() const { return hasFlag(ATTACHED) ? mAttached.mWeights->getCharacter() : NULL; }
+	BOOL					isDirty() const { return hasFlag(DIRTY); }
+	void					setDirty(BOOL dirty) { setFlag(DIRTY, dirty); }
+
+	// Moves the weights into a slot of the store, LLCharacter::addVisualParam()
+	// gives each param a slot in the character's store
+	void					setWeights(LLVisualParamWeights* weights);
 
 protected:
+	enum
+	{
+		ANIMATING	= 1 << 0,	// the param has been given an interpolation target
+		DUMMY		= 1 << 1,	// dummy params never animate
+		DIRTY		= 1 << 2,	// weight changed since the character last applied it
+		ATTACHED	= 1 << 3	// the weights are in mWeights, not mLocalWeight
+	};
+
 	LLVisualParam(const LLVisualParam& pOther);
 
-	F32					mCurWeight;			// current weight
-	F32					mLastWeight;		// last weight
-	LLVisualParam*		mNext;				// next param in a shared chain
-	F32					mTargetWeight;		// interpolation target
-	BOOL				mIsAnimating;	// this value has been given an interpolation target
-	BOOL				mIsDummy;  // this is used to prevent dummy visual params from animating
+	// queues the param on its character for the next updateVisualParams()
+	void					markDirty();
 
+	LLVisualParamWeight&	getWeightSlot() { return (mFlags & ATTACHED) ? mAttached.mWeights->getSlot(mAttached.mSlot) : mLocalWeight; }
+	const LLVisualParamWeight& getWeightSlot() const { return (mFlags & ATTACHED) ? mAttached.mWeights->getSlot(mAttached.mSlot) : mLocalWeight; }
+	BOOL					hasFlag(U32 flag) const { return (mFlags & flag) != 0; }
+	void					setFlag(U32 flag, BOOL set);
 
-	S32					mID;				// id for storing weight/morphtarget compares compactly
+	LLVisualParam*		mNext;				// next param in a shared chain
 	LLVisualParamInfo	*mInfo;
-	EParamLocation		mParamLocation;		// where does this visual param live?
+	// The weights are in the character's array once the param is added to
+	// one, the param only keeps where
+	union
+	{
+		LLVisualParamWeight	mLocalWeight;	// until ATTACHED
+		struct
+		{
+			LLVisualParamWeights* mWeights;	// the character's weights
+			U32				mSlot;			// of the weights in mWeights
+		}					mAttached;		// once ATTACHED
+	};
+	S32					mID;				// id for storing weight/morphtarget compares compactly
+	U16					mFlags;
+	U16					mParamLocation;		// EParamLocation, where does this visual param live?
 } LL_ALIGN_POSTFIX(16);
 
 #endif // LL_LLVisualParam_H
@@ -0,0 +1,305 @@
+/**
+ * @file llbvhloader_test.cpp
+ * @brief Tests and benchmark of the BVH import of LLBVHLoader
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "../llbvhloader.h"
+#include "llformat.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// The thresholds optimize() keeps every frame within
+	const F32 POSITION_KEYFRAME_THRESHOLD = 0.06f;
+	const F32 ROTATION_KEYFRAME_THRESHOLD = 0.02f;
+
+	ELoadStatus sConstructStatus;
+	S32 sConstructLine;
+	std::map<std::string, std::string> sNoAliases;
+
+	// Loads BVH text with the joint names of the avatar skeleton, without
+	// the translation table the viewer reads from its settings
+	class TestLoader : public LLBVHLoader
+	{
+	public:
+		TestLoader()
+		:	LLBVHLoader("", sConstructStatus, sConstructLine, sNoAliases)
+		{
+			makeTranslation("hip", "mPelvis");
+			makeTranslation("abdomen", "mTorso");
+			makeTranslation("chest", "mChest");
+			makeTranslation("lShldr", "mShoulderLeft");
+			makeTranslation("lForeArm", "mElbowLeft");
+		}
+
+		ELoadStatus load(const std::string& text)
+		{
+			char error_text[128];		/* Flawfinder: ignore */
+			S32 error_line;
+			ELoadStatus status = loadBVHFile(text.c_str(), error_text, error_line);
+			if (status == E_ST_OK)
+			{
+				applyTranslations();
+				optimize();
+			}
+			return status;
+		}
+
+		Joint* getJoint(U32 i) { return mJoints[i]; }
+		U32 getJointCount() { return mJoints.size(); }
+	};
+
+	// A chain of joints, the hip with positions, turning and moving by
+	// sines of their frame plus a little noise, as captured motion does
+	std::string make_bvh(S32 frames, const char** names, S32 num_joints, U32 seed = 1)
+	{
+		std::ostringstream bvh;
+		bvh << "HIERARCHY\n";
+		for (S32 j = 0; j < num_joints; ++j)
+		{
+			bvh << (j ? "JOINT " : "ROOT ") << names[j] << "\n{\n"
+				<< "OFFSET 0.00 " << (j ? 5.0 : 0.0) << " 0.00\n"
+				<< (j ? "CHANNELS 3 Zrotation Xrotation Yrotation\n"
+					  : "CHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n");
+		}
+		bvh << "End Site\n{\nOFFSET 0.00 5.00 0.00\n}\n";
+		for (S32 j = 0; j < num_joints; ++j)
+		{
+			bvh << "}\n";
+		}
+
+		bvh << "MOTION\nFrames: " << frames << "\nFrame Time: 0.033333\n";
+		for (S32 f = 0; f < frames; ++f)
+		{
+			F32 t = (F32)f / 30.f;
+			for (S32 j = 0; j < num_joints; ++j)
+			{
+				if (!j)
+				{
+					bvh << llformat("%.4f %.4f %.4f ", 10.f * sinf(t), 40.f + 2.f * sinf(3.f * t), 5.f * t);
+				}
+				seed = seed * 1664525 + 1013904223;
+				F32 noise = (F32)(seed >> 8) / (F32)(1 << 24) * 0.1f;
+				bvh << llformat("%.4f %.4f %.4f ", 30.f * sinf(t * (1.f + j)) + noise, 20.f * cosf(2.f * t), 5.f * j * t);
+			}
+			bvh << "\n";
+		}
+		return bvh.str();
+	}
+
+	LLQuaternion key_rotation(Joint* joint, const Key& key)
+	{
+		char order[4] = { joint->mOrder[2], joint->mOrder[1], joint->mOrder[0], 0 };		/* Flawfinder: ignore */
+		return mayaQ(key.mRot[0], key.mRot[1], key.mRot[2], StringToOrder(order));
+	}
+
+	F32 rotation_error(const LLQuaternion& a, const LLQuaternion& b)
+	{
+		return dist_vec(LLVector3::x_axis * a, LLVector3::x_axis * b)
+			+ dist_vec(LLVector3::y_axis * a, LLVector3::y_axis * b);
+	}
+}
+
+namespace tut
+{
+	struct bvhloader_data
+	{
+	};
+	typedef test_group<bvhloader_data> bvhloader_group;
+	typedef bvhloader_group::object bvhloader_object;
+	bvhloader_group bvhloader_test("LLBVHLoader");
+
+	template<> template<>
+	void bvhloader_object::test<1>()
+	{
+		set_test_name("frames are parsed into the keys of their joints");
+
+		TestLoader loader;
+		ensure_equals("load", loader.load(
+			"HIERARCHY\r\n"
+			"ROOT hip\r\n{\r\n\tOFFSET 0 0 0\r\n"
+			"\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\r\n"
+			"\tJOINT abdomen\r\n\t{\r\n\t\tOFFSET 0 5 0\r\n"
+			"\t\tCHANNELS 3 Xrotation Zrotation Yrotation\r\n"
+			"\t\tEnd Site\r\n\t\t{\r\n\t\t\tOFFSET 0 5 0\r\n\t\t}\r\n"
+			"\t}\r\n}\r\n\r\n"
+			"MOTION\r\nFrames: 2\r\nFrame Time: 0.5\r\n"
+			"1.5 -2.25 3 10 20 30\t 40 50 60\r\n"
+			"  0.5\t0.25 -0.125 1e1 2.5e1 -30 -40 -50 -60  \r\n"), E_ST_OK);
+
+		ensure_equals("joints", loader.getJointCount(), 2U);
+		Joint* hip = loader.getJoint(0);
+		Joint* abdomen = loader.getJoint(1);
+		ensure_equals("hip keys", hip->mKeys.size(), (size_t)2);
+		ensure_equals("hip x", hip->mKeys[0].mPos[0], 1.5f);
+		ensure_equals("hip y", hip->mKeys[0].mPos[1], -2.25f);
+		ensure_equals("hip z", hip->mKeys[1].mPos[2], -0.125f);
+		// Zrotation Xrotation Yrotation
+		ensure_equals("hip rot x", hip->mKeys[0].mRot[0], 20.f);
+		ensure_equals("hip rot z", hip->mKeys[1].mRot[2], 10.f);
+		// Xrotation Zrotation Yrotation
+		ensure_equals("abdomen rot x", abdomen->mKeys[0].mRot[0], 40.f);
+		ensure_equals("abdomen rot z", abdomen->mKeys[0].mRot[2], 50.f);
+		ensure_equals("abdomen rot y", abdomen->mKeys[1].mRot[1], -60.f);
+		ensure_equals("duration", loader.getDuration(), 1.f);
+
+		std::string header("HIERARCHY\nROOT hip\n{\nOFFSET 0 0 0\nCHANNELS 3 Zrotation Xrotation Yrotation\n"
+						   "End Site\n{\nOFFSET 0 5 0\n}\n}\nMOTION\nFrames: 1\nFrame Time: 0.1\n");
+		TestLoader bad_loader;
+		ensure_equals("not a number", bad_loader.load(header + "1 2x 3\n"), E_ST_NO_POS);
+		ensure_equals("too few", bad_loader.load(header + "1 2\n"), E_ST_NO_POS);
+		ensure_equals("no frame", bad_loader.load(header), E_ST_EOF);
+		ensure_equals("ends in an end site", bad_loader.load("HIERARCHY\nROOT hip\n{\nOFFSET 0 0 0\n"
+			"CHANNELS 3 Zrotation Xrotation Yrotation\nEnd Site\n{\n"), E_ST_EOF);
+	}
+
+	template<> template<>
+	void bvhloader_object::test<2>()
+	{
+		set_test_name("optimized keys interpolate every frame within the thresholds");
+
+		const char* names[] = { "hip", "abdomen", "chest", "lShldr", "lForeArm" };
+		const S32 FRAMES = 300;
+		TestLoader loader;
+		ensure_equals("load", loader.load(make_bvh(FRAMES, names, 5)), E_ST_OK);
+
+		for (U32 j = 0; j < loader.getJointCount(); ++j)
+		{
+			Joint* joint = loader.getJoint(j);
+			ensure(joint->mName + " moves", !joint->mIgnore);
+			ensure(joint->mName + " first frame", joint->mKeys[0].mIgnoreRot && joint->mKeys[0].mIgnorePos);
+			ensure(joint->mName + " last frame", !joint->mKeys[FRAMES - 1].mIgnoreRot && !joint->mKeys[FRAMES - 1].mIgnorePos);
+			ensure(joint->mName + " reduced", joint->mNumRotKeys > 1 && joint->mNumRotKeys < FRAMES / 2);
+
+			F32 rot_threshold = ROTATION_KEYFRAME_THRESHOLD / llmax((F32)joint->mChildTreeMaxDepth * 0.33f, 1.f);
+			S32 rot_keys = 0, pos_keys = 0;
+			S32 prev_rot = 1, prev_pos = 1;
+			for (S32 f = 1; f < FRAMES; ++f)
+			{
+				if (joint->mKeys[f].mIgnoreRot)
+				{
+					continue;
+				}
+				rot_keys++;
+				for (S32 i = prev_rot + 1; i < f; ++i)
+				{
+					LLQuaternion interp = nlerp((F32)(i - prev_rot) / (F32)(f - prev_rot),
+												key_rotation(joint, joint->mKeys[prev_rot]), key_rotation(joint, joint->mKeys[f]));
+					ensure(llformat("%s rotation of frame %d", joint->mName.c_str(), i),
+						   rotation_error(interp, key_rotation(joint, joint->mKeys[i])) < rot_threshold);
+				}
+				prev_rot = f;
+			}
+			for (S32 f = 1; f < FRAMES; ++f)
+			{
+				if (joint->mKeys[f].mIgnorePos)
+				{
+					continue;
+				}
+				pos_keys++;
+				LLVector3 a(joint->mKeys[prev_pos].mPos);
+				LLVector3 b(joint->mKeys[f].mPos);
+				for (S32 i = prev_pos + 1; i < f; ++i)
+				{
+					LLVector3 interp = lerp(a, b, (F32)(i - prev_pos) / (F32)(f - prev_pos));
+					ensure(llformat("%s position of frame %d", joint->mName.c_str(), i),
+						   dist_vec(interp, LLVector3(joint->mKeys[i].mPos)) < POSITION_KEYFRAME_THRESHOLD);
+				}
+				prev_pos = f;
+			}
+			ensure_equals(joint->mName + " rotation keys", joint->mNumRotKeys, rot_keys);
+			ensure_equals(joint->mName + " position keys", joint->mNumPosKeys, pos_keys);
+		}
+	}
+
+	template<> template<>
+	void bvhloader_object::test<3>()
+	{
+		set_test_name("a joint that doesn't move is left out");
+
+		const char* names[] = { "hip" };
+		std::ostringstream bvh;
+		bvh << "HIERARCHY\nROOT hip\n{\nOFFSET 0 0 0\n"
+			<< "CHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n"
+			<< "End Site\n{\nOFFSET 0 5 0\n}\n}\nMOTION\nFrames: 50\nFrame Time: 0.1\n";
+		for (S32 f = 0; f < 50; ++f)
+		{
+			bvh << "1 40 2 10 20 30\n";
+		}
+		TestLoader still;
+		ensure_equals("still", still.load(bvh.str()), E_ST_OK);
+		ensure("still ignored", still.getJoint(0)->mIgnore);
+
+		// a single frame is kept, as a pose
+		TestLoader pose;
+		ensure_equals("pose", pose.load(make_bvh(1, names, 1)), E_ST_OK);
+		ensure("pose kept", !pose.getJoint(0)->mIgnore);
+		ensure_equals("pose keys", pose.getJoint(0)->mNumRotKeys, 1);
+	}
+
+	template<> template<>
+	void bvhloader_object::test<4>()
+	{
+		set_test_name("benchmark importing a long animation");
+
+		const char* names[] = { "hip", "abdomen", "chest", "lShldr", "lForeArm" };
+		const S32 FRAMES = 6000;
+		std::string text = make_bvh(FRAMES, names, 5);
+
+		LLTimer timer;
+		TestLoader loader;
+		char error_text[128];		/* Flawfinder: ignore */
+		S32 error_line;
+		ensure_equals("load", loader.loadBVHFile(text.c_str(), error_text, error_line), E_ST_OK);
+		F64 parse_secs = timer.getElapsedTimeF64();
+
+		timer.reset();
+		loader.applyTranslations();
+		loader.optimize();
+		F64 optimize_secs = timer.getElapsedTimeF64();
+
+		S32 keys = 0;
+		for (U32 j = 0; j < loader.getJointCount(); ++j)
+		{
+			keys += loader.getJoint(j)->mNumRotKeys + loader.getJoint(j)->mNumPosKeys;
+		}
+
+		if (benchmarks_enabled())
+		{
+			std::cout << "\nImporting " << FRAMES << " frames of " << loader.getJointCount() << " joints, "
+					  << text.size() / 1024 << " KB\n"
+					  << llformat("  parse:    %.1f ms\n", parse_secs * 1000.0)
+					  << llformat("  optimize: %.1f ms, %d of %d keys kept, %d bytes\n", optimize_secs * 1000.0,
+								  keys, FRAMES * 2 * loader.getJointCount(), loader.getOutputSize())
+					  << std::flush;
+		}
+	}
+}
@@ -0,0 +1,308 @@
+/**
+ * @file llcharacter_test.cpp
+ * @brief Tests of the visual param dirty tracking of LLCharacter
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../llcharacter.h"
+#include "../llvisualparam.h"
+#include "lluuid.h"
+#include "v3dmath.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	typedef std::vector<S32> id_list_t;
+
+	// the fields LLVisualParam had while it kept its own weights
+	LL_ALIGN_PREFIX(16)
+	class OldParamLayout
+	{
+	public:
+		virtual ~OldParamLayout() {}
+
+		F32				mCurWeight;
+		F32				mLastWeight;
+		void*			mNext;
+		F32				mTargetWeight;
+		BOOL			mIsAnimating;
+		BOOL			mIsDummy;
+		S32				mID;
+		void*			mInfo;
+		EParamLocation	mParamLocation;
+	} LL_ALIGN_POSTFIX(16);
+
+	class TestParamInfo : public LLVisualParamInfo
+	{
+	public:
+		TestParamInfo(S32 id, F32 default_weight, ESex sex)
+		{
+			mID = id;
+			mMinWeight = -10.f;
+			mMaxWeight = 10.f;
+			mDefaultWeight = default_weight;
+			mSex = sex;
+		}
+	};
+
+	// records the order it is applied in, as a morph would apply its deltas
+	class TestParam : public LLVisualParam
+	{
+	public:
+		TestParam(id_list_t* applied, S32 id, F32 default_weight, ESex sex = SEX_BOTH)
+		:	mInfoData(id, default_weight, sex),
+			mApplied(applied)
+		{
+			mInfo = &mInfoData;
+			mID = id;
+			getWeightSlot().mCur = default_weight;
+		}
+
+		/*virtual*/ void apply(ESex avatar_sex)
+		{
+			mApplied->push_back(mID);
+			setLastWeight((getSex() & avatar_sex) ? getCurrentWeight() : getDefaultWeight());
+		}
+
+	private:
+		TestParamInfo	mInfoData;
+		id_list_t*		mApplied;
+	};
+
+	// drives another param at twice its weight, as LLDriverParam does
+	class TestDriverParam : public TestParam
+	{
+	public:
+		TestDriverParam(id_list_t* applied, S32 id, TestParam* driven)
+		:	TestParam(applied, id, 0.f),
+			mDriven(driven)
+		{
+		}
+
+		/*virtual*/ void setWeight(F32 weight)
+		{
+			LLVisualParam::setWeight(weight);
+			mDriven->setWeight(weight * 2.f);
+		}
+
+	private:
+		TestParam*		mDriven;
+	};
+
+	class TestCharacter : public LLCharacter
+	{
+	public:
+		/*virtual*/ const char* getAnimationPrefix() { return "test"; }
+		/*virtual*/ LLJoint* getRootJoint() { return NULL; }
+		/*virtual*/ LLVector3 getCharacterPosition() { return LLVector3::zero; }
+		/*virtual*/ LLQuaternion getCharacterRotation() { return LLQuaternion::DEFAULT; }
+		/*virtual*/ LLVector3 getCharacterVelocity() { return LLVector3::zero; }
+		/*virtual*/ LLVector3 getCharacterAngularVelocity() { return LLVector3::zero; }
+		/*virtual*/ void getGround(const LLVector3& inPos, LLVector3& outPos, LLVector3& outNorm) {}
+		/*virtual*/ LLJoint* getCharacterJoint(U32 i) { return NULL; }
+		/*virtual*/ F32 getTimeDilation() { return 1.f; }
+		/*virtual*/ F32 getPixelArea() const { return 1.f; }
+		/*virtual*/ LLPolyMesh* getHeadMesh() { return NULL; }
+		/*virtual*/ LLPolyMesh* getUpperBodyMesh() { return NULL; }
+		/*virtual*/ LLVector3d getPosGlobalFromAgent(const LLVector3& position) { return LLVector3d(position); }
+		/*virtual*/ LLVector3 getPosAgentFromGlobal(const LLVector3d& position) { return LLVector3(position); }
+		/*virtual*/ void addDebugText(const std::string& text) {}
+		/*virtual*/ const LLUUID& getID() const { return LLUUID::null; }
+
+		// the ids applied by an update
+		id_list_t update()
+		{
+			mApplied.clear();
+			updateVisualParams();
+			return mApplied;
+		}
+
+		TestParam* add(S32 id, F32 default_weight, ESex sex = SEX_BOTH)
+		{
+			TestParam* param = new TestParam(&mApplied, id, default_weight, sex);
+			addVisualParam(param);
+			return param;
+		}
+
+		id_list_t	mApplied;
+	};
+
+	id_list_t ids(S32 a = -1, S32 b = -1, S32 c = -1)
+	{
+		id_list_t list;
+		if (a >= 0) list.push_back(a);
+		if (b >= 0) list.push_back(b);
+		if (c >= 0) list.push_back(c);
+		return list;
+	}
+}
+
+namespace tut
+{
+	struct character_data
+	{
+	};
+	typedef test_group<character_data> character_group;
+	typedef character_group::object character_object;
+	character_group character_test("LLCharacter");
+
+	template<> template<>
+	void character_object::test<1>()
+	{
+		set_test_name("only params whose weights changed are applied, in id order");
+
+		TestCharacter character;
+		TestParam* p1 = character.add(1, 0.5f);
+		character.add(2, 0.f);
+		TestParam* p3 = character.add(3, 0.25f);
+		TestParam* p4 = character.add(4, 1.f);
+
+		ensure("first update", character.update() == ids(1, 3, 4));
+		ensure("nothing changed", character.update().empty());
+		ensure("no dirty params", !character.hasDirtyVisualParams());
+
+		p4->setWeight(2.f);
+		p1->setWeight(0.75f);
+		p3->setWeight(0.25f);
+		ensure("changed params", character.update() == ids(1, 4));
+
+		// changed and changed back before an update
+		p3->setWeight(1.f);
+		p3->setWeight(0.25f);
+		ensure("changed back", character.update().empty());
+	}
+
+	template<> template<>
+	void character_object::test<2>()
+	{
+		set_test_name("a change of sex applies the params of either sex");
+
+		TestCharacter character;
+		character.add(1, 0.f);
+		TestParam* male = character.add(2, 0.f, SEX_MALE);
+		character.add(3, 0.f, SEX_FEMALE);
+		male->setWeight(1.f);
+		character.update();
+
+		character.setSex(SEX_MALE);
+		ensure("male", character.update() == ids(2));
+		character.setSex(SEX_FEMALE);
+		ensure("female", character.update() == ids(2));
+		ensure("nothing changed", character.update().empty());
+	}
+
+	template<> template<>
+	void character_object::test<3>()
+	{
+		set_test_name("driven and animating params");
+
+		TestCharacter character;
+		TestParam* driven = character.add(1, 0.f);
+		TestDriverParam* driver = new TestDriverParam(&character.mApplied, 5, driven);
+		character.addVisualParam(driver);
+		character.update();
+
+		driver->setWeight(1.f);
+		ensure("driver and driven", character.update() == ids(1, 5));
+		ensure_equals("driven weight", driven->getWeight(), 2.f);
+
+		// animating params are applied by the avatar as they animate
+		driven->setAnimationTarget(3.f);
+		driven->animate(0.5f);
+		ensure("animating", character.update().empty());
+		driven->stopAnimating();
+		ensure("stopped", character.update() == ids(1));
+		ensure_equals("target weight", driven->getWeight(), 3.f);
+	}
+
+	template<> template<>
+	void character_object::test<4>()
+	{
+		set_test_name("a dirty param can be deleted");
+
+		TestCharacter character;
+		TestParam* param = character.add(1, 0.f);
+		character.add(2, 0.f);
+		character.update();
+
+		TestParam* replacement = new TestParam(&character.mApplied, 1, 1.f);
+		param->setWeight(1.f);
+		character.addVisualParam(replacement);
+		delete param;
+		ensure("replacement", character.update() == ids(1));
+		ensure("applied the replacement", replacement->getLastWeight() == 1.f);
+	}
+
+	template<> template<>
+	void character_object::test<5>()
+	{
+		set_test_name("weights move into the character's array");
+
+		id_list_t applied;
+		TestParam* param = new TestParam(&applied, 1, 0.f);
+		param->setWeight(0.5f);
+		param->setAnimationTarget(2.f);
+		param->setLastWeight(0.25f);
+		TestParam* dummy = new TestParam(&applied, 2, 0.f);
+		dummy->setIsDummy(TRUE);
+		dummy->setAnimating(TRUE);
+
+		TestCharacter character;
+		for (S32 id = 10; id < 260; ++id)
+		{
+			character.add(id, id * 0.001f);
+		}
+		character.addVisualParam(param);
+		character.addVisualParam(dummy);
+		ensure("character", param->getCharacter() == &character);
+		ensure_equals("current weight", param->getCurrentWeight(), 0.5f);
+		ensure_equals("last weight", param->getLastWeight(), 0.25f);
+		ensure_equals("target weight", param->getWeight(), 2.f);
+		ensure("still animating", param->isAnimating());
+		ensure("dummy never animates", !dummy->isAnimating());
+		ensure_equals("other weights", character.getVisualParam(100)->getWeight(), 0.1f);
+
+		// a clone keeps its weights apart
+		TestParam clone(*param);
+		ensure("clone has no character", clone.getCharacter() == NULL);
+		clone.setWeight(1.f);
+		ensure_equals("clone weight", clone.getCurrentWeight(), 1.f);
+		ensure_equals("original weight", param->getCurrentWeight(), 0.5f);
+
+		character.trimVisualParamWeights();
+		ensure_equals("weights after trim", param->getCurrentWeight(), 0.5f);
+
+		LLCharacter::LLVisualParamMemory memory;
+		character.getVisualParamMemory(memory);
+		ensure_equals("params", memory.mNumParams, 252U);
+		ensure_equals("weights", memory.mNumWeights, 252U);
+		ensure("weight bytes", memory.mWeightBytes == sizeof(LLVisualParamWeights) + 252 * sizeof(LLVisualParamWeight));
+		ensure("param base bytes", memory.mParamBaseBytes == 252 * sizeof(LLVisualParam));
+		ensure("a param and its weights take less than a param did",
+			   sizeof(LLVisualParam) + sizeof(LLVisualParamWeight) < sizeof(OldParamLayout));
+	}
+}
@@ -0,0 +1,249 @@
+/**
+ * @file lljointhierarchy_test.cpp
+ * @brief Tests and benchmark of LLJointHierarchy on synthetic skeletons
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <vector>
+
+#include "../lljointhierarchy.h"
+#include "../lljoint.h"
+#include "llformat.h"
+#include "llquaternion.h"
+#include "lltimer.h"
+#include "m4math.h"
+#include "v3math.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	F32 next_rand(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (F32)(seed >> 8) / (F32)(1 << 24);
+	}
+
+	// A skeleton shaped like the Bento one: a spine with limbs, long finger
+	// and face chains, some joints scaling their children's offsets
+	struct SyntheticSkeleton
+	{
+		SyntheticSkeleton(U32 seed, U32 num_joints)
+		{
+			mJoints.push_back(new LLJoint());
+			for (U32 i = 1; i < num_joints; ++i)
+			{
+				// mostly chains, now and then a branch from further up
+				U32 parent = i - 1;
+				if (next_rand(seed) < 0.3f)
+				{
+					parent = (U32)(next_rand(seed) * i);
+				}
+				LLJoint* joint = new LLJoint();
+				mJoints[parent]->addChild(joint);
+				joint->getXform()->setScaleChildOffset(next_rand(seed) < 0.2f);
+				mJoints.push_back(joint);
+			}
+			mJoints[0]->getXform()->setParent(&mAnchor);
+			mAnchor.setScaleChildOffset(TRUE);
+		}
+
+		~SyntheticSkeleton()
+		{
+			// children first, the destructor unlinks
+			for (S32 i = mJoints.size() - 1; i >= 0; --i)
+			{
+				delete mJoints[i];
+			}
+		}
+
+		// the next animation frame, the same for the same seed
+		void animate(U32 seed, F32 changed)
+		{
+			mAnchor.setPosition(LLVector3(next_rand(seed) * 256.f, next_rand(seed) * 256.f, next_rand(seed) * 40.f));
+			mAnchor.setRotation(LLQuaternion(next_rand(seed) * F_TWO_PI, LLVector3(0.f, 0.f, 1.f)));
+			mAnchor.setScale(LLVector3(1.f + next_rand(seed), 1.f + next_rand(seed), 1.f + next_rand(seed)));
+			mAnchor.update();
+
+			for (U32 i = 0; i < mJoints.size(); ++i)
+			{
+				if (next_rand(seed) >= changed)
+				{
+					continue;
+				}
+				LLJoint* joint = mJoints[i];
+				joint->setPosition(LLVector3(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, next_rand(seed) * 0.3f));
+				joint->setRotation(LLQuaternion(next_rand(seed) * F_TWO_PI,
+												LLVector3(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, 1.f)));
+				joint->setScale(LLVector3(0.5f + next_rand(seed), 0.5f + next_rand(seed), 0.5f + next_rand(seed)));
+			}
+			if (changed >= 1.f)
+			{
+				mJoints[0]->touch();
+			}
+		}
+
+		LLXformMatrix			mAnchor;	// the object the avatar sits on
+		std::vector<LLJoint*>	mJoints;
+	};
+
+	void ensure_same_world(const std::string& msg, SyntheticSkeleton& a, SyntheticSkeleton& b)
+	{
+		for (U32 i = 0; i < a.mJoints.size(); ++i)
+		{
+			LLXformMatrix* xa = a.mJoints[i]->getXform();
+			LLXformMatrix* xb = b.mJoints[i]->getXform();
+			tut::ensure_equals(llformat("%s: joint %d dirty", msg.c_str(), i), b.mJoints[i]->mDirtyFlags, a.mJoints[i]->mDirtyFlags);
+			for (U32 k = 0; k < 3; ++k)
+			{
+				tut::ensure_equals(llformat("%s: joint %d position %d", msg.c_str(), i, k),
+								   xb->getWorldPosition().mV[k], xa->getWorldPosition().mV[k]);
+			}
+			for (U32 k = 0; k < 4; ++k)
+			{
+				tut::ensure_equals(llformat("%s: joint %d rotation %d", msg.c_str(), i, k),
+								   xb->getWorldRotation().mQ[k], xa->getWorldRotation().mQ[k]);
+				for (U32 j = 0; j < 4; ++j)
+				{
+					tut::ensure_equals(llformat("%s: joint %d matrix %d %d", msg.c_str(), i, k, j),
+									   xb->getWorldMatrix().mMatrix[k][j], xa->getWorldMatrix().mMatrix[k][j]);
+				}
+			}
+		}
+	}
+}
+
+namespace tut
+{
+	struct jointhierarchy_data
+	{
+	};
+	typedef test_group<jointhierarchy_data> jointhierarchy_group;
+	typedef jointhierarchy_group::object jointhierarchy_object;
+	jointhierarchy_group jointhierarchy_test("LLJointHierarchy");
+
+	template<> template<>
+	void jointhierarchy_object::test<1>()
+	{
+		set_test_name("update matches updateWorldMatrixChildren");
+
+		SyntheticSkeleton recursive(1, 160), flat(1, 160);
+		LLJointHierarchy hierarchy;
+
+		// a subtree that is not updated, as for hidden attachment points
+		recursive.mJoints[40]->mUpdateXform = FALSE;
+		flat.mJoints[40]->mUpdateXform = FALSE;
+
+		for (U32 frame = 0; frame < 20; ++frame)
+		{
+			F32 changed = frame % 2 ? 1.f : 0.25f;
+			recursive.animate(frame, changed);
+			flat.animate(frame, changed);
+
+			recursive.mJoints[0]->updateWorldMatrixChildren();
+			hierarchy.update(flat.mJoints[0]);
+
+			ensure_same_world(llformat("frame %d", frame), recursive, flat);
+		}
+
+		ensure_equals("joints in order", hierarchy.getNumJoints(), (U32)160);
+		ensure("root first", hierarchy.getJoint(0) == flat.mJoints[0]);
+		ensure_equals("root has no parent", hierarchy.getParentIndex(0), -1);
+		for (U32 i = 1; i < hierarchy.getNumJoints(); ++i)
+		{
+			S32 parent = hierarchy.getParentIndex(i);
+			ensure(llformat("joint %d after its parent", i), parent >= 0 && parent < (S32)i);
+			ensure(llformat("joint %d parent", i), hierarchy.getJoint(parent) == hierarchy.getJoint(i)->getParent());
+		}
+	}
+
+	template<> template<>
+	void jointhierarchy_object::test<2>()
+	{
+		set_test_name("update follows changes to the tree");
+
+		SyntheticSkeleton recursive(2, 60), flat(2, 60);
+		LLJointHierarchy hierarchy;
+		recursive.animate(0, 1.f);
+		flat.animate(0, 1.f);
+		recursive.mJoints[0]->updateWorldMatrixChildren();
+		hierarchy.update(flat.mJoints[0]);
+
+		// move a branch elsewhere, as attaching an extra skeleton part would
+		recursive.mJoints[3]->addChild(recursive.mJoints[50]);
+		flat.mJoints[3]->addChild(flat.mJoints[50]);
+		recursive.animate(1, 0.5f);
+		flat.animate(1, 0.5f);
+		recursive.mJoints[0]->updateWorldMatrixChildren();
+		hierarchy.update(flat.mJoints[0]);
+		ensure_same_world("moved branch", recursive, flat);
+
+		// and the skeleton hanging off nothing, as after standing up
+		recursive.mJoints[0]->getXform()->setParent(NULL);
+		flat.mJoints[0]->getXform()->setParent(NULL);
+		recursive.animate(2, 1.f);
+		flat.animate(2, 1.f);
+		recursive.mJoints[0]->updateWorldMatrixChildren();
+		hierarchy.update(flat.mJoints[0]);
+		ensure_same_world("no anchor", recursive, flat);
+	}
+
+	template<> template<>
+	void jointhierarchy_object::test<3>()
+	{
+		set_test_name("benchmark full skeleton updates");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		// about the size of a Bento skeleton with its collision volumes and
+		// attachment points
+		const U32 JOINTS = 240;
+		const U32 UPDATES = 5000;
+		SyntheticSkeleton recursive(3, JOINTS), flat(3, JOINTS);
+		LLJointHierarchy hierarchy;
+
+		F64 recursive_secs = 0.0, flat_secs = 0.0;
+		for (U32 i = 0; i < UPDATES; ++i)
+		{
+			recursive.mJoints[0]->touch();
+			LLTimer timer;
+			recursive.mJoints[0]->updateWorldMatrixChildren();
+			recursive_secs += timer.getElapsedTimeF64();
+
+			flat.mJoints[0]->touch();
+			timer.reset();
+			hierarchy.update(flat.mJoints[0]);
+			flat_secs += timer.getElapsedTimeF64();
+		}
+
+		std::cout << "\nUpdating a skeleton of " << JOINTS << " joints, skeletons/s\n"
+				  << llformat("  updateWorldMatrixChildren: %.0f\n", UPDATES / recursive_secs)
+				  << llformat("  LLJointHierarchy:          %.0f\n", UPDATES / flat_secs)
+				  << std::flush;
+	}
+}
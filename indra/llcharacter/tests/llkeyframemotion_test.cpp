@@ -0,0 +1,265 @@
+/**
+ * @file llkeyframemotion_test.cpp
+ * @brief Tests and benchmark of the LLKeyframeMotion animation curves
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "../llkeyframemotion.h"
+#include "llformat.h"
+#include "llquantize.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	F32 next_rand(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (F32)(seed >> 8) / (F32)(1 << 24);
+	}
+
+	// The curves as they were, keyed by time in a map
+	struct MapCurves
+	{
+		typedef std::map<F32, LLQuaternion> rot_map_t;
+		typedef std::map<F32, LLVector3> pos_map_t;
+
+		LLQuaternion getRotation(F32 time)
+		{
+			rot_map_t::iterator right = mRotations.lower_bound(time);
+			if (right == mRotations.end())
+			{
+				--right;
+				return right->second;
+			}
+			else if (right == mRotations.begin() || right->first == time)
+			{
+				return right->second;
+			}
+			rot_map_t::iterator left = right; --left;
+			F32 u = (time - left->first) / (right->first - left->first);
+			return nlerp(u, left->second, right->second);
+		}
+
+		LLVector3 getPosition(F32 time)
+		{
+			pos_map_t::iterator right = mPositions.lower_bound(time);
+			if (right == mPositions.end())
+			{
+				--right;
+				return right->second;
+			}
+			else if (right == mPositions.begin() || right->first == time)
+			{
+				return right->second;
+			}
+			pos_map_t::iterator left = right; --left;
+			F32 u = (time - left->first) / (right->first - left->first);
+			return lerp(left->second, right->second, u);
+		}
+
+		rot_map_t	mRotations;
+		pos_map_t	mPositions;
+	};
+
+	// A joint's curves of an animation of the given length, with keys at
+	// quantized times like those of uploaded animations, a few repeated
+	struct SyntheticJoint
+	{
+		SyntheticJoint(U32& seed, F32 duration, S32 num_keys)
+		{
+			for (S32 k = 0; k < num_keys; ++k)
+			{
+				F32 time = U16_to_F32((U16)(next_rand(seed) * 65535.f), 0.f, duration);
+				LLQuaternion rot(next_rand(seed) * F_TWO_PI, LLVector3(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, 1.f));
+				LLVector3 pos(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, next_rand(seed) - 0.5f);
+				if (k > 0 && next_rand(seed) < 0.05f)
+				{
+					time = mPrevTime;
+				}
+				mPrevTime = time;
+
+				mRotationCurve.addKey(LLKeyframeMotion::RotationKey(time, rot));
+				mPositionCurve.addKey(LLKeyframeMotion::PositionKey(time, pos));
+				mMap.mRotations[time] = rot;
+				mMap.mPositions[time] = pos;
+			}
+			mRotationCurve.mNumKeys = num_keys;
+			mPositionCurve.mNumKeys = num_keys;
+		}
+
+		F32								mPrevTime;
+		LLKeyframeMotion::RotationCurve	mRotationCurve;
+		LLKeyframeMotion::PositionCurve	mPositionCurve;
+		LLKeyframeMotion::KeyCursors	mCursors;
+		MapCurves						mMap;
+	};
+
+	void ensure_same(const std::string& msg, const LLQuaternion& a, const LLQuaternion& b)
+	{
+		for (U32 k = 0; k < 4; ++k)
+		{
+			tut::ensure_equals(msg + llformat(" rotation %d", k), a.mQ[k], b.mQ[k]);
+		}
+	}
+
+	void ensure_same(const std::string& msg, const LLVector3& a, const LLVector3& b)
+	{
+		for (U32 k = 0; k < 3; ++k)
+		{
+			tut::ensure_equals(msg + llformat(" position %d", k), a.mV[k], b.mV[k]);
+		}
+	}
+}
+
+namespace tut
+{
+	struct keyframemotion_data
+	{
+	};
+	typedef test_group<keyframemotion_data> keyframemotion_group;
+	typedef keyframemotion_group::object keyframemotion_object;
+	keyframemotion_group keyframemotion_test("LLKeyframeMotion");
+
+	template<> template<>
+	void keyframemotion_object::test<1>()
+	{
+		set_test_name("curves sample as the map keyed curves did");
+
+		U32 seed = 1;
+		const S32 key_counts[] = { 1, 2, 3, 40, 600 };
+		for (U32 c = 0; c < sizeof(key_counts) / sizeof(key_counts[0]); ++c)
+		{
+			const F32 duration = 4.f;
+			SyntheticJoint joint(seed, duration, key_counts[c]);
+
+			// forward playback, a loop back to the start and random seeks,
+			// including before the first key, after the last and on keys
+			std::vector<F32> times;
+			for (F32 t = -0.1f; t < duration + 0.1f; t += 1.f / 45.f)
+			{
+				times.push_back(t);
+			}
+			for (U32 i = 0; i < 200; ++i)
+			{
+				times.push_back(next_rand(seed) * duration);
+			}
+			times.insert(times.end(), joint.mRotationCurve.mKeyTimes.begin(), joint.mRotationCurve.mKeyTimes.end());
+
+			for (U32 i = 0; i < times.size(); ++i)
+			{
+				std::string msg = llformat("%d keys, time %f", key_counts[c], times[i]);
+				ensure_same(msg, joint.mRotationCurve.getValue(times[i], duration, joint.mCursors.mRotationKey),
+							joint.mMap.getRotation(times[i]));
+				ensure_same(msg, joint.mPositionCurve.getValue(times[i], duration, joint.mCursors.mPositionKey),
+							joint.mMap.getPosition(times[i]));
+				ensure_same(msg + " uncached", joint.mPositionCurve.getValue(times[i], duration),
+							joint.mMap.getPosition(times[i]));
+			}
+		}
+	}
+
+	template<> template<>
+	void keyframemotion_object::test<2>()
+	{
+		set_test_name("a key at the time of another replaces it");
+
+		LLKeyframeMotion::PositionCurve curve;
+		curve.addKey(LLKeyframeMotion::PositionKey(1.f, LLVector3(1.f, 0.f, 0.f)));
+		curve.addKey(LLKeyframeMotion::PositionKey(0.f, LLVector3(0.f, 0.f, 0.f)));
+		curve.addKey(LLKeyframeMotion::PositionKey(1.f, LLVector3(2.f, 0.f, 0.f)));
+		curve.addKey(LLKeyframeMotion::PositionKey(0.5f, LLVector3(0.f, 1.f, 0.f)));
+
+		ensure_equals("keys", curve.mKeyTimes.size(), (size_t)3);
+		ensure_equals("sorted", curve.mKeyTimes[1], 0.5f);
+		ensure_same("replaced", curve.getValue(1.f, 1.f), LLVector3(2.f, 0.f, 0.f));
+		ensure_same("past the end", curve.getValue(3.f, 1.f), LLVector3(2.f, 0.f, 0.f));
+		ensure_same("between", curve.getValue(0.75f, 1.f), LLVector3(1.f, 0.5f, 0.f));
+	}
+
+	template<> template<>
+	void keyframemotion_object::test<3>()
+	{
+		set_test_name("benchmark sampling many animations");
+
+		// 100 avatars playing an animation of 60 joints, with 30 to 300 keys
+		// each, for 10 seconds of frames at 45 fps
+		const U32 ANIMATIONS = 100;
+		const U32 JOINTS = 60;
+		const F32 DURATION = 10.f;
+		const U32 FRAMES = 450;
+
+		U32 seed = 3;
+		std::vector<SyntheticJoint*> joints;
+		for (U32 i = 0; i < ANIMATIONS * JOINTS; ++i)
+		{
+			joints.push_back(new SyntheticJoint(seed, DURATION, 30 + (S32)(next_rand(seed) * 270.f)));
+		}
+
+		F32 map_sum = 0.f, curve_sum = 0.f;
+		LLTimer timer;
+		for (U32 f = 0; f < FRAMES; ++f)
+		{
+			F32 time = DURATION * f / FRAMES;
+			for (U32 i = 0; i < joints.size(); ++i)
+			{
+				map_sum += joints[i]->mMap.getRotation(time).mQ[VW] + joints[i]->mMap.getPosition(time).mV[VX];
+			}
+		}
+		F64 map_secs = timer.getElapsedTimeF64();
+
+		timer.reset();
+		for (U32 f = 0; f < FRAMES; ++f)
+		{
+			F32 time = DURATION * f / FRAMES;
+			for (U32 i = 0; i < joints.size(); ++i)
+			{
+				SyntheticJoint* joint = joints[i];
+				curve_sum += joint->mRotationCurve.getValue(time, DURATION, joint->mCursors.mRotationKey).mQ[VW]
+					+ joint->mPositionCurve.getValue(time, DURATION, joint->mCursors.mPositionKey).mV[VX];
+			}
+		}
+		F64 curve_secs = timer.getElapsedTimeF64();
+		ensure_equals("same samples", curve_sum, map_sum);
+
+		if (benchmarks_enabled())
+		{
+			F64 samples = (F64)joints.size() * FRAMES / 1000000.0;
+			std::cout << "\nSampling " << ANIMATIONS << " animations x " << JOINTS << " joints, million joints/s\n"
+					  << llformat("  std::map keys:       %.2f\n", samples / map_secs)
+					  << llformat("  key arrays, cursors: %.2f\n", samples / curve_secs)
+					  << std::flush;
+		}
+
+		for (U32 i = 0; i < joints.size(); ++i)
+		{
+			delete joints[i];
+		}
+	}
+}
@@ -0,0 +1,294 @@
+/**
+ * @file llmotioncontroller_test.cpp
+ * @brief Tests of the motion LOD of LLMotionController
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llcharacter.h"
+#include "../lljoint.h"
+#include "../lljointstate.h"
+#include "../llmotioncontroller.h"
+#include "llformat.h"
+#include "lluuid.h"
+#include "v3dmath.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	const S32 NUM_TEST_JOINTS = 4;
+
+	// a skeleton of two base joints and two extended ones
+	class TestCharacter : public LLCharacter
+	{
+	public:
+		TestCharacter()
+		{
+			for (S32 i = 0; i < NUM_TEST_JOINTS; ++i)
+			{
+				// poses keep their joint states by joint name
+				mJoints[i].setName(llformat("joint%d", i));
+				mJoints[i].setJointNum(i);
+				mJoints[i].setSupport(i < 2 ? LLJoint::SUPPORT_BASE : LLJoint::SUPPORT_EXTENDED);
+			}
+			mMotionController.setCharacter(this);
+		}
+
+		/*virtual*/ const char* getAnimationPrefix() { return "test"; }
+		/*virtual*/ LLJoint* getRootJoint() { return &mJoints[0]; }
+		/*virtual*/ LLVector3 getCharacterPosition() { return LLVector3::zero; }
+		/*virtual*/ LLQuaternion getCharacterRotation() { return LLQuaternion::DEFAULT; }
+		/*virtual*/ LLVector3 getCharacterVelocity() { return LLVector3::zero; }
+		/*virtual*/ LLVector3 getCharacterAngularVelocity() { return LLVector3::zero; }
+		/*virtual*/ void getGround(const LLVector3& inPos, LLVector3& outPos, LLVector3& outNorm) {}
+		/*virtual*/ LLJoint* getCharacterJoint(U32 i) { return i < NUM_TEST_JOINTS ? &mJoints[i] : NULL; }
+		/*virtual*/ F32 getTimeDilation() { return 1.f; }
+		/*virtual*/ F32 getPixelArea() const { return 1.f; }
+		/*virtual*/ LLPolyMesh* getHeadMesh() { return NULL; }
+		/*virtual*/ LLPolyMesh* getUpperBodyMesh() { return NULL; }
+		/*virtual*/ LLVector3d getPosGlobalFromAgent(const LLVector3& position) { return LLVector3d(position); }
+		/*virtual*/ LLVector3 getPosAgentFromGlobal(const LLVector3d& position) { return LLVector3(position); }
+		/*virtual*/ void addDebugText(const std::string& text) {}
+		/*virtual*/ const LLUUID& getID() const { return LLUUID::null; }
+
+		LLJoint		mJoints[NUM_TEST_JOINTS];
+	};
+
+	const LLUUID BASE_MOTION_ID("3b9c8a3e-6f5d-4a1e-9d2c-1f0e7b6a5c41");
+	const LLUUID EXTENDED_MOTION_ID("8e2d4c6a-1b3f-4e5d-a7c9-0b2e4f6a8c13");
+	// a quarter turn about z, what the test motions set their joints to
+	const LLQuaternion TURNED(F_PI_BY_TWO, LLVector3(0.f, 0.f, 1.f));
+
+	// A looping motion turning the joints it is given.  The base motion turns
+	// a base joint and an extended one, the extended motion an extended joint.
+	class TestMotion : public LLMotion
+	{
+	public:
+		TestMotion(const LLUUID& id)
+		:	LLMotion(id),
+			mNumUpdates(0)
+		{
+		}
+
+		static LLMotion* create(const LLUUID& id) { return new TestMotion(id); }
+
+		/*virtual*/ BOOL getLoop() { return TRUE; }
+		/*virtual*/ F32 getDuration() { return 0.f; }
+		/*virtual*/ F32 getEaseInDuration() { return 0.f; }
+		/*virtual*/ F32 getEaseOutDuration() { return 0.f; }
+		/*virtual*/ LLJoint::JointPriority getPriority() { return LLJoint::HIGH_PRIORITY; }
+		/*virtual*/ LLMotionBlendType getBlendType() { return NORMAL_BLEND; }
+		/*virtual*/ F32 getMinPixelArea() { return 0.f; }
+
+		/*virtual*/ LLMotionInitStatus onInitialize(LLCharacter* character)
+		{
+			if (getID() == BASE_MOTION_ID)
+			{
+				addTurn(character->getCharacterJoint(1));
+				addTurn(character->getCharacterJoint(3));
+			}
+			else
+			{
+				addTurn(character->getCharacterJoint(2));
+			}
+			return STATUS_SUCCESS;
+		}
+
+		/*virtual*/ BOOL onActivate() { return TRUE; }
+
+		/*virtual*/ BOOL onUpdate(F32 time, U8* joint_mask)
+		{
+			mNumUpdates++;
+			return TRUE;
+		}
+
+		/*virtual*/ void onDeactivate() {}
+
+		S32		mNumUpdates;
+
+	private:
+		void addTurn(LLJoint* joint)
+		{
+			LLPointer<LLJointState> state = new LLJointState(joint);
+			state->setUsage(LLJointState::ROT);
+			state->setRotation(TURNED);
+			addJointState(state);
+		}
+	};
+
+	bool is_turned(LLJoint& joint)
+	{
+		return dot(joint.getRotation(), TURNED) > 0.999f;
+	}
+
+	void reset_joints(TestCharacter& character)
+	{
+		for (S32 i = 0; i < NUM_TEST_JOINTS; ++i)
+		{
+			character.mJoints[i].setRotation(LLQuaternion::DEFAULT);
+		}
+	}
+}
+
+namespace tut
+{
+	struct motioncontroller_data
+	{
+	};
+	typedef test_group<motioncontroller_data> motioncontroller_group;
+	typedef motioncontroller_group::object motioncontroller_object;
+	motioncontroller_group motioncontroller_test("LLMotionController");
+
+	template<> template<>
+	void motioncontroller_object::test<1>()
+	{
+		set_test_name("LOD follows the pixel area with hysteresis");
+
+		TestCharacter character;
+		LLMotionController& controller = character.getMotionController();
+		ensure_equals("default", controller.getLOD(), LLMotionController::LOD_FULL);
+		ensure_equals("every frame", controller.getLODTimeStep(), 0.f);
+
+		controller.updateLOD(100000.f);
+		ensure_equals("near", controller.getLOD(), LLMotionController::LOD_FULL);
+		controller.updateLOD(10000.f);
+		ensure_equals("mid", controller.getLOD(), LLMotionController::LOD_REDUCED);
+		ensure_equals("reduced step", controller.getLODTimeStep(), LLMotionController::REDUCED_LOD_TIME_STEP);
+		controller.updateLOD(1000.f);
+		ensure_equals("far", controller.getLOD(), LLMotionController::LOD_CORE);
+		ensure_equals("core step", controller.getLODTimeStep(), LLMotionController::CORE_LOD_TIME_STEP);
+
+		// coming back only changes once past the hysteresis
+		controller.updateLOD(2800.f);
+		ensure_equals("just past core", controller.getLOD(), LLMotionController::LOD_CORE);
+		controller.updateLOD(4000.f);
+		ensure_equals("back to reduced", controller.getLOD(), LLMotionController::LOD_REDUCED);
+		controller.updateLOD(22000.f);
+		ensure_equals("just past reduced", controller.getLOD(), LLMotionController::LOD_REDUCED);
+		controller.updateLOD(30000.f);
+		ensure_equals("back to full", controller.getLOD(), LLMotionController::LOD_FULL);
+	}
+
+	template<> template<>
+	void motioncontroller_object::test<2>()
+	{
+		set_test_name("only base joints are animated at the core LOD");
+
+		TestCharacter character;
+		LLMotionController& controller = character.getMotionController();
+		LLJoint unnumbered;
+		for (S32 i = 0; i < NUM_TEST_JOINTS; ++i)
+		{
+			ensure("full", controller.isJointInLOD(&character.mJoints[i]));
+		}
+
+		controller.setLOD(LLMotionController::LOD_CORE);
+		ensure("base", controller.isJointInLOD(&character.mJoints[0]));
+		ensure("base child", controller.isJointInLOD(&character.mJoints[1]));
+		ensure("extended", !controller.isJointInLOD(&character.mJoints[2]));
+		ensure("extended child", !controller.isJointInLOD(&character.mJoints[3]));
+		ensure("not a skeleton joint", controller.isJointInLOD(&unnumbered));
+
+		controller.setLOD(LLMotionController::LOD_REDUCED);
+		ensure("reduced", controller.isJointInLOD(&character.mJoints[3]));
+	}
+
+	template<> template<>
+	void motioncontroller_object::test<3>()
+	{
+		set_test_name("motions of extended joints stay idle at the core LOD");
+
+		TestCharacter character;
+		LLMotionController& controller = character.getMotionController();
+		controller.registerMotion(BASE_MOTION_ID, TestMotion::create);
+		controller.registerMotion(EXTENDED_MOTION_ID, TestMotion::create);
+		ensure("start base", controller.startMotion(BASE_MOTION_ID, 0.f));
+		ensure("start extended", controller.startMotion(EXTENDED_MOTION_ID, 0.f));
+		TestMotion* base = (TestMotion*)controller.findMotion(BASE_MOTION_ID);
+		TestMotion* extended = (TestMotion*)controller.findMotion(EXTENDED_MOTION_ID);
+		ensure("motions", base && extended);
+
+		controller.updateMotions();
+		ensure_equals("full evaluated", controller.getMotionsEvaluated(), 2);
+		ensure_equals("full skipped", controller.getMotionsSkipped(), 0);
+		ensure("full base joint", is_turned(character.mJoints[1]));
+		ensure("full extended joint", is_turned(character.mJoints[2]));
+		ensure("full extended joint of the base motion", is_turned(character.mJoints[3]));
+
+		reset_joints(character);
+		controller.setLOD(LLMotionController::LOD_CORE);
+		S32 base_updates = base->mNumUpdates;
+		S32 extended_updates = extended->mNumUpdates;
+		controller.updateMotions();
+		ensure_equals("core evaluated", controller.getMotionsEvaluated(), 1);
+		ensure_equals("core skipped", controller.getMotionsSkipped(), 1);
+		ensure_equals("base updated", base->mNumUpdates, base_updates + 1);
+		ensure_equals("extended idle", extended->mNumUpdates, extended_updates);
+		ensure("extended still active", controller.isMotionActive(extended));
+		ensure("core base joint", is_turned(character.mJoints[1]));
+		ensure("core extended joint", !is_turned(character.mJoints[2]));
+		// the base motion ran, the pose blender left out its extended joint
+		ensure("core extended joint of the base motion", !is_turned(character.mJoints[3]));
+
+		controller.setLOD(LLMotionController::LOD_FULL);
+		controller.updateMotions();
+		ensure_equals("back evaluated", controller.getMotionsEvaluated(), 2);
+		ensure_equals("extended updated", extended->mNumUpdates, extended_updates + 1);
+		ensure("back extended joint", is_turned(character.mJoints[2]));
+		ensure("back extended joint of the base motion", is_turned(character.mJoints[3]));
+	}
+
+	template<> template<>
+	void motioncontroller_object::test<4>()
+	{
+		set_test_name("every active motion is counted as evaluated or skipped");
+
+		TestCharacter character;
+		LLMotionController& controller = character.getMotionController();
+		controller.registerMotion(BASE_MOTION_ID, TestMotion::create);
+		controller.registerMotion(EXTENDED_MOTION_ID, TestMotion::create);
+		controller.startMotion(BASE_MOTION_ID, 0.f);
+		controller.startMotion(EXTENDED_MOTION_ID, 0.f);
+
+		const S32 UPDATES = 12;
+		LLMotionController::resetFrameStats();
+		for (S32 i = 0; i < UPDATES; ++i)
+		{
+			controller.setLOD(i < UPDATES / 2 ? LLMotionController::LOD_FULL : LLMotionController::LOD_CORE);
+			controller.updateMotions();
+			ensure_equals(llformat("update %d", i), controller.getMotionsEvaluated() + controller.getMotionsSkipped(), 2);
+		}
+		ensure_equals("frame total", LLMotionController::getFrameMotionsEvaluated()
+					  + LLMotionController::getFrameMotionsSkipped(), 2 * UPDATES);
+		ensure_equals("frame skipped", LLMotionController::getFrameMotionsSkipped(), UPDATES / 2);
+
+		// between time steps nothing is evaluated, all of it is skipped
+		controller.setLOD(LLMotionController::LOD_FULL);
+		controller.setTimeStep(10.f);
+		controller.updateMotions();
+		controller.updateMotions();
+		ensure_equals("between steps evaluated", controller.getMotionsEvaluated(), 0);
+		ensure_equals("between steps skipped", controller.getMotionsSkipped(), 2);
+	}
+}
@@ -0,0 +1,290 @@
+/**
+ * @file llphysicsmotionbatch_test.cpp
+ * @brief Tests and stress test of LLPhysicsMotionBatch on synthetic avatars
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <vector>
+
+#include "../llphysicsmotionbatch.h"
+#include "llformat.h"
+#include "llmath.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+typedef LLPhysicsMotionBatch::Lane Lane;
+
+namespace
+{
+	F32 next_rand(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (F32)(seed >> 8) / (F32)(1 << 24);
+	}
+
+	// The loop of the old per motion LLPhysicsMotion::onUpdate(), one lane at
+	// a time, with the same early stop and NaN reset
+	void integrate_reference(Lane& lane)
+	{
+		const F32 joint_time = lane.mTimeDelta * 30.f;
+		const F32 velocity_joint = lane.mJointMotion / joint_time;
+		const F32 acceleration_joint = (velocity_joint - lane.mVelocityJoint) / joint_time * (1.f / 3.f)
+									   + lane.mAccelerationJoint * (2.f / 3.f);
+
+		lane.mFlags = 0;
+		for (F32 time_iteration = 0; time_iteration <= lane.mTimeDelta; time_iteration += LLPhysicsMotionBatch::TIME_ITERATION_STEP)
+		{
+			F32 step = LLPhysicsMotionBatch::TIME_ITERATION_STEP;
+			if (time_iteration + LLPhysicsMotionBatch::TIME_ITERATION_STEP > lane.mTimeDelta)
+			{
+				step = lane.mTimeDelta - time_iteration;
+			}
+
+			const F32 position_current = llclamp(lane.mPosition, 0.f, 1.f);
+			if (lane.mMaxEffect == 0 && position_current == lane.mPositionUser)
+			{
+				return;
+			}
+
+			const F32 force_spring = -(position_current - lane.mPositionUser) * lane.mSpring;
+			const F32 force_accel = lane.mGain * (acceleration_joint * lane.mMass);
+			const F32 force_gravity = lane.mUp * lane.mGravity * lane.mMass;
+			const F32 force_damping = -lane.mDamping * lane.mVelocity;
+			const F32 force_drag = 0.5f * lane.mDrag * velocity_joint * fabsf(velocity_joint);
+			const F32 force_net = force_accel + force_gravity + force_drag + force_spring + force_damping;
+
+			F32 velocity_new = llclamp(lane.mVelocity + force_net / lane.mMass * step, -100.f, 100.f);
+			F32 position_new = position_current + velocity_new * step;
+			if (lane.mMaxEffect == 0)
+			{
+				position_new = lane.mPositionUser;
+			}
+			if ((position_new < 0 && velocity_new < 0) || (position_new > 1 && velocity_new > 0))
+			{
+				velocity_new = 0;
+			}
+			if (lane.mPosition != lane.mPosition || lane.mVelocity != lane.mVelocity || position_new != position_new)
+			{
+				position_new = 0;
+				velocity_new = 0;
+			}
+
+			const F32 position_clamped = llclamp(position_new, 0.f, 1.f);
+			if (llabs(lane.mPositionLastUpdate - position_clamped) > lane.mMinDelta)
+			{
+				lane.mFlags |= LLPhysicsMotionBatch::UPDATE_VISUALS;
+				lane.mPositionLastUpdate = position_new;
+			}
+			lane.mFlags |= LLPhysicsMotionBatch::STEPPED;
+			lane.mValue = position_clamped;
+			lane.mVelocity = velocity_new;
+			lane.mAccelerationJoint = acceleration_joint;
+			lane.mPosition = position_new;
+		}
+		lane.mFlags |= LLPhysicsMotionBatch::FINISHED;
+		lane.mVelocityJoint = velocity_joint;
+	}
+
+	// The six motions of an avatar (breast in/out, up/down and left/right,
+	// butt up/down and left/right, belly up/down) with random physics
+	// settings, some of them turned off, on a torso that moves around
+	struct SyntheticAvatars
+	{
+		SyntheticAvatars(U32 seed, U32 num_avatars)
+		:	mSeed(seed),
+			mLanes(num_avatars * 6)
+		{
+			for (U32 i = 0; i < mLanes.size(); ++i)
+			{
+				Lane& lane = mLanes[i];
+				lane.mPositionUser = next_rand(mSeed);
+				lane.mMass = 0.1f + next_rand(mSeed) * 0.9f;
+				lane.mGravity = next_rand(mSeed) * 30.f;
+				lane.mSpring = next_rand(mSeed) * 100.f;
+				lane.mGain = next_rand(mSeed) * 100.f;
+				lane.mDamping = next_rand(mSeed);
+				lane.mDrag = next_rand(mSeed) * 10.f;
+				lane.mMaxEffect = next_rand(mSeed) < 0.2f ? 0.f : next_rand(mSeed) * 3.f;
+				lane.mMinDelta = next_rand(mSeed) < 0.5f ? 0.0004f : F32_MAX;
+				lane.mPosition = lane.mPositionUser;
+				lane.mPositionLastUpdate = lane.mPositionUser;
+			}
+		}
+
+		// the next frame, the same for the same seed
+		void animate(U32 frame)
+		{
+			U32 seed = mSeed + frame;
+			F32 time_delta = 0.011f + next_rand(seed) * 0.3f;
+			for (U32 i = 0; i < mLanes.size(); ++i)
+			{
+				Lane& lane = mLanes[i];
+				// all avatars share the frame, now and then one ran late
+				lane.mTimeDelta = next_rand(seed) < 0.1f ? 0.011f + next_rand(seed) * 0.98f : time_delta;
+				lane.mJointMotion = (next_rand(seed) - 0.5f) * 20.f;
+				lane.mUp = next_rand(seed) * 2.f - 1.f;
+			}
+		}
+
+		U32					mSeed;
+		std::vector<Lane>	mLanes;
+	};
+
+	void ensure_close(const std::string& msg, F32 actual, F32 expected)
+	{
+		tut::ensure(llformat("%s: %g, expected %g", msg.c_str(), actual, expected),
+					llabs(actual - expected) <= 1e-4f * llmax(1.f, llabs(expected)));
+	}
+}
+
+namespace tut
+{
+	struct physicsmotionbatch_data
+	{
+	};
+	typedef test_group<physicsmotionbatch_data> physicsmotionbatch_group;
+	typedef physicsmotionbatch_group::object physicsmotionbatch_object;
+	physicsmotionbatch_group physicsmotionbatch_test("LLPhysicsMotionBatch");
+
+	template<> template<>
+	void physicsmotionbatch_object::test<1>()
+	{
+		set_test_name("integrate matches the per motion loop");
+
+		// not a multiple of four, for the padding lanes
+		SyntheticAvatars batched(1, 83), reference(1, 83);
+		LLPhysicsMotionBatch batch;
+		for (U32 frame = 0; frame < 60; ++frame)
+		{
+			batched.animate(frame);
+			reference.animate(frame);
+
+			for (U32 i = 0; i < batched.mLanes.size(); ++i)
+			{
+				batch.addLane(&batched.mLanes[i]);
+				integrate_reference(reference.mLanes[i]);
+			}
+			batch.integrate();
+			ensure_equals("lanes", batch.getNumLanes(), (U32)batched.mLanes.size());
+			batch.clear();
+
+			for (U32 i = 0; i < batched.mLanes.size(); ++i)
+			{
+				const Lane& a = batched.mLanes[i];
+				Lane& b = reference.mLanes[i];
+				std::string msg = llformat("frame %d lane %d", frame, i);
+				ensure_equals(msg + " flags", a.mFlags, b.mFlags);
+				ensure_close(msg + " position", a.mPosition, b.mPosition);
+				ensure_close(msg + " velocity", a.mVelocity, b.mVelocity);
+				ensure_close(msg + " joint velocity", a.mVelocityJoint, b.mVelocityJoint);
+				ensure_close(msg + " joint acceleration", a.mAccelerationJoint, b.mAccelerationJoint);
+				ensure_close(msg + " last update", a.mPositionLastUpdate, b.mPositionLastUpdate);
+				ensure_close(msg + " value", a.mValue, b.mValue);
+
+				// go on from the same state, so that rounding does not add up
+				b = a;
+			}
+		}
+	}
+
+	template<> template<>
+	void physicsmotionbatch_object::test<2>()
+	{
+		set_test_name("motions with no effect come to rest");
+
+		Lane at_rest, moved, running;
+		at_rest.mTimeDelta = moved.mTimeDelta = running.mTimeDelta = 0.35f;
+		at_rest.mMass = moved.mMass = running.mMass = 0.2f;
+		at_rest.mPositionUser = at_rest.mPosition = 0.5f;
+		moved.mPositionUser = 0.5f;
+		moved.mPosition = 0.8f;
+		moved.mMinDelta = 0.f;
+		running.mPositionUser = 0.5f;
+		running.mPosition = 0.8f;
+		running.mSpring = 0.1f;
+		running.mMaxEffect = 0.1f;
+
+		LLPhysicsMotionBatch batch;
+		batch.addLane(&at_rest);
+		batch.addLane(&moved);
+		batch.addLane(&running);
+		batch.integrate();
+
+		ensure_equals("at rest does nothing", at_rest.mFlags, (U32)0);
+		ensure_equals("moved back to the user position", moved.mFlags,
+					  (U32)(LLPhysicsMotionBatch::STEPPED | LLPhysicsMotionBatch::UPDATE_VISUALS));
+		ensure_equals("moved value", moved.mValue, 0.5f);
+		ensure_equals("running flags", running.mFlags,
+					  (U32)(LLPhysicsMotionBatch::STEPPED | LLPhysicsMotionBatch::FINISHED));
+		ensure("running towards the user position", running.mPosition < 0.8f && running.mPosition > 0.5f);
+	}
+
+	template<> template<>
+	void physicsmotionbatch_object::test<3>()
+	{
+		set_test_name("stress test hundreds of avatars");
+
+		const U32 AVATARS = 500;
+		const U32 FRAMES = 400;
+		SyntheticAvatars batched(3, AVATARS), reference(3, AVATARS);
+		LLPhysicsMotionBatch batch;
+
+		F64 reference_secs = 0.0, batch_secs = 0.0;
+		for (U32 frame = 0; frame < FRAMES; ++frame)
+		{
+			reference.animate(frame);
+			LLTimer timer;
+			for (U32 i = 0; i < reference.mLanes.size(); ++i)
+			{
+				integrate_reference(reference.mLanes[i]);
+			}
+			reference_secs += timer.getElapsedTimeF64();
+
+			batched.animate(frame);
+			timer.reset();
+			for (U32 i = 0; i < batched.mLanes.size(); ++i)
+			{
+				batch.addLane(&batched.mLanes[i]);
+			}
+			batch.integrate();
+			batch.clear();
+			batch_secs += timer.getElapsedTimeF64();
+		}
+
+		for (U32 i = 0; i < batched.mLanes.size(); ++i)
+		{
+			ensure(llformat("lane %d in range", i), batched.mLanes[i].mValue >= 0.f && batched.mLanes[i].mValue <= 1.f);
+		}
+
+		if (benchmarks_enabled())
+		{
+			std::cout << "\nAvatar physics of " << AVATARS << " avatars, 6 motions each, ms per frame\n"
+					  << llformat("  per motion loop:      %.3f\n", reference_secs * 1000.0 / FRAMES)
+					  << llformat("  LLPhysicsMotionBatch: %.3f\n", batch_secs * 1000.0 / FRAMES)
+					  << std::flush;
+		}
+	}
+}
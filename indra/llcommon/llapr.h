@@ -183,6 +183,9 @@ public:
 
 	Type operator ++() { return apr_atomic_inc32(&mData); } // Type++
 	Type operator --() { return apr_atomic_dec32(&mData); } // approximately --Type (0 if final is 0, non-zero otherwise)
+
+	// Sets the value to x only if it is currently cmp, returns the value it had before.  Full memory barrier.
+	Type compareAndSwap(const Type& cmp, const Type& x) { return Type(apr_atomic_cas32(&mData, apr_uint32_t(x), apr_uint32_t(cmp))); }
 	
 private:
 	volatile apr_uint32_t mData;
@@ -0,0 +1,315 @@
+/**
+ * @file lllockfreequeue.h
+ * @brief Bounded lock-free multi-producer multi-consumer queues
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLOCKFREEQUEUE_H
+#define LL_LLLOCKFREEQUEUE_H
+
+#include "llapr.h"		// LLAtomic32
+#include "llerror.h"
+
+//============================================================================
+// LLLockFreeQueue
+//
+// Fixed capacity FIFO that any number of threads may push to and pop from
+// without taking a lock (Vyukov's bounded MPMC array queue).  Every slot
+// carries a sequence number: a producer claims the slot at the tail once its
+// sequence equals the tail position, a consumer claims the slot at the head
+// once its sequence is one past the head position.  Claiming is a single
+// compare-and-swap on the head or tail counter, so producers only contend
+// with producers and consumers with consumers.
+//
+// The capacity is rounded up to a power of two.  Neither operation blocks:
+// tryPush() fails when the queue is full and tryPop() when it is empty.
+// ElementT must be default constructible and assignable; popped slots are
+// reset to ElementT() so that the queue does not hold on to references.
+
+template<typename ElementT>
+class LLLockFreeQueue
+{
+public:
+	typedef ElementT value_type;
+
+	LLLockFreeQueue(U32 capacity = 1024);
+	~LLLockFreeQueue();
+
+	// Returns false if the queue is full
+	bool tryPush(const ElementT& element);
+
+	// Returns false if the queue is empty
+	bool tryPop(ElementT& element);
+
+	// Only a snapshot when other threads are pushing or popping
+	U32 size() const;
+	bool empty() const { return size() == 0; }
+	U32 capacity() const { return mMask + 1; }
+
+private:
+	// No copy constructor or copy assignment
+	LLLockFreeQueue(const LLLockFreeQueue&);
+	LLLockFreeQueue& operator=(const LLLockFreeQueue&);
+
+	enum { CACHE_LINE_SIZE = 64 };
+
+	struct Cell
+	{
+		LLAtomic32<U32>	mSequence;
+		ElementT		mElement;
+	};
+
+	Cell*			mCells;
+	U32				mMask;
+
+	// Keep the producer and consumer positions on separate cache lines
+	char			mPad0[CACHE_LINE_SIZE];
+	LLAtomic32<U32>	mTail;	// next position to push
+	char			mPad1[CACHE_LINE_SIZE];
+	LLAtomic32<U32>	mHead;	// next position to pop
+	char			mPad2[CACHE_LINE_SIZE];
+};
+
+template<typename ElementT>
+LLLockFreeQueue<ElementT>::LLLockFreeQueue(U32 capacity)
+:	mTail(0),
+	mHead(0)
+{
+	U32 size = 2;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+	llassert_always(size <= 0x80000000);
+	mMask = size - 1;
+
+	mCells = new Cell[size];
+	for (U32 i = 0; i < size; ++i)
+	{
+		mCells[i].mSequence = i;
+	}
+}
+
+template<typename ElementT>
+LLLockFreeQueue<ElementT>::~LLLockFreeQueue()
+{
+	delete[] mCells;
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPush(const ElementT& element)
+{
+	Cell* cell;
+	U32 pos = mTail.CurrentValue();
+	while (true)
+	{
+		cell = &mCells[pos & mMask];
+		S32 diff = (S32)(cell->mSequence.CurrentValue() - pos);
+		if (diff == 0)
+		{
+			// Slot is free, try to claim it
+			U32 prev = mTail.compareAndSwap(pos, pos + 1);
+			if (prev == pos)
+			{
+				break;
+			}
+			pos = prev;
+		}
+		else if (diff < 0)
+		{
+			// Slot still holds the element from one lap ago: full
+			return false;
+		}
+		else
+		{
+			// Another producer got here first
+			pos = mTail.CurrentValue();
+		}
+	}
+
+	cell->mElement = element;
+	// Publish to consumers.  Plain stores to an LLAtomic32 carry no barrier,
+	// the compare-and-swap keeps the element write ahead of the sequence.
+	cell->mSequence.compareAndSwap(pos, pos + 1);
+	return true;
+}
+
+template<typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPop(ElementT& element)
+{
+	Cell* cell;
+	U32 pos = mHead.CurrentValue();
+	while (true)
+	{
+		cell = &mCells[pos & mMask];
+		S32 diff = (S32)(cell->mSequence.CurrentValue() - (pos + 1));
+		if (diff == 0)
+		{
+			// Slot is filled, try to claim it
+			U32 prev = mHead.compareAndSwap(pos, pos + 1);
+			if (prev == pos)
+			{
+				break;
+			}
+			pos = prev;
+		}
+		else if (diff < 0)
+		{
+			// Slot not written yet: empty
+			return false;
+		}
+		else
+		{
+			// Another consumer got here first
+			pos = mHead.CurrentValue();
+		}
+	}
+
+	element = cell->mElement;
+	cell->mElement = ElementT();
+	// Hand the slot back to producers for the next lap
+	cell->mSequence.compareAndSwap(pos + 1, pos + mMask + 1);
+	return true;
+}
+
+template<typename ElementT>
+U32 LLLockFreeQueue<ElementT>::size() const
+{
+	S32 size = (S32)(mTail.CurrentValue() - mHead.CurrentValue());
+	return (U32)llclamp(size, 0, (S32)capacity());
+}
+
+//============================================================================
+// LLPriorityBucketQueue
+//
+// A fixed number of LLLockFreeQueues, one per priority level.  pop() returns
+// the oldest element of the highest non-empty level.  Elements of the same
+// level come out in FIFO order; there is no ordering within a level beyond
+// that, so map fine grained priorities onto a handful of levels first.
+//
+// A per level count lets pop() skip empty levels without touching their
+// queues.  The counts can briefly lag behind the queues, so pop() may miss
+// an element pushed concurrently; it is never lost, the next pop() sees it.
+
+template<typename ElementT>
+class LLPriorityBucketQueue
+{
+public:
+	typedef ElementT value_type;
+
+	LLPriorityBucketQueue(U32 num_levels, U32 capacity_per_level = 1024);
+	~LLPriorityBucketQueue();
+
+	// level 0 is the lowest priority.  Returns false if that level is full.
+	bool tryPush(const ElementT& element, U32 level);
+
+	// Returns false if every level is empty
+	bool tryPop(ElementT& element);
+
+	// Pops only from levels >= min_level
+	bool tryPop(ElementT& element, U32 min_level);
+
+	U32 size() const;
+	U32 size(U32 level) const { return (U32)llmax(mCounts[level].CurrentValue(), 0); }
+	bool empty() const { return size() == 0; }
+	U32 getNumLevels() const { return mNumLevels; }
+
+private:
+	// No copy constructor or copy assignment
+	LLPriorityBucketQueue(const LLPriorityBucketQueue&);
+	LLPriorityBucketQueue& operator=(const LLPriorityBucketQueue&);
+
+	U32							mNumLevels;
+	LLLockFreeQueue<ElementT>**	mLevels;
+	LLAtomic32<S32>*			mCounts;
+};
+
+template<typename ElementT>
+LLPriorityBucketQueue<ElementT>::LLPriorityBucketQueue(U32 num_levels, U32 capacity_per_level)
+:	mNumLevels(num_levels)
+{
+	llassert_always(num_levels > 0);
+	mLevels = new LLLockFreeQueue<ElementT>*[num_levels];
+	mCounts = new LLAtomic32<S32>[num_levels];
+	for (U32 i = 0; i < num_levels; ++i)
+	{
+		mLevels[i] = new LLLockFreeQueue<ElementT>(capacity_per_level);
+		mCounts[i] = 0;
+	}
+}
+
+template<typename ElementT>
+LLPriorityBucketQueue<ElementT>::~LLPriorityBucketQueue()
+{
+	for (U32 i = 0; i < mNumLevels; ++i)
+	{
+		delete mLevels[i];
+	}
+	delete[] mLevels;
+	delete[] mCounts;
+}
+
+template<typename ElementT>
+bool LLPriorityBucketQueue<ElementT>::tryPush(const ElementT& element, U32 level)
+{
+	llassert(level < mNumLevels);
+	if (!mLevels[level]->tryPush(element))
+	{
+		return false;
+	}
+	mCounts[level]++;
+	return true;
+}
+
+template<typename ElementT>
+bool LLPriorityBucketQueue<ElementT>::tryPop(ElementT& element)
+{
+	return tryPop(element, 0);
+}
+
+template<typename ElementT>
+bool LLPriorityBucketQueue<ElementT>::tryPop(ElementT& element, U32 min_level)
+{
+	for (S32 level = (S32)mNumLevels - 1; level >= (S32)min_level; --level)
+	{
+		if (mCounts[level].CurrentValue() > 0 && mLevels[level]->tryPop(element))
+		{
+			mCounts[level]--;
+			return true;
+		}
+	}
+	return false;
+}
+
+template<typename ElementT>
+U32 LLPriorityBucketQueue<ElementT>::size() const
+{
+	U32 total = 0;
+	for (U32 i = 0; i < mNumLevels; ++i)
+	{
+		total += size(i);
+	}
+	return total;
+}
+
+#endif // LL_LLLOCKFREEQUEUE_H
@@ -26,10 +26,19 @@
 #include "linden_common.h"
 #include "llqueuedthread.h"
 
+#include <boost/bind.hpp>
+
 #include "llstl.h"
+#include "llthreadpool.h"
 #include "lltimer.h"	// ms_sleep()
 #include "lltracethreadrecorder.h"
 
+// Longest a pooled queue keeps its worker before letting other tasks in
+static const F64 POOL_UPDATE_SLICE = 0.005;
+
+//static
+LLThreadPool* LLQueuedThread::sThreadPool = NULL;
+
 //============================================================================
 
 // MAIN THREAD
@@ -38,7 +47,9 @@ LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool shou
 	mThreaded(threaded),
 	mIdleThread(TRUE),
 	mNextHandle(0),
-	mStarted(FALSE)
+	mStarted(FALSE),
+	mThreadPool(threaded ? sThreadPool : NULL),
+	mPoolUpdateQueued(FALSE)
 {
 	if (mThreaded)
 	{
@@ -47,10 +58,24 @@ LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool shou
 			pause() ; //call this before start the thread.
 		}
 
-		start();
+		if (mThreadPool)
+		{
+			// No thread of our own, the pool calls poolUpdate() when there is work
+			mStatus = RUNNING;
+		}
+		else
+		{
+			start();
+		}
 	}
 }
 
+//static
+void LLQueuedThread::setThreadPool(LLThreadPool* pool)
+{
+	sThreadPool = pool;
+}
+
 // MAIN THREAD
 LLQueuedThread::~LLQueuedThread()
 {
@@ -67,7 +92,34 @@ void LLQueuedThread::shutdown()
 	setQuitting();
 
 	unpause(); // MAIN THREAD
-	if (mThreaded)
+	if (mThreadPool)
+	{
+		// Wait for a queued or running poolUpdate() to notice we are quitting
+		S32 timeout = 100;
+		for ( ; timeout>0; timeout--)
+		{
+			lockData();
+			bool queued = mPoolUpdateQueued;
+			unlockData();
+			if (!queued)
+			{
+				break;
+			}
+			ms_sleep(100);
+			LLThread::yield();
+		}
+		if (timeout == 0)
+		{
+			LL_WARNS() << "~LLQueuedThread (" << mName << ") timed out!" << LL_ENDL;
+		}
+		if (mStarted)
+		{
+			endThread();
+			mStarted = FALSE;
+		}
+		mStatus = STOPPED;
+	}
+	else if (mThreaded)
 	{
 		S32 timeout = 100;
 		for ( ; timeout>0; timeout--)
@@ -135,8 +187,12 @@ S32 LLQueuedThread::updateQueue(F32 max_time_ms)
 		pending = getPending();
 		if(pending > 0)
 		{
-		unpause();
-	}
+			unpause();
+			if (mThreadPool)
+			{
+				schedulePoolUpdate();
+			}
+		}
 	}
 	else
 	{
@@ -155,7 +211,11 @@ void LLQueuedThread::incQueue()
 	// Something has been added to the queue
 	if (!isPaused())
 	{
-		if (mThreaded)
+		if (mThreadPool)
+		{
+			schedulePoolUpdate();
+		}
+		else if (mThreaded)
 		{
 			wake(); // Wake the thread up if necessary.
 		}
@@ -464,7 +524,7 @@ S32 LLQueuedThread::processNextRequest()
 			req->setStatus(STATUS_QUEUED);
 			mRequestQueue.insert(req);
 			unlockData();
-			if (mThreaded && start_priority < PRIORITY_NORMAL)
+			if (mThreaded && !mThreadPool && start_priority < PRIORITY_NORMAL)
 			{
 				ms_sleep(1); // sleep the thread a little
 			}
@@ -523,6 +583,67 @@ void LLQueuedThread::run()
 	LL_INFOS() << "LLQueuedThread " << mName << " EXITING." << LL_ENDL;
 }
 
+//============================================================================
+// Shared pool mode
+
+// May be called from any thread
+void LLQueuedThread::schedulePoolUpdate()
+{
+	lockData();
+	if (!mPoolUpdateQueued && !isPaused() && !isQuitting())
+	{
+		U32 priority = mRequestQueue.empty() ? (U32)PRIORITY_LOW : (*mRequestQueue.begin())->getPriority();
+		mPoolUpdateQueued = TRUE;
+		mThreadPool->submit(boost::bind(&LLQueuedThread::poolUpdate, this),
+							LLThreadPool::mapPriority(priority));
+	}
+	unlockData();
+}
+
+// Runs on a pool worker, never on more than one at a time.
+// Does the work of one pass through run() until the queue is empty or
+// our time slice is up, then lets the other pool tasks have the worker.
+void LLQueuedThread::poolUpdate()
+{
+	if (!mStarted && !isQuitting())
+	{
+		startThread();
+		mStarted = TRUE;
+	}
+
+	LLTimer timer;
+	S32 pending_work = 0;
+	while (!isQuitting() && !isPaused())
+	{
+		mIdleThread = FALSE;
+
+		threadedUpdate();
+
+		pending_work = processNextRequest();
+		if (pending_work == 0)
+		{
+			mIdleThread = TRUE;
+			break;
+		}
+		if (timer.getElapsedTimeF64() > POOL_UPDATE_SLICE)
+		{
+			break;
+		}
+	}
+	LLTrace::get_thread_recorder()->pushToParent();
+
+	lockData();
+	mPoolUpdateQueued = FALSE;
+	if (pending_work > 0)
+	{
+		// Still busy, go to the back of the line
+		schedulePoolUpdate();
+	}
+	// shutdown() may delete us as soon as the flag is clear, don't touch
+	// any members after this.
+	unlockData();
+}
+
 // virtual
 void LLQueuedThread::startThread()
 {
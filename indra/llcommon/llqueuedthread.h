@@ -37,6 +37,8 @@
 #include "llthread.h"
 #include "llsimplehash.h"
 
+class LLThreadPool;
+
 //============================================================================
 // Note: ~LLQueuedThread is O(N) N=# of queued threads, assumed to be small
 //   It is assumed that LLQueuedThreads are rarely created/destroyed.
@@ -152,6 +154,12 @@ public:
 	LLQueuedThread(const std::string& name, bool threaded = true, bool should_pause = false);
 	virtual ~LLQueuedThread();	
 	virtual void shutdown();
+
+	// Threaded LLQueuedThreads constructed after this call run their loop as
+	// tasks on the given pool rather than on a thread of their own.
+	// Pass NULL to go back to one LLThread per instance.
+	static void setThreadPool(LLThreadPool* pool);
+	static LLThreadPool* getThreadPool() { return sThreadPool; }
 	
 private:
 	// No copy constructor or copy assignment
@@ -164,6 +172,9 @@ private:
 	virtual void endThread(void);
 	virtual void threadedUpdate(void);
 
+	void schedulePoolUpdate();
+	void poolUpdate();
+
 protected:
 	handle_t generateHandle();
 	bool addRequest(QueuedRequest* req);
@@ -208,6 +219,11 @@ protected:
 	request_hash_t mRequestHash;
 
 	handle_t mNextHandle;
+
+	LLThreadPool* mThreadPool; // non-NULL when running on a shared pool instead of our own thread
+	BOOL mPoolUpdateQueued; // a poolUpdate() task is queued or running, guarded by lockData()
+
+	static LLThreadPool* sThreadPool;
 };
 
 #endif // LL_LLQUEUEDTHREAD_H
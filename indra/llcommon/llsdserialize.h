@@ -791,6 +791,10 @@ public:
 		return fromXMLEmbedded(sd, str, emit_errors);
 //		return fromXMLDocument(sd, str, emit_errors);
 	}
+	// Single pass parser for a complete XML document already in
+	// memory.  Several times faster than fromXML() on large documents;
+	// anything unusual is handed on to fromXML().
+	static S32 fromXMLBuffer(LLSD& sd, const char* buf, size_t len, bool emit_errors=true);
 
 	/*
 	 * Binary Methods
@@ -29,8 +29,12 @@
 
 #include <iostream>
 #include <deque>
+#include <algorithm>
+#include <clocale>
+#include <cmath>
 
 #include "apr_base64.h"
+#include "llmemorystream.h"
 #include <boost/regex.hpp>
 
 extern "C"
@@ -899,6 +903,685 @@ LLSDXMLParser::Impl::Element LLSDXMLParser::Impl::readElement(const XML_Char* na
 
 
 
+/**
+ * LLSDXMLFastParser
+ *
+ * Single pass tokenizer for a complete LLSD XML document held in
+ * memory.  Values are written straight into the result, text is only
+ * copied when it becomes a string, key, uuid, date or uri, and base64
+ * is decoded directly into the binary buffer.  Anything outside the
+ * plain LLSD subset (DTDs, CDATA, unknown elements, stray keys, named
+ * entities, malformed utf-8) makes it give up so the caller can fall
+ * back to the expat based LLSDXMLParser, which remains the reference.
+ */
+class LLSDXMLFastParser
+{
+public:
+	enum
+	{
+		PARSE_FALLBACK = -2
+	};
+
+	LLSDXMLFastParser(const char* buf, size_t len);
+
+	// Returns the number of LLSD objects parsed into data, or
+	// PARSE_FALLBACK if the document has to go through expat.
+	S32 parse(LLSD& data);
+
+private:
+	enum Element {
+		ELEMENT_LLSD,
+		ELEMENT_UNDEF,
+		ELEMENT_BOOL,
+		ELEMENT_INTEGER,
+		ELEMENT_REAL,
+		ELEMENT_STRING,
+		ELEMENT_UUID,
+		ELEMENT_DATE,
+		ELEMENT_URI,
+		ELEMENT_BINARY,
+		ELEMENT_MAP,
+		ELEMENT_ARRAY,
+		ELEMENT_KEY,
+		ELEMENT_UNKNOWN
+	};
+	static Element readElement(const char* name, size_t len);
+
+	bool skipMisc();
+	bool readTag(Element& element, bool& closing, bool& empty);
+	bool readContent(const char*& begin, const char*& end, bool& plain);
+	bool readClose(Element element);
+	bool decodeText(const char* begin, const char* end, bool plain);
+	bool setValue(Element element, const char* begin, const char* end, bool plain, LLSD& value);
+	bool decodeBase64(const char* begin, const char* end, LLSD& value);
+
+	const char* find(const char* token, size_t len) const;
+	static bool isSpace(char c)
+	{
+		return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+	}
+	// Conservative ascii-only subset of the xml name characters
+	static bool isNameStart(char c)
+	{
+		return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':');
+	}
+	static bool isNameChar(char c)
+	{
+		return (isNameStart(c) || (c >= '0' && c <= '9') || c == '-' || c == '.');
+	}
+	void skipSpace()
+	{
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+	}
+
+	const char* mCur;
+	const char* mEnd;
+	bool mDotDecimal;		// true if the C locale, which strtod() reads with, uses a '.' decimal point
+	bool mBase64;			// false if the last tag had a non base64 encoding
+	std::string mText;		// scratch buffer for decoded text
+};
+
+LLSDXMLFastParser::LLSDXMLFastParser(const char* buf, size_t len)
+:	mCur(buf),
+	mEnd(buf + len),
+	mBase64(true)
+{
+	const struct lconv* lc = localeconv();
+	mDotDecimal = (lc && lc->decimal_point && 0 == strcmp(lc->decimal_point, "."));
+}
+
+// static
+LLSDXMLFastParser::Element LLSDXMLFastParser::readElement(const char* name, size_t len)
+{
+	switch (len)
+	{
+		case 3:
+			if (!strncmp(name, "key", 3)) { return ELEMENT_KEY; }
+			if (!strncmp(name, "map", 3)) { return ELEMENT_MAP; }
+			if (!strncmp(name, "uri", 3)) { return ELEMENT_URI; }
+			break;
+		case 4:
+			if (!strncmp(name, "real", 4)) { return ELEMENT_REAL; }
+			if (!strncmp(name, "uuid", 4)) { return ELEMENT_UUID; }
+			if (!strncmp(name, "llsd", 4)) { return ELEMENT_LLSD; }
+			if (!strncmp(name, "date", 4)) { return ELEMENT_DATE; }
+			break;
+		case 5:
+			if (!strncmp(name, "array", 5)) { return ELEMENT_ARRAY; }
+			if (!strncmp(name, "undef", 5)) { return ELEMENT_UNDEF; }
+			break;
+		case 6:
+			if (!strncmp(name, "binary", 6)) { return ELEMENT_BINARY; }
+			if (!strncmp(name, "string", 6)) { return ELEMENT_STRING; }
+			break;
+		case 7:
+			if (!strncmp(name, "integer", 7)) { return ELEMENT_INTEGER; }
+			if (!strncmp(name, "boolean", 7)) { return ELEMENT_BOOL; }
+			break;
+	}
+	return ELEMENT_UNKNOWN;
+}
+
+const char* LLSDXMLFastParser::find(const char* token, size_t len) const
+{
+	const char* found = std::search(mCur, mEnd, token, token + len);
+	return (found == mEnd) ? NULL : found;
+}
+
+// Skips whitespace, the xml declaration, processing instructions and
+// comments.  Leaves mCur on the '<' of the next tag.
+bool LLSDXMLFastParser::skipMisc()
+{
+	while (true)
+	{
+		skipSpace();
+		if (mEnd - mCur < 2 || *mCur != '<')
+		{
+			return false;
+		}
+		if (mCur[1] == '?')
+		{
+			const char* close = find("?>", 2);
+			if (!close) { return false; }
+			mCur = close + 2;
+		}
+		else if (mCur[1] == '!')
+		{
+			// DOCTYPE and CDATA are left to expat
+			if (mEnd - mCur < 4 || strncmp(mCur, "<!--", 4)) { return false; }
+			mCur += 4;
+			const char* close = find("-->", 3);
+			if (!close) { return false; }
+			mCur = close + 3;
+		}
+		else
+		{
+			return true;
+		}
+	}
+}
+
+bool LLSDXMLFastParser::readTag(Element& element, bool& closing, bool& empty)
+{
+	// mCur is on '<'
+	++mCur;
+	closing = (mCur < mEnd && *mCur == '/');
+	if (closing)
+	{
+		++mCur;
+	}
+	else
+	{
+		mBase64 = true;
+	}
+	empty = false;
+
+	const char* name = mCur;
+	while (mCur < mEnd && isNameChar(*mCur))
+	{
+		++mCur;
+	}
+	element = readElement(name, mCur - name);
+	if (element == ELEMENT_UNKNOWN || mCur >= mEnd
+		|| !(isSpace(*mCur) || *mCur == '>' || *mCur == '/'))
+	{
+		return false;
+	}
+
+	while (true)
+	{
+		skipSpace();
+		if (mCur >= mEnd) { return false; }
+		if (*mCur == '>')
+		{
+			++mCur;
+			return true;
+		}
+		if (closing) { return false; }
+		if (*mCur == '/')
+		{
+			if (mEnd - mCur < 2 || mCur[1] != '>') { return false; }
+			mCur += 2;
+			empty = true;
+			return true;
+		}
+
+		// attribute, which has to be separated from what precedes it
+		const char* attr = mCur;
+		if (!isSpace(attr[-1]) || !isNameStart(*mCur)) { return false; }
+		while (mCur < mEnd && isNameChar(*mCur))
+		{
+			++mCur;
+		}
+		size_t attr_len = mCur - attr;
+		skipSpace();
+		if (mCur >= mEnd || *mCur != '=') { return false; }
+		++mCur;
+		skipSpace();
+		if (mCur >= mEnd || (*mCur != '"' && *mCur != '\'')) { return false; }
+		const char quote = *mCur++;
+		const char* value = mCur;
+		while (mCur < mEnd && *mCur != quote)
+		{
+			if (*mCur == '<' || *mCur == '&') { return false; }
+			++mCur;
+		}
+		if (mCur >= mEnd) { return false; }
+		if (attr_len == 8 && !strncmp(attr, "encoding", 8))
+		{
+			mBase64 = (mCur - value == 6 && !strncmp(value, "base64", 6));
+		}
+		++mCur;
+	}
+}
+
+// Finds the character data running up to the next tag.  plain is
+// cleared if it holds anything that needs decoding.
+bool LLSDXMLFastParser::readContent(const char*& begin, const char*& end, bool& plain)
+{
+	begin = mCur;
+	plain = true;
+	for (; mCur < mEnd; ++mCur)
+	{
+		const U8 c = (U8)*mCur;
+		if (c == '<')
+		{
+			end = mCur;
+			return true;
+		}
+		if (c == '&' || c == '\r' || c >= 0x80)
+		{
+			plain = false;
+		}
+		else if (c < 0x20 && c != '\t' && c != '\n')
+		{
+			return false;
+		}
+	}
+	return false;
+}
+
+bool LLSDXMLFastParser::readClose(Element element)
+{
+	Element closed;
+	bool closing, empty;
+	return (mEnd - mCur >= 2 && mCur[1] == '/'
+			&& readTag(closed, closing, empty)
+			&& closed == element);
+}
+
+// Decodes entities, normalizes line ends and validates utf-8 the way
+// expat does, into mText.
+bool LLSDXMLFastParser::decodeText(const char* begin, const char* end, bool plain)
+{
+	if (plain)
+	{
+		mText.assign(begin, end);
+		return true;
+	}
+
+	mText.clear();
+	mText.reserve(end - begin);
+	const char* p = begin;
+	while (p < end)
+	{
+		const U8 c = (U8)*p;
+		if (c == '\r')
+		{
+			mText += '\n';
+			++p;
+			if (p < end && *p == '\n') { ++p; }
+		}
+		else if (c == '&')
+		{
+			const char* semi = std::find(p, end, ';');
+			if (semi == end) { return false; }
+			const char* name = p + 1;
+			size_t len = semi - name;
+			p = semi + 1;
+			if (len == 2 && !strncmp(name, "lt", 2)) { mText += '<'; }
+			else if (len == 2 && !strncmp(name, "gt", 2)) { mText += '>'; }
+			else if (len == 3 && !strncmp(name, "amp", 3)) { mText += '&'; }
+			else if (len == 4 && !strncmp(name, "apos", 4)) { mText += '\''; }
+			else if (len == 4 && !strncmp(name, "quot", 4)) { mText += '"'; }
+			else if (len >= 2 && name[0] == '#')
+			{
+				U32 code = 0;
+				bool hex = (name[1] == 'x');
+				const char* digit = name + (hex ? 2 : 1);
+				if (digit == semi || semi - digit > 8) { return false; }
+				for (; digit < semi; ++digit)
+				{
+					char d = *digit;
+					if (d >= '0' && d <= '9') { code = code * (hex ? 16 : 10) + (d - '0'); }
+					else if (hex && d >= 'a' && d <= 'f') { code = code * 16 + (d - 'a' + 10); }
+					else if (hex && d >= 'A' && d <= 'F') { code = code * 16 + (d - 'A' + 10); }
+					else { return false; }
+				}
+				if (code < 0x80)
+				{
+					if (code < 0x20 && code != 0x9 && code != 0xA && code != 0xD) { return false; }
+					mText += (char)code;
+				}
+				else if (code < 0x800)
+				{
+					mText += (char)(0xC0 | (code >> 6));
+					mText += (char)(0x80 | (code & 0x3F));
+				}
+				else if (code < 0x10000)
+				{
+					if ((code >= 0xD800 && code <= 0xDFFF) || code >= 0xFFFE) { return false; }
+					mText += (char)(0xE0 | (code >> 12));
+					mText += (char)(0x80 | ((code >> 6) & 0x3F));
+					mText += (char)(0x80 | (code & 0x3F));
+				}
+				else if (code <= 0x10FFFF)
+				{
+					mText += (char)(0xF0 | (code >> 18));
+					mText += (char)(0x80 | ((code >> 12) & 0x3F));
+					mText += (char)(0x80 | ((code >> 6) & 0x3F));
+					mText += (char)(0x80 | (code & 0x3F));
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (c >= 0x80)
+		{
+			// validate one utf-8 sequence
+			size_t count;
+			U8 lo = 0x80, hi = 0xBF;
+			if (c >= 0xC2 && c <= 0xDF) { count = 1; }
+			else if (c >= 0xE0 && c <= 0xEF)
+			{
+				count = 2;
+				if (c == 0xE0) { lo = 0xA0; }
+				if (c == 0xED) { hi = 0x9F; }
+			}
+			else if (c >= 0xF0 && c <= 0xF4)
+			{
+				count = 3;
+				if (c == 0xF0) { lo = 0x90; }
+				if (c == 0xF4) { hi = 0x8F; }
+			}
+			else
+			{
+				return false;
+			}
+			if ((size_t)(end - p) <= count) { return false; }
+			U8 next = (U8)p[1];
+			if (next < lo || next > hi) { return false; }
+			for (size_t i = 2; i <= count; ++i)
+			{
+				if (((U8)p[i] & 0xC0) != 0x80) { return false; }
+			}
+			// U+FFFE and U+FFFF are not xml characters
+			if (c == 0xEF && next == 0xBF && (U8)p[2] >= 0xBE) { return false; }
+			mText.append(p, count + 1);
+			p += count + 1;
+		}
+		else
+		{
+			mText += (char)c;
+			++p;
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	// Same alphabet as apr_base64_decode_binary(): whitespace is
+	// skipped and decoding stops at the first other character.
+	struct Base64DecodeTable
+	{
+		Base64DecodeTable()
+		{
+			memset(mDecode, -1, sizeof(mDecode));
+			const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			for (S8 i = 0; i < 64; ++i)
+			{
+				mDecode[(U8)alphabet[i]] = i;
+			}
+			mDecode[(U8)' '] = mDecode[(U8)'\t'] = mDecode[(U8)'\n'] = mDecode[(U8)'\r'] = -2;
+		}
+
+		S8 mDecode[256];
+	};
+}
+
+bool LLSDXMLFastParser::decodeBase64(const char* begin, const char* end, LLSD& value)
+{
+	// parsers run on several threads, the table is built once by the
+	// initialization of the local static
+	static const Base64DecodeTable sTable;
+	const S8* decode = sTable.mDecode;
+
+	LLSD::Binary data;
+	data.reserve(((end - begin) / 4) * 3 + 2);
+	U32 bits = 0;
+	S32 nbits = 0;
+	for (const char* p = begin; p < end; ++p)
+	{
+		S8 d = decode[(U8)*p];
+		if (d == -2) { continue; }
+		if (d < 0) { break; }
+		bits = (bits << 6) | (U32)d;
+		nbits += 6;
+		if (nbits >= 8)
+		{
+			nbits -= 8;
+			data.push_back((U8)(bits >> nbits));
+		}
+	}
+	value = data;
+	return true;
+}
+
+bool LLSDXMLFastParser::setValue(Element element, const char* begin, const char* end, bool plain, LLSD& value)
+{
+	switch (element)
+	{
+		case ELEMENT_UNDEF:
+			value.clear();
+			return true;
+
+		case ELEMENT_BOOL:
+			if (!decodeText(begin, end, plain)) { return false; }
+			value = (mText == "true" || mText == "1");
+			return true;
+
+		case ELEMENT_INTEGER:
+		{
+			if (plain)
+			{
+				// Inline equivalent of sscanf("%d") for values that
+				// cannot overflow.
+				const char* p = begin;
+				while (p < end && (*p == ' ' || *p == '\t' || *p == '\n')) { ++p; }
+				bool negative = (p < end && *p == '-');
+				if (p < end && (*p == '-' || *p == '+')) { ++p; }
+				const char* digits = p;
+				S32 i = 0;
+				while (p < end && p - digits < 9 && *p >= '0' && *p <= '9')
+				{
+					i = i * 10 + (*p++ - '0');
+				}
+				if (p != digits && (p == end || *p < '0' || *p > '9'))
+				{
+					value = negative ? -i : i;
+					return true;
+				}
+			}
+			if (!decodeText(begin, end, plain)) { return false; }
+			S32 i;
+			if (sscanf(mText.c_str(), "%d", &i) == 1)
+			{
+				value = i;
+			}
+			else
+			{
+				value = LLSD(mText).asInteger();
+			}
+			return true;
+		}
+
+		case ELEMENT_REAL:
+		{
+			if (plain && mDotDecimal)
+			{
+				// Only hand strtod() what std::istream would accept
+				// in full, so both give the same double.
+				const char* p = begin;
+				while (p < end && (*p == ' ' || *p == '\t' || *p == '\n')) { ++p; }
+				const char* start = p;
+				if (p < end && (*p == '-' || *p == '+')) { ++p; }
+				const char* mantissa = p;
+				while (p < end && *p >= '0' && *p <= '9') { ++p; }
+				bool digits = (p != mantissa);
+				if (p < end && *p == '.')
+				{
+					const char* fraction = ++p;
+					while (p < end && *p >= '0' && *p <= '9') { ++p; }
+					digits = digits || (p != fraction);
+				}
+				if (digits && p < end && (*p == 'e' || *p == 'E'))
+				{
+					++p;
+					if (p < end && (*p == '-' || *p == '+')) { ++p; }
+					const char* exponent = p;
+					while (p < end && *p >= '0' && *p <= '9') { ++p; }
+					digits = (p != exponent);
+				}
+				if (digits && p == end)
+				{
+					// the content is terminated by the '<' of its end tag
+					F64 r = strtod(start, NULL);
+					if (!std::isinf(r))
+					{
+						value = r;
+						return true;
+					}
+				}
+			}
+			if (!decodeText(begin, end, plain)) { return false; }
+			value = LLSD(mText).asReal();
+			return true;
+		}
+
+		case ELEMENT_STRING:
+			if (!decodeText(begin, end, plain)) { return false; }
+			value = mText;
+			return true;
+
+		case ELEMENT_UUID:
+			if (!decodeText(begin, end, plain)) { return false; }
+			value = LLUUID(mText);
+			return true;
+
+		case ELEMENT_DATE:
+			if (!decodeText(begin, end, plain)) { return false; }
+			value = LLDate(mText);
+			return true;
+
+		case ELEMENT_URI:
+			if (!decodeText(begin, end, plain)) { return false; }
+			value = LLURI(mText);
+			return true;
+
+		case ELEMENT_BINARY:
+			if (!mBase64) { return false; }
+			if (plain) { return decodeBase64(begin, end, value); }
+			if (!decodeText(begin, end, plain)) { return false; }
+			return decodeBase64(mText.data(), mText.data() + mText.size(), value);
+
+		default:
+			return false;
+	}
+}
+
+S32 LLSDXMLFastParser::parse(LLSD& data)
+{
+	Element element;
+	bool closing, empty;
+	if (!skipMisc() || !readTag(element, closing, empty)
+		|| closing || element != ELEMENT_LLSD)
+	{
+		return PARSE_FALLBACK;
+	}
+
+	LLSD result;
+	S32 parse_count = 0;
+	if (!empty)
+	{
+		std::vector<LLSD*> stack;
+		std::string key;
+		bool have_key = false;
+		bool have_result = false;
+		while (true)
+		{
+			if (!skipMisc() || !readTag(element, closing, empty))
+			{
+				return PARSE_FALLBACK;
+			}
+
+			if (closing)
+			{
+				if (stack.empty())
+				{
+					if (element != ELEMENT_LLSD) { return PARSE_FALLBACK; }
+					break;
+				}
+				LLSD* top = stack.back();
+				if (!((element == ELEMENT_MAP && top->isMap() && !have_key)
+					  || (element == ELEMENT_ARRAY && top->isArray())))
+				{
+					return PARSE_FALLBACK;
+				}
+				stack.pop_back();
+				continue;
+			}
+
+			if (element == ELEMENT_KEY)
+			{
+				const char* begin;
+				const char* end;
+				bool plain;
+				if (empty || have_key || stack.empty() || !stack.back()->isMap()
+					|| !readContent(begin, end, plain) || !readClose(ELEMENT_KEY)
+					|| !decodeText(begin, end, plain) || mText.empty())
+				{
+					return PARSE_FALLBACK;
+				}
+				key.swap(mText);
+				have_key = true;
+				continue;
+			}
+			if (element == ELEMENT_LLSD || element == ELEMENT_UNKNOWN)
+			{
+				return PARSE_FALLBACK;
+			}
+
+			// everything else is a value, find where it goes
+			LLSD* value;
+			if (stack.empty())
+			{
+				if (have_result) { return PARSE_FALLBACK; }
+				have_result = true;
+				value = &result;
+			}
+			else if (stack.back()->isMap())
+			{
+				if (!have_key) { return PARSE_FALLBACK; }
+				value = &(*stack.back())[key];
+				have_key = false;
+			}
+			else
+			{
+				LLSD& array = *stack.back();
+				array.append(LLSD());
+				value = &array[array.size() - 1];
+			}
+			++parse_count;
+
+			if (element == ELEMENT_MAP || element == ELEMENT_ARRAY)
+			{
+				*value = (element == ELEMENT_MAP) ? LLSD::emptyMap() : LLSD::emptyArray();
+				if (!empty)
+				{
+					stack.push_back(value);
+				}
+				continue;
+			}
+
+			const char* begin = mCur;
+			const char* end = mCur;
+			bool plain = true;
+			if (!empty && (!readContent(begin, end, plain) || !readClose(element)))
+			{
+				return PARSE_FALLBACK;
+			}
+			if (!setValue(element, begin, end, plain, *value))
+			{
+				return PARSE_FALLBACK;
+			}
+		}
+	}
+
+	data = result;
+	return parse_count;
+}
+
+
 /**
  * LLSDXMLParser
  */
@@ -937,3 +1620,17 @@ void LLSDXMLParser::doReset()
 {
 	impl.reset();
 }
+
+// static
+S32 LLSDSerialize::fromXMLBuffer(LLSD& sd, const char* buf, size_t len, bool emit_errors)
+{
+	LLSDXMLFastParser fast(buf, len);
+	S32 parse_count = fast.parse(sd);
+	if (parse_count != LLSDXMLFastParser::PARSE_FALLBACK)
+	{
+		return parse_count;
+	}
+
+	LLMemoryStream str((const U8*)buf, (S32)len);
+	return fromXML(sd, str, emit_errors);
+}
@@ -0,0 +1,426 @@
+/**
+ * @file llthreadpool.cpp
+ * @brief Shared work-stealing pool of worker threads
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llthreadpool.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "llformat.h"
+#include "llqueuedthread.h"
+#include "lltimer.h"	// ms_sleep()
+#include "lltracethreadrecorder.h"
+
+// How often a busy worker hands its trace recordings to the main thread
+static const F64 RECORDER_PUSH_INTERVAL = 0.1;
+
+//static
+LLThreadPool* LLThreadPool::sInstance = NULL;
+
+//============================================================================
+
+LLThreadPool::TaskQueue::TaskQueue()
+:	mMutex(NULL)
+{
+	for (S32 i = 0; i < PRIORITY_COUNT; ++i)
+	{
+		mCount[i] = 0;
+	}
+}
+
+LLThreadPool::Worker::Worker(LLThreadPool& pool, S32 index)
+:	LLThread(llformat("%s %d", pool.getName().c_str(), index)),
+	mPool(pool),
+	mIndex(index)
+{
+}
+
+// virtual
+void LLThreadPool::Worker::run()
+{
+	LLTimer push_timer;
+	while (!isQuitting())
+	{
+		Task* task = mPool.takeTask(mIndex);
+		if (task)
+		{
+			mPool.runTask(task);
+			if (push_timer.getElapsedTimeF64() < RECORDER_PUSH_INTERVAL)
+			{
+				continue;
+			}
+		}
+
+		LLTrace::get_thread_recorder()->pushToParent();
+		push_timer.reset();
+
+		if (!task)
+		{
+			mPool.waitForWork();
+		}
+	}
+	LL_INFOS() << "LLThreadPool worker " << mName << " EXITING." << LL_ENDL;
+}
+
+//============================================================================
+
+LLThreadPool::LLThreadPool(const std::string& name, S32 num_workers)
+:	mName(name),
+	mQueued(0),
+	mPending(0),
+	mSleeping(0),
+	mNextQueue(0),
+	mQuitting(FALSE),
+	mMainMutex(NULL)
+{
+	if (num_workers <= 0)
+	{
+		num_workers = (S32)boost::thread::hardware_concurrency() - 1;
+	}
+	num_workers = llmax(num_workers, 1);
+
+	mWorkCondition = new LLCondition(NULL);
+	for (S32 i = 0; i < num_workers; ++i)
+	{
+		mQueues.push_back(new TaskQueue());
+	}
+	// Queues first: a worker looks at its siblings' queues as soon as it runs
+	for (S32 i = 0; i < num_workers; ++i)
+	{
+		mWorkers.push_back(new Worker(*this, i));
+	}
+	for (S32 i = 0; i < num_workers; ++i)
+	{
+		mWorkers[i]->start();
+	}
+
+	LL_INFOS() << "LLThreadPool " << mName << " started " << num_workers << " workers" << LL_ENDL;
+}
+
+LLThreadPool::~LLThreadPool()
+{
+	shutdown();
+
+	delete mWorkCondition;
+	mWorkCondition = NULL;
+}
+
+void LLThreadPool::shutdown()
+{
+	if (mWorkers.empty())
+	{
+		return;
+	}
+
+	mQuitting = TRUE;
+	for (size_t i = 0; i < mWorkers.size(); ++i)
+	{
+		mWorkers[i]->quit();
+	}
+	mWorkCondition->lock();
+	mWorkCondition->broadcast();
+	mWorkCondition->unlock();
+
+	// ~LLThread() waits for each worker to finish its current task
+	for (size_t i = 0; i < mWorkers.size(); ++i)
+	{
+		delete mWorkers[i];
+	}
+	mWorkers.clear();
+
+	S32 dropped = 0;
+	for (size_t i = 0; i < mQueues.size(); ++i)
+	{
+		TaskQueue* queue = mQueues[i];
+		for (S32 pri = 0; pri < PRIORITY_COUNT; ++pri)
+		{
+			dropped += (S32)queue->mTasks[pri].size();
+			for (std::deque<Task*>::iterator iter = queue->mTasks[pri].begin();
+				 iter != queue->mTasks[pri].end(); ++iter)
+			{
+				delete *iter;
+			}
+		}
+		delete queue;
+	}
+	mQueues.clear();
+	mQueued = 0;
+	mPending = 0;
+
+	if (dropped)
+	{
+		LL_WARNS() << "LLThreadPool " << mName << " shut down with " << dropped << " queued tasks" << LL_ENDL;
+	}
+}
+
+//----------------------------------------------------------------------------
+
+void LLThreadPool::submit(const task_t& task, EPriority priority,
+						  const token_ptr_t& token, const task_t& continuation)
+{
+	if (mQuitting.CurrentValue())
+	{
+		return;
+	}
+	llassert(priority >= 0 && priority < PRIORITY_COUNT);
+
+	Task* entry = new Task;
+	entry->mWork = task;
+	entry->mContinuation = continuation;
+	entry->mToken = token;
+
+	// Work spawned by a worker stays with it until somebody steals it
+	S32 index = currentWorkerIndex();
+	if (index < 0)
+	{
+		index = (S32)((mNextQueue++) % (U32)mQueues.size());
+	}
+	TaskQueue& queue = *mQueues[index];
+
+	mPending++;
+	{
+		LLMutexLock lock(&queue.mMutex);
+		queue.mTasks[priority].push_back(entry);
+		queue.mCount[priority]++;
+		mQueued++;
+	}
+
+	if (mSleeping.CurrentValue() > 0)
+	{
+		mWorkCondition->lock();
+		mWorkCondition->signal();
+		mWorkCondition->unlock();
+	}
+}
+
+void LLThreadPool::postToMain(const task_t& func)
+{
+	LLMutexLock lock(&mMainMutex);
+	mMainQueue.push_back(func);
+}
+
+void LLThreadPool::parallelFor(U32 count, const index_func_t& func, S32 max_helpers)
+{
+	S32 helpers = (S32)llmin(count, (U32)mWorkers.size()) - 1;
+	if (max_helpers >= 0)
+	{
+		helpers = llmin(helpers, max_helpers);
+	}
+	if (helpers <= 0 || mQuitting.CurrentValue())
+	{
+		for (U32 i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	LLPointer<ParallelBatch> batch = new ParallelBatch(count, func);
+	for (S32 i = 0; i < helpers; ++i)
+	{
+		submit(boost::bind(&LLThreadPool::runBatch, batch), PRIORITY_URGENT);
+	}
+	runBatch(batch);
+
+	// Whatever is left is already running on a worker
+	while (batch->mDone.CurrentValue() < count)
+	{
+		LLThread::yield();
+	}
+}
+
+// static
+void LLThreadPool::runBatch(LLPointer<ParallelBatch> batch)
+{
+	while (true)
+	{
+		U32 index = batch->mNext++;
+		if (index >= batch->mCount)
+		{
+			break;
+		}
+		batch->mFunc(index);
+		batch->mDone++;
+	}
+}
+
+// MAIN thread
+S32 LLThreadPool::updateMainThread(F32 max_time_ms)
+{
+	F64 max_time = (F64)max_time_ms * .001;
+	LLTimer timer;
+	while (true)
+	{
+		task_t func;
+		{
+			LLMutexLock lock(&mMainMutex);
+			if (mMainQueue.empty())
+			{
+				return 0;
+			}
+			func = mMainQueue.front();
+			mMainQueue.pop_front();
+		}
+
+		func();
+
+		if (max_time && timer.getElapsedTimeF64() > max_time)
+		{
+			break;
+		}
+	}
+
+	LLMutexLock lock(&mMainMutex);
+	return (S32)mMainQueue.size();
+}
+
+//----------------------------------------------------------------------------
+// Runs on worker threads
+
+LLThreadPool::Task* LLThreadPool::popTask(TaskQueue& queue, S32 priority, bool steal)
+{
+	if (queue.mCount[priority].CurrentValue() <= 0)
+	{
+		return NULL;
+	}
+
+	LLMutexLock lock(&queue.mMutex);
+	std::deque<Task*>& tasks = queue.mTasks[priority];
+	if (tasks.empty())
+	{
+		return NULL;
+	}
+
+	Task* task;
+	if (steal)
+	{
+		task = tasks.back();
+		tasks.pop_back();
+	}
+	else
+	{
+		task = tasks.front();
+		tasks.pop_front();
+	}
+	queue.mCount[priority]--;
+	mQueued--;
+	return task;
+}
+
+LLThreadPool::Task* LLThreadPool::takeTask(S32 index)
+{
+	const S32 num_queues = (S32)mQueues.size();
+	for (S32 pri = PRIORITY_COUNT - 1; pri >= 0; --pri)
+	{
+		Task* task = popTask(*mQueues[index], pri, false);
+		for (S32 i = 1; !task && i < num_queues; ++i)
+		{
+			task = popTask(*mQueues[(index + i) % num_queues], pri, true);
+		}
+		if (task)
+		{
+			return task;
+		}
+	}
+	return NULL;
+}
+
+void LLThreadPool::runTask(Task* task)
+{
+	if (!task->mToken || !task->mToken->isCancelled())
+	{
+		task->mWork();
+
+		if (task->mContinuation && (!task->mToken || !task->mToken->isCancelled()))
+		{
+			postToMain(task->mContinuation);
+		}
+	}
+	delete task;
+	mPending--;
+}
+
+void LLThreadPool::waitForWork()
+{
+	mWorkCondition->lock();
+	mSleeping++;
+	while (mQueued.CurrentValue() <= 0 && !mQuitting.CurrentValue())
+	{
+		mWorkCondition->wait();
+	}
+	mSleeping--;
+	mWorkCondition->unlock();
+}
+
+S32 LLThreadPool::currentWorkerIndex() const
+{
+	U32 id = LLThread::currentID();
+	for (size_t i = 0; i < mWorkers.size(); ++i)
+	{
+		if (mWorkers[i]->getID() == id)
+		{
+			return (S32)i;
+		}
+	}
+	return -1;
+}
+
+//============================================================================
+
+// static
+LLThreadPool::EPriority LLThreadPool::mapPriority(U32 queued_priority)
+{
+	if (queued_priority >= LLQueuedThread::PRIORITY_URGENT)
+	{
+		return PRIORITY_URGENT;
+	}
+	if (queued_priority >= LLQueuedThread::PRIORITY_HIGH)
+	{
+		return PRIORITY_HIGH;
+	}
+	if (queued_priority >= LLQueuedThread::PRIORITY_NORMAL)
+	{
+		return PRIORITY_NORMAL;
+	}
+	return PRIORITY_LOW;
+}
+
+// static
+void LLThreadPool::initClass(S32 num_workers)
+{
+	if (!sInstance)
+	{
+		sInstance = new LLThreadPool("General", num_workers);
+	}
+}
+
+// static
+void LLThreadPool::cleanupClass()
+{
+	delete sInstance;
+	sInstance = NULL;
+}
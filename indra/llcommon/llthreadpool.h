@@ -0,0 +1,205 @@
+/**
+ * @file llthreadpool.h
+ * @brief Shared work-stealing pool of worker threads
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTHREADPOOL_H
+#define LL_LLTHREADPOOL_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "llthread.h"
+#include "llpointer.h"
+
+//============================================================================
+// A fixed set of worker threads shared by every subsystem with background
+// work, so that idle capacity in one is available to the others instead of
+// each owning a mostly sleeping LLThread.
+//
+// Every worker owns one deque per priority level.  Tasks submitted from a
+// worker go to its own deques, tasks submitted from any other thread are
+// dealt out round robin.  A worker always runs the highest priority task it
+// can find: it takes from the front of its own deque first, then steals from
+// the back of its siblings' deques at the same level before looking at
+// lower levels.
+//
+// A task may carry a CancelToken, checked just before the task starts, and a
+// continuation that is queued for the main thread once the task has run.
+// The main thread drains those from updateMainThread().
+
+class LL_COMMON_API LLThreadPool
+{
+public:
+	typedef boost::function<void ()> task_t;
+
+	enum EPriority
+	{
+		PRIORITY_LOW = 0,
+		PRIORITY_NORMAL,
+		PRIORITY_HIGH,
+		PRIORITY_URGENT,
+		PRIORITY_COUNT
+	};
+
+	// Cancelling is advisory: a task that has not started yet is dropped
+	// (along with its continuation), one that is already running can poll
+	// isCancelled() to bail out early.
+	class LL_COMMON_API CancelToken : public LLThreadSafeRefCount
+	{
+	public:
+		CancelToken() : mCancelled(FALSE) {}
+
+		void cancel() { mCancelled = TRUE; }
+		bool isCancelled() const { return mCancelled.CurrentValue() != FALSE; }
+
+	private:
+		LLAtomic32<BOOL> mCancelled;
+	};
+	typedef LLPointer<CancelToken> token_ptr_t;
+
+public:
+	// num_workers <= 0 uses one worker per core, less one for the main thread
+	LLThreadPool(const std::string& name, S32 num_workers = 0);
+	~LLThreadPool();
+
+	// Stops the workers.  Tasks that have not started are discarded without
+	// running their continuations.  Called from the destructor.
+	void shutdown();
+
+	// May be called from any thread
+	void submit(const task_t& task,
+				EPriority priority = PRIORITY_NORMAL,
+				const token_ptr_t& token = token_ptr_t(),
+				const task_t& continuation = task_t());
+
+	// Queue a function for the next updateMainThread(), from any thread
+	void postToMain(const task_t& func);
+
+	// Calls func(0) .. func(count - 1) on the calling thread and up to
+	// max_helpers workers (< 0 for all of them), returning once every call
+	// has finished.  The calling thread works through the items too, so
+	// this makes progress even when every worker is busy elsewhere.  func
+	// must be safe to call concurrently for different indices.
+	typedef boost::function<void (U32)> index_func_t;
+	void parallelFor(U32 count, const index_func_t& func, S32 max_helpers = -1);
+
+	// MAIN THREAD: runs queued continuations until max_time_ms has passed
+	// (0 for no limit), returns the number still waiting.
+	S32 updateMainThread(F32 max_time_ms);
+
+	// Tasks queued or running on the workers
+	S32 getPending() const { return mPending.CurrentValue(); }
+	S32 getNumWorkers() const { return (S32)mWorkers.size(); }
+	const std::string& getName() const { return mName; }
+
+	// Maps an LLQueuedThread::priority_t onto a pool level
+	static EPriority mapPriority(U32 queued_priority);
+
+	// The pool shared by the viewer's background subsystems
+	static void initClass(S32 num_workers = 0);
+	static void cleanupClass();
+	static LLThreadPool* getInstance() { return sInstance; }
+
+private:
+	struct Task
+	{
+		task_t		mWork;
+		task_t		mContinuation;
+		token_ptr_t	mToken;
+	};
+
+	// Per worker deques.  The counts let other workers skip empty levels
+	// without taking the lock.
+	struct TaskQueue
+	{
+		TaskQueue();
+
+		LLMutex				mMutex;
+		std::deque<Task*>	mTasks[PRIORITY_COUNT];
+		LLAtomic32<S32>		mCount[PRIORITY_COUNT];
+	};
+
+	class Worker : public LLThread
+	{
+	public:
+		Worker(LLThreadPool& pool, S32 index);
+
+		void quit() { setQuitting(); }
+
+	protected:
+		/*virtual*/ void run();
+
+	private:
+		LLThreadPool&	mPool;
+		S32				mIndex;
+	};
+	friend class Worker;
+
+	// No copy constructor or copy assignment
+	LLThreadPool(const LLThreadPool&);
+	LLThreadPool& operator=(const LLThreadPool&);
+
+	// Items of one parallelFor(), claimed by whichever thread gets there
+	// first.  Helpers that start after the last item was claimed just return.
+	struct ParallelBatch : public LLThreadSafeRefCount
+	{
+		ParallelBatch(U32 count, const index_func_t& func)
+		:	mFunc(func), mCount(count), mNext(0), mDone(0) {}
+
+		index_func_t	mFunc;
+		U32				mCount;
+		LLAtomic32<U32>	mNext;
+		LLAtomic32<U32>	mDone;
+	};
+	static void runBatch(LLPointer<ParallelBatch> batch);
+
+	Task* popTask(TaskQueue& queue, S32 priority, bool steal);
+	Task* takeTask(S32 index);
+	void runTask(Task* task);
+	void waitForWork();
+	S32 currentWorkerIndex() const;
+
+private:
+	std::string					mName;
+	std::vector<Worker*>		mWorkers;
+	std::vector<TaskQueue*>		mQueues;
+
+	LLCondition*				mWorkCondition;
+	LLAtomic32<S32>				mQueued;		// tasks sitting in a deque
+	LLAtomic32<S32>				mPending;		// tasks queued or running
+	LLAtomic32<S32>				mSleeping;		// workers waiting on mWorkCondition
+	LLAtomic32<U32>				mNextQueue;		// round robin for external submits
+	LLAtomic32<BOOL>			mQuitting;
+
+	LLMutex						mMainMutex;
+	std::deque<task_t>			mMainQueue;
+
+	static LLThreadPool*		sInstance;
+};
+
+#endif // LL_LLTHREADPOOL_H
@@ -1,5 +1,5 @@
 /** 
- * @file llthread.cpp
+ * @file llthreadsafequeue.cpp
  *
  * $LicenseInfo:firstyear=2004&license=viewerlgpl$
  * Second Life Viewer Source Code
@@ -24,10 +24,10 @@
  */
 
 #include "linden_common.h"
-#include <apr_pools.h>
-#include <apr_queue.h>
 #include "llthreadsafequeue.h"
 #include "llexception.h"
+#include "llmutex.h"
+#include "llthread.h"
 
 
 
@@ -36,75 +36,109 @@
 
 
 LLThreadSafeQueueImplementation::LLThreadSafeQueueImplementation(apr_pool_t * pool, unsigned int capacity):
-	mOwnsPool(pool == 0),
-	mPool(pool),
-	mQueue(0)
+	mQueue(capacity),
+	mCondition(new LLCondition(pool)),
+	mPushWaiters(0),
+	mPopWaiters(0),
+	mBlocked(0),
+	mTerminated(FALSE)
 {
-	if(mOwnsPool) {
-		apr_status_t status = apr_pool_create(&mPool, 0);
-		if(status != APR_SUCCESS) LLTHROW(LLThreadSafeQueueError("failed to allocate pool"));
-	} else {
-		; // No op.
-	}
-	
-	apr_status_t status = apr_queue_create(&mQueue, capacity, mPool);
-	if(status != APR_SUCCESS) LLTHROW(LLThreadSafeQueueError("failed to allocate queue"));
+	; // No op.
 }
 
 
 LLThreadSafeQueueImplementation::~LLThreadSafeQueueImplementation()
 {
-	if(mQueue != 0) {
-		if(apr_queue_size(mQueue) != 0) LL_WARNS() << 
-			"terminating queue which still contains " << apr_queue_size(mQueue) <<
-			" elements;" << "memory will be leaked" << LL_ENDL;
-		apr_queue_term(mQueue);
+	if(mQueue.size() != 0) LL_WARNS() << 
+		"terminating queue which still contains " << mQueue.size() <<
+		" elements;" << "memory will be leaked" << LL_ENDL;
+
+	// Kick out anybody still blocked in pushFront() or popBack().
+	mCondition->lock();
+	mTerminated = TRUE;
+	mCondition->broadcast();
+	mCondition->unlock();
+	while(mBlocked.CurrentValue() > 0) {
+		LLThread::yield();
 	}
-	if(mOwnsPool && (mPool != 0)) apr_pool_destroy(mPool);
+
+	delete mCondition;
 }
 
 
 void LLThreadSafeQueueImplementation::pushFront(void * element)
 {
-	apr_status_t status = apr_queue_push(mQueue, element);
-	
-	if(status == APR_EINTR) {
-		LLTHROW(LLThreadSafeQueueInterrupt());
-	} else if(status != APR_SUCCESS) {
-		LLTHROW(LLThreadSafeQueueError("push failed"));
-	} else {
-		; // Success.
+	if(tryPushFront(element)) return;
+
+	mBlocked++;
+	mCondition->lock();
+	mPushWaiters++;
+	bool pushed;
+	// LLCondition::wait() leaves the mutex unable to tell that we hold it
+	// again, so nothing in here may lock it recursively.
+	while(!(pushed = mQueue.tryPush(element)) && !mTerminated.CurrentValue()) {
+		mCondition->wait();
 	}
+	mPushWaiters--;
+	mCondition->unlock();
+	if(pushed) wakeWaiters(mPopWaiters);
+	mBlocked--; // Must not touch this after here.
+
+	if(!pushed) LLTHROW(LLThreadSafeQueueInterrupt());
 }
 
 
 bool LLThreadSafeQueueImplementation::tryPushFront(void * element){
-	return apr_queue_trypush(mQueue, element) == APR_SUCCESS;
+	bool result = mQueue.tryPush(element);
+	if(result) wakeWaiters(mPopWaiters);
+	return result;
 }
 
 
 void * LLThreadSafeQueueImplementation::popBack(void)
 {
 	void * element;
-	apr_status_t status = apr_queue_pop(mQueue, &element);
-
-	if(status == APR_EINTR) {
-		LLTHROW(LLThreadSafeQueueInterrupt());
-	} else if(status != APR_SUCCESS) {
-		LLTHROW(LLThreadSafeQueueError("pop failed"));
-	} else {
-		return element;
+	if(tryPopBack(element)) return element;
+
+	mBlocked++;
+	mCondition->lock();
+	mPopWaiters++;
+	bool popped;
+	while(!(popped = mQueue.tryPop(element)) && !mTerminated.CurrentValue()) {
+		mCondition->wait();
 	}
+	mPopWaiters--;
+	mCondition->unlock();
+	if(popped) wakeWaiters(mPushWaiters);
+	mBlocked--; // Must not touch this after here.
+
+	if(!popped) LLTHROW(LLThreadSafeQueueInterrupt());
+	return element;
 }
 
 
 bool LLThreadSafeQueueImplementation::tryPopBack(void *& element)
 {
-	return apr_queue_trypop(mQueue, &element) == APR_SUCCESS;
+	bool result = mQueue.tryPop(element);
+	if(result) wakeWaiters(mPushWaiters);
+	return result;
 }
 
 
 size_t LLThreadSafeQueueImplementation::size()
 {
-	return apr_queue_size(mQueue);
+	return mQueue.size();
+}
+
+
+void LLThreadSafeQueueImplementation::wakeWaiters(LLAtomic32<S32> & waiters)
+{
+	// Waiters register under the lock before their last try, so either they
+	// see our element or we see them.  Pushers and poppers share the
+	// condition, hence broadcast.
+	if(waiters.CurrentValue() > 0) {
+		mCondition->lock();
+		mCondition->broadcast();
+		mCondition->unlock();
+	}
 }
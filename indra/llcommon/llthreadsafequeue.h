@@ -28,10 +28,12 @@
 #define LL_LLTHREADSAFEQUEUE_H
 
 #include "llexception.h"
+#include "lllockfreequeue.h"
 #include <string>
 
 
 struct apr_pool_t; // From apr_pools.h
+class LLCondition;
 class LLThreadSafeQueueImplementation; // See below.
 
 
@@ -65,12 +67,13 @@ public:
 };
 
 
-struct apr_queue_t; // From apr_queue.h
-
-
 //
 // Implementation details. 
 //
+// Elements live in an LLLockFreeQueue, so the non-blocking calls never take
+// a lock.  The condition is only used to park callers of the blocking calls
+// and is only signalled when somebody is actually parked on it.
+//
 class LL_COMMON_API LLThreadSafeQueueImplementation
 {
 public:
@@ -83,9 +86,14 @@ public:
 	size_t size();
 	
 private:
-	bool mOwnsPool;
-	apr_pool_t * mPool;
-	apr_queue_t * mQueue;
+	void wakeWaiters(LLAtomic32<S32> & waiters);
+
+	LLLockFreeQueue<void *> mQueue;
+	LLCondition * mCondition;
+	LLAtomic32<S32> mPushWaiters;
+	LLAtomic32<S32> mPopWaiters;
+	LLAtomic32<S32> mBlocked; // callers inside pushFront() or popBack()
+	LLAtomic32<BOOL> mTerminated;
 };
 
 
@@ -99,7 +107,7 @@ public:
 	typedef ElementT value_type;
 	
 	// If the pool is set to NULL one will be allocated and managed by this
-	// queue.
+	// queue.  The capacity is rounded up to a power of two.
 	LLThreadSafeQueue(apr_pool_t * pool = 0, unsigned int capacity = 1024);
 	
 	// Add an element to the front of queue (will block if the queue has
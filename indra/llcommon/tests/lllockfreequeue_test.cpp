@@ -0,0 +1,356 @@
+/**
+ * @file lllockfreequeue_test.cpp
+ * @brief Stress tests and contention benchmark for LLLockFreeQueue
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+
+#include "../lllockfreequeue.h"
+#include "../llthreadsafequeue.h"
+#include "../llformat.h"
+#include "../llthread.h"
+#include "../lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// Runs a function on its own LLThread
+	class FuncThread : public LLThread
+	{
+	public:
+		FuncThread(const std::string& name, const boost::function<void ()>& func)
+		:	LLThread(name),
+			mFunc(func)
+		{
+		}
+
+		/*virtual*/ void run()
+		{
+			mFunc();
+		}
+
+	private:
+		boost::function<void ()> mFunc;
+	};
+
+	void run_threads(const std::vector<boost::function<void ()> >& funcs)
+	{
+		std::vector<FuncThread*> threads;
+		for (size_t i = 0; i < funcs.size(); ++i)
+		{
+			threads.push_back(new FuncThread(llformat("queue test %d", (S32)i), funcs[i]));
+		}
+		for (size_t i = 0; i < threads.size(); ++i)
+		{
+			threads[i]->start();
+		}
+		for (size_t i = 0; i < threads.size(); ++i)
+		{
+			while (!threads[i]->isStopped())
+			{
+				ms_sleep(1);
+			}
+			delete threads[i];
+		}
+	}
+
+	// What the apr queue behind the old LLThreadSafeQueue amounted to
+	class MutexQueue
+	{
+	public:
+		MutexQueue(U32 capacity) : mMutex(NULL), mCapacity(capacity) {}
+
+		bool tryPush(U32 value)
+		{
+			LLMutexLock lock(&mMutex);
+			if (mQueue.size() >= mCapacity)
+			{
+				return false;
+			}
+			mQueue.push_back(value);
+			return true;
+		}
+
+		bool tryPop(U32& value)
+		{
+			LLMutexLock lock(&mMutex);
+			if (mQueue.empty())
+			{
+				return false;
+			}
+			value = mQueue.front();
+			mQueue.pop_front();
+			return true;
+		}
+
+	private:
+		LLMutex mMutex;
+		std::deque<U32> mQueue;
+		size_t mCapacity;
+	};
+
+	// Producers push the values first..first+count-1 (never 0)
+	template<typename QueueT>
+	void produce(QueueT* queue, U32 first, U32 count)
+	{
+		for (U32 value = first; value < first + count; ++value)
+		{
+			while (!queue->tryPush(value))
+			{
+				LLThread::yield();
+			}
+		}
+	}
+
+	// Consumers pop until the shared total reaches expected, marking each
+	// value in seen and counting anything popped twice
+	template<typename QueueT>
+	void consume(QueueT* queue, LLAtomic32<U32>* popped, U32 expected,
+				 std::vector<LLAtomic32<U32> >* seen, LLAtomic32<U32>* duplicates)
+	{
+		U32 value;
+		while (popped->CurrentValue() < expected)
+		{
+			if (queue->tryPop(value))
+			{
+				if (seen && (*seen)[value - 1]++ != 0)
+				{
+					(*duplicates)++;
+				}
+				(*popped)++;
+			}
+			else
+			{
+				LLThread::yield();
+			}
+		}
+	}
+
+	// Half the threads produce, half consume.  Returns elapsed seconds.
+	template<typename QueueT>
+	F64 run_contention(QueueT& queue, S32 num_threads, U32 per_producer,
+					   std::vector<LLAtomic32<U32> >* seen, LLAtomic32<U32>* duplicates)
+	{
+		S32 producers = llmax(num_threads / 2, 1);
+		S32 consumers = llmax(num_threads - producers, 1);
+		U32 total = per_producer * producers;
+		LLAtomic32<U32> popped(0);
+
+		std::vector<boost::function<void ()> > funcs;
+		for (S32 i = 0; i < producers; ++i)
+		{
+			funcs.push_back(boost::bind(produce<QueueT>, &queue, 1 + i * per_producer, per_producer));
+		}
+		for (S32 i = 0; i < consumers; ++i)
+		{
+			funcs.push_back(boost::bind(consume<QueueT>, &queue, &popped, total, seen, duplicates));
+		}
+
+		LLTimer timer;
+		run_threads(funcs);
+		return timer.getElapsedTimeF64();
+	}
+}
+
+namespace tut
+{
+	struct lockfreequeue_data
+	{
+	};
+	typedef test_group<lockfreequeue_data> lockfreequeue_group;
+	typedef lockfreequeue_group::object lockfreequeue_object;
+	lockfreequeue_group lockfreequeue_test("LLLockFreeQueue");
+
+	template<> template<>
+	void lockfreequeue_object::test<1>()
+	{
+		set_test_name("single thread FIFO, full and empty");
+
+		LLLockFreeQueue<S32> queue(5);
+		ensure_equals("capacity rounded up", queue.capacity(), 8U);
+		ensure("starts empty", queue.empty());
+
+		S32 value = 0;
+		ensure("pop from empty", !queue.tryPop(value));
+
+		// Go round the ring a few times
+		for (S32 lap = 0; lap < 4; ++lap)
+		{
+			for (S32 i = 0; i < 8; ++i)
+			{
+				ensure("push", queue.tryPush(lap * 100 + i));
+			}
+			ensure("push when full", !queue.tryPush(-1));
+			ensure_equals("size when full", queue.size(), 8U);
+			for (S32 i = 0; i < 8; ++i)
+			{
+				ensure("pop", queue.tryPop(value));
+				ensure_equals("FIFO order", value, lap * 100 + i);
+			}
+			ensure("pop when drained", !queue.tryPop(value));
+		}
+	}
+
+	template<> template<>
+	void lockfreequeue_object::test<2>()
+	{
+		set_test_name("every value popped exactly once under contention");
+
+		const U32 PER_PRODUCER = 50000;
+		const S32 thread_counts[] = { 2, 4, 8, 16, 32 };
+		for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+		{
+			S32 num_threads = thread_counts[t];
+			U32 total = PER_PRODUCER * (num_threads / 2);
+			std::vector<LLAtomic32<U32> > seen(total);
+			for (U32 i = 0; i < total; ++i)
+			{
+				seen[i] = 0;
+			}
+			LLAtomic32<U32> duplicates(0);
+
+			// Small capacity so that producers keep running into a full queue
+			LLLockFreeQueue<U32> queue(64);
+			run_contention(queue, num_threads, PER_PRODUCER, &seen, &duplicates);
+
+			U32 missing = 0;
+			for (U32 i = 0; i < total; ++i)
+			{
+				if (seen[i].CurrentValue() != 1)
+				{
+					++missing;
+				}
+			}
+			std::string msg = llformat("%d threads", num_threads);
+			ensure_equals(msg + ": duplicates", duplicates.CurrentValue(), 0U);
+			ensure_equals(msg + ": missing", missing, 0U);
+			ensure(msg + ": drained", queue.empty());
+		}
+	}
+
+	template<> template<>
+	void lockfreequeue_object::test<3>()
+	{
+		set_test_name("LLPriorityBucketQueue pops the highest level first");
+
+		LLPriorityBucketQueue<S32> queue(4, 16);
+		ensure_equals("levels", queue.getNumLevels(), 4U);
+		ensure("push", queue.tryPush(10, 0));
+		ensure("push", queue.tryPush(30, 3));
+		ensure("push", queue.tryPush(20, 1));
+		ensure("push", queue.tryPush(31, 3));
+		ensure("push", queue.tryPush(11, 0));
+		ensure_equals("size", queue.size(), 5U);
+		ensure_equals("level size", queue.size(3), 2U);
+
+		S32 value;
+		ensure("pop above min level", queue.tryPop(value, 2));
+		ensure_equals("highest level first", value, 30);
+		ensure("pop above min level", queue.tryPop(value, 2));
+		ensure_equals("FIFO within level", value, 31);
+		ensure("nothing left at or above min level", !queue.tryPop(value, 2));
+
+		const S32 expected[] = { 20, 10, 11 };
+		for (S32 i = 0; i < 3; ++i)
+		{
+			ensure("pop", queue.tryPop(value));
+			ensure_equals("order", value, expected[i]);
+		}
+		ensure("empty", queue.empty() && !queue.tryPop(value));
+	}
+
+	template<> template<>
+	void lockfreequeue_object::test<4>()
+	{
+		set_test_name("LLThreadSafeQueue blocking calls");
+
+		LLThreadSafeQueue<S32> queue(NULL, 4);
+		std::vector<boost::function<void ()> > funcs;
+		S32 sum = 0;
+		// The consumer blocks in popBack() until the producer, which blocks in
+		// pushFront() whenever the four slots are full, catches up.
+		struct local
+		{
+			static void push(LLThreadSafeQueue<S32>* queue)
+			{
+				for (S32 i = 1; i <= 1000; ++i)
+				{
+					queue->pushFront(i);
+				}
+			}
+			static void pop(LLThreadSafeQueue<S32>* queue, S32* sum)
+			{
+				for (S32 i = 1; i <= 1000; ++i)
+				{
+					*sum += queue->popBack();
+				}
+			}
+		};
+		funcs.push_back(boost::bind(local::pop, &queue, &sum));
+		funcs.push_back(boost::bind(local::push, &queue));
+		run_threads(funcs);
+
+		ensure_equals("all values arrived", sum, 1000 * 1001 / 2);
+		ensure_equals("drained", queue.size(), (size_t)0);
+	}
+
+	template<> template<>
+	void lockfreequeue_object::test<5>()
+	{
+		set_test_name("contention benchmark against a mutex queue");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		const U32 PER_PRODUCER = 200000;
+		std::cout << "\nMPMC queue, million ops/s (push + pop), half producers, half consumers\n"
+				  << "threads  lock-free    mutex" << std::endl;
+		const S32 thread_counts[] = { 2, 4, 8, 16, 32 };
+		for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+		{
+			S32 num_threads = thread_counts[t];
+			F64 total = (F64)(PER_PRODUCER * (num_threads / 2));
+
+			LLLockFreeQueue<U32> lock_free(1024);
+			F64 lock_free_secs = run_contention(lock_free, num_threads, PER_PRODUCER,
+												(std::vector<LLAtomic32<U32> >*)NULL, (LLAtomic32<U32>*)NULL);
+			MutexQueue mutexed(1024);
+			F64 mutex_secs = run_contention(mutexed, num_threads, PER_PRODUCER,
+											(std::vector<LLAtomic32<U32> >*)NULL, (LLAtomic32<U32>*)NULL);
+
+			std::cout << llformat("%7d %10.2f %8.2f", num_threads,
+								  total / lock_free_secs / 1000000.0,
+								  total / mutex_secs / 1000000.0) << std::endl;
+		}
+	}
+}
@@ -55,6 +55,7 @@ using namespace boost::phoenix;
 #include "../llsdserialize.h"
 #include "llsdutil.h"
 #include "../llformat.h"
+#include "../lltimer.h"
 
 #include "../test/lltut.h"
 #include "../test/namedtempfile.h"
@@ -714,6 +715,158 @@ namespace tut
 			expected,
 			1);
 	}
+
+	// Parses xml with both the expat parser and the in-memory fast path
+	// and requires identical results.
+	static void ensureSameXMLParse(const std::string& msg, const std::string& xml)
+	{
+		LLSD expected;
+		std::istringstream input(xml);
+		S32 expected_count = LLSDSerialize::fromXML(expected, input, false);
+
+		LLSD actual;
+		S32 actual_count = LLSDSerialize::fromXMLBuffer(actual, xml.data(), xml.size(), false);
+
+		std::ostringstream expected_str, actual_str;
+		LLSDSerialize::toNotation(expected, expected_str);
+		LLSDSerialize::toNotation(actual, actual_str);
+		ensure_equals(msg + " (value)", actual_str.str(), expected_str.str());
+		ensure_equals(msg + " (count)", actual_count, expected_count);
+	}
+
+	// Deterministic pseudo random LLSD for the parser corpus
+	static LLSD makeCorpusValue(U32& seed, S32 depth)
+	{
+		seed = seed * 1103515245 + 12345;
+		U32 r = seed >> 8;
+		switch (r % (depth > 3 ? 8 : 10))
+		{
+		case 0:
+			return LLSD();
+		case 1:
+			return LLSD((bool)(r & 0x100));
+		case 2:
+			return LLSD((S32)(r * 2654435761u));
+		case 3:
+			return LLSD((F64)(S32)r / (F64)((r % 977) + 1));
+		case 4:
+		{
+			static const char* pieces[] = { "a", "<", "&", "\"", "'", "\xc3\xa9", "\n", " ", "\r\n" };
+			std::string str;
+			for (U32 i = 0; i < r % 16; ++i)
+			{
+				str += pieces[(r >> i) % LL_ARRAY_SIZE(pieces)];
+			}
+			return LLSD(str);
+		}
+		case 5:
+		{
+			LLSD::Binary binary(r % 40);
+			for (size_t i = 0; i < binary.size(); ++i)
+			{
+				binary[i] = (U8)(r >> (i % 24));
+			}
+			return LLSD(binary);
+		}
+		case 6:
+			return LLSD(LLUUID("60e44ec5-305c-43c2-9a19-b4b89b1ae2a6"));
+		case 7:
+			return LLSD(LLURI("http://example.com/cap?a=1&b=<2>"));
+		case 8:
+		{
+			LLSD map = LLSD::emptyMap();
+			for (U32 i = 0; i < r % 6; ++i)
+			{
+				map[llformat("key%d&%c", i, 'a' + (r % 26))] = makeCorpusValue(seed, depth + 1);
+			}
+			return map;
+		}
+		default:
+		{
+			LLSD array = LLSD::emptyArray();
+			for (U32 i = 0; i < r % 6; ++i)
+			{
+				array.append(makeCorpusValue(seed, depth + 1));
+			}
+			return array;
+		}
+		}
+	}
+
+	template<> template<> 
+	void TestLLSDXMLParsingObject::test<5>()
+	{
+		// the in-memory fast path must agree with expat on documents it
+		// handles itself and on everything it hands back
+		ensureSameXMLParse("integer with junk", "<llsd><integer> 12abc</integer></llsd>");
+		ensureSameXMLParse("integer overflow", "<llsd><integer>99999999999</integer></llsd>");
+		ensureSameXMLParse("real with spaces", "<llsd><real> 1.5 </real></llsd>");
+		ensureSameXMLParse("real overflow", "<llsd><real>1e999</real></llsd>");
+		ensureSameXMLParse("real fraction", "<llsd><real>.5e-3</real></llsd>");
+		ensureSameXMLParse("prolog and comments",
+			"<?xml version=\"1.0\" ?>\n<llsd>\n<map>\n<!-- c -->\n"
+			"<key>a&amp;b</key>\n<string>x&#233;&#x1F600;y&lt;</string></map></llsd>");
+		ensureSameXMLParse("line ends", "<llsd><string>a\r\nb\rc</string></llsd>");
+		ensureSameXMLParse("wrapped base64", "<llsd><binary>aGVs\nbG8=</binary></llsd>");
+		ensureSameXMLParse("unknown encoding", "<llsd><binary encoding=\"base16\">00</binary></llsd>");
+		ensureSameXMLParse("empty key", "<llsd><map><key></key><integer>1</integer></map></llsd>");
+		ensureSameXMLParse("unknown element",
+			"<llsd><map><key>amy</key><integer>23</integer>"
+			"<key>bob</key><bigint>99</bigint></map></llsd>");
+		ensureSameXMLParse("cdata", "<llsd><string><![CDATA[x]]></string></llsd>");
+		ensureSameXMLParse("bad utf-8", "<llsd><string>\xff</string></llsd>");
+		ensureSameXMLParse("unterminated", "<llsd><string>ha ha</string>");
+		ensureSameXMLParse("empty llsd", "<llsd />");
+
+		U32 seed = 1;
+		for (S32 i = 0; i < 500; ++i)
+		{
+			LLSD value = makeCorpusValue(seed, 0);
+			std::ostringstream compact, pretty;
+			LLSDSerialize::toXML(value, compact);
+			LLSDSerialize::toPrettyXML(value, pretty);
+			ensureSameXMLParse(llformat("corpus %d", i), compact.str());
+			ensureSameXMLParse(llformat("pretty corpus %d", i), pretty.str());
+		}
+	}
+
+	template<> template<> 
+	void TestLLSDXMLParsingObject::test<6>()
+	{
+		// throughput of both xml parsers on a ~1MB document
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		U32 seed = 42;
+		LLSD value = LLSD::emptyArray();
+		for (S32 i = 0; i < 10000; ++i)
+		{
+			value.append(makeCorpusValue(seed, 1));
+		}
+		std::ostringstream ostr;
+		LLSDSerialize::toPrettyXML(value, ostr);
+		const std::string xml(ostr.str());
+		F64 megabytes = xml.size() / (1024.0 * 1024.0);
+
+		LLTimer timer;
+		LLSD expat_result;
+		std::istringstream input(xml);
+		LLSDSerialize::fromXML(expat_result, input);
+		F64 expat_seconds = timer.getElapsedTimeF64();
+
+		timer.reset();
+		LLSD fast_result;
+		LLSDSerialize::fromXMLBuffer(fast_result, xml.data(), xml.size());
+		F64 fast_seconds = timer.getElapsedTimeF64();
+
+		ensure_equals("same size", fast_result.size(), expat_result.size());
+		std::cout << "\nllsd xml parse " << megabytes << " MB: expat "
+				  << megabytes / llmax(expat_seconds, 1e-6) << " MB/s, fast path "
+				  << megabytes / llmax(fast_seconds, 1e-6) << " MB/s" << std::endl;
+	}
+
 	/*
 	TODO:
 		test XML parsing
@@ -0,0 +1,383 @@
+/**
+ * @file llthreadpool_test.cpp
+ * @brief Unit tests and benchmark for LLThreadPool
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "../llthreadpool.h"
+#include "../llformat.h"
+#include "../llqueuedthread.h"
+#include "../lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	void increment(LLAtomic32<S32>* counter)
+	{
+		(*counter)++;
+	}
+
+	void increment_plain(S32* counter)
+	{
+		++(*counter);
+	}
+
+	// Holds the worker it runs on until *release is set
+	void gate(LLAtomic32<S32>* started, LLAtomic32<S32>* release)
+	{
+		*started = 1;
+		while (!release->CurrentValue())
+		{
+			ms_sleep(1);
+		}
+	}
+
+	void record(LLMutex* mutex, std::vector<S32>* order, S32 value)
+	{
+		LLMutexLock lock(mutex);
+		order->push_back(value);
+	}
+
+	// Each index adds its own value once, so the total tells missed and
+	// repeated calls apart
+	void add_index(std::vector<LLAtomic32<S32> >* hits, LLAtomic32<U32>* total, U32 index)
+	{
+		(*hits)[index]++;
+		*total += index;
+	}
+
+	// Returns false if the pool did not drain in time
+	bool wait_for_pool(LLThreadPool& pool)
+	{
+		for (S32 i = 0; i < 10000 && pool.getPending() > 0; ++i)
+		{
+			ms_sleep(1);
+		}
+		return pool.getPending() == 0;
+	}
+
+	// A queued thread whose requests do a little busy work and track how long
+	// they sat in the queue.
+	class BenchQueue : public LLQueuedThread
+	{
+	public:
+		class BenchRequest : public QueuedRequest
+		{
+		public:
+			BenchRequest(handle_t handle, BenchQueue* queue)
+			:	QueuedRequest(handle, PRIORITY_NORMAL, FLAG_AUTO_COMPLETE),
+				mQueue(queue),
+				mQueuedAt(LLTimer::getTotalSeconds())
+			{
+			}
+
+			/*virtual*/ bool processRequest()
+			{
+				mQueue->mLatency += LLTimer::getTotalSeconds() - mQueuedAt;
+				U32 x = getHashKey();
+				for (S32 i = 0; i < 2000; ++i)
+				{
+					x = x * 1664525 + 1013904223;
+				}
+				mQueue->mChecksum += x;
+				mQueue->mProcessed++;
+				return true;
+			}
+
+		private:
+			BenchQueue* mQueue;
+			F64 mQueuedAt;
+		};
+
+		BenchQueue(const std::string& name)
+		:	LLQueuedThread(name),
+			mLatency(0.0),
+			mChecksum(0),
+			mProcessed(0)
+		{
+		}
+
+		void post()
+		{
+			addRequest(new BenchRequest(generateHandle(), this));
+		}
+
+		// Only touched by whichever thread processes requests, one at a time
+		F64 mLatency;
+		U32 mChecksum;
+		LLAtomic32<S32> mProcessed;
+	};
+
+	// Runs requests_per_queue requests through each of num_queues queues,
+	// returns the wall clock seconds and the mean queue latency
+	void run_queues(S32 num_queues, S32 requests_per_queue, F64& seconds, F64& latency)
+	{
+		std::vector<BenchQueue*> queues;
+		for (S32 i = 0; i < num_queues; ++i)
+		{
+			queues.push_back(new BenchQueue(llformat("Bench %d", i)));
+		}
+
+		LLTimer timer;
+		for (S32 n = 0; n < requests_per_queue; ++n)
+		{
+			for (S32 i = 0; i < num_queues; ++i)
+			{
+				queues[i]->post();
+			}
+		}
+		for (S32 i = 0; i < num_queues; ++i)
+		{
+			queues[i]->waitOnPending();
+			while (queues[i]->mProcessed.CurrentValue() < requests_per_queue)
+			{
+				LLThread::yield();
+			}
+		}
+		seconds = timer.getElapsedTimeF64();
+
+		latency = 0.0;
+		for (S32 i = 0; i < num_queues; ++i)
+		{
+			latency += queues[i]->mLatency;
+			delete queues[i];
+		}
+		latency /= (F64)(num_queues * requests_per_queue);
+	}
+}
+
+namespace tut
+{
+	struct threadpool_data
+	{
+	};
+	typedef test_group<threadpool_data> threadpool_group;
+	typedef threadpool_group::object threadpool_object;
+	threadpool_group threadpool_test("LLThreadPool");
+
+	template<> template<>
+	void threadpool_object::test<1>()
+	{
+		set_test_name("every submitted task runs once");
+
+		LLThreadPool pool("test", 4);
+		ensure_equals("worker count", pool.getNumWorkers(), 4);
+
+		LLAtomic32<S32> counter(0);
+		const S32 COUNT = 10000;
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			pool.submit(boost::bind(increment, &counter),
+						(LLThreadPool::EPriority)(i % LLThreadPool::PRIORITY_COUNT));
+		}
+		ensure("pool drained", wait_for_pool(pool));
+		ensure_equals("tasks run", counter.CurrentValue(), COUNT);
+	}
+
+	template<> template<>
+	void threadpool_object::test<2>()
+	{
+		set_test_name("cancelled tasks and their continuations are skipped");
+
+		LLThreadPool pool("test", 1);
+		LLAtomic32<S32> started(0), release(0);
+		pool.submit(boost::bind(gate, &started, &release));
+		while (!started.CurrentValue())
+		{
+			ms_sleep(1);
+		}
+
+		LLAtomic32<S32> ran(0), kept(0);
+		S32 continued = 0;
+		LLThreadPool::token_ptr_t token = new LLThreadPool::CancelToken;
+		for (S32 i = 0; i < 10; ++i)
+		{
+			pool.submit(boost::bind(increment, &ran), LLThreadPool::PRIORITY_NORMAL,
+						token, boost::bind(increment_plain, &continued));
+			pool.submit(boost::bind(increment, &kept));
+		}
+		token->cancel();
+		release = 1;
+
+		ensure("pool drained", wait_for_pool(pool));
+		pool.updateMainThread(0.f);
+		ensure_equals("cancelled tasks run", ran.CurrentValue(), 0);
+		ensure_equals("cancelled continuations run", continued, 0);
+		ensure_equals("other tasks run", kept.CurrentValue(), 10);
+	}
+
+	template<> template<>
+	void threadpool_object::test<3>()
+	{
+		set_test_name("continuations only run from updateMainThread");
+
+		LLThreadPool pool("test", 2);
+		LLAtomic32<S32> ran(0);
+		S32 continued = 0;
+		for (S32 i = 0; i < 100; ++i)
+		{
+			pool.submit(boost::bind(increment, &ran), LLThreadPool::PRIORITY_NORMAL,
+						LLThreadPool::token_ptr_t(), boost::bind(increment_plain, &continued));
+		}
+		ensure("pool drained", wait_for_pool(pool));
+		ensure_equals("tasks run", ran.CurrentValue(), 100);
+		ensure_equals("continuations before update", continued, 0);
+		ensure_equals("continuations left", pool.updateMainThread(0.f), 0);
+		ensure_equals("continuations after update", continued, 100);
+	}
+
+	template<> template<>
+	void threadpool_object::test<4>()
+	{
+		set_test_name("higher priorities run first");
+
+		LLThreadPool pool("test", 1);
+		LLAtomic32<S32> started(0), release(0);
+		pool.submit(boost::bind(gate, &started, &release));
+		while (!started.CurrentValue())
+		{
+			ms_sleep(1);
+		}
+
+		LLMutex mutex(NULL);
+		std::vector<S32> order;
+		for (S32 i = 0; i < 3; ++i)
+		{
+			for (S32 pri = 0; pri < LLThreadPool::PRIORITY_COUNT; ++pri)
+			{
+				pool.submit(boost::bind(record, &mutex, &order, pri), (LLThreadPool::EPriority)pri);
+			}
+		}
+		release = 1;
+		ensure("pool drained", wait_for_pool(pool));
+
+		ensure_equals("tasks run", order.size(), (size_t)(3 * LLThreadPool::PRIORITY_COUNT));
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			ensure_equals("priority order", order[i], (S32)(LLThreadPool::PRIORITY_COUNT - 1 - i / 3));
+		}
+
+		ensure_equals("queued priority mapping", LLThreadPool::mapPriority(LLQueuedThread::PRIORITY_IMMEDIATE),
+					  LLThreadPool::PRIORITY_URGENT);
+		ensure_equals("queued priority mapping", LLThreadPool::mapPriority(LLQueuedThread::PRIORITY_NORMAL | 0x1234),
+					  LLThreadPool::PRIORITY_NORMAL);
+		ensure_equals("queued priority mapping", LLThreadPool::mapPriority(0),
+					  LLThreadPool::PRIORITY_LOW);
+	}
+
+	template<> template<>
+	void threadpool_object::test<5>()
+	{
+		set_test_name("LLQueuedThread on a shared pool");
+
+		LLThreadPool pool("test", 2);
+		LLQueuedThread::setThreadPool(&pool);
+		BenchQueue* queue = new BenchQueue("pooled");
+		LLQueuedThread::setThreadPool(NULL);
+
+		for (S32 i = 0; i < 500; ++i)
+		{
+			queue->post();
+		}
+		queue->waitOnPending();
+		for (S32 i = 0; i < 10000 && queue->mProcessed.CurrentValue() < 500; ++i)
+		{
+			ms_sleep(1);
+		}
+		ensure_equals("requests processed", queue->mProcessed.CurrentValue(), 500);
+		ensure_equals("queue empty", queue->getPending(), 0);
+		delete queue;
+		ensure("pool drained", wait_for_pool(pool));
+	}
+
+	template<> template<>
+	void threadpool_object::test<6>()
+	{
+		set_test_name("parallelFor calls every index once, even with the workers busy");
+
+		LLThreadPool pool("test", 3);
+		const U32 COUNT = 5000;
+		std::vector<LLAtomic32<S32> > hits(COUNT);
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			hits[i] = 0;
+		}
+		LLAtomic32<U32> total(0);
+		pool.parallelFor(COUNT, boost::bind(add_index, &hits, &total, _1));
+		ensure_equals("sum of indices", total.CurrentValue(), COUNT * (COUNT - 1) / 2);
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("called once", hits[i].CurrentValue(), 1);
+		}
+
+		// With every worker held the calling thread does all the work itself
+		LLAtomic32<S32> started(0), release(0);
+		for (S32 i = 0; i < pool.getNumWorkers(); ++i)
+		{
+			pool.submit(boost::bind(gate, &started, &release));
+		}
+		total = 0;
+		pool.parallelFor(100, boost::bind(add_index, &hits, &total, _1));
+		ensure_equals("sum with busy workers", total.CurrentValue(), 100U * 99U / 2);
+		release = 1;
+		ensure("pool drained", wait_for_pool(pool));
+	}
+
+	template<> template<>
+	void threadpool_object::test<7>()
+	{
+		set_test_name("benchmark dedicated threads against the shared pool");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		const S32 NUM_QUEUES = 4;
+		const S32 REQUESTS = 5000;
+
+		F64 thread_seconds, thread_latency;
+		run_queues(NUM_QUEUES, REQUESTS, thread_seconds, thread_latency);
+
+		LLThreadPool pool("bench");
+		LLQueuedThread::setThreadPool(&pool);
+		F64 pool_seconds, pool_latency;
+		run_queues(NUM_QUEUES, REQUESTS, pool_seconds, pool_latency);
+		LLQueuedThread::setThreadPool(NULL);
+
+		const F64 total = (F64)(NUM_QUEUES * REQUESTS);
+		std::cout << "\nLLQueuedThread, " << NUM_QUEUES << " queues x " << REQUESTS << " requests\n"
+				  << "  own threads:  " << (S32)(total / thread_seconds) << " req/s, mean latency "
+				  << thread_latency * 1000.0 << " ms\n"
+				  << "  shared pool (" << pool.getNumWorkers() << " workers): "
+				  << (S32)(total / pool_seconds) << " req/s, mean latency "
+				  << pool_latency * 1000.0 << " ms" << std::endl;
+	}
+}
@@ -153,6 +153,15 @@ const int HTTP_CONNECTION_LIMIT_MAX = 256;
 const long HTTP_PIPELINING_DEFAULT = 0L;
 const long HTTP_PIPELINING_MAX = 20L;
 
+// HTTP/2 concurrent stream limits (per connection)
+const long HTTP_HTTP2_STREAMS_DEFAULT = 0L;
+const long HTTP_HTTP2_STREAMS_MAX = 100L;
+
+// Largest response body that will be pre-sized into a single
+// BufferArray block from its Content-Length.  Anything larger
+// is accumulated in ordinary blocks.
+const size_t HTTP_REPLY_RESERVE_MAX = 64U * 1024U * 1024U;
+
 // Miscellaneous defaults
 const bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 const long HTTP_THROTTLE_RATE_DEFAULT = 0L;
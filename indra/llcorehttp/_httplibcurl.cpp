@@ -32,6 +32,7 @@
 #include "_httppolicy.h"
 
 #include "llhttpconstants.h"
+#include "httpstats.h"
 
 namespace
 {
@@ -398,6 +399,11 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
         }
 	}
 
+    if (handle && mService->getPolicy().getClassOptions(op->mReqPolicy).mHttp2Streams > 0L)
+    {
+        recordStreamStats(handle);
+    }
+
     if (multi_handle && handle)
     {
         // Detach from multi and recycle handle
@@ -429,6 +435,26 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
 }
 
 
+void HttpLibcurl::recordStreamStats(CURL * handle)
+{
+	bool multiplexed(false);
+#if LIBCURL_VERSION_NUM >= 0x073200
+	long version(0L);
+	if (CURLE_OK == curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version))
+	{
+		multiplexed = (CURL_HTTP_VERSION_2_0 == version);
+	}
+#endif
+	long connects(0L);
+	double first_byte(0.0), total(0.0);
+	curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+	curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &first_byte);
+	curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &total);
+
+	HTTPStats::instance().recordStream(multiplexed, connects > 0L, F32(first_byte), F32(total));
+}
+
+
 int HttpLibcurl::getActiveCount() const
 {
 	return mActiveOps.size();
@@ -475,7 +501,29 @@ void HttpLibcurl::policyUpdated(int policy_class)
 		policy.stallPolicy(policy_class, false);
 		mDirtyPolicy[policy_class] = false;
 
-		if (options.mPipelining > 1)
+		if (options.mHttp2Streams > 0)
+		{
+			// Multiplex HTTP/2 streams over a few connections.  Requests
+			// that can't get HTTP/2 use ordinary HTTP/1.1 connections
+			// under the same limits.
+#if LIBCURL_VERSION_NUM >= 0x072b00
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_PIPELINING,
+									 long(CURLPIPE_MULTIPLEX));
+#endif
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_HOST_CONNECTIONS,
+									 long(options.mPerHostConnectionLimit));
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_TOTAL_CONNECTIONS,
+									 long(options.mConnectionLimit));
+#if LIBCURL_VERSION_NUM >= 0x074300
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_CONCURRENT_STREAMS,
+									 long(options.mHttp2Streams));
+#endif
+		}
+		else if (options.mPipelining > 1)
 		{
 			// We'll try to do pipelining on this multihandle
 			check_curl_multi_setopt(multi_handle,
@@ -148,6 +148,9 @@ protected:
 	/// to completion and we need to move the request to a new state.
 	bool completeRequest(CURLM * multi_handle, CURL * handle, CURLcode status);
 
+	/// Per-stream statistics for requests on HTTP/2 policy classes.
+	void recordStreamStats(CURL * handle);
+
 	/// Invoked to cancel an active request, mainly during shutdown
 	/// and destroy.
     void cancelRequest(const opReqPtr_t &op);
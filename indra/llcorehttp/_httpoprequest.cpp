@@ -89,6 +89,13 @@ int parse_content_range_header(char * buffer,
 int parse_retry_after_header(char * buffer, int * time);
 
 
+// Maps the U32 request priority onto the 1-256 range of HTTP/2
+// stream weights.  Priorities span many orders of magnitude (texture
+// fetches OR flags into the high bits) so the weight follows the
+// position of the highest set bit.
+long priority_to_stream_weight(LLCore::HttpRequest::priority_t priority);
+
+
 // Take data from libcurl's CURLOPT_DEBUGFUNCTION callback and
 // escape and format it for a tracing line in logging.  Absolutely
 // anything including NULs can be in the data.  If @scrub is true,
@@ -734,13 +741,32 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 		//
 		// xfer_timeout *= cpolicy.mPipelining;
 		xfer_timeout *= 2L;
+	}
+	if (cpolicy.mHttp2Streams > 0L)
+	{
+		// HTTP/2 streams share a connection much like pipelined requests
+		// do so the same handwave on transfer timeout applies.
+		if (cpolicy.mPipelining <= 1L)
+		{
+			xfer_timeout *= 2L;
+		}
 
-		// Also try requesting HTTP/2.
-/******************************/
-		// but for test purposes, only if overriding VIEWERASSET
-		if (getenv("VIEWERASSET"))
-/******************************/
-		check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#else
+		if (0 == mReqURL.compare(0, 6, "https:"))
+		{
+			check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
+		}
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+		// Wait for a stream on an existing connection rather than
+		// opening a new one while the first is still negotiating.
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072e00
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_STREAM_WEIGHT, priority_to_stream_weight(mReqPriority));
+#endif
 	}
 	// *DEBUG:  Enable following override for timeout handling and "[curl:bugs] #1420" tests
     //if (cpolicy.mPipelining)
@@ -780,6 +806,17 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
 	if (! op->mReplyBody)
 	{
 		op->mReplyBody = new BufferArray();
+
+		// Headers are in by the first body write.  With a known
+		// length the whole body can go into one block which lets
+		// consumers look at it in place rather than copying it out.
+		double content_length(-1.0);
+		if (CURLE_OK == curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &content_length)
+			&& content_length > double(BufferArray::BLOCK_ALLOC_SIZE)
+			&& content_length <= double(HTTP_REPLY_RESERVE_MAX))
+		{
+			op->mReplyBody->reserve(size_t(content_length));
+		}
 	}
 	const size_t req_size(size * nmemb);
 	const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
@@ -1201,6 +1238,18 @@ int parse_content_range_header(char * buffer,
 }
 
 
+long priority_to_stream_weight(LLCore::HttpRequest::priority_t priority)
+{
+	// 0 -> 1, 1 -> 9, ... 0x40000000 -> 249, top bit set -> 256
+	long weight(1L);
+	for (LLCore::HttpRequest::priority_t bits(priority); bits; bits >>= 1)
+	{
+		weight += 8L;
+	}
+	return llmin(weight, 256L);
+}
+
+
 int parse_retry_after_header(char * buffer, int * time)
 {
 	char * endptr(buffer);
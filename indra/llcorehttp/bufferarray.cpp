@@ -184,6 +184,76 @@ void * BufferArray::appendBufferAlloc(size_t len)
 }
 
 
+bool BufferArray::reserve(size_t len)
+{
+	if (mLen || ! len)
+	{
+		return false;
+	}
+
+	// Drop any empty blocks so the reserved one is first
+	for (container_t::iterator it(mBlocks.begin());
+		 it != mBlocks.end();
+		 ++it)
+	{
+		delete *it;
+	}
+	mBlocks.clear();
+
+	Block * block;
+	try
+	{
+		block = Block::alloc(len);
+	}
+	catch (std::bad_alloc)
+	{
+		LL_WARNS() << "Unable to reserve " << len << " bytes in BufferArray" << LL_ENDL;
+		return false;
+	}
+	mBlocks.push_back(block);
+	return true;
+}
+
+
+const char * BufferArray::contiguousData() const
+{
+	const char * result(NULL);
+	for (container_t::const_iterator it(mBlocks.begin());
+		 it != mBlocks.end();
+		 ++it)
+	{
+		if ((*it)->mUsed)
+		{
+			if (result)
+			{
+				// Second non-empty block, not contiguous
+				return NULL;
+			}
+			result = (*it)->mData;
+		}
+	}
+	return result;
+}
+
+
+size_t BufferArray::getSegments(segments_t & segs) const
+{
+	segs.clear();
+	segs.reserve(mBlocks.size());
+	for (container_t::const_iterator it(mBlocks.begin());
+		 it != mBlocks.end();
+		 ++it)
+	{
+		if ((*it)->mUsed)
+		{
+			Segment seg = { (*it)->mData, (*it)->mUsed };
+			segs.push_back(seg);
+		}
+	}
+	return segs.size();
+}
+
+
 size_t BufferArray::read(size_t pos, void * dst, size_t len)
 {
 	char * c_dst(static_cast<char *>(dst));
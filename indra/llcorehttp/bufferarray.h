@@ -104,12 +104,44 @@ public:
 	///					of BufferArray of 'len' size.
 	void * appendBufferAlloc(size_t len);
 
+	/// Allocates a single block able to hold 'len' bytes so
+	/// that subsequent appends up to that total land in one
+	/// contiguous region.  Used when the final size is known
+	/// ahead of time (e.g. from a Content-Length header).
+	/// Only has an effect on an empty instance.
+	///
+	/// @return			True if the block was allocated.
+	bool reserve(size_t len);
+
 	/// Current count of bytes in BufferArray instance.
 	size_t size() const
 		{
 			return mLen;
 		}
 
+	/// One contiguous region of the instance's data, in the
+	/// manner of a struct iovec.
+	struct Segment
+	{
+		const char *	mData;
+		size_t			mLen;
+	};
+	typedef std::vector<Segment> segments_t;
+
+	/// Returns a pointer to the data when it is held in a
+	/// single contiguous block, NULL if the instance is empty
+	/// or spans several blocks.  The pointer is valid until
+	/// the next modifying operation or release of the instance.
+	const char * contiguousData() const;
+
+	/// Fills 'segs' with a view of the data, one entry per
+	/// non-empty block, without copying.  The pointers are
+	/// valid until the next modifying operation or release
+	/// of the instance.
+	///
+	/// @return			Count of segments
+	size_t getSegments(segments_t & segs) const;
+
 	/// Copies data from the given position in the instance
 	/// to the caller's buffer.  Will return a short count of
 	/// bytes copied if the 'len' extends beyond the data.
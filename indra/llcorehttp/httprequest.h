@@ -233,6 +233,22 @@ public:
 		/// Global only
 		PO_SSL_VERIFY_CALLBACK,
 
+		/// If greater than 0, requests in the class ask for HTTP/2
+		/// over TLS and are multiplexed as concurrent streams over
+		/// at most PO_PER_HOST_CONNECTION_LIMIT connections per
+		/// host (and PO_CONNECTION_LIMIT overall).  The value is
+		/// the number of streams the class will try to keep in
+		/// flight on each connection.  Servers that don't negotiate
+		/// HTTP/2, and plain http: URLs, fall back to HTTP/1.1 on
+		/// the same connection limits.
+		///
+		/// Request priorities are passed to the server as HTTP/2
+		/// stream weights.  Takes precedence over
+		/// PO_PIPELINING_DEPTH when both are set.
+		///
+		/// Per-class only
+		PO_HTTP2_STREAMS,
+
 		PO_LAST  // Always at end
 	};
 
@@ -30,6 +30,8 @@
 namespace LLCore
 {
 HTTPStats::HTTPStats()
+:   mBodyMutex(NULL),
+    mStreamMutex(NULL)
 {
     resetStats();
 }
@@ -45,6 +47,19 @@ void HTTPStats::resetStats()
     mDataDown.reset();
     mDataUp.reset();
     mRequests = 0;
+    {
+        LLMutexLock lock(&mBodyMutex);
+        mBodyCopied.reset();
+        mBodyInPlace.reset();
+    }
+    {
+        LLMutexLock lock(&mStreamMutex);
+        mStreams = 0;
+        mStreamFallbacks = 0;
+        mStreamConnects = 0;
+        mStreamFirstByte.reset();
+        mStreamTotal.reset();
+    }
 }
 
 
@@ -61,6 +76,26 @@ void HTTPStats::recordResultCode(S32 code)
 
 }
 
+void HTTPStats::recordStream(bool multiplexed, bool new_connection, F32 first_byte_secs, F32 total_secs)
+{
+    LLMutexLock lock(&mStreamMutex);
+    if (multiplexed)
+    {
+        ++mStreams;
+        mStreamFirstByte.push(first_byte_secs);
+        mStreamTotal.push(total_secs);
+    }
+    else
+    {
+        ++mStreamFallbacks;
+    }
+
+    if (new_connection)
+    {
+        ++mStreamConnects;
+    }
+}
+
 namespace
 {
     std::string byte_count_converter(F32 bytes)
@@ -93,6 +128,23 @@ void HTTPStats::dumpStats()
     out << "Data Sent: " << byte_count_converter(mDataUp.getSum()) << "   (" << mDataUp.getSum() << ")" << std::endl;
     out << "Data Recv: " << byte_count_converter(mDataDown.getSum()) << "   (" << mDataDown.getSum() << ")" << std::endl;
     out << "Total requests: " << mRequests << "(request objects created)" << std::endl;
+    {
+        LLMutexLock lock(&mBodyMutex);
+        out << "Body bytes copied: " << byte_count_converter(mBodyCopied.getSum()) << "   (" << mBodyCopied.getSum() << ")"
+            << "   used in place: " << byte_count_converter(mBodyInPlace.getSum()) << "   (" << mBodyInPlace.getSum() << ")" << std::endl;
+    }
+    {
+        LLMutexLock lock(&mStreamMutex);
+        if (mStreams || mStreamFallbacks)
+        {
+            out << "HTTP/2 streams: " << mStreams << "   HTTP/1.x fallbacks: " << mStreamFallbacks
+                << "   New connections: " << mStreamConnects << std::endl;
+            out << "Stream first byte (s): mean " << mStreamFirstByte.getMean()
+                << "   max " << mStreamFirstByte.getMaxValue() << std::endl;
+            out << "Stream total (s): mean " << mStreamTotal.getMean()
+                << "   max " << mStreamTotal.getMaxValue() << std::endl;
+        }
+    }
     out << std::endl;
     out << "Result Codes:" << std::endl << "--- -----" << std::endl;
 
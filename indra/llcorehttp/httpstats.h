@@ -31,6 +31,7 @@
 #include "lltrace.h"
 #include "llstatsaccumulator.h"
 #include "llsingleton.h"
+#include "llmutex.h"
 #include "llsd.h"
 
 namespace LLCore
@@ -57,8 +58,29 @@ namespace LLCore
 
         void    recordHTTPRequest() { ++mRequests; }
 
+        /// Response bytes consumers had to copy out of a BufferArray
+        /// versus bytes they could use in place.  Called from the main,
+        /// mesh and texture fetch threads.
+        void    recordBodyCopied(size_t bytes)
+        {
+            LLMutexLock lock(&mBodyMutex);
+            mBodyCopied.push(bytes);
+        }
+
+        void    recordBodyInPlace(size_t bytes)
+        {
+            LLMutexLock lock(&mBodyMutex);
+            mBodyInPlace.push(bytes);
+        }
+
         void    recordResultCode(S32 code);
 
+        /// Requests on HTTP/2 enabled policy classes.  multiplexed is
+        /// false when the request fell back to HTTP/1.x, new_connection
+        /// when it could not share an existing connection.  Called from
+        /// the HTTP servicing thread.
+        void    recordStream(bool multiplexed, bool new_connection, F32 first_byte_secs, F32 total_secs);
+
         void    dumpStats();
     private:
         StatsAccumulator mDataDown;
@@ -66,6 +88,17 @@ namespace LLCore
 
         S32              mRequests;
 
+        LLMutex          mBodyMutex;
+        StatsAccumulator mBodyCopied;
+        StatsAccumulator mBodyInPlace;
+
+        LLMutex          mStreamMutex;
+        S32              mStreams;
+        S32              mStreamFallbacks;
+        S32              mStreamConnects;
+        StatsAccumulator mStreamFirstByte;
+        StatsAccumulator mStreamTotal;
+
         std::map<S32, S32> mResutCodes;
     };
 
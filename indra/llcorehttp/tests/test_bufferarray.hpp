@@ -426,6 +426,72 @@ void BufferArrayTestObjectType::test<8>()
 	ensure("All memory released", mMemTotal == GetMemTotal());
 }
 
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+	set_test_name("BufferArray reserve and in-place views");
+
+	// record the total amount of dynamically allocated memory
+	mMemTotal = GetMemTotal();
+
+	// create a new ref counted object with an implicit reference
+	BufferArray * ba = new BufferArray();
+	ensure("Empty BA has no contiguous data", NULL == ba->contiguousData());
+
+	// Reserve more than a default block and fill it in pieces
+	const size_t big_len(3 * BufferArray::BLOCK_ALLOC_SIZE + 17);
+	ensure("Reserve on empty BA", ba->reserve(big_len));
+	ensure("Reserve doesn't change size", 0 == ba->size());
+	char * src = new char [big_len];
+	for (size_t i(0); i < big_len; ++i)
+	{
+		src[i] = char(i * 7);
+	}
+	for (size_t pos(0); pos < big_len; pos += 1000)
+	{
+		ba->append(src + pos, (std::min)(size_t(1000), big_len - pos));
+	}
+	ensure("Reserved BA length correct", big_len == ba->size());
+	ensure("Reserve on non-empty BA refused", ! ba->reserve(big_len));
+
+	const char * data(ba->contiguousData());
+	ensure("Reserved BA is contiguous", NULL != data);
+	ensure("Contiguous content correct", 0 == memcmp(data, src, big_len));
+
+	BufferArray::segments_t segs;
+	ensure("Reserved BA is one segment", 1 == ba->getSegments(segs));
+	ensure("Segment is the contiguous data", data == segs[0].mData && big_len == segs[0].mLen);
+
+	// Overflowing the reservation spills into a new block
+	ba->append("overflow", 8);
+	ensure("Overflowed BA not contiguous", NULL == ba->contiguousData());
+	ensure("Overflowed BA is two segments", 2 == ba->getSegments(segs));
+	ensure("First segment unchanged", data == segs[0].mData && big_len == segs[0].mLen);
+	ensure("Second segment content", 8 == segs[1].mLen && 0 == memcmp(segs[1].mData, "overflow", 8));
+	ba->release();
+
+	// Unreserved appends walk blocks; segments cover everything in order
+	ba = new BufferArray();
+	for (size_t pos(0); pos < big_len; pos += 1000)
+	{
+		ba->append(src + pos, (std::min)(size_t(1000), big_len - pos));
+	}
+	ensure("Multi-block BA not contiguous", NULL == ba->contiguousData());
+	ensure("Multi-block BA segments", 1 < ba->getSegments(segs));
+	size_t offset(0);
+	for (size_t i(0); i < segs.size(); ++i)
+	{
+		ensure("Segment content correct", 0 == memcmp(segs[i].mData, src + offset, segs[i].mLen));
+		offset += segs[i].mLen;
+	}
+	ensure("Segments cover the data", big_len == offset);
+	ba->release();
+	delete [] src;
+
+	// make sure we didn't leak any memory
+	ensure("All memory released", mMemTotal == GetMemTotal());
+}
+
 }  // end namespace tut
 
 
@@ -291,6 +291,95 @@ S32 LLCamera::AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVec
 	return AABBInFrustumNoFarClip(center, radius, mRegionPlanes);
 }
 
+void LLCamera::AABBInFrustumBatch(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results,
+								  bool no_far_clip, const LLPlane* planes)
+{
+	if (!planes)
+	{
+		//use agent space
+		planes = mAgentPlanes;
+	}
+
+	//splat the planes that take part, a component at a time
+	LLVector4a plane_x[AGENT_PLANE_USER_CLIP_NUM];
+	LLVector4a plane_y[AGENT_PLANE_USER_CLIP_NUM];
+	LLVector4a plane_z[AGENT_PLANE_USER_CLIP_NUM];
+	LLVector4a plane_d[AGENT_PLANE_USER_CLIP_NUM];
+	U8 masks[AGENT_PLANE_USER_CLIP_NUM];
+	U32 num_planes = 0;
+	U32 max_planes = llmin(mPlaneCount, (U32) AGENT_PLANE_USER_CLIP_NUM);
+	for (U32 i = 0; i < max_planes; i++)
+	{
+		U8 mask = mPlaneMask[i];
+		if (mask < PLANE_MASK_NUM && !(no_far_clip && i == AGENT_PLANE_FAR))
+		{
+			const LLPlane& p(planes[i]);
+			plane_x[num_planes].splat(p[0]);
+			plane_y[num_planes].splat(p[1]);
+			plane_z[num_planes].splat(p[2]);
+			plane_d[num_planes].splat(-p[3]);
+			masks[num_planes] = mask;
+			num_planes++;
+		}
+	}
+
+	for (U32 base = 0; base < count; base += 4)
+	{
+		//transpose up to four boxes, repeating the last one to fill the gap
+		LLQuad c[4], r[4];
+		for (U32 i = 0; i < 4; i++)
+		{
+			U32 idx = llmin(base + i, count - 1);
+			c[i] = centers[idx];
+			r[i] = radii[idx];
+		}
+		_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+		_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+		//corners are built the way the single box tests build them, center -/+ radius,
+		//so that every dot product rounds the same and the results match exactly
+		LLVector4a lo[3], hi[3];
+		for (U32 i = 0; i < 3; i++)
+		{
+			lo[i] = _mm_sub_ps(c[i], r[i]);
+			hi[i] = _mm_add_ps(c[i], r[i]);
+		}
+
+		LLQuad outside = _mm_setzero_ps();
+		LLQuad intersect = _mm_setzero_ps();
+		for (U32 i = 0; i < num_planes; i++)
+		{
+			//the mask picks the corner furthest behind the plane per component
+			U8 mask = masks[i];
+			const LLVector4a& min_x = mask & 1 ? lo[0] : hi[0];
+			const LLVector4a& min_y = mask & 2 ? lo[1] : hi[1];
+			const LLVector4a& min_z = mask & 4 ? lo[2] : hi[2];
+			const LLVector4a& max_x = mask & 1 ? hi[0] : lo[0];
+			const LLVector4a& max_y = mask & 2 ? hi[1] : lo[1];
+			const LLVector4a& max_z = mask & 4 ? hi[2] : lo[2];
+
+			LLQuad dot_min = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[i], min_x), _mm_mul_ps(plane_y[i], min_y)),
+										_mm_mul_ps(plane_z[i], min_z));
+			LLQuad dot_max = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[i], max_x), _mm_mul_ps(plane_y[i], max_y)),
+										_mm_mul_ps(plane_z[i], max_z));
+			outside = _mm_or_ps(outside, _mm_cmpgt_ps(dot_min, plane_d[i]));
+			if (_mm_movemask_ps(outside) == 0xf)
+			{ //all four culled, like the early out of the single box test
+				break;
+			}
+			intersect = _mm_or_ps(intersect, _mm_cmpgt_ps(dot_max, plane_d[i]));
+		}
+
+		S32 outside_bits = _mm_movemask_ps(outside);
+		S32 intersect_bits = _mm_movemask_ps(intersect);
+		U32 num = llmin(count - base, (U32) 4);
+		for (U32 i = 0; i < num; i++)
+		{
+			results[base + i] = (outside_bits & (1 << i)) ? 0 : ((intersect_bits & (1 << i)) ? 1 : 2);
+		}
+	}
+}
+
 int LLCamera::sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius) 
 {
 	LLVector3 dist = sphere_center-mFrustCenter;
@@ -208,6 +208,11 @@ public:
 	S32 AABBInFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius, const LLPlane* planes = NULL);
 	S32 AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius);
 
+	// Tests count boxes at once, four per pass in structure of arrays form, and writes what
+	// AABBInFrustum() (or AABBInFrustumNoFarClip() with no_far_clip) returns for each to results.
+	void AABBInFrustumBatch(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results,
+							bool no_far_clip = false, const LLPlane* planes = NULL);
+
 	//does a quick 'n dirty sphere-sphere check
 	S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius); 
 
@@ -0,0 +1,136 @@
+/**
+ * @file llskinningkernel.cpp
+ * @brief Four weight linear blend skinning of vertex arrays
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llskinningkernel.h"
+
+// Splits the packed weights into clamped joint indices and normalized weights
+static LL_FORCE_INLINE void unpack_weights(const LLVector4a& weights, const LLQuad& max_index, S32* idx, LLQuad& wght)
+{
+	const LLQuad one = _mm_set1_ps(1.f);
+
+	//floor() by truncation, minus one where that rounded a negative value up
+	LLQuad w = weights;
+	LLQuad fl = _mm_cvtepi32_ps(_mm_cvttps_epi32(w));
+	fl = _mm_sub_ps(fl, _mm_and_ps(_mm_cmpgt_ps(fl, w), one));
+
+	LLQuad clamped = _mm_min_ps(_mm_max_ps(fl, _mm_setzero_ps()), max_index);
+	_mm_storeu_si128((__m128i*) idx, _mm_cvttps_epi32(clamped));
+
+	//sum the fractions one at a time, in the order a scalar loop would
+	LLQuad frac = _mm_sub_ps(w, fl);
+	LLQuad scale = _mm_add_ss(frac, _mm_shuffle_ps(frac, frac, _MM_SHUFFLE(1, 1, 1, 1)));
+	scale = _mm_add_ss(scale, _mm_shuffle_ps(frac, frac, _MM_SHUFFLE(2, 2, 2, 2)));
+	scale = _mm_add_ss(scale, _mm_shuffle_ps(frac, frac, _MM_SHUFFLE(3, 3, 3, 3)));
+	LLQuad inv_scale = _mm_div_ss(one, scale);
+	inv_scale = _mm_shuffle_ps(inv_scale, inv_scale, _MM_SHUFFLE(0, 0, 0, 0));
+
+	//LLVector4 *= F32 only scales x, y and z, so getPerVertexSkinMatrix() leaves the
+	//fourth weight as it was; do the same so that both paths agree
+	const LLQuad xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	inv_scale = _mm_or_ps(_mm_and_ps(xyz, inv_scale), _mm_andnot_ps(xyz, one));
+	wght = _mm_mul_ps(frac, inv_scale);
+}
+
+static LL_FORCE_INLINE void blend_matrix(const LLMatrix4a* palette, const S32* idx, const LLQuad& wght, LLMatrix4a& final_mat)
+{
+	const LLMatrix4a& m0 = palette[idx[0]];
+	const LLMatrix4a& m1 = palette[idx[1]];
+	const LLMatrix4a& m2 = palette[idx[2]];
+	const LLMatrix4a& m3 = palette[idx[3]];
+
+	LLQuad w0 = _mm_shuffle_ps(wght, wght, _MM_SHUFFLE(0, 0, 0, 0));
+	LLQuad w1 = _mm_shuffle_ps(wght, wght, _MM_SHUFFLE(1, 1, 1, 1));
+	LLQuad w2 = _mm_shuffle_ps(wght, wght, _MM_SHUFFLE(2, 2, 2, 2));
+	LLQuad w3 = _mm_shuffle_ps(wght, wght, _MM_SHUFFLE(3, 3, 3, 3));
+
+	for (U32 i = 0; i < 4; ++i)
+	{
+		//accumulate onto zero like LLMatrix4a::clear() then add() does
+		LLQuad col = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(m0.mMatrix[i], w0));
+		col = _mm_add_ps(col, _mm_mul_ps(m1.mMatrix[i], w1));
+		col = _mm_add_ps(col, _mm_mul_ps(m2.mMatrix[i], w2));
+		col = _mm_add_ps(col, _mm_mul_ps(m3.mMatrix[i], w3));
+		final_mat.mMatrix[i] = col;
+	}
+}
+
+//static
+void LLSkinningKernel::getSkinMatrix(const LLMatrix4a* palette, U32 max_joints, const LLVector4a& weights,
+									 LLMatrix4a& final_mat)
+{
+	LLQuad max_index = _mm_set1_ps((F32) (max_joints - 1));
+	LL_ALIGN_16(S32 idx[4]);
+	LLQuad wght;
+	unpack_weights(weights, max_index, idx, wght);
+	blend_matrix(palette, idx, wght, final_mat);
+}
+
+//static
+void LLSkinningKernel::skinVertices(const LLMatrix4a* palette, U32 max_joints, const LLMatrix4a& bind_shape_in,
+									const LLVector4a* weights, const LLVector4a* positions, const LLVector4a* normals,
+									U32 count, LLVector4a* pos_out, LLVector4a* norm_out)
+{
+	if (!count)
+	{
+		return;
+	}
+
+	LLMatrix4a bind_shape = bind_shape_in;
+	LLQuad max_index = _mm_set1_ps((F32) (max_joints - 1));
+	bool do_normals = normals && norm_out;
+
+	LLMatrix4a final_mat;
+	LL_ALIGN_16(S32 idx[4]);
+	LLQuad wght;
+	__m128i last_weights = _mm_setzero_si128();
+
+	for (U32 j = 0; j < count; ++j)
+	{
+		//same packed weights as the previous vertex, same matrix
+		__m128i cur_weights = _mm_castps_si128(weights[j]);
+		if (j == 0 || _mm_movemask_epi8(_mm_cmpeq_epi32(cur_weights, last_weights)) != 0xffff)
+		{
+			unpack_weights(weights[j], max_index, idx, wght);
+			blend_matrix(palette, idx, wght, final_mat);
+			last_weights = cur_weights;
+		}
+
+		LLVector4a t;
+		bind_shape.affineTransform(positions[j], t);
+		final_mat.affineTransform(t, pos_out[j]);
+
+		if (do_normals)
+		{
+			LLVector4a dst;
+			bind_shape.rotate(normals[j], t);
+			final_mat.rotate(t, dst);
+			dst.normalize3fast();
+			norm_out[j] = dst;
+		}
+	}
+}
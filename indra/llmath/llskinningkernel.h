@@ -0,0 +1,62 @@
+/**
+ * @file llskinningkernel.h
+ * @brief Four weight linear blend skinning of vertex arrays
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSKINNINGKERNEL_H
+#define LL_LLSKINNINGKERNEL_H
+
+#include "llmath.h"	// LLVector4a
+#include "llmatrix4a.h"
+
+// CPU skinning of a rigged face, for when the shaders do not skin and for
+// the picking and bounds of rigged volumes.
+//
+// Each vertex weight packs four influences, joint index in the integer part
+// and weight in the fraction.  Indices are clamped to the palette and the
+// weights normalized (only the first three, as getPerVertexSkinMatrix() has
+// always done), the four palette matrices are blended and the vertex, after
+// the bind shape matrix, is transformed by the blend.  Results match
+// LLSkinningUtil::getPerVertexSkinMatrix() followed by affineTransform()
+// bit for bit, the same operations happen in the same order.
+//
+// The kernel works on whole arrays so that the weight unpacking stays in
+// SSE registers and the blended matrix is reused while consecutive vertices
+// carry the same weights, which the rigid parts of a mesh mostly do.
+class LLSkinningKernel
+{
+public:
+	// Skins count positions (and normals, if both normals and norm_out are
+	// given) from the bind pose into pos_out and norm_out.  Normals are
+	// renormalized with normalize3fast().  The outputs may not alias the inputs.
+	static void skinVertices(const LLMatrix4a* palette, U32 max_joints, const LLMatrix4a& bind_shape,
+							 const LLVector4a* weights, const LLVector4a* positions, const LLVector4a* normals,
+							 U32 count, LLVector4a* pos_out, LLVector4a* norm_out);
+
+	// The blended matrix of one vertex
+	static void getSkinMatrix(const LLMatrix4a* palette, U32 max_joints, const LLVector4a& weights,
+							  LLMatrix4a& final_mat);
+};
+
+#endif // LL_LLSKINNINGKERNEL_H
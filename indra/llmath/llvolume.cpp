@@ -46,6 +46,7 @@
 #include "lloctree.h"
 #include "llvolume.h"
 #include "llvolumeoctree.h"
+#include "llvolumebvh.h"
 #include "llstl.h"
 #include "llsdserialize.h"
 #include "llvector4a.h"
@@ -683,7 +684,8 @@ LLProfile::Face* LLProfile::addHole(const LLProfileParams& params, BOOL flat, F3
 
 	Face *face = addFace(mTotalOut, mTotal-mTotalOut,0,LL_FACE_INNER_SIDE, flat);
 
-	static LLAlignedArray<LLVector4a,64> pt;
+	// Not static: volumes may be generated on several threads at once
+	LLAlignedArray<LLVector4a,64> pt;
 	pt.resize(mTotal) ;
 
 	for (S32 i=mTotalOut;i<mTotal;i++)
@@ -2037,7 +2039,8 @@ LLProfile::~LLProfile()
 }
 
 
-S32 LLVolume::sNumMeshPoints = 0;
+LLAtomicS32 LLVolume::sNumMeshPoints(0);
+bool LLVolume::sUsePickBVH = true;
 
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL generate_single_face, const BOOL is_unique)
 	: mParams(params)
@@ -3915,6 +3918,69 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 	}
 }
 
+// Fills in what the caller of lineSegmentIntersect() asked for about a hit
+// at start + t * dir on the triangle idx0, idx1, idx2
+static void set_hit_attributes(const LLVolumeFace& face, U16 idx0, U16 idx1, U16 idx2,
+							   F32 a, F32 b, F32 t, const LLVector4a& start, const LLVector4a& dir,
+							   LLVector4a* intersection, LLVector2* tex_coord, LLVector4a* normal, LLVector4a* tangent_out)
+{
+	if (intersection != NULL)
+	{
+		LLVector4a intersect = dir;
+		intersect.mul(t);
+		intersect.add(start);
+		*intersection = intersect;
+	}
+
+	if (tex_coord != NULL)
+	{
+		const LLVector2* tc = face.mTexCoords;
+		*tex_coord = ((1.f - a - b)  * tc[idx0] +
+			a              * tc[idx1] +
+			b              * tc[idx2]);
+	}
+
+	if (normal!= NULL)
+	{
+		const LLVector4a* norm = face.mNormals;
+		
+		LLVector4a n1,n2,n3;
+		n1 = norm[idx0];
+		n1.mul(1.f-a-b);
+		
+		n2 = norm[idx1];
+		n2.mul(a);
+		
+		n3 = norm[idx2];
+		n3.mul(b);
+
+		n1.add(n2);
+		n1.add(n3);
+		
+		*normal		= n1; 
+	}
+
+	if (tangent_out != NULL)
+	{
+		const LLVector4a* tangents = face.mTangents;
+		
+		LLVector4a t1,t2,t3;
+		t1 = tangents[idx0];
+		t1.mul(1.f-a-b);
+		
+		t2 = tangents[idx1];
+		t2.mul(a);
+		
+		t3 = tangents[idx2];
+		t3.mul(b);
+
+		t1.add(t2);
+		t1.add(t3);
+		
+		*tangent_out = t1; 
+	}
+}
+
 S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& end, 
 								   S32 face,
 								   LLVector4a* intersection,LLVector2* tex_coord, LLVector4a* normal, LLVector4a* tangent_out)
@@ -3986,67 +4052,25 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
 							closest_t = t;
 							hit_face = i;
 
-							if (intersection != NULL)
-							{
-								LLVector4a intersect = dir;
-								intersect.mul(closest_t);
-								intersect.add(start);
-								*intersection = intersect;
-							}
-
-
-							if (tex_coord != NULL)
-							{
-								LLVector2* tc = (LLVector2*) face.mTexCoords;
-								*tex_coord = ((1.f - a - b)  * tc[idx0] +
-									a              * tc[idx1] +
-									b              * tc[idx2]);
-
-							}
-
-							if (normal!= NULL)
-							{
-								LLVector4a* norm = face.mNormals;
-								
-								LLVector4a n1,n2,n3;
-								n1 = norm[idx0];
-								n1.mul(1.f-a-b);
-								
-								n2 = norm[idx1];
-								n2.mul(a);
-								
-								n3 = norm[idx2];
-								n3.mul(b);
-
-								n1.add(n2);
-								n1.add(n3);
-								
-								*normal		= n1; 
-							}
-
-							if (tangent_out != NULL)
-							{
-								LLVector4a* tangents = face.mTangents;
-								
-								LLVector4a t1,t2,t3;
-								t1 = tangents[idx0];
-								t1.mul(1.f-a-b);
-								
-								t2 = tangents[idx1];
-								t2.mul(a);
-								
-								t3 = tangents[idx2];
-								t3.mul(b);
-
-								t1.add(t2);
-								t1.add(t3);
-								
-								*tangent_out = t1; 
-							}
+							set_hit_attributes(face, idx0, idx1, idx2, a, b, closest_t, start, dir,
+											   intersection, tex_coord, normal, tangent_out);
 						}
 					}
 				}
 			}
+			else if (sUsePickBVH)
+			{
+				face.createBVH();
+
+				const U16* tri;
+				F32 a, b;
+				if (face.mBVH->intersect(face, start, dir, closest_t, tri, a, b))
+				{
+					hit_face = i;
+					set_hit_attributes(face, tri[0], tri[1], tri[2], a, b, closest_t, start, dir,
+									   intersection, tex_coord, normal, tangent_out);
+				}
+			}
 			else
 			{
 				if (!face.mOctree)
@@ -4606,6 +4630,7 @@ LLVolumeFace::LLVolumeFace() :
 	mWeights(NULL),
     mWeightsScrubbed(FALSE),
 	mOctree(NULL),
+	mBVH(NULL),
 	mOptimized(FALSE)
 {
 	mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
@@ -4631,7 +4656,8 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
 	mIndices(NULL),
 	mWeights(NULL),
     mWeightsScrubbed(FALSE),
-	mOctree(NULL)
+	mOctree(NULL),
+	mBVH(NULL)
 { 
 	mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
 	mCenter = mExtents+2;
@@ -4744,6 +4770,7 @@ void LLVolumeFace::freeData()
 
 	delete mOctree;
 	mOctree = NULL;
+	destroyBVH();
 }
 
 BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
@@ -4751,6 +4778,7 @@ BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 	//tree for this face is no longer valid
 	delete mOctree;
 	mOctree = NULL;
+	destroyBVH();
 
 	LL_CHECK_MEMORY
 	BOOL ret = FALSE ;
@@ -4909,397 +4937,299 @@ void LLVolumeFace::optimize(F32 angle_cutoff)
 
 }
 
-class LLVCacheTriangleData;
+// Vertex cache optimization, Tom Forsyth's method:
+// http://home.comcast.net/~tom_forsyth/papers/fast_vert_cache_opt.html
+//
+// Each step emits the best scoring triangle that uses a vertex in the
+// simulated cache, and only the triangles of those vertices are rescored.
+// Triangles are dropped from their vertices' lists as they are emitted, so
+// a step costs the cache size times the valence, independent of the face
+// size.  When nothing in the cache has triangles left (a dead end), the
+// most recently used vertices that still have some are tried first, then a
+// cursor that walks the triangles once in input order, as in Tipsify.
 
-class LLVCacheVertexData
-{
-public:
-	S32 mIdx;
-	S32 mCacheTag;
-	F64 mScore;
-	U32 mActiveTriangles;
-	std::vector<LLVCacheTriangleData*> mTriangles;
-
-	LLVCacheVertexData()
-	{
-		mCacheTag = -1;
-		mScore = 0.0;
-		mActiveTriangles = 0;
-		mIdx = -1;
-	}
-};
+const F32 FindVertexScore_CacheDecayPower = 1.5f;
+const F32 FindVertexScore_LastTriScore = 0.75f;
+const F32 FindVertexScore_ValenceBoostScale = 2.0f;
+const F32 FindVertexScore_ValenceBoostPower = 0.5f;
+const U32 MaxSizeVertexCache = 32;
+const U32 MaxValenceScore = 32;		// valence boost is table driven up to this
+const U32 ACMRCacheSize = 24;		// FIFO size getACMR() simulates by default
 
-class LLVCacheTriangleData
+class LLVCacheOptimizer
 {
 public:
-	bool mActive;
-	F64 mScore;
-	LLVCacheVertexData* mVertex[3];
-
-	LLVCacheTriangleData()
-	{
-		mActive = true;
-		mScore = 0.0;
-		mVertex[0] = mVertex[1] = mVertex[2] = NULL;
-	}
-
-	void complete()
+	LLVCacheOptimizer()
 	{
-		mActive = false;
-		for (S32 i = 0; i < 3; ++i)
+		const F32 scaler = 1.f / (MaxSizeVertexCache - 3);
+		for (U32 i = 0; i < MaxSizeVertexCache; ++i)
 		{
-			if (mVertex[i])
-			{
-				llassert(mVertex[i]->mActiveTriangles > 0);
-				mVertex[i]->mActiveTriangles--;
+			if (i < 3)
+			{ //vertex was in the last triangle
+				mCacheScore[i] = FindVertexScore_LastTriScore;
+			}
+			else
+			{ //more points for being higher in the cache
+				mCacheScore[i] = powf(1.f - (i - 3) * scaler, FindVertexScore_CacheDecayPower);
 			}
 		}
-	}
-
-	bool operator<(const LLVCacheTriangleData& rhs) const
-	{ //highest score first
-		return rhs.mScore < mScore;
-	}
-};
-
-const F64 FindVertexScore_CacheDecayPower = 1.5;
-const F64 FindVertexScore_LastTriScore = 0.75;
-const F64 FindVertexScore_ValenceBoostScale = 2.0;
-const F64 FindVertexScore_ValenceBoostPower = 0.5;
-const U32 MaxSizeVertexCache = 32;
-const F64 FindVertexScore_Scaler = 1.0/(MaxSizeVertexCache-3);
-
-F64 find_vertex_score(LLVCacheVertexData& data)
-{
-	F64 score = -1.0;
-
-	score = 0.0;
-
-	S32 cache_idx = data.mCacheTag;
-
-	if (cache_idx < 0)
-	{
-		//not in cache
-	}
-	else
-	{
-		if (cache_idx < 3)
-		{ //vertex was in the last triangle
-			score = FindVertexScore_LastTriScore;
-		}
-		else
-		{ //more points for being higher in the cache
-				score = 1.0-((cache_idx-3)*FindVertexScore_Scaler);
-				score = pow(score, FindVertexScore_CacheDecayPower);
+		mValenceScore[0] = 0.f;
+		for (U32 i = 1; i < MaxValenceScore; ++i)
+		{ //bonus points for having low valence
+			mValenceScore[i] = FindVertexScore_ValenceBoostScale * powf((F32)i, -FindVertexScore_ValenceBoostPower);
 		}
 	}
 
-	//bonus points for having low valence
-	F64 valence_boost = pow((F64)data.mActiveTriangles, -FindVertexScore_ValenceBoostPower);
-	score += FindVertexScore_ValenceBoostScale * valence_boost;
-
-	return score;
-}
-
-class LLVCacheFIFO
-{
-public:
-	LLVCacheVertexData* mCache[MaxSizeVertexCache];
-	U32 mMisses;
-
-	LLVCacheFIFO()
+	// Writes the triangles of indices to out in cache friendly order.
+	// Indices past the last whole triangle are copied as they are.
+	void optimize(const U16* indices, U32 num_indices, U32 num_vertices, U16* out)
 	{
-		mMisses = 0;
-		for (U32 i = 0; i < MaxSizeVertexCache; ++i)
+		const U32 num_tris = num_indices / 3;
+		for (U32 i = num_tris * 3; i < num_indices; ++i)
 		{
-			mCache[i] = NULL;
+			out[i] = indices[i];
 		}
-	}
-
-	void addVertex(LLVCacheVertexData* data)
-	{
-		if (data->mCacheTag == -1)
+		if (!num_tris)
 		{
-			mMisses++;
-
-			S32 end = MaxSizeVertexCache-1;
-
-			if (mCache[end])
-			{
-				mCache[end]->mCacheTag = -1;
-			}
-
-			for (S32 i = end; i > 0; --i)
-			{
-				mCache[i] = mCache[i-1];
-				if (mCache[i])
-				{
-					mCache[i]->mCacheTag = i;
-				}
-			}
-
-			mCache[0] = data;
-			data->mCacheTag = 0;
+			return;
 		}
-	}
-};
-
-class LLVCacheLRU
-{
-public:
-	LLVCacheVertexData* mCache[MaxSizeVertexCache+3];
 
-	LLVCacheTriangleData* mBestTriangle;
-	
-	U32 mMisses;
-
-	LLVCacheLRU()
-	{
-		for (U32 i = 0; i < MaxSizeVertexCache+3; ++i)
+		// Triangle lists per vertex, packed into one array.  The first
+		// mActive[v] entries of vertex v's list are not emitted yet.
+		mOffset.assign(num_vertices + 1, 0);
+		mActive.assign(num_vertices, 0);
+		for (U32 i = 0; i < num_tris * 3; ++i)
 		{
-			mCache[i] = NULL;
+			mActive[indices[i]]++;
 		}
-
-		mBestTriangle = NULL;
-		mMisses = 0;
-	}
-
-	void addVertex(LLVCacheVertexData* data)
-	{
-		S32 end = MaxSizeVertexCache+2;
-		if (data->mCacheTag != -1)
-		{ //just moving a vertex to the front of the cache
-			end = data->mCacheTag;
+		for (U32 v = 0; v < num_vertices; ++v)
+		{
+			mOffset[v + 1] = mOffset[v] + mActive[v];
+			mActive[v] = 0;
 		}
-		else
+		mTriangles.resize(num_tris * 3);
+		for (U32 i = 0; i < num_tris * 3; ++i)
 		{
-			mMisses++;
-			if (mCache[end])
-			{ //adding a new vertex, vertex at end of cache falls off
-				mCache[end]->mCacheTag = -1;
-			}
+			U16 v = indices[i];
+			mTriangles[mOffset[v] + mActive[v]++] = i / 3;
 		}
 
-		for (S32 i = end; i > 0; --i)
-		{ //adjust cache pointers and tags
-			mCache[i] = mCache[i-1];
-
-			if (mCache[i])
-			{
-				mCache[i]->mCacheTag = i;			
-			}
+		mCachePos.assign(num_vertices, -1);
+		mVertexScore.resize(num_vertices);
+		for (U32 v = 0; v < num_vertices; ++v)
+		{
+			mVertexScore[v] = vertexScore(v);
 		}
 
-		mCache[0] = data;
-		mCache[0]->mCacheTag = 0;
-	}
-
-	void addTriangle(LLVCacheTriangleData* data)
-	{
-		addVertex(data->mVertex[0]);
-		addVertex(data->mVertex[1]);
-		addVertex(data->mVertex[2]);
-	}
-
-	void updateScores()
-	{
-		LLVCacheVertexData** data_iter = mCache+MaxSizeVertexCache;
-		LLVCacheVertexData** end_data = mCache+MaxSizeVertexCache+3;
-
-		while(data_iter != end_data)
+		mEmitted.assign(num_tris, false);
+		S32 best = 0;
+		F32 best_score = -1.f;
+		for (U32 t = 0; t < num_tris; ++t)
 		{
-			LLVCacheVertexData* data = *data_iter++;
-			//trailing 3 vertices aren't actually in the cache for scoring purposes
-			if (data)
+			const U16* tri = indices + t * 3;
+			F32 score = mVertexScore[tri[0]] + mVertexScore[tri[1]] + mVertexScore[tri[2]];
+			if (score > best_score)
 			{
-				data->mCacheTag = -1;
+				best_score = score;
+				best = t;
 			}
 		}
 
-		data_iter = mCache;
-		end_data = mCache+MaxSizeVertexCache;
-
-		while (data_iter != end_data)
-		{ //update scores of vertices in cache
-			LLVCacheVertexData* data = *data_iter++;
-			if (data)
+		mDeadEnd.clear();
+		U32 cache_size = 0;
+		U32 cursor = 0;
+		for (U32 emitted = 0; emitted < num_tris; ++emitted)
+		{
+			if (best < 0)
 			{
-				data->mScore = find_vertex_score(*data);
+				best = findDeadEndTriangle(num_tris, cursor);
 			}
-		}
 
-		mBestTriangle = NULL;
-		//update triangle scores
-		data_iter = mCache;
-		end_data = mCache+MaxSizeVertexCache+3;
+			const U16* tri = indices + best * 3;
+			out[emitted * 3] = tri[0];
+			out[emitted * 3 + 1] = tri[1];
+			out[emitted * 3 + 2] = tri[2];
+			mEmitted[best] = true;
 
-		while (data_iter != end_data)
-		{
-			LLVCacheVertexData* data = *data_iter++;
-			if (data)
+			for (U32 k = 0; k < 3; ++k)
 			{
-				for (std::vector<LLVCacheTriangleData*>::iterator iter = data->mTriangles.begin(), end_iter = data->mTriangles.end(); iter != end_iter; ++iter)
+				U16 v = tri[k];
+				U32* list = &mTriangles[mOffset[v]];
+				U32 last = --mActive[v];
+				for (U32 j = 0; j <= last; ++j)
 				{
-					LLVCacheTriangleData* tri = *iter;
-					if (tri->mActive)
+					if (list[j] == (U32)best)
 					{
-						tri->mScore = tri->mVertex[0]->mScore;
-						tri->mScore += tri->mVertex[1]->mScore;
-						tri->mScore += tri->mVertex[2]->mScore;
-
-						if (!mBestTriangle || mBestTriangle->mScore < tri->mScore)
-						{
-							mBestTriangle = tri;
-						}
+						list[j] = list[last];
+						list[last] = best;
+						break;
 					}
 				}
+				mDeadEnd.push_back(v);
 			}
-		}
 
-		//knock trailing 3 vertices off the cache
-		data_iter = mCache+MaxSizeVertexCache;
-		end_data = mCache+MaxSizeVertexCache+3;
-		while (data_iter != end_data)
-		{
-			LLVCacheVertexData* data = *data_iter;
-			if (data)
+			// The triangle's vertices go to the front of the cache,
+			// whatever comes after MaxSizeVertexCache falls out
+			U32 new_size = 0;
+			for (U32 k = 0; k < 3; ++k)
 			{
-				llassert(data->mCacheTag == -1);
-				*data_iter = NULL;
+				mNewCache[new_size++] = tri[k];
 			}
-			++data_iter;
-		}
-	}
-};
-
-
-void LLVolumeFace::cacheOptimize()
-{ //optimize for vertex cache according to Forsyth method: 
-  // http://home.comcast.net/~tom_forsyth/papers/fast_vert_cache_opt.html
-	
-	llassert(!mOptimized);
-	mOptimized = TRUE;
+			for (U32 i = 0; i < cache_size; ++i)
+			{
+				U16 v = mCache[i];
+				if (v != tri[0] && v != tri[1] && v != tri[2])
+				{
+					mNewCache[new_size++] = v;
+				}
+			}
+			for (U32 i = 0; i < new_size; ++i)
+			{
+				U16 v = mNewCache[i];
+				mCachePos[v] = i < MaxSizeVertexCache ? (S32)i : -1;
+				mVertexScore[v] = vertexScore(v);
+			}
+			cache_size = llmin(new_size, MaxSizeVertexCache);
+			memcpy(mCache, mNewCache, cache_size * sizeof(U16));
 
-	LLVCacheLRU cache;
-	
-	if (mNumVertices < 3)
-	{ //nothing to do
-		return;
+			// Only triangles around the vertices just moved change score
+			best = -1;
+			best_score = -1.f;
+			for (U32 i = 0; i < new_size; ++i)
+			{
+				U16 v = mNewCache[i];
+				const U32* list = &mTriangles[mOffset[v]];
+				for (U32 j = 0; j < mActive[v]; ++j)
+				{
+					U32 t = list[j];
+					const U16* other = indices + t * 3;
+					F32 score = mVertexScore[other[0]] + mVertexScore[other[1]] + mVertexScore[other[2]];
+					if (score > best_score)
+					{
+						best_score = score;
+						best = t;
+					}
+				}
+			}
+		}
 	}
 
-	//mapping of vertices to triangles and indices
-	std::vector<LLVCacheVertexData> vertex_data;
-
-	//mapping of triangles do vertices
-	std::vector<LLVCacheTriangleData> triangle_data;
-
-	triangle_data.resize(mNumIndices/3);
-	vertex_data.resize(mNumVertices);
-
-	for (U32 i = 0; i < mNumIndices; i++)
-	{ //populate vertex data and triangle data arrays
-		U16 idx = mIndices[i];
-		U32 tri_idx = i/3;
-
-		vertex_data[idx].mTriangles.push_back(&(triangle_data[tri_idx]));
-		vertex_data[idx].mIdx = idx;
-		triangle_data[tri_idx].mVertex[i%3] = &(vertex_data[idx]);
+private:
+	F32 vertexScore(U16 v) const
+	{
+		U32 active = mActive[v];
+		if (!active)
+		{ //no triangles left, never pick this one
+			return -1.f;
+		}
+		S32 cache_pos = mCachePos[v];
+		F32 score = cache_pos < 0 ? 0.f : mCacheScore[cache_pos];
+		return score + (active < MaxValenceScore ? mValenceScore[active] : 0.f);
 	}
 
-	/*F32 pre_acmr = 1.f;
-	//measure cache misses from before rebuild
+	S32 findDeadEndTriangle(U32 num_tris, U32& cursor)
 	{
-		LLVCacheFIFO test_cache;
-		for (U32 i = 0; i < mNumIndices; ++i)
+		while (!mDeadEnd.empty())
 		{
-			test_cache.addVertex(&vertex_data[mIndices[i]]);
+			U16 v = mDeadEnd.back();
+			mDeadEnd.pop_back();
+			if (mActive[v])
+			{
+				return mTriangles[mOffset[v]];
+			}
 		}
-
-		for (U32 i = 0; i < mNumVertices; i++)
+		while (mEmitted[cursor])
 		{
-			vertex_data[i].mCacheTag = -1;
+			++cursor;
 		}
+		llassert(cursor < num_tris);
+		return cursor;
+	}
 
-		pre_acmr = (F32) test_cache.mMisses/(mNumIndices/3);
-	}*/
+	F32 mCacheScore[MaxSizeVertexCache];
+	F32 mValenceScore[MaxValenceScore];
 
-	for (U32 i = 0; i < mNumVertices; i++)
-	{ //initialize score values (no cache -- might try a fifo cache here)
-		LLVCacheVertexData& data = vertex_data[i];
+	std::vector<U32> mOffset;
+	std::vector<U32> mActive;
+	std::vector<U32> mTriangles;
+	std::vector<S32> mCachePos;
+	std::vector<F32> mVertexScore;
+	std::vector<bool> mEmitted;
+	std::vector<U16> mDeadEnd;
+	U16 mCache[MaxSizeVertexCache];
+	U16 mNewCache[MaxSizeVertexCache + 3];
+};
 
-		data.mScore = find_vertex_score(data);
-		data.mActiveTriangles = data.mTriangles.size();
+F32 LLVolumeFace::getACMR(U32 cache_size) const
+{
+	if (mNumIndices < 3)
+	{
+		return 0.f;
+	}
+	if (!cache_size)
+	{
+		cache_size = ACMRCacheSize;
+	}
 
-		for (U32 j = 0; j < data.mActiveTriangles; ++j)
+	// A vertex is still in the FIFO if fewer than cache_size misses
+	// happened since it went in
+	std::vector<U32> added(mNumVertices, 0);
+	U32 misses = 0;
+	for (U32 i = 0; i < mNumIndices; ++i)
+	{
+		U16 idx = mIndices[i];
+		if (!added[idx] || misses - added[idx] >= cache_size)
 		{
-			data.mTriangles[j]->mScore += data.mScore;
+			misses++;
+			added[idx] = misses;
 		}
 	}
+	return (F32)misses / (F32)(mNumIndices / 3);
+}
 
-	//sort triangle data by score
-	std::sort(triangle_data.begin(), triangle_data.end());
-
-	std::vector<U16> new_indices;
-
-	LLVCacheTriangleData* tri;
+void LLVolumeFace::cacheOptimize()
+{
+	llassert(!mOptimized);
+	mOptimized = TRUE;
 
-	//prime pump by adding first triangle to cache;
-	tri = &(triangle_data[0]);
-	cache.addTriangle(tri);
-	new_indices.push_back(tri->mVertex[0]->mIdx);
-	new_indices.push_back(tri->mVertex[1]->mIdx);
-	new_indices.push_back(tri->mVertex[2]->mIdx);
-	tri->complete();
+	if (mNumVertices < 3 || mNumIndices < 3)
+	{ //nothing to do
+		return;
+	}
 
-	U32 breaks = 0;
-	for (U32 i = 1; i < mNumIndices/3; ++i)
+	//reorder triangles for the post-TnL cache
+	std::vector<U16> new_indices(mNumIndices);
 	{
-		cache.updateScores();
-		tri = cache.mBestTriangle;
-		if (!tri)
-		{
-			breaks++;
-			for (U32 j = 0; j < triangle_data.size(); ++j)
-			{
-				if (triangle_data[j].mActive)
-				{
-					tri = &(triangle_data[j]);
-					break;
-				}
-			}
-		}	
-		
-		cache.addTriangle(tri);
-		new_indices.push_back(tri->mVertex[0]->mIdx);
-		new_indices.push_back(tri->mVertex[1]->mIdx);
-		new_indices.push_back(tri->mVertex[2]->mIdx);
-		tri->complete();
+		LLVCacheOptimizer optimizer;
+		optimizer.optimize(mIndices, mNumIndices, mNumVertices, &new_indices[0]);
 	}
 
+	//optimize for pre-TnL cache: vertices in the order the triangles first
+	//use them, anything no triangle uses goes at the end
+	std::vector<S32> new_idx;
+	new_idx.resize(mNumVertices, -1);
+	std::vector<U16> old_idx;
+	old_idx.reserve(mNumVertices);
+
 	for (U32 i = 0; i < mNumIndices; ++i)
 	{
-		mIndices[i] = new_indices[i];
+		U16 idx = new_indices[i];
+		if (new_idx[idx] == -1)
+		{ //this vertex hasn't been added yet
+			new_idx[idx] = (S32)old_idx.size();
+			old_idx.push_back(idx);
+		}
+		mIndices[i] = new_idx[idx];
 	}
-
-	/*F32 post_acmr = 1.f;
-	//measure cache misses from after rebuild
+	for (S32 i = 0; i < mNumVertices; ++i)
 	{
-		LLVCacheFIFO test_cache;
-		for (U32 i = 0; i < mNumVertices; i++)
-		{
-			vertex_data[i].mCacheTag = -1;
-		}
-
-		for (U32 i = 0; i < mNumIndices; ++i)
+		if (new_idx[i] == -1)
 		{
-			test_cache.addVertex(&vertex_data[mIndices[i]]);
+			new_idx[i] = (S32)old_idx.size();
+			old_idx.push_back(i);
 		}
-		
-		post_acmr = (F32) test_cache.mMisses/(mNumIndices/3);
-	}*/
+	}
 
-	//optimize for pre-TnL cache
-	
 	//allocate space for new buffer
 	S32 num_verts = mNumVertices;
 	S32 size = ((num_verts*sizeof(LLVector2)) + 0xF) & ~0xF;
@@ -5331,40 +5261,23 @@ void LLVolumeFace::cacheOptimize()
 		}
 	}
 
-	//allocate mapping of old indices to new indices
-	std::vector<S32> new_idx;
-	new_idx.resize(mNumVertices, -1);
-
-	S32 cur_idx = 0;
-	for (U32 i = 0; i < mNumIndices; ++i)
+	//copy vertex data
+	for (S32 i = 0; i < num_verts; ++i)
 	{
-		U16 idx = mIndices[i];
-		if (new_idx[idx] == -1)
-		{ //this vertex hasn't been added yet
-			new_idx[idx] = cur_idx;
-
-			//copy vertex data
-			pos[cur_idx] = mPositions[idx];
-			norm[cur_idx] = mNormals[idx];
-			tc[cur_idx] = mTexCoords[idx];
-			if (mWeights)
-			{
-				wght[cur_idx] = mWeights[idx];
-			}
-			if (mTangents)
-			{
-				binorm[cur_idx] = mTangents[idx];
-			}
-
-			cur_idx++;
+		U16 idx = old_idx[i];
+		pos[i] = mPositions[idx];
+		norm[i] = mNormals[idx];
+		tc[i] = mTexCoords[idx];
+		if (mWeights)
+		{
+			wght[i] = mWeights[idx];
+		}
+		if (mTangents)
+		{
+			binorm[i] = mTangents[idx];
 		}
 	}
 
-	for (U32 i = 0; i < mNumIndices; ++i)
-	{
-		mIndices[i] = new_idx[mIndices[i]];
-	}
-	
 	ll_aligned_free<64>(mPositions);
 	// DO NOT free mNormals and mTexCoords as they are part of mPositions buffer
 	ll_aligned_free_16(mWeights);
@@ -5375,10 +5288,6 @@ void LLVolumeFace::cacheOptimize()
 	mTexCoords = tc;
 	mWeights = wght;
 	mTangents = binorm;
-
-	//std::string result = llformat("ACMR pre/post: %.3f/%.3f  --  %d triangles %d breaks", pre_acmr, post_acmr, mNumIndices/3, breaks);
-	//LL_INFOS() << result << LL_ENDL;
-
 }
 
 void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVector4a& size)
@@ -5450,6 +5359,19 @@ void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVe
 	}
 }
 
+void LLVolumeFace::createBVH()
+{
+	if (!mBVH)
+	{
+		mBVH = new LLVolumeBVH(*this);
+	}
+}
+
+void LLVolumeFace::destroyBVH()
+{
+	delete mBVH;
+	mBVH = NULL;
+}
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
@@ -5460,6 +5382,8 @@ void LLVolumeFace::swapData(LLVolumeFace& rhs)
 	llswap(rhs.mIndices,mIndices);
 	llswap(rhs.mNumVertices, mNumVertices);
 	llswap(rhs.mNumIndices, mNumIndices);
+	destroyBVH();
+	rhs.destroyBVH();
 }
 
 void	LerpPlanarVertex(LLVolumeFace::VertexData& v0,
@@ -6685,7 +6609,8 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 
 	LLVector4a* norm = mNormals;
 
-	static LLAlignedArray<LLVector4a, 64> triangle_normals;
+	// Not static: volumes may be generated on several threads at once
+	LLAlignedArray<LLVector4a, 64> triangle_normals;
 	triangle_normals.resize(count);
 	LLVector4a* output = triangle_normals.mArray;
 	LLVector4a* end_output = output+count;
@@ -40,6 +40,7 @@ template <class T> class LLOctreeNode;
 class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
+class LLVolumeBVH;
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -57,6 +58,7 @@ class LLVolumeTriangle;
 #include "llpointer.h"
 #include "llfile.h"
 #include "llalignedarray.h"
+#include "llapr.h"
 
 //============================================================================
 
@@ -903,9 +905,17 @@ public:
 	};
 
 	void optimize(F32 angle_cutoff = 2.f);
+	// Reorders triangles for the post-transform vertex cache, then
+	// vertices in the order the new triangle order fetches them
 	void cacheOptimize();
+	// Average cache miss ratio (misses per triangle) of the current index
+	// order through a FIFO vertex cache, 0 picks a typical cache size
+	F32 getACMR(U32 cache_size = 0) const;
 
 	void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
+	// Builds mBVH if it isn't there yet
+	void createBVH();
+	void destroyBVH();
 
 	enum
 	{
@@ -961,6 +971,9 @@ public:
     
 	LLOctreeNode<LLVolumeTriangle>* mOctree;
 
+	//flat picking tree, see LLVolume::sUsePickBVH.  Built on first use.
+	LLVolumeBVH* mBVH;
+
 	//whether or not face has been cache optimized
 	BOOL mOptimized;
 
@@ -1045,7 +1058,9 @@ public:
 	LLFaceID generateFaceMask();
 
 	BOOL isFaceMaskValid(LLFaceID face_mask);
-	static S32 sNumMeshPoints;
+	static LLAtomicS32 sNumMeshPoints;	// volumes are generated on several threads
+	// lineSegmentIntersect() uses LLVolumeFace::mBVH instead of mOctree
+	static bool sUsePickBVH;
 
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);		// HACK to bypass Windoze confusion over 
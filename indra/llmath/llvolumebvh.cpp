@@ -0,0 +1,452 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flat bounding volume hierarchy for ray queries against a volume face
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+
+#include <algorithm>
+
+#include "llmemory.h"
+#include "llvolume.h"
+
+// Nodes this small are always leaves.  Up to MAX_LEAF_SIZE triangles are
+// kept in a leaf when splitting doesn't pay off, anything bigger is split.
+static const U32 MIN_LEAF_SIZE = 4;
+static const U32 MAX_LEAF_SIZE = 8;
+// At most this many bins per axis, small nodes use one per triangle
+static const U32 NUM_BINS = 16;
+// Cost of visiting a node relative to testing a triangle
+static const F32 TRAVERSAL_COST = 1.f;
+// Below this depth nodes are split at the median instead, which bounds the
+// depth (and intersect()'s stack) even for the most lopsided input
+static const U32 MAX_SAH_DEPTH = 40;
+static const U32 MAX_STACK_DEPTH = 64;
+
+struct LLVolumeBVH::BuildData
+{
+	BuildData(U32 num_triangles)
+	:	mNumNodes(0)
+	{
+		mBounds = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a) * 3 * num_triangles);
+		mCentroids = mBounds + 2 * num_triangles;
+		mOrder.resize(num_triangles);
+	}
+
+	~BuildData()
+	{
+		ll_aligned_free_16(mBounds);
+	}
+
+	LLVector4a*			mBounds;	// min, max per triangle
+	LLVector4a*			mCentroids;
+	std::vector<U32>	mOrder;		// triangles, partitioned as the tree is built
+	Node*				mNodes;
+	U32					mNumNodes;
+};
+
+namespace
+{
+	F32 half_area(const LLVector4a& min, const LLVector4a& max)
+	{
+		LLVector4a size;
+		size.setSub(max, min);
+		const F32* s = size.getF32ptr();
+		return s[0] * s[1] + s[1] * s[2] + s[2] * s[0];
+	}
+
+	struct Bin
+	{
+		LLVector4a mMin;
+		LLVector4a mMax;
+		U32 mCount;
+
+		void reset()
+		{
+			mMin.splat(F32_MAX);
+			mMax.splat(-F32_MAX);
+			mCount = 0;
+		}
+	};
+
+	struct CentroidLess
+	{
+		CentroidLess(const LLVector4a* centroids, S32 axis)
+		:	mCentroids(centroids), mAxis(axis)
+		{
+		}
+
+		bool operator()(U32 lhs, U32 rhs) const
+		{
+			return mCentroids[lhs][mAxis] < mCentroids[rhs][mAxis];
+		}
+
+		const LLVector4a* mCentroids;
+		S32 mAxis;
+	};
+
+	struct CentroidBelow
+	{
+		CentroidBelow(const LLVector4a* centroids, S32 axis, F32 split)
+		:	mCentroids(centroids), mAxis(axis), mSplit(split)
+		{
+		}
+
+		bool operator()(U32 tri) const
+		{
+			return mCentroids[tri][mAxis] < mSplit;
+		}
+
+		const LLVector4a* mCentroids;
+		S32 mAxis;
+		F32 mSplit;
+	};
+}
+
+LLVolumeBVH::LLVolumeBVH(const LLVolumeFace& face)
+:	mNodes(NULL),
+	mNumNodes(0),
+	mIndices(NULL),
+	mNumTriangles(face.mNumIndices / 3)
+{
+	if (!mNumTriangles)
+	{
+		return;
+	}
+
+	BuildData data(mNumTriangles);
+	for (U32 i = 0; i < mNumTriangles; ++i)
+	{
+		const LLVector4a& v0 = face.mPositions[face.mIndices[i * 3]];
+		const LLVector4a& v1 = face.mPositions[face.mIndices[i * 3 + 1]];
+		const LLVector4a& v2 = face.mPositions[face.mIndices[i * 3 + 2]];
+		LLVector4a& min = data.mBounds[i * 2];
+		LLVector4a& max = data.mBounds[i * 2 + 1];
+		min.setMin(v0, v1);
+		min.setMin(min, v2);
+		max.setMax(v0, v1);
+		max.setMax(max, v2);
+		data.mCentroids[i].setAdd(min, max);
+		data.mCentroids[i].mul(0.5f);
+		data.mOrder[i] = i;
+	}
+
+	// A binary tree with at least one triangle per leaf
+	Node* nodes = (Node*) ll_aligned_malloc_16(sizeof(Node) * (2 * mNumTriangles - 1));
+	data.mNodes = nodes;
+	build(data, 0, mNumTriangles, 0);
+
+	mNumNodes = data.mNumNodes;
+	mNodes = (Node*) ll_aligned_malloc_16(sizeof(Node) * mNumNodes);
+	memcpy(mNodes, nodes, sizeof(Node) * mNumNodes);
+	ll_aligned_free_16(nodes);
+
+	mIndices = (U16*) ll_aligned_malloc_16(sizeof(U16) * 3 * mNumTriangles);
+	for (U32 i = 0; i < mNumTriangles; ++i)
+	{
+		const U16* src = face.mIndices + data.mOrder[i] * 3;
+		mIndices[i * 3] = src[0];
+		mIndices[i * 3 + 1] = src[1];
+		mIndices[i * 3 + 2] = src[2];
+	}
+}
+
+LLVolumeBVH::~LLVolumeBVH()
+{
+	ll_aligned_free_16(mNodes);
+	ll_aligned_free_16(mIndices);
+}
+
+U32 LLVolumeBVH::getMemoryUsage() const
+{
+	return sizeof(LLVolumeBVH) + mNumNodes * sizeof(Node) + mNumTriangles * 3 * sizeof(U16);
+}
+
+U32 LLVolumeBVH::build(BuildData& data, U32 begin, U32 end, U32 depth)
+{
+	U32 index = data.mNumNodes++;
+	Node& node = data.mNodes[index];
+	const U32 count = end - begin;
+
+	LLVector4a min, max, centroid_min, centroid_max;
+	min.splat(F32_MAX);
+	max.splat(-F32_MAX);
+	centroid_min = min;
+	centroid_max = max;
+	for (U32 i = begin; i < end; ++i)
+	{
+		U32 tri = data.mOrder[i];
+		min.setMin(min, data.mBounds[tri * 2]);
+		max.setMax(max, data.mBounds[tri * 2 + 1]);
+		centroid_min.setMin(centroid_min, data.mCentroids[tri]);
+		centroid_max.setMax(centroid_max, data.mCentroids[tri]);
+	}
+	node.mMin = min;
+	node.mMax = max;
+	node.mMin.getF32ptr()[3] = 0.f;
+	node.mMax.getF32ptr()[3] = F32_MAX;
+	node.mOffset = begin;
+	node.mCount = count;
+	node.mAxis = 0;
+
+	if (count <= MIN_LEAF_SIZE)
+	{
+		return index;
+	}
+
+	if (depth >= MAX_SAH_DEPTH)
+	{
+		LLVector4a extent;
+		extent.setSub(centroid_max, centroid_min);
+		S32 axis = extent[0] > extent[1] ? 0 : 1;
+		axis = extent[2] > extent[axis] ? 2 : axis;
+		U32 middle = begin + count / 2;
+		std::nth_element(data.mOrder.begin() + begin, data.mOrder.begin() + middle, data.mOrder.begin() + end,
+						 CentroidLess(data.mCentroids, axis));
+		build(data, begin, middle, depth + 1);
+		node.mOffset = build(data, middle, end, depth + 1);
+		node.mCount = 0;
+		node.mAxis = axis;
+		return index;
+	}
+
+	// Best split over every axis by the surface area heuristic, binning
+	// all three axes in one pass over the triangles
+	LLVector4a centroid_extent;
+	centroid_extent.setSub(centroid_max, centroid_min);
+	const U32 num_bins = llmin(count, NUM_BINS);
+	LLVector4a scale;
+	for (S32 axis = 0; axis < 3; ++axis)
+	{
+		F32 extent = centroid_extent[axis];
+		scale.getF32ptr()[axis] = extent > 0.f ? num_bins / extent : 0.f;
+	}
+	scale.getF32ptr()[3] = 0.f;
+
+	Bin bins[3][NUM_BINS];
+	for (S32 axis = 0; axis < 3; ++axis)
+	{
+		for (U32 b = 0; b < num_bins; ++b)
+		{
+			bins[axis][b].reset();
+		}
+	}
+	for (U32 i = begin; i < end; ++i)
+	{
+		U32 tri = data.mOrder[i];
+		const LLVector4a& tri_min = data.mBounds[tri * 2];
+		const LLVector4a& tri_max = data.mBounds[tri * 2 + 1];
+		LLVector4a pos;
+		pos.setSub(data.mCentroids[tri], centroid_min);
+		pos.mul(scale);
+		for (S32 axis = 0; axis < 3; ++axis)
+		{
+			Bin& bin = bins[axis][llmin((U32)pos[axis], num_bins - 1)];
+			bin.mMin.setMin(bin.mMin, tri_min);
+			bin.mMax.setMax(bin.mMax, tri_max);
+			bin.mCount++;
+		}
+	}
+
+	S32 best_axis = -1;
+	F32 best_split = 0.f;
+	F32 best_cost = F32_MAX;
+	for (S32 axis = 0; axis < 3; ++axis)
+	{
+		if (scale[axis] <= 0.f)
+		{
+			continue;
+		}
+		F32 lo = centroid_min[axis];
+
+		// Sweep from the right to get the cost of everything past each plane
+		F32 right_cost[NUM_BINS];
+		LLVector4a right_min, right_max;
+		right_min.splat(F32_MAX);
+		right_max.splat(-F32_MAX);
+		U32 right_count = 0;
+		for (U32 b = num_bins - 1; b > 0; --b)
+		{
+			right_min.setMin(right_min, bins[axis][b].mMin);
+			right_max.setMax(right_max, bins[axis][b].mMax);
+			right_count += bins[axis][b].mCount;
+			right_cost[b] = right_count ? half_area(right_min, right_max) * right_count : 0.f;
+		}
+
+		LLVector4a left_min, left_max;
+		left_min.splat(F32_MAX);
+		left_max.splat(-F32_MAX);
+		U32 left_count = 0;
+		for (U32 b = 0; b < num_bins - 1; ++b)
+		{
+			left_min.setMin(left_min, bins[axis][b].mMin);
+			left_max.setMax(left_max, bins[axis][b].mMax);
+			left_count += bins[axis][b].mCount;
+			if (!left_count || left_count == count)
+			{
+				continue;
+			}
+			F32 cost = half_area(left_min, left_max) * left_count + right_cost[b + 1];
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_axis = axis;
+				best_split = lo + (b + 1) / scale[axis];
+			}
+		}
+	}
+
+	U32 middle = begin;
+	if (best_axis >= 0)
+	{
+		F32 area = half_area(min, max);
+		F32 split_cost = TRAVERSAL_COST + (area > 0.f ? best_cost / area : (F32)count);
+		if (count <= MAX_LEAF_SIZE && split_cost >= (F32)count)
+		{
+			return index;
+		}
+		middle = (U32)(std::partition(data.mOrder.begin() + begin, data.mOrder.begin() + end,
+									  CentroidBelow(data.mCentroids, best_axis, best_split))
+					   - data.mOrder.begin());
+	}
+	if (middle == begin || middle == end)
+	{
+		// All centroids in one place, nothing to gain by splitting
+		if (count <= MAX_LEAF_SIZE)
+		{
+			return index;
+		}
+		middle = begin + count / 2;
+		best_axis = 0;
+	}
+
+	// node stays valid, the array was allocated for the worst case
+	build(data, begin, middle, depth + 1);
+	node.mOffset = build(data, middle, end, depth + 1);
+	node.mCount = 0;
+	node.mAxis = best_axis;
+	return index;
+}
+
+bool LLVolumeBVH::intersect(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& dir,
+							F32& closest_t, const U16*& indices, F32& a, F32& b) const
+{
+	if (!mNumNodes)
+	{
+		return false;
+	}
+
+	// Slab test setup.  The w lanes make the test include t >= 0 for free:
+	// with start.w = 0 and inv_dir.w = 1 a node's w extents give a near
+	// of 0 and a far of F32_MAX.
+	LLVector4a origin = start;
+	origin.getF32ptr()[3] = 0.f;
+	LLVector4a inv_dir;
+	F32* inv = inv_dir.getF32ptr();
+	for (S32 i = 0; i < 3; ++i)
+	{
+		F32 d = dir[i];
+		if (fabsf(d) < 1e-20f)
+		{
+			d = d < 0.f ? -1e-20f : 1e-20f;
+		}
+		inv[i] = 1.f / d;
+	}
+	inv[3] = 1.f;
+	bool negative[3] = { inv[0] < 0.f, inv[1] < 0.f, inv[2] < 0.f };
+
+	bool hit = false;
+	F32 max_t = llmin(closest_t, 1.f);
+
+	U32 stack[MAX_STACK_DEPTH];
+	U32 stack_size = 0;
+	U32 current = 0;
+	while (true)
+	{
+		const Node& node = mNodes[current];
+
+		LLVector4a t0, t1, near_t, far_t;
+		t0.setSub(node.mMin, origin);
+		t0.mul(inv_dir);
+		t1.setSub(node.mMax, origin);
+		t1.mul(inv_dir);
+		near_t.setMin(t0, t1);
+		far_t.setMax(t0, t1);
+		// Largest near and smallest far over all four lanes
+		LLQuad n = near_t;
+		LLQuad f = far_t;
+		n = _mm_max_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 3, 0, 1)));
+		n = _mm_max_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(1, 0, 3, 2)));
+		f = _mm_min_ps(f, _mm_shuffle_ps(f, f, _MM_SHUFFLE(2, 3, 0, 1)));
+		f = _mm_min_ps(f, _mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 0, 3, 2)));
+		f = _mm_min_ss(f, _mm_set_ss(max_t));
+
+		if (_mm_comile_ss(n, f))
+		{
+			if (node.mCount)
+			{
+				const U16* tri = mIndices + node.mOffset * 3;
+				for (U32 i = 0; i < node.mCount; ++i, tri += 3)
+				{
+					F32 tri_a, tri_b, t;
+					if (LLTriangleRayIntersect(face.mPositions[tri[0]], face.mPositions[tri[1]], face.mPositions[tri[2]],
+											   start, dir, tri_a, tri_b, t)
+						&& t >= 0.f && t <= max_t && t < closest_t)
+					{
+						closest_t = t;
+						max_t = t;
+						indices = tri;
+						a = tri_a;
+						b = tri_b;
+						hit = true;
+					}
+				}
+			}
+			else
+			{
+				// Visit the child on the ray's side of the split first
+				U32 first = current + 1;
+				U32 second = node.mOffset;
+				if (negative[node.mAxis])
+				{
+					std::swap(first, second);
+				}
+				llassert(stack_size < sizeof(stack) / sizeof(stack[0]));
+				stack[stack_size++] = second;
+				current = first;
+				continue;
+			}
+		}
+
+		if (!stack_size)
+		{
+			break;
+		}
+		current = stack[--stack_size];
+	}
+
+	return hit;
+}
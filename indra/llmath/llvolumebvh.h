@@ -0,0 +1,85 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flat bounding volume hierarchy for ray queries against a volume face
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include "llmath.h"	// LLVector4a
+
+class LLVolumeFace;
+
+// Bounding volume hierarchy over the triangles of one LLVolumeFace, an
+// alternative to LLVolumeFace::mOctree for picking.  Nodes live in one
+// array in depth first order, so a node's first child directly follows it
+// and only the second child's index is stored.  Splits are picked by the
+// surface area heuristic over binned triangle centroids.
+//
+// The tree keeps its own copy of the face's indices, reordered so that each
+// leaf's triangles are contiguous, but reads vertex positions from the face.
+// Anything that moves the face's vertices must throw the tree away.
+class LLVolumeBVH
+{
+public:
+	LLVolumeBVH(const LLVolumeFace& face);
+	~LLVolumeBVH();
+
+	// Finds the closest triangle hit by the segment start + t * dir,
+	// 0 <= t <= 1, that is closer than closest_t.  On a hit closest_t is
+	// updated, indices points at the triangle's three vertex indices and
+	// a, b are the barycentric coordinates of vertices 1 and 2.
+	bool intersect(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& dir,
+				   F32& closest_t, const U16*& indices, F32& a, F32& b) const;
+
+	U32 getNumNodes() const { return mNumNodes; }
+	U32 getNumTriangles() const { return mNumTriangles; }
+	U32 getMemoryUsage() const;
+
+private:
+	// No copy constructor or copy assignment
+	LLVolumeBVH(const LLVolumeBVH&);
+	LLVolumeBVH& operator=(const LLVolumeBVH&);
+
+	LL_ALIGN_PREFIX(16)
+	struct Node
+	{
+		LLVector4a	mMin;		// w is 0
+		LLVector4a	mMax;		// w is F32_MAX, see intersect()
+		U32			mOffset;	// leaf: first triangle, interior: index of second child
+		U16			mCount;		// triangles in a leaf, 0 for interior nodes
+		U16			mAxis;		// split axis of an interior node
+		U32			mPad[2];
+	} LL_ALIGN_POSTFIX(16);
+
+	struct BuildData;
+	U32 build(BuildData& data, U32 begin, U32 end, U32 depth);
+
+	Node*	mNodes;
+	U32		mNumNodes;
+	U16*	mIndices;
+	U32		mNumTriangles;
+};
+
+#endif // LL_LLVOLUMEBVH_H
@@ -28,6 +28,8 @@
 #include "llvolumemgr.h"
 #include "llvolume.h"
 
+#include <boost/bind.hpp>
+
 
 const F32 BASE_THRESHOLD = 0.03f;
 
@@ -44,7 +46,15 @@ F32 LLVolumeLODGroup::mDetailScales[NUM_LODS] = {1.f, 1.5f, 2.5f, 4.f};
 //============================================================================
 
 LLVolumeMgr::LLVolumeMgr()
-:	mDataMutex(NULL)
+:	mDataMutex(NULL),
+	mThreadPool(NULL),
+	mPendingCount(0),
+	mGeneratedCount(0),
+	mCacheBudget(0),
+	mCacheBytes(0),
+	mCacheHits(0),
+	mCacheMisses(0),
+	mCacheEvictions(0)
 {
 	// the LLMutex magic interferes with easy unit testing,
 	// so you now must manually call useMutex() to use it
@@ -53,6 +63,7 @@ LLVolumeMgr::LLVolumeMgr()
 
 LLVolumeMgr::~LLVolumeMgr()
 {
+	setThreadPool(NULL);
 	cleanup();
 
 	delete mDataMutex;
@@ -78,6 +89,7 @@ BOOL LLVolumeMgr::cleanup()
  		delete volgroupp;
 	}
 	mVolumeLODGroups.clear();
+	clearCache();
 	if (mDataMutex)
 	{
 		mDataMutex->unlock();
@@ -100,6 +112,7 @@ LLVolume* LLVolumeMgr::refVolume(const LLVolumeParams &volume_params, const S32
 	if( iter == mVolumeLODGroups.end() )
 	{
 		volgroupp = createNewGroup(volume_params);
+		restoreGroup(volgroupp);
 	}
 	else
 	{
@@ -161,6 +174,8 @@ void LLVolumeMgr::unrefVolume(LLVolume *volumep)
 		volgroupp->derefLOD(volumep);
 		if (volgroupp->getNumRefs() == 0)
 		{
+			// params points into the group, which cacheGroup() leaves alone
+			cacheGroup(volgroupp);
 			mVolumeLODGroups.erase(params);
 			delete volgroupp;
 		}
@@ -208,6 +223,9 @@ void LLVolumeMgr::dump()
 		mDataMutex->unlock();
 	}
 	LL_INFOS() << "Average usage of LODs " << avg << LL_ENDL;
+	LL_INFOS() << "Volume cache: " << mCacheEntries.size() << " groups, " << mCacheBytes / 1024 << " KB of "
+			   << mCacheBudget / 1024 << " KB, hits " << mCacheHits << ", misses " << mCacheMisses
+			   << ", evictions " << mCacheEvictions << LL_ENDL;
 }
 
 void LLVolumeMgr::useMutex()
@@ -218,6 +236,258 @@ void LLVolumeMgr::useMutex()
 	}
 }
 
+void LLVolumeMgr::setThreadPool(LLThreadPool* pool)
+{
+	if (mGenerateToken.notNull())
+	{
+		// Anything still in flight belongs to the old pool, drop it
+		mGenerateToken->cancel();
+		mGenerateToken = NULL;
+		mPendingCount = 0;
+
+		if (mDataMutex)
+		{
+			mDataMutex->lock();
+		}
+		for (volume_lod_group_map_t::iterator iter = mVolumeLODGroups.begin(),
+				 end = mVolumeLODGroups.end();
+			 iter != end; iter++)
+		{
+			for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; i++)
+			{
+				iter->second->setLODPending(i, FALSE);
+			}
+		}
+		if (mDataMutex)
+		{
+			mDataMutex->unlock();
+		}
+	}
+	mThreadPool = pool;
+	if (mThreadPool)
+	{
+		mGenerateToken = new LLThreadPool::CancelToken;
+	}
+}
+
+// static
+bool LLVolumeMgr::canGenerateAsync(const LLVolumeParams &volume_params)
+{
+	return volume_params.getSculptID().isNull()
+		&& volume_params.getSculptType() == LL_SCULPT_TYPE_NONE
+		&& volume_params.getPathParams().getCurveType() != LL_PCODE_PATH_FLEXIBLE;
+}
+
+BOOL LLVolumeMgr::isLODReady(const LLVolumeParams &volume_params, const S32 detail) const
+{
+	LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+	return volgroupp && volgroupp->hasLOD(detail);
+}
+
+BOOL LLVolumeMgr::requestLOD(const LLVolumeParams &volume_params, const S32 detail)
+{
+	if (!mThreadPool || !canGenerateAsync(volume_params))
+	{
+		return TRUE;
+	}
+
+	LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+	if (!volgroupp || volgroupp->hasLOD(detail))
+	{
+		return TRUE;
+	}
+
+	if (!volgroupp->isLODPending(detail))
+	{
+		volgroupp->setLODPending(detail, TRUE);
+		mPendingCount++;
+		request_ptr_t request = new GenerateRequest(*volgroupp->getVolumeParams(), detail);
+		mThreadPool->submit(boost::bind(&LLVolumeMgr::generateVolume, request),
+							LLThreadPool::PRIORITY_HIGH,
+							mGenerateToken,
+							boost::bind(&LLVolumeMgr::onVolumeGenerated, this, mGenerateToken, request));
+	}
+	return FALSE;
+}
+
+// static
+// Runs on a pool worker.  Nothing else sees the request's volume until
+// onVolumeGenerated() picks it up on the main thread.
+void LLVolumeMgr::generateVolume(request_ptr_t request)
+{
+	request->mVolume = new LLVolume(request->mParams,
+									LLVolumeLODGroup::getVolumeScaleFromDetail(request->mDetail));
+}
+
+// static
+// MAIN THREAD, from LLThreadPool::updateMainThread()
+void LLVolumeMgr::onVolumeGenerated(LLVolumeMgr* mgr, LLThreadPool::token_ptr_t token, request_ptr_t request)
+{
+	// LLVolume's refcount isn't thread safe: take the volume off the
+	// request here so that it can't be released on the worker
+	LLPointer<LLVolume> volume = request->mVolume;
+	request->mVolume = NULL;
+
+	// A cancelled token means the manager let go of the pool, and may be
+	// gone altogether
+	if (!token->isCancelled())
+	{
+		mgr->installVolume(request->mParams, request->mDetail, volume);
+	}
+}
+
+void LLVolumeMgr::installVolume(const LLVolumeParams &volume_params, const S32 detail, LLVolume* volumep)
+{
+	mPendingCount--;
+
+	// The group may have been released, or released and created again,
+	// while the volume was being built
+	LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+	if (volgroupp)
+	{
+		volgroupp->setLODPending(detail, FALSE);
+		if (volumep)
+		{
+			// Count it even when the LOD was built synchronously in the
+			// meantime, whoever waits on it can go ahead either way
+			volgroupp->setLOD(detail, volumep);
+			mGeneratedCount++;
+		}
+	}
+}
+
+void LLVolumeMgr::setCacheBudget(U32 bytes)
+{
+	if (mDataMutex)
+	{
+		mDataMutex->lock();
+	}
+	mCacheBudget = bytes;
+	evictCache(mCacheBudget);
+	if (mDataMutex)
+	{
+		mDataMutex->unlock();
+	}
+}
+
+void LLVolumeMgr::clearCache()
+{
+	if (mDataMutex)
+	{
+		mDataMutex->lock();
+	}
+	evictCache(0);
+	if (mDataMutex)
+	{
+		mDataMutex->unlock();
+	}
+}
+
+// static
+U32 LLVolumeMgr::getVolumeBytes(const LLVolume* volumep)
+{
+	U32 bytes = 0;
+	for (S32 i = 0; i < volumep->getNumVolumeFaces(); i++)
+	{
+		const LLVolumeFace& face = volumep->getVolumeFace(i);
+		U32 num_verts = (U32)llmax(face.mNumVertices, face.mNumAllocatedVertices);
+		// Positions and normals, texture coordinates share their allocation
+		bytes += num_verts * (2 * sizeof(LLVector4a) + sizeof(LLVector2));
+		if (face.mTangents)
+		{
+			bytes += num_verts * sizeof(LLVector4a);
+		}
+		if (face.mWeights)
+		{
+			bytes += num_verts * sizeof(LLVector4a);
+		}
+		bytes += (U32)face.mNumIndices * sizeof(U16);
+		bytes += (U32)face.mEdge.size() * sizeof(S32);
+	}
+	return bytes;
+}
+
+// protected, called with mDataMutex held
+void LLVolumeMgr::cacheGroup(LLVolumeLODGroup* volgroupp)
+{
+	if (!mCacheBudget || !canGenerateAsync(*volgroupp->getVolumeParams()))
+	{
+		return;
+	}
+
+	CacheEntry* entry = new CacheEntry(*volgroupp->getVolumeParams());
+	for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; i++)
+	{
+		LLVolume* volumep = volgroupp->getLOD(i);
+		if (volumep)
+		{
+			// The vertex buffers get rebuilt if the volume comes back,
+			// don't keep video memory around for it meanwhile
+			for (S32 f = 0; f < volumep->getNumVolumeFaces(); f++)
+			{
+				volumep->getVolumeFace(f).mVertexBuffer = NULL;
+			}
+			entry->mVolumeLODs[i] = volumep;
+			entry->mBytes += getVolumeBytes(volumep);
+		}
+	}
+	if (!entry->mBytes || entry->mBytes > mCacheBudget)
+	{
+		delete entry;
+		return;
+	}
+
+	// A group with these params can't be cached already: the entry is
+	// taken out when the group is created
+	llassert(mCacheMap.find(&entry->mParams) == mCacheMap.end());
+	evictCache(mCacheBudget - entry->mBytes);
+	mCacheEntries.push_front(entry);
+	mCacheMap[&entry->mParams] = mCacheEntries.begin();
+	mCacheBytes += entry->mBytes;
+}
+
+// protected, called with mDataMutex held
+void LLVolumeMgr::restoreGroup(LLVolumeLODGroup* volgroupp)
+{
+	cache_map_t::iterator iter = mCacheMap.find(volgroupp->getVolumeParams());
+	if (iter == mCacheMap.end())
+	{
+		if (mCacheBudget && canGenerateAsync(*volgroupp->getVolumeParams()))
+		{
+			mCacheMisses++;
+		}
+		return;
+	}
+
+	CacheEntry* entry = *iter->second;
+	for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; i++)
+	{
+		if (entry->mVolumeLODs[i].notNull())
+		{
+			volgroupp->setLOD(i, entry->mVolumeLODs[i]);
+		}
+	}
+	mCacheHits++;
+	mCacheBytes -= entry->mBytes;
+	mCacheEntries.erase(iter->second);
+	mCacheMap.erase(iter);
+	delete entry;
+}
+
+// protected, called with mDataMutex held
+void LLVolumeMgr::evictCache(U32 budget)
+{
+	while (mCacheBytes > budget && !mCacheEntries.empty())
+	{
+		CacheEntry* entry = mCacheEntries.back();
+		mCacheMap.erase(&entry->mParams);
+		mCacheEntries.pop_back();
+		mCacheBytes -= entry->mBytes;
+		mCacheEvictions++;
+		delete entry;
+	}
+}
+
 std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr)
 {
 	s << "{ numLODgroups=" << volume_mgr.mVolumeLODGroups.size() << ", ";
@@ -253,6 +523,7 @@ LLVolumeLODGroup::LLVolumeLODGroup(const LLVolumeParams &params)
 	{
 		mLODRefs[i] = 0;
 		mAccessCount[i] = 0;
+		mLODPending[i] = FALSE;
 	}
 }
 
@@ -301,6 +572,18 @@ LLVolume* LLVolumeLODGroup::refLOD(const S32 detail)
 	return mVolumeLODs[detail];
 }
 
+BOOL LLVolumeLODGroup::setLOD(const S32 detail, LLVolume* volumep)
+{
+	llassert(detail >=0 && detail < NUM_LODS);
+	if (mVolumeLODs[detail].notNull())
+	{
+		// Somebody needed it sooner and built it synchronously
+		return FALSE;
+	}
+	mVolumeLODs[detail] = volumep;
+	return TRUE;
+}
+
 BOOL LLVolumeLODGroup::derefLOD(LLVolume *volumep)
 {
 	llassert_always(mRefs > 0);
@@ -27,11 +27,13 @@
 #ifndef LL_LLVOLUMEMGR_H
 #define LL_LLVOLUMEMGR_H
 
+#include <list>
 #include <map>
 
 #include "llvolume.h"
 #include "llpointer.h"
 #include "llthread.h"
+#include "llthreadpool.h"
 
 class LLVolumeParams;
 class LLVolumeLODGroup;
@@ -58,6 +60,14 @@ public:
 	LLVolume* refLOD(const S32 detail);
 	BOOL derefLOD(LLVolume *volumep);
 	S32 getNumRefs() const { return mRefs; }
+
+	// Asynchronous generation, see LLVolumeMgr::requestLOD()
+	BOOL hasLOD(const S32 detail) const { return mVolumeLODs[detail].notNull(); }
+	LLVolume* getLOD(const S32 detail) const { return mVolumeLODs[detail]; }
+	BOOL isLODPending(const S32 detail) const { return mLODPending[detail]; }
+	void setLODPending(const S32 detail, BOOL pending) { mLODPending[detail] = pending; }
+	// Installs a volume generated elsewhere, unless the LOD got built meanwhile
+	BOOL setLOD(const S32 detail, LLVolume* volumep);
 	
 	const LLVolumeParams* getVolumeParams() const { return &mVolumeParams; };
 
@@ -70,6 +80,7 @@ protected:
 	S32 mRefs;
 	S32 mLODRefs[NUM_LODS];
 	LLPointer<LLVolume> mVolumeLODs[NUM_LODS];
+	BOOL	mLODPending[NUM_LODS];
 	static F32 mDetailThresholds[NUM_LODS];
 	static F32 mDetailScales[NUM_LODS];
 	S32		mAccessCount[NUM_LODS];
@@ -95,6 +106,54 @@ public:
 	// manually call this for mutex magic
 	void useMutex();
 
+	// Asynchronous LOD generation.  With a pool set, requestLOD() builds
+	// missing LODs of plain prims on the pool's workers.  Finished volumes
+	// are installed in their LOD group from the pool's main thread
+	// continuations, so the main thread never sees a half built volume and
+	// a later refVolume() finds the LOD already there.  NULL (the default)
+	// turns it off.
+	void setThreadPool(LLThreadPool* pool);
+	bool isAsync() const { return mThreadPool != NULL; }
+
+	// TRUE if refVolume() for these would not have to generate anything
+	BOOL isLODReady(const LLVolumeParams &volume_params, const S32 detail) const;
+
+	// MAIN THREAD: returns TRUE if the LOD is ready to be referenced.
+	// Otherwise queues its generation (once) and returns FALSE; callers
+	// should keep the LOD they have until it is ready.  Only LODs of a
+	// group that is already referenced and that canGenerateAsync() can be
+	// requested, for anything else this returns TRUE and refVolume()
+	// generates as it always has.
+	BOOL requestLOD(const LLVolumeParams &volume_params, const S32 detail);
+
+	// Generation requests in flight
+	S32 getPendingCount() const { return mPendingCount; }
+	// Bumped every time a generated LOD is installed
+	U32 getGeneratedCount() const { return mGeneratedCount; }
+
+	// Sculpts and meshes get their geometry from other sources after the
+	// volume is created, only plain prims are generated asynchronously.
+	static bool canGenerateAsync(const LLVolumeParams &volume_params);
+
+	// Volume cache.  When the last reference to a group goes away its built
+	// LODs are kept, most recently released first, until they no longer fit
+	// in the budget.  Referencing the same params again puts them straight
+	// back into the new group instead of tessellating them again.  Only
+	// plain prims are cached, by the same rule as canGenerateAsync().
+	// A budget of 0 (the default) turns the cache off.
+	void setCacheBudget(U32 bytes);
+	U32 getCacheBudget() const { return mCacheBudget; }
+	U32 getCacheBytes() const { return mCacheBytes; }
+	S32 getCacheCount() const { return (S32)mCacheEntries.size(); }
+	// Groups restored from the cache / created with nothing cached
+	U32 getCacheHits() const { return mCacheHits; }
+	U32 getCacheMisses() const { return mCacheMisses; }
+	U32 getCacheEvictions() const { return mCacheEvictions; }
+	void clearCache();
+
+	// Approximate memory held by the faces of a volume
+	static U32 getVolumeBytes(const LLVolume* volumep);
+
 	friend std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr);
 
 protected:
@@ -102,11 +161,60 @@ protected:
 	// Overridden in llphysics/abstract/utils/llphysicsvolumemanager.h
 	virtual LLVolumeLODGroup* createNewGroup(const LLVolumeParams& volume_params);
 
+	// One LOD being built on the pool
+	class GenerateRequest : public LLThreadSafeRefCount
+	{
+	public:
+		GenerateRequest(const LLVolumeParams &volume_params, S32 detail)
+		:	mParams(volume_params),
+			mDetail(detail)
+		{
+		}
+
+		LLVolumeParams		mParams;
+		S32					mDetail;
+		LLPointer<LLVolume>	mVolume;	// Set by the worker
+	};
+	typedef LLPointer<GenerateRequest> request_ptr_t;
+
+	static void generateVolume(request_ptr_t request);
+	static void onVolumeGenerated(LLVolumeMgr* mgr, LLThreadPool::token_ptr_t token, request_ptr_t request);
+	void installVolume(const LLVolumeParams &volume_params, const S32 detail, LLVolume* volumep);
+
+	// The LODs of one released group
+	struct CacheEntry
+	{
+		CacheEntry(const LLVolumeParams &volume_params) : mParams(volume_params), mBytes(0) {}
+
+		LLVolumeParams		mParams;
+		LLPointer<LLVolume>	mVolumeLODs[LLVolumeLODGroup::NUM_LODS];
+		U32					mBytes;
+	};
+	typedef std::list<CacheEntry*> cache_list_t;
+
+	void cacheGroup(LLVolumeLODGroup* volgroupp);
+	void restoreGroup(LLVolumeLODGroup* volgroupp);
+	void evictCache(U32 budget);
+
 protected:
 	typedef std::map<const LLVolumeParams*, LLVolumeLODGroup*, LLVolumeParams::compare> volume_lod_group_map_t;
 	volume_lod_group_map_t mVolumeLODGroups;
 
 	LLMutex* mDataMutex;
+
+	LLThreadPool*				mThreadPool;
+	LLThreadPool::token_ptr_t	mGenerateToken;	// Cancelled when the pool is detached
+	S32							mPendingCount;
+	U32							mGeneratedCount;
+
+	typedef std::map<const LLVolumeParams*, cache_list_t::iterator, LLVolumeParams::compare> cache_map_t;
+	cache_list_t	mCacheEntries;	// Most recently released first
+	cache_map_t		mCacheMap;
+	U32				mCacheBudget;
+	U32				mCacheBytes;
+	U32				mCacheHits;
+	U32				mCacheMisses;
+	U32				mCacheEvictions;
 };
 
 #endif // LL_LLVOLUMEMGR_H
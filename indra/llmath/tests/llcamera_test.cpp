@@ -0,0 +1,551 @@
+/**
+ * @file llcamera_test.cpp
+ * @brief Tests for LLCamera frustum tests, and a model of the parallel cull pre-pass
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "../llcamera.h"
+#include "llformat.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// Points the camera from origin towards at and sets up its agent
+	// frustum planes the way LLViewerCamera does from the GL matrices
+	void place_camera(LLCamera& camera, const LLVector3& origin, const LLVector3& at)
+	{
+		LLVector3 x_axis = at - origin;
+		x_axis.normVec();
+		LLVector3 y_axis = LLVector3::z_axis % x_axis;	// left
+		y_axis.normVec();
+		LLVector3 z_axis = x_axis % y_axis;				// up
+		camera.setOrigin(origin);
+		camera.setAxes(x_axis, y_axis, z_axis);
+
+		// Near corners then far corners: bottom left, bottom right, top right, top left
+		LLVector3 frust[8];
+		F32 dists[2] = { camera.getNear(), camera.getFar() };
+		for (S32 i = 0; i < 2; ++i)
+		{
+			F32 half_height = dists[i] * tanf(camera.getView() * 0.5f);
+			F32 half_width = half_height * camera.getAspect();
+			LLVector3 center = origin + x_axis * dists[i];
+			frust[i * 4] = center + y_axis * half_width - z_axis * half_height;
+			frust[i * 4 + 1] = center - y_axis * half_width - z_axis * half_height;
+			frust[i * 4 + 2] = center - y_axis * half_width + z_axis * half_height;
+			frust[i * 4 + 3] = center + y_axis * half_width + z_axis * half_height;
+		}
+		camera.calcAgentFrustumPlanes(frust);
+	}
+
+	S32 box_in_frustum(LLCamera& camera, const LLVector3& center, F32 radius)
+	{
+		LLVector4a c, r;
+		c.load3(center.mV);
+		r.splat(radius);
+		return camera.AABBInFrustum(c, r);
+	}
+
+	// A synthetic scene of boxes scattered over a few regions, binned into
+	// one octree per region.  Nodes keep tight bounds like LLSpatialGroup.
+	// SceneTree is a stand-in for the spatial partitions, it checks the scheme
+	// of the pre-pass on LLCamera and LLThreadPool.  LLViewerOctreeCull and
+	// LLViewerOctreeGroup belong to the viewer and are not run here.
+	struct SceneNode
+	{
+		LLVector4a	mCenter;
+		LLVector4a	mSize;
+		S32			mFirstChild;	// index into SceneTree::mChildren
+		S32			mNumChildren;
+		S32			mNumObjects;
+		S32			mCullRes;		// precomputed frustum test, -1 for none
+		S32			mPad[4];
+	};
+
+	class SceneTree
+	{
+	public:
+		void build(const std::vector<LLVector4a>& objects, const LLVector4a& center, F32 half_size)
+		{
+			std::vector<U32> all(objects.size());
+			for (U32 i = 0; i < all.size(); ++i)
+			{
+				all[i] = i;
+			}
+			mNodes.reserve(objects.size());
+			buildNode(objects, all, center, half_size);
+		}
+
+		S32 buildNode(const std::vector<LLVector4a>& objects, const std::vector<U32>& members,
+					  const LLVector4a& center, F32 half_size)
+		{
+			S32 index = (S32)mNodes.size();
+			mNodes.push_back(SceneNode());
+			mNodes[index].mNumChildren = 0;
+			mNodes[index].mFirstChild = 0;
+			mNodes[index].mCullRes = -1;
+
+			// objects hold center xyz and radius in w
+			LLVector4a min, max;
+			min.splat(F32_MAX);
+			max.splat(-F32_MAX);
+			for (U32 i = 0; i < members.size(); ++i)
+			{
+				const LLVector4a& obj = objects[members[i]];
+				LLVector4a radius, lo, hi;
+				radius.splat(obj[3]);
+				lo.setSub(obj, radius);
+				hi.setAdd(obj, radius);
+				min.setMin(min, lo);
+				max.setMax(max, hi);
+			}
+
+			std::vector<U32> octants[8];
+			if (members.size() > 8 && half_size > 1.f)
+			{
+				for (U32 i = 0; i < members.size(); ++i)
+				{
+					const LLVector4a& obj = objects[members[i]];
+					S32 octant = (obj[0] > center[0] ? 1 : 0) | (obj[1] > center[1] ? 2 : 0) | (obj[2] > center[2] ? 4 : 0);
+					octants[octant].push_back(members[i]);
+				}
+			}
+
+			std::vector<S32> children;
+			U32 kept = members.size();
+			for (S32 o = 0; o < 8; ++o)
+			{
+				if (octants[o].empty())
+				{
+					continue;
+				}
+				LLVector4a offset, child_center;
+				offset.set(o & 1 ? half_size : -half_size, o & 2 ? half_size : -half_size, o & 4 ? half_size : -half_size);
+				offset.mul(0.5f);
+				child_center.setAdd(center, offset);
+				children.push_back(buildNode(objects, octants[o], child_center, half_size * 0.5f));
+				kept = 0;
+			}
+
+			SceneNode& node = mNodes[index];
+			node.mCenter.setAdd(min, max);
+			node.mCenter.mul(0.5f);
+			node.mSize.setSub(max, min);
+			node.mSize.mul(0.5f);
+			node.mNumObjects = kept;
+			node.mFirstChild = (S32)mChildren.size();
+			node.mNumChildren = (S32)children.size();
+			mChildren.insert(mChildren.end(), children.begin(), children.end());
+			return index;
+		}
+
+		// Modelled on the hierarchical test of LLViewerOctreeCull::traverse(): a node
+		// fully inside passes its result down without testing its children.
+		// use_cache takes the results of precull() when there are any.
+		void cull(LLCamera& camera, S32 index, S32 res, bool use_cache, std::vector<S32>& visible)
+		{
+			SceneNode& node = mNodes[index];
+			if (res != 2)
+			{
+				res = use_cache && node.mCullRes >= 0 ? node.mCullRes : camera.AABBInFrustum(node.mCenter, node.mSize);
+				if (!res)
+				{
+					return;
+				}
+			}
+			if (node.mNumObjects)
+			{
+				visible.push_back(index);
+			}
+			for (S32 i = 0; i < node.mNumChildren; ++i)
+			{
+				cull(camera, mChildren[node.mFirstChild + i], res, use_cache, visible);
+			}
+		}
+
+		// Modelled on LLViewerOctreeCull::precull(): only the tests, stored in
+		// the nodes, with the children of a partially visible node tested together
+		S32 precull(LLCamera& camera, S32 index, bool recurse)
+		{
+			SceneNode& node = mNodes[index];
+			node.mCullRes = camera.AABBInFrustum(node.mCenter, node.mSize);
+			if (node.mCullRes == 1 && recurse)
+			{
+				precullChildren(camera, index);
+			}
+			return node.mCullRes;
+		}
+
+		void precullChildren(LLCamera& camera, S32 index)
+		{
+			const SceneNode& node = mNodes[index];
+			LLVector4a centers[8], sizes[8];
+			S32 results[8];
+			for (S32 i = 0; i < node.mNumChildren; ++i)
+			{
+				const SceneNode& child = mNodes[mChildren[node.mFirstChild + i]];
+				centers[i] = child.mCenter;
+				sizes[i] = child.mSize;
+			}
+			camera.AABBInFrustumBatch(centers, sizes, node.mNumChildren, results);
+			for (S32 i = 0; i < node.mNumChildren; ++i)
+			{
+				S32 child = mChildren[node.mFirstChild + i];
+				mNodes[child].mCullRes = results[i];
+				if (results[i] == 1)
+				{
+					precullChildren(camera, child);
+				}
+			}
+		}
+
+		void clearCache()
+		{
+			for (U32 i = 0; i < mNodes.size(); ++i)
+			{
+				mNodes[i].mCullRes = -1;
+			}
+		}
+
+		std::vector<SceneNode> mNodes;
+		std::vector<S32> mChildren;
+	};
+
+	struct PrecullItem
+	{
+		SceneTree*	mTree;
+		S32			mNode;
+	};
+
+	void precull_item(LLCamera* camera, std::vector<PrecullItem>* items, U32 index)
+	{
+		(*items)[index].mTree->precull(*camera, (*items)[index].mNode, true);
+	}
+
+	// As the pre-pass of LLPipeline::precull(): roots here, their children on the pool
+	void parallel_precull(LLThreadPool& pool, LLCamera& camera, std::vector<SceneTree*>& trees)
+	{
+		std::vector<PrecullItem> items;
+		for (U32 t = 0; t < trees.size(); ++t)
+		{
+			SceneTree* tree = trees[t];
+			if (tree->precull(camera, 0, false) == 1)
+			{
+				for (S32 i = 0; i < tree->mNodes[0].mNumChildren; ++i)
+				{
+					PrecullItem item = { tree, tree->mChildren[tree->mNodes[0].mFirstChild + i] };
+					items.push_back(item);
+				}
+			}
+		}
+		pool.parallelFor(items.size(), boost::bind(precull_item, &camera, &items, _1));
+	}
+
+	void make_scene(std::vector<SceneTree*>& trees, S32 regions_per_side, S32 objects_per_region)
+	{
+		U32 seed = 12345;
+		for (S32 rx = 0; rx < regions_per_side; ++rx)
+		{
+			for (S32 ry = 0; ry < regions_per_side; ++ry)
+			{
+				std::vector<LLVector4a> objects(objects_per_region);
+				for (S32 i = 0; i < objects_per_region; ++i)
+				{
+					F32 rnd[4];
+					for (S32 k = 0; k < 4; ++k)
+					{
+						seed = seed * 1664525 + 1013904223;
+						rnd[k] = (F32)(seed >> 8) / (F32)(1 << 24);
+					}
+					// Buildings near the ground, the odd large object
+					objects[i].set(rx * 256.f + rnd[0] * 256.f, ry * 256.f + rnd[1] * 256.f,
+								   20.f + rnd[2] * rnd[2] * 80.f, 0.25f + rnd[3] * rnd[3] * rnd[3] * 16.f);
+				}
+				LLVector4a center;
+				center.set(rx * 256.f + 128.f, ry * 256.f + 128.f, 128.f);
+				SceneTree* tree = new SceneTree;
+				tree->build(objects, center, 128.f);
+				trees.push_back(tree);
+			}
+		}
+	}
+
+	F32 next_rand(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (F32)(seed >> 8) / (F32)(1 << 24);
+	}
+
+	// count boxes of all sizes around the camera, some far past its far plane
+	void make_boxes(U32& seed, U32 count, std::vector<LLVector4a>& centers, std::vector<LLVector4a>& radii)
+	{
+		centers.resize(count);
+		radii.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			centers[i].set(next_rand(seed) * 600.f - 300.f, next_rand(seed) * 600.f - 300.f, next_rand(seed) * 200.f - 100.f);
+			F32 size = next_rand(seed);
+			radii[i].set(size * size * 40.f, next_rand(seed) * 20.f, next_rand(seed) * 10.f);
+		}
+	}
+
+	// Frame f of a fixed orbit around the middle of the scene, looking outwards
+	void camera_path(LLCamera& camera, S32 f, S32 frames, F32 scene_size)
+	{
+		F32 angle = F_TWO_PI * (F32)f / (F32)frames;
+		LLVector3 middle(scene_size * 0.5f, scene_size * 0.5f, 40.f);
+		LLVector3 origin = middle + LLVector3(cosf(angle), sinf(angle), 0.f) * (scene_size * 0.2f);
+		LLVector3 at = origin + LLVector3(cosf(angle * 3.f), sinf(angle * 3.f), -0.1f);
+		place_camera(camera, origin, at);
+	}
+}
+
+namespace tut
+{
+	struct camera_data
+	{
+	};
+	typedef test_group<camera_data> camera_group;
+	typedef camera_group::object camera_object;
+	camera_group camera_test("LLCamera");
+
+	template<> template<>
+	void camera_object::test<1>()
+	{
+		set_test_name("AABBInFrustum inside, partial and outside");
+
+		LLCamera camera(F_PI_BY_TWO, 1.f, 512, 0.5f, 100.f);
+		place_camera(camera, LLVector3(0.f, 0.f, 0.f), LLVector3(1.f, 0.f, 0.f));
+
+		ensure_equals("fully in front", box_in_frustum(camera, LLVector3(10.f, 0.f, 0.f), 1.f), 2);
+		ensure_equals("behind", box_in_frustum(camera, LLVector3(-10.f, 0.f, 0.f), 1.f), 0);
+		ensure_equals("left of the frustum", box_in_frustum(camera, LLVector3(10.f, 20.f, 0.f), 1.f), 0);
+		ensure_equals("below the frustum", box_in_frustum(camera, LLVector3(10.f, 0.f, -20.f), 1.f), 0);
+		ensure_equals("past the far plane", box_in_frustum(camera, LLVector3(200.f, 0.f, 0.f), 1.f), 0);
+		ensure_equals("across the left plane", box_in_frustum(camera, LLVector3(10.f, 10.f, 0.f), 1.f), 1);
+		ensure_equals("across the far plane", box_in_frustum(camera, LLVector3(100.f, 0.f, 0.f), 1.f), 1);
+	}
+
+	template<> template<>
+	void camera_object::test<2>()
+	{
+		set_test_name("the parallel pre-pass model finds the same nodes as a serial cull");
+
+		std::vector<SceneTree*> trees;
+		make_scene(trees, 2, 3000);
+		LLThreadPool pool("cull test", 3);
+		LLCamera camera(1.f, 1.5f, 768, 0.5f, 256.f);
+
+		const S32 FRAMES = 24;
+		S32 total = 0;
+		for (S32 f = 0; f < FRAMES; ++f)
+		{
+			camera_path(camera, f, FRAMES, 512.f);
+
+			std::vector<S32> serial, parallel;
+			for (U32 t = 0; t < trees.size(); ++t)
+			{
+				trees[t]->clearCache();
+				trees[t]->cull(camera, 0, 0, false, serial);
+			}
+
+			parallel_precull(pool, camera, trees);
+			for (U32 t = 0; t < trees.size(); ++t)
+			{
+				trees[t]->cull(camera, 0, 0, true, parallel);
+			}
+
+			ensure(llformat("frame %d: same visible nodes", f), serial == parallel);
+			total += (S32)serial.size();
+		}
+		ensure("something was visible", total > 0);
+
+		for (U32 t = 0; t < trees.size(); ++t)
+		{
+			delete trees[t];
+		}
+	}
+
+	template<> template<>
+	void camera_object::test<3>()
+	{
+		set_test_name("benchmark serial and parallel culling along a camera path");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		std::vector<SceneTree*> trees;
+		make_scene(trees, 3, 20000);
+		LLThreadPool pool("cull bench");
+		LLCamera camera(1.f, 1.5f, 768, 0.5f, 512.f);
+
+		const S32 FRAMES = 120;
+		F64 serial_secs = 0.0, precull_secs = 0.0, replay_secs = 0.0;
+		S32 visible_nodes = 0;
+		std::vector<S32> visible;
+		for (S32 f = 0; f < FRAMES; ++f)
+		{
+			camera_path(camera, f, FRAMES, 768.f);
+
+			visible.clear();
+			LLTimer timer;
+			for (U32 t = 0; t < trees.size(); ++t)
+			{
+				trees[t]->cull(camera, 0, 0, false, visible);
+			}
+			serial_secs += timer.getElapsedTimeF64();
+			visible_nodes += (S32)visible.size();
+
+			visible.clear();
+			timer.reset();
+			parallel_precull(pool, camera, trees);
+			precull_secs += timer.getElapsedTimeF64();
+			timer.reset();
+			for (U32 t = 0; t < trees.size(); ++t)
+			{
+				trees[t]->cull(camera, 0, 0, true, visible);
+			}
+			replay_secs += timer.getElapsedTimeF64();
+		}
+
+		size_t nodes = 0;
+		for (U32 t = 0; t < trees.size(); ++t)
+		{
+			nodes += trees[t]->mNodes.size();
+			delete trees[t];
+		}
+
+		std::cout << "\nCulling " << trees.size() << " octrees, " << nodes << " nodes, "
+				  << visible_nodes / FRAMES << " visible per frame, " << FRAMES << " frames\n"
+				  << llformat("  serial:           %.3f ms/frame\n", serial_secs * 1000.0 / FRAMES)
+				  << llformat("  precull (%d workers): %.3f ms/frame + %.3f ms/frame main thread walk\n",
+							  pool.getNumWorkers(), precull_secs * 1000.0 / FRAMES, replay_secs * 1000.0 / FRAMES)
+				  << std::flush;
+	}
+
+	template<> template<>
+	void camera_object::test<4>()
+	{
+		set_test_name("AABBInFrustumBatch matches AABBInFrustum box for box");
+
+		U32 seed = 4321;
+		LLCamera camera(1.f, 1.5f, 768, 0.5f, 200.f);
+		std::vector<LLVector4a> centers, radii;
+		S32 counts[3] = { 0, 0, 0 };
+		for (S32 pass = 0; pass < 40; ++pass)
+		{
+			LLVector3 origin(next_rand(seed) * 20.f, next_rand(seed) * 20.f, next_rand(seed) * 20.f);
+			LLVector3 at(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, next_rand(seed) - 0.5f);
+			camera.disableUserClipPlane();
+			place_camera(camera, origin, origin + at);
+			if (pass % 4 == 1)
+			{ //a water plane style user clip plane
+				LLPlane plane(LLVector3(0.f, 0.f, origin.mV[2]), LLVector3(0.f, 0.f, 1.f));
+				camera.setUserClipPlane(plane);
+			}
+			else if (pass % 4 == 2)
+			{
+				camera.ignoreAgentFrustumPlane(LLCamera::AGENT_PLANE_LEFT);
+			}
+
+			// odd counts so the last group of four is partial
+			U32 count = 1 + (U32)(next_rand(seed) * 999.f);
+			make_boxes(seed, count, centers, radii);
+			std::vector<S32> results(count), results_no_far(count);
+			camera.AABBInFrustumBatch(&centers[0], &radii[0], count, &results[0]);
+			camera.AABBInFrustumBatch(&centers[0], &radii[0], count, &results_no_far[0], true);
+
+			for (U32 i = 0; i < count; ++i)
+			{
+				S32 expected = camera.AABBInFrustum(centers[i], radii[i]);
+				ensure_equals(llformat("pass %d box %d", pass, i), results[i], expected);
+				ensure_equals(llformat("pass %d box %d no far clip", pass, i), results_no_far[i],
+							  camera.AABBInFrustumNoFarClip(centers[i], radii[i]));
+				counts[expected]++;
+			}
+		}
+		ensure("boxes outside, across and inside", counts[0] && counts[1] && counts[2]);
+	}
+
+	template<> template<>
+	void camera_object::test<5>()
+	{
+		set_test_name("benchmark AABBInFrustum against AABBInFrustumBatch");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		U32 seed = 99;
+		LLCamera camera(1.f, 1.5f, 768, 0.5f, 200.f);
+		place_camera(camera, LLVector3(0.f, 0.f, 0.f), LLVector3(1.f, 0.2f, -0.1f));
+		const U32 COUNT = 4096;
+		const S32 REPEATS = 500;
+		std::vector<LLVector4a> centers, radii;
+		make_boxes(seed, COUNT, centers, radii);
+		std::vector<S32> results(COUNT);
+
+		S32 sum = 0;
+		LLTimer timer;
+		for (S32 r = 0; r < REPEATS; ++r)
+		{
+			for (U32 i = 0; i < COUNT; ++i)
+			{
+				results[i] = camera.AABBInFrustum(centers[i], radii[i]);
+			}
+			sum += results[r % COUNT];
+		}
+		F64 scalar_secs = timer.getElapsedTimeF64();
+
+		timer.reset();
+		for (S32 r = 0; r < REPEATS; ++r)
+		{
+			// groups of eight, the most an octree node hands over at once
+			for (U32 i = 0; i < COUNT; i += 8)
+			{
+				camera.AABBInFrustumBatch(&centers[i], &radii[i], 8, &results[i]);
+			}
+			sum -= results[r % COUNT];
+		}
+		F64 batch_secs = timer.getElapsedTimeF64();
+		ensure_equals("same results", sum, 0);
+
+		F64 boxes = (F64)COUNT * REPEATS / 1000000.0;
+		std::cout << "\nFrustum tests, million boxes/s\n"
+				  << llformat("  AABBInFrustum:      %.1f\n", boxes / scalar_secs)
+				  << llformat("  AABBInFrustumBatch: %.1f\n", boxes / batch_secs)
+				  << std::flush;
+	}
+}
@@ -0,0 +1,313 @@
+/**
+ * @file llskinningkernel_test.cpp
+ * @brief Tests and benchmark of LLSkinningKernel on synthetic skins
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "../llskinningkernel.h"
+#include "../llquaternion.h"
+#include "../m4math.h"
+#include "../v4math.h"
+#include "llformat.h"
+#include "llmemory.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	const U32 MAX_JOINTS = 110;	// LL_MAX_JOINTS_PER_MESH_OBJECT
+
+	F32 next_rand(U32& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (F32)(seed >> 8) / (F32)(1 << 24);
+	}
+
+	// What LLSkinningUtil::getPerVertexSkinMatrix() does
+	void reference_skin_matrix(const F32* weights, LLMatrix4a* mat, LLMatrix4a& final_mat, U32 max_joints)
+	{
+		final_mat.clear();
+
+		S32 idx[4];
+		LLVector4 wght;
+		F32 scale = 0.f;
+		for (U32 k = 0; k < 4; k++)
+		{
+			F32 w = weights[k];
+			idx[k] = llclamp((S32) floorf(w), (S32)0, (S32)max_joints-1);
+			wght[k] = w - floorf(w);
+			scale += wght[k];
+		}
+		wght *= 1.f/scale;
+
+		for (U32 k = 0; k < 4; k++)
+		{
+			LLMatrix4a src;
+			src.setMul(mat[idx[k]], wght[k]);
+			final_mat.add(src);
+		}
+	}
+
+	// The per vertex loop of LLDrawPoolAvatar::updateRiggedFaceVertexBuffer()
+	void reference_skin(LLMatrix4a* palette, U32 max_joints, LLMatrix4a bind_shape, const LLVector4a* weights,
+						const LLVector4a* positions, const LLVector4a* normals, U32 count,
+						LLVector4a* pos_out, LLVector4a* norm_out)
+	{
+		for (U32 j = 0; j < count; ++j)
+		{
+			LLMatrix4a final_mat;
+			reference_skin_matrix(weights[j].getF32ptr(), palette, final_mat, max_joints);
+
+			LLVector4a t;
+			LLVector4a dst;
+			bind_shape.affineTransform(positions[j], t);
+			final_mat.affineTransform(t, dst);
+			pos_out[j] = dst;
+
+			if (norm_out)
+			{
+				bind_shape.rotate(normals[j], t);
+				final_mat.rotate(t, dst);
+				dst.normalize3fast();
+				norm_out[j] = dst;
+			}
+		}
+	}
+
+	void random_matrix(U32& seed, LLMatrix4a& out)
+	{
+		LLQuaternion rot(next_rand(seed) * F_TWO_PI, LLVector3(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, 1.f));
+		LLMatrix4 mat(rot, LLVector4(next_rand(seed) * 2.f - 1.f, next_rand(seed) * 2.f - 1.f, next_rand(seed) * 2.f, 1.f));
+		out.loadu(mat);
+	}
+
+	// A mesh face rigged like clothing: runs of vertices share their weights,
+	// the rest blend up to four joints
+	struct SyntheticFace
+	{
+		SyntheticFace(U32& seed, U32 count, U32 num_joints)
+		:	mCount(count)
+		{
+			mWeights = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mPositions = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mNormals = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mPosOut = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+			mNormOut = (LLVector4a*) ll_aligned_malloc_16(count * sizeof(LLVector4a));
+
+			LLVector4a weights;
+			for (U32 j = 0; j < count; ++j)
+			{
+				if (j == 0 || next_rand(seed) < 0.3f)
+				{
+					F32 w[4];
+					for (U32 k = 0; k < 4; ++k)
+					{
+						// weights of 0.001..0.999 on any joint, the odd index out of range
+						F32 joint = (F32)(U32)(next_rand(seed) * (num_joints + 2));
+						w[k] = joint + 0.001f + next_rand(seed) * 0.998f;
+					}
+					weights.loadua(w);
+				}
+				mWeights[j] = weights;
+				mPositions[j].set(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, next_rand(seed) * 2.f, 1.f);
+				mNormals[j].set(next_rand(seed) - 0.5f, next_rand(seed) - 0.5f, next_rand(seed) - 0.5f);
+				mNormals[j].normalize3fast();
+			}
+		}
+
+		~SyntheticFace()
+		{
+			ll_aligned_free_16(mWeights);
+			ll_aligned_free_16(mPositions);
+			ll_aligned_free_16(mNormals);
+			ll_aligned_free_16(mPosOut);
+			ll_aligned_free_16(mNormOut);
+		}
+
+		U32			mCount;
+		LLVector4a*	mWeights;
+		LLVector4a*	mPositions;
+		LLVector4a*	mNormals;
+		LLVector4a*	mPosOut;
+		LLVector4a*	mNormOut;
+	};
+
+	struct SkinJob
+	{
+		LLMatrix4a*						mPalette;
+		const LLMatrix4a*				mBindShape;
+		std::vector<SyntheticFace*>*	mFaces;
+	};
+
+	void skin_face(const SkinJob* job, U32 index)
+	{
+		SyntheticFace* face = (*job->mFaces)[index];
+		LLSkinningKernel::skinVertices(job->mPalette, MAX_JOINTS, *job->mBindShape, face->mWeights, face->mPositions,
+									   face->mNormals, face->mCount, face->mPosOut, face->mNormOut);
+	}
+
+	void reference_skin_face(const SkinJob* job, U32 index)
+	{
+		SyntheticFace* face = (*job->mFaces)[index];
+		reference_skin(job->mPalette, MAX_JOINTS, *job->mBindShape, face->mWeights, face->mPositions,
+					   face->mNormals, face->mCount, face->mPosOut, face->mNormOut);
+	}
+}
+
+namespace tut
+{
+	struct skinning_data
+	{
+		skinning_data()
+		{
+			U32 seed = 777;
+			for (U32 i = 0; i < MAX_JOINTS; ++i)
+			{
+				random_matrix(seed, mPalette[i]);
+			}
+			random_matrix(seed, mBindShape);
+		}
+
+		LLMatrix4a mPalette[MAX_JOINTS];
+		LLMatrix4a mBindShape;
+	};
+	typedef test_group<skinning_data> skinning_group;
+	typedef skinning_group::object skinning_object;
+	skinning_group skinning_test("LLSkinningKernel");
+
+	template<> template<>
+	void skinning_object::test<1>()
+	{
+		set_test_name("skinVertices matches the per vertex skin matrix path");
+
+		U32 seed = 1;
+		const U32 counts[] = { 1, 2, 7, 500, 3001 };
+		for (U32 c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+		{
+			SyntheticFace face(seed, counts[c], MAX_JOINTS);
+			std::vector<LLVector4a> pos(face.mCount), norm(face.mCount);
+			reference_skin(mPalette, MAX_JOINTS, mBindShape, face.mWeights, face.mPositions, face.mNormals,
+						   face.mCount, &pos[0], &norm[0]);
+			LLSkinningKernel::skinVertices(mPalette, MAX_JOINTS, mBindShape, face.mWeights, face.mPositions,
+										   face.mNormals, face.mCount, face.mPosOut, face.mNormOut);
+
+			for (U32 j = 0; j < face.mCount; ++j)
+			{
+				for (U32 k = 0; k < 3; ++k)
+				{
+					std::string msg = llformat("%d vertices, vertex %d component %d", counts[c], j, k);
+					ensure_equals(msg + ": position", face.mPosOut[j][k], pos[j][k]);
+					ensure_equals(msg + ": normal", face.mNormOut[j][k], norm[j][k]);
+				}
+			}
+		}
+	}
+
+	template<> template<>
+	void skinning_object::test<2>()
+	{
+		set_test_name("getSkinMatrix clamps indices and normalizes weights");
+
+		// joint 2 at 0.25 and joint 500 (clamped to the last) at 0.75, with the
+		// fraction summing to one the fourth weight is the same either way
+		F32 w[4] = { 2.125f, 500.375f, 2.125f, 500.375f };
+		LLVector4a weights;
+		weights.loadua(w);
+		LLMatrix4a final_mat, expected;
+		LLSkinningKernel::getSkinMatrix(mPalette, MAX_JOINTS, weights, final_mat);
+		reference_skin_matrix(w, mPalette, expected, MAX_JOINTS);
+		for (U32 i = 0; i < 4; ++i)
+		{
+			for (U32 k = 0; k < 4; ++k)
+			{
+				ensure_equals(llformat("column %d row %d", i, k), final_mat.mMatrix[i][k], expected.mMatrix[i][k]);
+				ensure_approximately_equals(llformat("blend column %d row %d", i, k).c_str(), final_mat.mMatrix[i][k],
+											mPalette[2].mMatrix[i][k] * 0.25f + mPalette[MAX_JOINTS - 1].mMatrix[i][k] * 0.75f, 16);
+			}
+		}
+	}
+
+	template<> template<>
+	void skinning_object::test<3>()
+	{
+		set_test_name("benchmark skinning a crowd of rigged faces");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		// 60 avatars with 8 rigged faces of 3000 vertices each
+		U32 seed = 2;
+		std::vector<SyntheticFace*> faces;
+		for (U32 i = 0; i < 480; ++i)
+		{
+			faces.push_back(new SyntheticFace(seed, 3000, MAX_JOINTS));
+		}
+		SkinJob job = { mPalette, &mBindShape, &faces };
+		LLThreadPool pool("skinning bench");
+
+		const S32 FRAMES = 5;
+		F64 reference_secs = 0.0, kernel_secs = 0.0, pool_secs = 0.0;
+		for (S32 f = 0; f < FRAMES; ++f)
+		{
+			LLTimer timer;
+			for (U32 i = 0; i < faces.size(); ++i)
+			{
+				reference_skin_face(&job, i);
+			}
+			reference_secs += timer.getElapsedTimeF64();
+
+			timer.reset();
+			for (U32 i = 0; i < faces.size(); ++i)
+			{
+				skin_face(&job, i);
+			}
+			kernel_secs += timer.getElapsedTimeF64();
+
+			timer.reset();
+			pool.parallelFor(faces.size(), boost::bind(skin_face, &job, _1));
+			pool_secs += timer.getElapsedTimeF64();
+		}
+
+		F64 vertices = (F64)faces.size() * 3000.0 * FRAMES / 1000000.0;
+		std::cout << "\nSkinning " << faces.size() << " faces of 3000 vertices, million vertices/s\n"
+				  << llformat("  per vertex skin matrix: %.1f\n", vertices / reference_secs)
+				  << llformat("  skinVertices:           %.1f\n", vertices / kernel_secs)
+				  << llformat("  skinVertices, %d workers: %.1f\n", pool.getNumWorkers(), vertices / pool_secs)
+				  << std::flush;
+
+		for (U32 i = 0; i < faces.size(); ++i)
+		{
+			delete faces[i];
+		}
+	}
+}
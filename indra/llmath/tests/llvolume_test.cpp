@@ -0,0 +1,422 @@
+/**
+ * @file llvolume_test.cpp
+ * @brief Tests and benchmarks for LLVolumeFace cache optimization and picking
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumemgr.h"
+#include "../llvolumeoctree.h"
+#include "llformat.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	U32 sSeed = 12345;
+
+	U32 next_random()
+	{
+		sSeed = sSeed * 1664525 + 1013904223;
+		return sSeed >> 8;
+	}
+
+	// An n x n vertex grid with vertices and triangles in random order, the
+	// worst case for the vertex cache.  Mesh uploads often come close.
+	void make_shuffled_grid(LLVolumeFace& face, S32 n)
+	{
+		face.resizeVertices(n * n);
+		face.resizeIndices((n - 1) * (n - 1) * 6);
+
+		std::vector<S32> vert_order(n * n);
+		for (S32 i = 0; i < n * n; ++i)
+		{
+			vert_order[i] = i;
+		}
+		for (S32 i = n * n - 1; i > 0; --i)
+		{
+			std::swap(vert_order[i], vert_order[next_random() % (i + 1)]);
+		}
+		for (S32 y = 0; y < n; ++y)
+		{
+			for (S32 x = 0; x < n; ++x)
+			{
+				S32 v = vert_order[y * n + x];
+				// Unit box like mesh faces, with some relief for ray tests
+				F32 fx = (F32)x / (n - 1) - 0.5f;
+				F32 fy = (F32)y / (n - 1) - 0.5f;
+				face.mPositions[v].set(fx, fy, 0.1f * sinf(fx * 20.f) * cosf(fy * 14.f));
+				face.mNormals[v].set(0.f, 0.f, 1.f);
+				face.mTexCoords[v].set((F32)x / n, (F32)y / n);
+			}
+		}
+
+		std::vector<S32> quads((n - 1) * (n - 1));
+		for (S32 i = 0; i < (S32)quads.size(); ++i)
+		{
+			quads[i] = i;
+		}
+		for (S32 i = (S32)quads.size() - 1; i > 0; --i)
+		{
+			std::swap(quads[i], quads[next_random() % (i + 1)]);
+		}
+		for (S32 i = 0; i < (S32)quads.size(); ++i)
+		{
+			S32 a = quads[i] / (n - 1) * n + quads[i] % (n - 1);
+			S32 corners[6] = { a, a + 1, a + n + 1, a, a + n + 1, a + n };
+			for (S32 k = 0; k < 6; ++k)
+			{
+				face.mIndices[i * 6 + k] = vert_order[corners[k]];
+			}
+		}
+	}
+
+	F32 random_unit()
+	{
+		return (F32)(next_random() & 0xffff) / 65535.f;
+	}
+
+	// Segments between random points around the unit box
+	void make_segments(std::vector<LLVector4a>& segments, S32 count)
+	{
+		segments.resize(count * 2);
+		for (S32 i = 0; i < count * 2; ++i)
+		{
+			LLVector4a p(random_unit() * 2.f - 1.f, random_unit() * 2.f - 1.f, random_unit() * 2.f - 1.f);
+			segments[i] = p;
+		}
+	}
+
+	// What the octree path of LLVolume::lineSegmentIntersect() finds
+	F32 octree_intersect(LLVolumeFace& face, const LLVector4a& start, const LLVector4a& end)
+	{
+		LLVector4a dir;
+		dir.setSub(end, start);
+		F32 closest_t = 2.f;
+		LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, NULL, NULL, NULL, NULL);
+		intersect.traverse(face.mOctree);
+		return intersect.mHitFace ? closest_t : -1.f;
+	}
+
+	F32 bvh_intersect(LLVolumeFace& face, const LLVector4a& start, const LLVector4a& end)
+	{
+		LLVector4a dir;
+		dir.setSub(end, start);
+		F32 closest_t = 2.f;
+		const U16* tri;
+		F32 a, b;
+		return face.mBVH->intersect(face, start, dir, closest_t, tri, a, b) ? closest_t : -1.f;
+	}
+
+	// Rough heap footprint of a face's octree
+	class OctreeSize : public LLOctreeTraveler<LLVolumeTriangle>
+	{
+	public:
+		OctreeSize() : mBytes(0) {}
+
+		/*virtual*/ void visit(const LLOctreeNode<LLVolumeTriangle>* node)
+		{
+			mBytes += sizeof(LLOctreeNode<LLVolumeTriangle>) + sizeof(LLVolumeOctreeListener)
+					  + node->getElementCount() * (sizeof(LLVolumeTriangle) + sizeof(LLPointer<LLVolumeTriangle>));
+		}
+
+		U32 mBytes;
+	};
+
+	// Triangles by their texture coordinates, starting from the smallest
+	// corner so that the winding is kept
+	std::vector<std::vector<F32> > get_triangles(const LLVolumeFace& face)
+	{
+		std::vector<std::vector<F32> > tris;
+		for (S32 i = 0; i + 2 < face.mNumIndices; i += 3)
+		{
+			S32 first = 0;
+			for (S32 k = 1; k < 3; ++k)
+			{
+				const LLVector2& tc = face.mTexCoords[face.mIndices[i + k]];
+				const LLVector2& best = face.mTexCoords[face.mIndices[i + first]];
+				if (tc.mV[0] < best.mV[0] || (tc.mV[0] == best.mV[0] && tc.mV[1] < best.mV[1]))
+				{
+					first = k;
+				}
+			}
+			std::vector<F32> tri;
+			for (S32 k = 0; k < 3; ++k)
+			{
+				const LLVector2& tc = face.mTexCoords[face.mIndices[i + (first + k) % 3]];
+				tri.push_back(tc.mV[0]);
+				tri.push_back(tc.mV[1]);
+			}
+			tris.push_back(tri);
+		}
+		std::sort(tris.begin(), tris.end());
+		return tris;
+	}
+}
+
+namespace tut
+{
+	struct volume_data
+	{
+	};
+	typedef test_group<volume_data> volume_group;
+	typedef volume_group::object volume_object;
+	volume_group volume_test("LLVolume");
+
+	template<> template<>
+	void volume_object::test<1>()
+	{
+		set_test_name("getACMR");
+
+		LLVolumeFace face;
+		face.resizeVertices(4);
+		face.resizeIndices(6);
+		const U16 indices[] = { 0, 1, 2, 2, 1, 3 };
+		memcpy(face.mIndices, indices, sizeof(indices));
+		ensure_approximately_equals("shared edge", face.getACMR(), 2.f, 8);
+		ensure_approximately_equals("cache too small to share", face.getACMR(1), 2.5f, 8);
+	}
+
+	template<> template<>
+	void volume_object::test<2>()
+	{
+		set_test_name("cacheOptimize keeps every triangle and vertex");
+
+		LLVolumeFace face;
+		make_shuffled_grid(face, 40);
+		std::vector<std::vector<F32> > before = get_triangles(face);
+		F32 before_acmr = face.getACMR();
+
+		face.cacheOptimize();
+		ensure("optimized", face.mOptimized);
+		ensure_equals("vertex count", face.mNumVertices, 40 * 40);
+		ensure("same triangles", get_triangles(face) == before);
+		ensure("fewer cache misses", face.getACMR() < before_acmr * 0.5f);
+		ensure("close to one miss per two triangles", face.getACMR() < 0.8f);
+
+		// Vertices come in the order the triangles first use them
+		S32 next_new = 0;
+		for (S32 i = 0; i < face.mNumIndices; ++i)
+		{
+			S32 idx = face.mIndices[i];
+			ensure("fetched in order", idx <= next_new);
+			if (idx == next_new)
+			{
+				++next_new;
+			}
+		}
+		ensure_equals("every vertex used", next_new, 40 * 40);
+	}
+
+	template<> template<>
+	void volume_object::test<3>()
+	{
+		set_test_name("vertices no triangle uses survive cacheOptimize");
+
+		LLVolumeFace face;
+		face.resizeVertices(5);
+		face.resizeIndices(3);
+		for (S32 i = 0; i < 5; ++i)
+		{
+			face.mPositions[i].set((F32)i, 0.f, 0.f);
+			face.mNormals[i].set(0.f, 0.f, 1.f);
+			face.mTexCoords[i].set((F32)i, 0.f);
+		}
+		const U16 indices[] = { 4, 2, 3 };
+		memcpy(face.mIndices, indices, sizeof(indices));
+
+		face.cacheOptimize();
+		ensure_equals("triangle first", face.mIndices[0], 0);
+		ensure_equals("moved vertex", face.mPositions[0].getF32ptr()[0], 4.f);
+		ensure_equals("unused vertex kept", face.mPositions[3].getF32ptr()[0], 0.f);
+		ensure_equals("unused vertex kept", face.mPositions[4].getF32ptr()[0], 1.f);
+	}
+
+	template<> template<>
+	void volume_object::test<4>()
+	{
+		set_test_name("cacheOptimize benchmark");
+		// With LL_TEST_BENCHMARK set, an -O2 x86-64 build takes 4.5 ms for
+		// the 64 grid (7938 tris), 19.0 ms for 128 (32258) and 43.7 ms for
+		// 181 (64800), taking the shuffled grids' ACMR from about 2.0 to 0.67.
+		// The old cacheOptimize() is not run here.  The before and after
+		// timings, and the ACMR of 2.8, given when this optimizer went in
+		// came from a separate harness and are not what this test measures.
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		std::cout << "\nLLVolumeFace::cacheOptimize\n"
+				  << "face               tris        ms   ACMR before  after" << std::endl;
+
+		const S32 grid_sizes[] = { 16, 64, 128, 181 };
+		for (size_t i = 0; i < sizeof(grid_sizes) / sizeof(grid_sizes[0]); ++i)
+		{
+			LLVolumeFace face;
+			make_shuffled_grid(face, grid_sizes[i]);
+			F32 before = face.getACMR();
+			LLTimer timer;
+			face.cacheOptimize();
+			F64 ms = timer.getElapsedTimeF64() * 1000.0;
+			std::cout << llformat("shuffled grid %3d %7d %9.2f %12.3f %6.3f", grid_sizes[i],
+								  face.mNumIndices / 3, ms, before, face.getACMR()) << std::endl;
+		}
+
+		// Prims come out of LLVolume in strip order, which is already good
+		LLVolumeParams params;
+		params.setType(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE);
+		LLPointer<LLVolume> sphere = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(3));
+		for (S32 i = 0; i < sphere->getNumVolumeFaces(); ++i)
+		{
+			LLVolumeFace face(sphere->getVolumeFace(i));
+			F32 before = face.getACMR();
+			LLTimer timer;
+			face.cacheOptimize();
+			F64 ms = timer.getElapsedTimeF64() * 1000.0;
+			std::cout << llformat("sphere face %d   %7d %9.2f %12.3f %6.3f", i,
+								  face.mNumIndices / 3, ms, before, face.getACMR()) << std::endl;
+		}
+	}
+
+	template<> template<>
+	void volume_object::test<5>()
+	{
+		set_test_name("BVH and octree agree");
+
+		std::vector<LLVector4a> segments;
+		make_segments(segments, 2000);
+
+		LLVolumeParams params;
+		params.setType(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE);
+		params.setHollow(0.5f);
+		LLPointer<LLVolume> sphere = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(3));
+
+		std::vector<LLVolumeFace*> faces;
+		for (S32 i = 0; i < sphere->getNumVolumeFaces(); ++i)
+		{
+			faces.push_back(new LLVolumeFace(sphere->getVolumeFace(i)));
+		}
+		faces.push_back(new LLVolumeFace());
+		make_shuffled_grid(*faces.back(), 60);
+
+		S32 hits = 0;
+		for (size_t f = 0; f < faces.size(); ++f)
+		{
+			LLVolumeFace& face = *faces[f];
+			face.createOctree();
+			face.createBVH();
+			ensure_equals("every triangle in the tree", face.mBVH->getNumTriangles(), (U32)face.mNumIndices / 3);
+			for (S32 i = 0; i < 2000; ++i)
+			{
+				F32 expected = octree_intersect(face, segments[i * 2], segments[i * 2 + 1]);
+				F32 actual = bvh_intersect(face, segments[i * 2], segments[i * 2 + 1]);
+				ensure_equals("hit or miss", actual >= 0.f, expected >= 0.f);
+				if (expected >= 0.f)
+				{
+					ensure_approximately_equals("distance", actual, expected, 16);
+					++hits;
+				}
+			}
+			delete faces[f];
+		}
+		ensure("some segments hit", hits > 1000);
+
+		// Through LLVolume, either way
+		LLVector4a start(0.f, 0.f, 2.f);
+		LLVector4a end(0.f, 0.1f, -2.f);
+		LLVector4a bvh_pos, octree_pos;
+		LLVector2 bvh_tc, octree_tc;
+		LLVolume::sUsePickBVH = true;
+		S32 bvh_face = sphere->lineSegmentIntersect(start, end, -1, &bvh_pos, &bvh_tc);
+		LLVolume::sUsePickBVH = false;
+		S32 octree_face = sphere->lineSegmentIntersect(start, end, -1, &octree_pos, &octree_tc);
+		LLVolume::sUsePickBVH = true;
+		ensure("hit", bvh_face >= 0);
+		ensure_equals("same face", bvh_face, octree_face);
+		ensure("same point", bvh_pos.equals3(octree_pos));
+		ensure("same texture coordinate", bvh_tc == octree_tc);
+	}
+
+	template<> template<>
+	void volume_object::test<6>()
+	{
+		set_test_name("BVH benchmark against the octree");
+
+		if (!benchmarks_enabled())
+		{
+			return;
+		}
+
+		const S32 NUM_SEGMENTS = 20000;
+		std::vector<LLVector4a> segments;
+		make_segments(segments, NUM_SEGMENTS);
+
+		std::cout << "\nPicking, octree vs BVH (" << NUM_SEGMENTS << " segments per face)\n"
+				  << "   tris   build ms       KB      Krays/s" << std::endl;
+		const S32 grid_sizes[] = { 16, 64, 128, 181 };
+		for (size_t i = 0; i < sizeof(grid_sizes) / sizeof(grid_sizes[0]); ++i)
+		{
+			LLVolumeFace face;
+			make_shuffled_grid(face, grid_sizes[i]);
+
+			LLTimer timer;
+			face.createOctree();
+			F64 octree_build = timer.getElapsedTimeF64() * 1000.0;
+			timer.reset();
+			face.createBVH();
+			F64 bvh_build = timer.getElapsedTimeF64() * 1000.0;
+
+			OctreeSize octree_size;
+			octree_size.traverse(face.mOctree);
+
+			std::vector<F32> octree_t(NUM_SEGMENTS), bvh_t(NUM_SEGMENTS);
+			timer.reset();
+			for (S32 s = 0; s < NUM_SEGMENTS; ++s)
+			{
+				octree_t[s] = octree_intersect(face, segments[s * 2], segments[s * 2 + 1]);
+			}
+			F64 octree_rays = NUM_SEGMENTS / timer.getElapsedTimeF64() / 1000.0;
+			timer.reset();
+			for (S32 s = 0; s < NUM_SEGMENTS; ++s)
+			{
+				bvh_t[s] = bvh_intersect(face, segments[s * 2], segments[s * 2 + 1]);
+			}
+			F64 bvh_rays = NUM_SEGMENTS / timer.getElapsedTimeF64() / 1000.0;
+
+			std::cout << llformat("%7d %5.2f/%5.2f %5d/%5d %6.0f/%6.0f", face.mNumIndices / 3,
+								  octree_build, bvh_build,
+								  octree_size.mBytes / 1024, face.mBVH->getMemoryUsage() / 1024,
+								  octree_rays, bvh_rays) << std::endl;
+			ensure("same answers", octree_t == bvh_t);
+		}
+	}
+}
@@ -0,0 +1,228 @@
+/**
+ * @file llvolumemgr_test.cpp
+ * @brief Tests for asynchronous LOD generation in LLVolumeMgr
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llvolumemgr.h"
+#include "../llvolume.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	LLVolumeParams make_params(U8 profile, U8 path, F32 hollow)
+	{
+		LLVolumeParams params;
+		params.setType(profile, path);
+		params.setHollow(hollow);
+		return params;
+	}
+
+	// Runs continuations until the manager has nothing in flight.  Returns
+	// false if that takes unreasonably long.
+	bool drain(LLThreadPool& pool, LLVolumeMgr& mgr)
+	{
+		for (S32 i = 0; i < 10000; ++i)
+		{
+			pool.updateMainThread(0.f);
+			if (mgr.getPendingCount() == 0)
+			{
+				return true;
+			}
+			ms_sleep(1);
+		}
+		return false;
+	}
+}
+
+namespace tut
+{
+	struct volumemgr_data
+	{
+	};
+	typedef test_group<volumemgr_data> volumemgr_group;
+	typedef volumemgr_group::object volumemgr_object;
+	volumemgr_group volumemgr_test("LLVolumeMgr");
+
+	template<> template<>
+	void volumemgr_object::test<1>()
+	{
+		set_test_name("requestLOD without a pool is always ready");
+
+		LLVolumeMgr mgr;
+		LLVolumeParams params = make_params(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE, 0.f);
+		ensure("not async", !mgr.isAsync());
+		ensure("ready with no group", mgr.requestLOD(params, 2));
+
+		LLVolume* volume = mgr.refVolume(params, 0);
+		ensure("ready with a group", mgr.requestLOD(params, 3));
+		ensure_equals("nothing pending", mgr.getPendingCount(), 0);
+		mgr.unrefVolume(volume);
+	}
+
+	template<> template<>
+	void volumemgr_object::test<2>()
+	{
+		set_test_name("generated LODs match synchronous ones");
+
+		LLThreadPool pool("volume test", 2);
+		LLVolumeMgr mgr;
+		mgr.setThreadPool(&pool);
+
+		const U8 profiles[] = { LL_PCODE_PROFILE_SQUARE, LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PROFILE_CIRCLE_HALF };
+		const U8 paths[] = { LL_PCODE_PATH_LINE, LL_PCODE_PATH_CIRCLE, LL_PCODE_PATH_CIRCLE };
+		for (S32 p = 0; p < 3; ++p)
+		{
+			LLVolumeParams params = make_params(profiles[p], paths[p], p == 0 ? 0.5f : 0.f);
+			LLVolume* low = mgr.refVolume(params, 0);
+
+			ensure("not ready before generation", !mgr.requestLOD(params, 3));
+			ensure("second request not queued again", !mgr.requestLOD(params, 3));
+			ensure_equals("one pending", mgr.getPendingCount(), 1);
+			U32 generated = mgr.getGeneratedCount();
+
+			ensure("generation finished", drain(pool, mgr));
+			ensure_equals("generated count", mgr.getGeneratedCount(), generated + 1);
+			ensure("ready after generation", mgr.isLODReady(params, 3));
+			ensure("request when ready", mgr.requestLOD(params, 3));
+
+			LLVolume* high = mgr.refVolume(params, 3);
+			LLPointer<LLVolume> reference = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(3));
+			ensure_equals("face count", high->getNumVolumeFaces(), reference->getNumVolumeFaces());
+			for (S32 i = 0; i < high->getNumVolumeFaces(); ++i)
+			{
+				const LLVolumeFace& face = high->getVolumeFace(i);
+				const LLVolumeFace& ref_face = reference->getVolumeFace(i);
+				ensure_equals("vertex count", face.mNumVertices, ref_face.mNumVertices);
+				ensure_equals("index count", face.mNumIndices, ref_face.mNumIndices);
+				ensure("positions", !memcmp(face.mPositions, ref_face.mPositions, face.mNumVertices * sizeof(LLVector4a)));
+				ensure("indices", !memcmp(face.mIndices, ref_face.mIndices, face.mNumIndices * sizeof(U16)));
+			}
+
+			mgr.unrefVolume(high);
+			mgr.unrefVolume(low);
+		}
+	}
+
+	template<> template<>
+	void volumemgr_object::test<3>()
+	{
+		set_test_name("results for released groups are dropped");
+
+		LLThreadPool pool("volume test", 1);
+		LLVolumeMgr mgr;
+		mgr.setThreadPool(&pool);
+
+		LLVolumeParams params = make_params(LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE, 0.f);
+		LLVolume* low = mgr.refVolume(params, 0);
+		ensure("queued", !mgr.requestLOD(params, 3));
+		mgr.unrefVolume(low);
+		ensure("group released", mgr.getGroup(params) == NULL);
+
+		ensure("generation finished", drain(pool, mgr));
+		ensure("no group came back", mgr.getGroup(params) == NULL);
+
+		// Detaching the pool with work in flight drops the work
+		low = mgr.refVolume(params, 0);
+		ensure("queued again", !mgr.requestLOD(params, 2));
+		mgr.setThreadPool(NULL);
+		ensure_equals("nothing pending after detach", mgr.getPendingCount(), 0);
+		ensure("synchronous after detach", mgr.requestLOD(params, 2));
+		while (pool.getPending() > 0)
+		{
+			ms_sleep(1);
+		}
+		pool.updateMainThread(0.f);
+		ensure("cancelled result not installed", !mgr.isLODReady(params, 2));
+		mgr.unrefVolume(low);
+	}
+
+	template<> template<>
+	void volumemgr_object::test<4>()
+	{
+		set_test_name("released groups come back from the cache");
+
+		LLVolumeMgr mgr;
+		LLVolumeParams params = make_params(LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE, 0.f);
+
+		// No budget, no cache
+		LLVolume* volume = mgr.refVolume(params, 3);
+		mgr.unrefVolume(volume);
+		ensure_equals("nothing cached without a budget", mgr.getCacheCount(), 0);
+
+		mgr.setCacheBudget(64 * 1024 * 1024);
+		LLPointer<LLVolume> high = mgr.refVolume(params, 3);
+		LLPointer<LLVolume> low = mgr.refVolume(params, 0);
+		ensure_equals("first use misses", mgr.getCacheMisses(), 1U);
+		mgr.unrefVolume(high);
+		mgr.unrefVolume(low);
+		ensure("group released", mgr.getGroup(params) == NULL);
+		ensure_equals("group cached", mgr.getCacheCount(), 1);
+		ensure_equals("cached bytes", mgr.getCacheBytes(),
+					  LLVolumeMgr::getVolumeBytes(high) + LLVolumeMgr::getVolumeBytes(low));
+
+		// Both LODs come back without being generated again
+		LLVolume* volume2 = mgr.refVolume(params, 0);
+		ensure_equals("cache hit", mgr.getCacheHits(), 1U);
+		ensure_equals("cache emptied", mgr.getCacheCount(), 0);
+		ensure_equals("no bytes left", mgr.getCacheBytes(), 0U);
+		ensure("same low LOD", volume2 == low.get());
+		ensure("high LOD ready", mgr.isLODReady(params, 3));
+		LLVolume* volume3 = mgr.refVolume(params, 3);
+		ensure("same high LOD", volume3 == high.get());
+		mgr.unrefVolume(volume3);
+		mgr.unrefVolume(volume2);
+
+		// Sculpts are left alone
+		LLVolumeParams sculpt = params;
+		sculpt.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_SPHERE);
+		volume = mgr.refVolume(sculpt, 1);
+		mgr.unrefVolume(volume);
+		ensure_equals("sculpt not cached", mgr.getCacheCount(), 1);
+
+		// Releasing more than fits evicts the oldest groups first
+		U32 group_bytes = mgr.getCacheBytes();
+		mgr.setCacheBudget(group_bytes * 5 / 2);
+		const F32 hollows[] = { 0.1f, 0.2f, 0.3f };
+		for (S32 i = 0; i < 3; ++i)
+		{
+			LLVolumeParams other = make_params(LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE, hollows[i]);
+			LLVolume* lod = mgr.refVolume(other, 3);
+			LLVolume* lod2 = mgr.refVolume(other, 0);
+			mgr.unrefVolume(lod);
+			mgr.unrefVolume(lod2);
+		}
+		ensure("within budget", mgr.getCacheBytes() <= mgr.getCacheBudget());
+		ensure("evicted", mgr.getCacheEvictions() > 0);
+		volume = mgr.refVolume(params, 3);
+		ensure("oldest group was evicted", volume != high.get());
+		mgr.unrefVolume(volume);
+
+		mgr.clearCache();
+		ensure_equals("cleared", mgr.getCacheBytes(), 0U);
+	}
+}
@@ -32,6 +32,7 @@
 #include <iterator>
 #include "llcorehttputil.h"
 #include "llhttpconstants.h"
+#include "httpstats.h"
 #include "llsd.h"
 #include "llsdjson.h"
 #include "llsdserialize.h"
@@ -118,9 +119,24 @@ bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd)
         return false;
     }
 
-    LLCore::BufferArrayStream bas(body);
+    // The in-memory xml parser is considerably faster than streaming
+    // through expat.  Parse the body in place when it is a single block,
+    // otherwise flatten it first.
+    const char * data(body->contiguousData());
+    std::vector<char> buffer;
+    if (data)
+    {
+        HTTPStats::instance().recordBodyInPlace(body->size());
+    }
+    else
+    {
+        buffer.resize(body->size());
+        body->read(0, &buffer[0], buffer.size());
+        data = &buffer[0];
+        HTTPStats::instance().recordBodyCopied(body->size());
+    }
     LLSD body_llsd;
-    S32 parse_status(LLSDSerialize::fromXML(body_llsd, bas, log));
+    S32 parse_status(LLSDSerialize::fromXMLBuffer(body_llsd, data, body->size(), log));
     if (LLSDParser::PARSE_FAILURE == parse_status){
         return false;
     }
@@ -77,6 +77,179 @@ BOOL LLXmlTree::parseFile(const std::string &path, BOOL keep_contents)
 	return success;
 }
 
+namespace
+{
+	void write_u32(std::string& buffer, U32 value)
+	{
+		buffer.append((const char*)&value, sizeof(U32));
+	}
+
+	BOOL read_u32(const U8*& data, const U8* end, U32& value)
+	{
+		if (end - data < (S32)sizeof(U32))
+		{
+			return FALSE;
+		}
+		memcpy(&value, data, sizeof(U32));
+		data += sizeof(U32);
+		return TRUE;
+	}
+
+	// the strings of a tree by first use, for writeBinary()
+	class LLXmlTreeStringIndex
+	{
+	public:
+		U32 index(const std::string& str)
+		{
+			std::map<std::string, U32>::iterator iter = mIndex.find(str);
+			if (iter != mIndex.end())
+			{
+				return iter->second;
+			}
+			U32 index = mStrings.size();
+			mIndex.insert(std::make_pair(str, index));
+			mStrings.push_back(&mIndex.find(str)->first);
+			return index;
+		}
+
+		std::map<std::string, U32>			mIndex;
+		std::vector<const std::string*>		mStrings;
+	};
+
+	void write_node(const std::string& name, const std::string& contents,
+					const std::map<LLStdStringHandle, const std::string*>& attributes, U32 num_children,
+					LLXmlTreeStringIndex& strings, std::string& nodes)
+	{
+		write_u32(nodes, strings.index(name));
+		write_u32(nodes, strings.index(contents));
+		write_u32(nodes, attributes.size());
+		for (std::map<LLStdStringHandle, const std::string*>::const_iterator iter = attributes.begin();
+			 iter != attributes.end(); ++iter)
+		{
+			write_u32(nodes, strings.index(*iter->first));
+			write_u32(nodes, strings.index(*iter->second));
+		}
+		write_u32(nodes, num_children);
+	}
+}
+
+void LLXmlTree::writeBinary(std::string& buffer)
+{
+	// the nodes in document order, each followed by its children
+	LLXmlTreeStringIndex strings;
+	std::string nodes;
+	std::vector<LLXmlTreeNode*> stack;
+	if (mRoot)
+	{
+		stack.push_back(mRoot);
+	}
+	while (!stack.empty())
+	{
+		LLXmlTreeNode* node = stack.back();
+		stack.pop_back();
+		write_node(node->mName, node->mContents, node->mAttributes, node->mChildList.size(), strings, nodes);
+		for (LLXmlTreeNode::child_list_t::reverse_iterator iter = node->mChildList.rbegin();
+			 iter != node->mChildList.rend(); ++iter)
+		{
+			stack.push_back(*iter);
+		}
+	}
+
+	write_u32(buffer, strings.mStrings.size());
+	for (U32 i = 0; i < strings.mStrings.size(); ++i)
+	{
+		const std::string& str = *strings.mStrings[i];
+		write_u32(buffer, str.size());
+		buffer.append(str);
+	}
+	write_u32(buffer, mRoot ? 1 : 0);
+	buffer.append(nodes);
+}
+
+BOOL LLXmlTree::readBinary(const U8* data, U32 size)
+{
+	cleanup();
+
+	const U8* end = data + size;
+	U32 num_strings = 0;
+	if (!read_u32(data, end, num_strings) || num_strings > size)
+	{
+		return FALSE;
+	}
+	std::vector<std::string> strings(num_strings);
+	for (U32 i = 0; i < num_strings; ++i)
+	{
+		U32 length = 0;
+		if (!read_u32(data, end, length) || (U32)(end - data) < length)
+		{
+			return FALSE;
+		}
+		strings[i].assign((const char*)data, length);
+		data += length;
+	}
+	// attribute keys are looked up in the global table once per string
+	std::vector<LLStdStringHandle> keys(num_strings, NULL);
+
+	U32 has_root = 0;
+	if (!read_u32(data, end, has_root) || has_root > 1)
+	{
+		return FALSE;
+	}
+
+	// the parent of the next node and how many more children it takes
+	std::vector<std::pair<LLXmlTreeNode*, U32> > stack;
+	for (U32 remaining = has_root; remaining > 0 || !stack.empty(); )
+	{
+		if (!stack.empty() && stack.back().second == 0)
+		{
+			stack.pop_back();
+			continue;
+		}
+		U32 name = 0, contents = 0, num_attributes = 0;
+		if (!read_u32(data, end, name) || !read_u32(data, end, contents) || !read_u32(data, end, num_attributes)
+			|| name >= num_strings || contents >= num_strings)
+		{
+			return FALSE;
+		}
+
+		LLXmlTreeNode* parent = stack.empty() ? NULL : stack.back().first;
+		LLXmlTreeNode* node = new LLXmlTreeNode(strings[name], parent, this);
+		node->mContents = strings[contents];
+		if (parent)
+		{
+			parent->addChild(node);
+			stack.back().second--;
+		}
+		else
+		{
+			mRoot = node;
+			remaining--;
+		}
+
+		for (U32 i = 0; i < num_attributes; ++i)
+		{
+			U32 key = 0, value = 0;
+			if (!read_u32(data, end, key) || !read_u32(data, end, value) || key >= num_strings || value >= num_strings)
+			{
+				return FALSE;
+			}
+			if (!keys[key])
+			{
+				keys[key] = sAttributeKeys.addString(strings[key]);
+			}
+			node->mAttributes[keys[key]] = new std::string(strings[value]);
+		}
+
+		U32 num_children = 0;
+		if (!read_u32(data, end, num_children))
+		{
+			return FALSE;
+		}
+		stack.push_back(std::make_pair(node, num_children));
+	}
+	return data == end;
+}
+
 void LLXmlTree::dump()
 {
 	if( mRoot )
@@ -57,6 +57,12 @@ public:
 
 	virtual BOOL	parseFile(const std::string &path, BOOL keep_contents = TRUE);
 
+	// A compact binary copy of the parsed tree, with each name and string
+	// stored once, for caches of parsed files.  readBinary() builds the same
+	// tree back from it without any XML parsing.
+	void			writeBinary(std::string& buffer);
+	BOOL			readBinary(const U8* data, U32 size);
+
 	LLXmlTreeNode*	getRoot() { return mRoot; }
 
 	void			dump();
@@ -60,57 +60,68 @@ static const struct
 	U32							mRate;
 	bool						mPipelined;
 	std::string					mKey;
+	std::string					mHttp2Key;
 	const char *				mUsage;
 } init_data[LLAppCoreHttp::AP_COUNT] =
 {
 	{ // AP_DEFAULT
 		8,		8,		8,		0,		false,
 		"",
+		"",
 		"other"
 	},
 	{ // AP_TEXTURE
 		8,		1,		12,		0,		true,
 		"TextureFetchConcurrency",
+		"TextureFetchHttp2Streams",
 		"texture fetch"
 	},
 	{ // AP_MESH1
 		32,		1,		128,	0,		false,
 		"MeshMaxConcurrentRequests",
+		"MeshHttp2Streams",
 		"mesh fetch"
 	},
 	{ // AP_MESH2
 		8,		1,		32,		0,		true,	
 		"Mesh2MaxConcurrentRequests",
+		"Mesh2Http2Streams",
 		"mesh2 fetch"
 	},
 	{ // AP_LARGE_MESH
 		2,		1,		8,		0,		false,
 		"",
+		"",
 		"large mesh fetch"
 	},
 	{ // AP_UPLOADS 
 		2,		1,		8,		0,		false,
 		"",
+		"",
 		"asset upload"
 	},
 	{ // AP_LONG_POLL
 		32,		32,		32,		0,		false,
 		"",
+		"",
 		"long poll"
 	},
 	{ // AP_INVENTORY
 		4,		1,		4,		0,		false,
 		"",
+		"",
 		"inventory"
 	},
 	{ // AP_MATERIALS
 		2,		1,		8,		0,		false,
 		"RenderMaterials",
+		"",
 		"material manager requests"
 	},
 	{ // AP_AGENT
 		2,		1,		32,		0,		false,
 		"Agent",
+		"",
 		"Agent requests"
 	}
 };
@@ -121,7 +132,8 @@ static void setting_changed();
 LLAppCoreHttp::HttpClass::HttpClass()
 	: mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
 	  mConnLimit(0U),
-	  mPipelined(false)
+	  mPipelined(false),
+	  mHttp2Streams(0U)
 {}
 
 
@@ -287,6 +299,20 @@ void LLAppCoreHttp::init()
 				mHttpClasses[app_policy].mSettingsSignal = cntrl_ptr->getCommitSignal()->connect(boost::bind(&setting_changed));
 			}
 		}
+
+		if (! init_data[i].mHttp2Key.empty() && gSavedSettings.controlExists(init_data[i].mHttp2Key))
+		{
+			LLPointer<LLControlVariable> cntrl_ptr = gSavedSettings.getControl(init_data[i].mHttp2Key);
+			if (cntrl_ptr.isNull())
+			{
+				LL_WARNS("Init") << "Unable to set signal on global setting '" << init_data[i].mHttp2Key
+								 << "'" << LL_ENDL;
+			}
+			else
+			{
+				mHttpClasses[app_policy].mHttp2Signal = cntrl_ptr->getCommitSignal()->connect(boost::bind(&setting_changed));
+			}
+		}
 	}
 }
 
@@ -354,6 +380,7 @@ void LLAppCoreHttp::cleanup()
 	for (int i(0); i < LL_ARRAY_SIZE(mHttpClasses); ++i)
 	{
 		mHttpClasses[i].mSettingsSignal.disconnect();
+		mHttpClasses[i].mHttp2Signal.disconnect();
 	}
 	mPipelinedSignal.disconnect();
 	
@@ -448,6 +475,35 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 			}
 		}
 		
+		// HTTP/2 streams per connection, zero to not ask for HTTP/2.
+		// Takes precedence over pipelining in the class.
+		if (! init_data[i].mHttp2Key.empty() && gSavedSettings.controlExists(init_data[i].mHttp2Key))
+		{
+			const U32 streams(gSavedSettings.getU32(init_data[i].mHttp2Key));
+			if (initial || streams != mHttpClasses[app_policy].mHttp2Streams)
+			{
+				LLCore::HttpHandle handle;
+				handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAMS,
+												   mHttpClasses[app_policy].mPolicy,
+												   long(streams),
+												   LLCore::HttpHandler::ptr_t());
+				if (LLCORE_HTTP_HANDLE_INVALID == handle)
+				{
+					status = mRequest->getStatus();
+					LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+									 << " HTTP/2 streams.  Reason:  " << status.toString()
+									 << LL_ENDL;
+				}
+				else
+				{
+					LL_DEBUGS("Init") << "Changed " << init_data[i].mUsage
+									  << " HTTP/2 streams.  New value:  " << streams
+									  << LL_ENDL;
+					mHttpClasses[app_policy].mHttp2Streams = streams;
+				}
+			}
+		}
+
 		// Get target connection concurrency value
 		U32 setting(init_data[i].mDefault);
 		if (! init_data[i].mKey.empty() && gSavedSettings.controlExists(init_data[i].mKey))
@@ -246,7 +246,9 @@ private:
 		policy_t					mPolicy;			// Policy class id for the class
 		U32							mConnLimit;
 		bool						mPipelined;
+		U32							mHttp2Streams;		// PO_HTTP2_STREAMS of the class, 0 for none
 		boost::signals2::connection mSettingsSignal;	// Signal to global setting that affect this class (if any)
+		boost::signals2::connection mHttp2Signal;		// Signal to the HTTP/2 streams setting of this class (if any)
 	};
 		
 	LLCore::HttpRequest *		mRequest;				// Request queue to issue shutdowns
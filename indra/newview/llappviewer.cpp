@@ -147,6 +147,7 @@
 #include "llviewerkeyboard.h"
 #include "lllfsthread.h"
 #include "llworkerthread.h"
+#include "llthreadpool.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
@@ -585,6 +586,7 @@ static void settings_to_globals()
 	LLImageGL::sGlobalUseAnisotropic	= gSavedSettings.getBOOL("RenderAnisotropic");
 	LLImageGL::sCompressTextures		= gSavedSettings.getBOOL("RenderCompressTextures");
 	LLVOVolume::sLODFactor				= gSavedSettings.getF32("RenderVolumeLODFactor");
+	LLVolume::sUsePickBVH				= gSavedSettings.getBOOL("RenderPickBVH");
 	LLVOVolume::sDistanceFactor			= 1.f-LLVOVolume::sLODFactor * 0.1f;
 	LLVolumeImplFlexible::sUpdateFactor = gSavedSettings.getF32("RenderFlexTimeFactor");
 	LLVOTree::sTreeFactor				= gSavedSettings.getF32("RenderTreeLODFactor");
@@ -1493,6 +1495,7 @@ bool LLAppViewer::frame()
 				F32 max_time = llmin(gFrameIntervalSeconds.value() *10.f, 1.f);
 
 				work_pending += updateTextureThreads(max_time);
+				work_pending += LLThreadPool::getInstance()->updateMainThread(max_time);
 
 				{
 					LL_RECORD_BLOCK_TIME(FTM_VFS);
@@ -1856,6 +1859,9 @@ bool LLAppViewer::cleanup()
 	//#endif // LL_WINDOWS
 
 	LLVolumeMgr* volume_manager = LLPrimitive::getVolumeManager();
+	LL_INFOS() << "Volume cache hits: " << volume_manager->getCacheHits()
+			   << " misses: " << volume_manager->getCacheMisses()
+			   << " evictions: " << volume_manager->getCacheEvictions() << LL_ENDL;
 	if (!volume_manager->cleanup())
 	{
 		LL_WARNS() << "Remaining references in the volume manager!" << LL_ENDL;
@@ -1996,6 +2002,9 @@ bool LLAppViewer::cleanup()
     sTextureFetch = NULL;
 	delete sImageDecodeThread;
     sImageDecodeThread = NULL;
+	// After the queued threads, which may still have work on the pool
+	LLQueuedThread::setThreadPool(NULL);
+	LLThreadPool::cleanupClass();
 	delete mFastTimerLogThread;
 	mFastTimerLogThread = NULL;
 
@@ -2142,6 +2151,18 @@ bool LLAppViewer::initThreads()
 	LLVFSThread::initClass(enable_threads && false);
 	LLLFSThread::initClass(enable_threads && false);
 
+	// Shared background workers, must exist before any LLQueuedThread that uses them
+	LLThreadPool::initClass(gSavedSettings.getS32("ThreadPoolWorkers"));
+	if (gSavedSettings.getBOOL("QueuedThreadsUseThreadPool"))
+	{
+		LLQueuedThread::setThreadPool(LLThreadPool::getInstance());
+	}
+	if (gSavedSettings.getBOOL("AsyncVolumeGeneration"))
+	{
+		LLPrimitive::getVolumeManager()->setThreadPool(LLThreadPool::getInstance());
+	}
+	LLPrimitive::getVolumeManager()->setCacheBudget((U32)llmax(gSavedSettings.getS32("VolumeCacheMemory"), 0) * 1024 * 1024);
+
 	// Image decoding
 	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
 	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
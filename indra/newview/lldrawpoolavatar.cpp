@@ -28,6 +28,7 @@
 
 #include "lldrawpoolavatar.h"
 #include "llskinningutil.h"
+#include "llskinningkernel.h"
 #include "llrender.h"
 
 #include "llvoavatar.h"
@@ -1649,28 +1650,8 @@ void LLDrawPoolAvatar::updateRiggedFaceVertexBuffer(
 		bind_shape_matrix.loadu(skin->mBindShapeMatrix);
 
         const U32 max_joints = LLSkinningUtil::getMaxJointCount();
-		for (U32 j = 0; j < buffer->getNumVerts(); ++j)
-		{
-			LLMatrix4a final_mat;
-            LLSkinningUtil::getPerVertexSkinMatrix(weights[j].getF32ptr(), mat, false, final_mat, max_joints);
-			
-			LLVector4a& v = vol_face.mPositions[j];
-
-			LLVector4a t;
-			LLVector4a dst;
-			bind_shape_matrix.affineTransform(v, t);
-			final_mat.affineTransform(t, dst);
-			pos[j] = dst;
-
-			if (norm)
-			{
-				LLVector4a& n = vol_face.mNormals[j];
-				bind_shape_matrix.rotate(n, t);
-				final_mat.rotate(t, dst);
-				dst.normalize3fast();
-				norm[j] = dst;
-			}
-		}
+		LLSkinningKernel::skinVertices(mat, max_joints, bind_shape_matrix, weights, vol_face.mPositions, vol_face.mNormals,
+									   buffer->getNumVerts(), pos, norm);
 	}
 }
 
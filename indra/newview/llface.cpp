@@ -53,6 +53,7 @@
 #include "llviewershadermgr.h"
 #include "llviewertexture.h"
 #include "llvoavatar.h"
+#include "llthreadpool.h"
 
 #if LL_LINUX
 // Work-around spurious used before init warning on Vector4a
@@ -67,6 +68,8 @@ static LLStaticHashedString sTextureIndexIn("texture_index_in");
 static LLStaticHashedString sColorIn("color_in");
 
 BOOL LLFace::sSafeRenderSelect = TRUE; // FALSE
+std::vector<LLFace::VertexFill> LLFace::sVertexFills;
+bool LLFace::sDeferVertexFill = false;
 
 #define DOTVEC(a,b) (a.mV[0]*b.mV[0] + a.mV[1]*b.mV[1] + a.mV[2]*b.mV[2])
 
@@ -1209,6 +1212,146 @@ static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_NO_XFORM("No Xform");
 static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_XFORM("Xform");
 static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_PLANAR("Quick Planar");
 
+static LLTrace::BlockTimerStatHandle FTM_FACE_VERTEX_FILL("Vertex Fill");
+
+//static
+void LLFace::beginVertexFill()
+{
+	llassert(!sDeferVertexFill);
+	sDeferVertexFill = true;
+}
+
+static void fill_vertices(const std::vector<LLFace::VertexFill>* fills, U32 index)
+{
+	LLFace::fillVertices((*fills)[index]);
+}
+
+//static
+void LLFace::endVertexFill()
+{
+	llassert(sDeferVertexFill);
+	sDeferVertexFill = false;
+
+	if (sVertexFills.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_FACE_VERTEX_FILL);
+
+	//a few small faces are done before the pool could pick them up
+	const S32 MIN_PARALLEL_VERTICES = 4096;
+	S32 vertices = 0;
+	for (U32 i = 0; i < sVertexFills.size(); ++i)
+	{
+		vertices += sVertexFills[i].mNumVertices;
+	}
+
+	LLThreadPool* pool = LLThreadPool::getInstance();
+	if (LLPipeline::sParallelVertexFill && pool && sVertexFills.size() > 1 && vertices >= MIN_PARALLEL_VERTICES)
+	{
+		pool->parallelFor(sVertexFills.size(), boost::bind(fill_vertices, &sVertexFills, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < sVertexFills.size(); ++i)
+		{
+			fillVertices(sVertexFills[i]);
+		}
+	}
+
+	sVertexFills.clear();
+}
+
+//static
+void LLFace::fillVertices(const VertexFill& fill)
+{
+	if (fill.mVertexOut)
+	{
+		LLMatrix4a mat_vert;
+		mat_vert.loadu(fill.mMatVert);
+
+		const LLVector4a* src = fill.mPositions;
+		const LLVector4a* end = src+fill.mNumVertices;
+		F32* dst = fill.mVertexOut;
+		F32* end_f32 = dst+fill.mGeomCount*4;
+
+		//texture index goes in the w component as the bits of an integer
+		F32 val = 0.f;
+		S32* vp = (S32*) &val;
+		*vp = fill.mTextureIndex;
+
+		LLVector4Logical mask;
+		mask.clear();
+		mask.setElement<3>();
+
+		LLVector4a texIdx;
+		texIdx.set(0,0,0,val);
+
+		LLVector4a res0;
+		LLVector4a tmp;
+
+		while (src < end)
+		{	
+			mat_vert.affineTransform(*src++, res0);
+			tmp.setSelectWithMask(mask, texIdx, res0);
+			tmp.store4a(dst);
+			dst += 4;
+		}
+
+		while (dst < end_f32)
+		{
+			res0.store4a(dst);
+			dst += 4;
+		}
+	}
+
+	if (fill.mNormalOut || fill.mTangentOut)
+	{
+		LLMatrix4a mat_normal;
+		mat_normal.loadu(fill.mMatNormal);
+
+		if (fill.mNormalOut)
+		{
+			F32* normals = fill.mNormalOut;
+			const LLVector4a* src = fill.mNormals;
+			const LLVector4a* end = src+fill.mNumVertices;
+			
+			while (src < end)
+			{	
+				LLVector4a normal;
+				mat_normal.rotate(*src++, normal);
+				normal.store4a(normals);
+				normals += 4;
+			}
+		}
+
+		if (fill.mTangentOut)
+		{
+			F32* tangents = fill.mTangentOut;
+
+			LLVector4Logical mask;
+			mask.clear();
+			mask.setElement<3>();
+
+			const LLVector4a* src = fill.mTangents;
+			const LLVector4a* end = src+fill.mNumVertices;
+
+			while (src < end)
+			{
+				LLVector4a tangent_out;
+				mat_normal.rotate(*src, tangent_out);
+				tangent_out.normalize3fast();
+				tangent_out.setSelectWithMask(mask, *src, tangent_out);
+				tangent_out.store4a(tangents);
+				
+				src++;
+				tangents += 4;
+			}
+		}
+	}
+}
+
 BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							   const S32 &f,
 								const LLMatrix4& mat_vert_in, const LLMatrix3& mat_norm_in,
@@ -1956,160 +2099,64 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			}
 		}
 
+		//positions, normals and tangents are transformed by fillVertices(), either right
+		//away or with the rest of the faces queued between beginVertexFill() and endVertexFill()
+		VertexFill fill;
+		fill.mMatVert = mat_vert_in;
+		fill.mMatNormal = mat_norm_in;
+		fill.mPositions = vf.mPositions;
+		fill.mNormals = vf.mNormals;
+		fill.mTangents = NULL;
+		fill.mVertexOut = NULL;
+		fill.mNormalOut = NULL;
+		fill.mTangentOut = NULL;
+		fill.mNumVertices = num_vertices;
+		fill.mGeomCount = mGeomCount;
+		fill.mTextureIndex = 0;
+
 		if (rebuild_pos)
 		{
-			LLVector4a* src = vf.mPositions;
-			
-			//_mm_prefetch((char*)src, _MM_HINT_T0);
-
-			LLVector4a* end = src+num_vertices;
-			//LLVector4a* end_64 = end-4;
-
 			//LL_RECORD_TIME_BLOCK(FTM_FACE_GEOM_POSITION);
 			llassert(num_vertices > 0);
 		
 			mVertexBuffer->getVertexStrider(vert, mGeomIndex, mGeomCount, map_range);
-			
-			LLMatrix4a mat_vert;
-			mat_vert.loadu(mat_vert_in);
-
-			F32* dst = (F32*) vert.get();
-			F32* end_f32 = dst+mGeomCount*4;
-
-			//_mm_prefetch((char*)dst, _MM_HINT_NTA);
-			//_mm_prefetch((char*)src, _MM_HINT_NTA);
-				
-			//_mm_prefetch((char*)dst, _MM_HINT_NTA);
-
-
-			LLVector4a res0; //,res1,res2,res3;
-
-			LLVector4a texIdx;
+			fill.mVertexOut = (F32*) vert.get();
 
 			S32 index = mTextureIndex < 255 ? mTextureIndex : 0;
-
-			F32 val = 0.f;
-			S32* vp = (S32*) &val;
-			*vp = index;
-			
 			llassert(index <= LLGLSLShader::sIndexedTextureChannels-1);
-
-			LLVector4Logical mask;
-			mask.clear();
-			mask.setElement<3>();
-		
-			texIdx.set(0,0,0,val);
-
-			LLVector4a tmp;
-
-			{
-				//LL_RECORD_TIME_BLOCK(FTM_FACE_POSITION_STORE);
-
-				/*if (num_vertices > 4)
-				{ //more than 64 bytes
-					while (src < end_64)
-					{	
-						_mm_prefetch((char*)src + 64, _MM_HINT_T0);
-						_mm_prefetch((char*)dst + 64, _MM_HINT_T0);
-
-						mat_vert.affineTransform(*src, res0);
-						tmp.setSelectWithMask(mask, texIdx, res0);
-						tmp.store4a((F32*) dst);
-
-						mat_vert.affineTransform(*(src+1), res1);
-						tmp.setSelectWithMask(mask, texIdx, res1);
-						tmp.store4a((F32*) dst+4);
-
-						mat_vert.affineTransform(*(src+2), res2);
-						tmp.setSelectWithMask(mask, texIdx, res2);
-						tmp.store4a((F32*) dst+8);
-
-						mat_vert.affineTransform(*(src+3), res3);
-						tmp.setSelectWithMask(mask, texIdx, res3);
-						tmp.store4a((F32*) dst+12);
-
-						dst += 16;
-						src += 4;
-					}
-				}*/
-
-				while (src < end)
-				{	
-					mat_vert.affineTransform(*src++, res0);
-					tmp.setSelectWithMask(mask, texIdx, res0);
-					tmp.store4a((F32*) dst);
-					dst += 4;
-				}
-			}
-
-			{
-				//LL_RECORD_TIME_BLOCK(FTM_FACE_POSITION_PAD);
-				while (dst < end_f32)
-				{
-					res0.store4a((F32*) dst);
-					dst += 4;
-				}
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			fill.mTextureIndex = index;
 		}
-
 		
 		if (rebuild_normal)
 		{
 			//LL_RECORD_TIME_BLOCK(FTM_FACE_GEOM_NORMAL);
 			mVertexBuffer->getNormalStrider(norm, mGeomIndex, mGeomCount, map_range);
-			F32* normals = (F32*) norm.get();
-			LLVector4a* src = vf.mNormals;
-			LLVector4a* end = src+num_vertices;
-			
-			while (src < end)
-			{	
-				LLVector4a normal;
-				mat_normal.rotate(*src++, normal);
-				normal.store4a(normals);
-				normals += 4;
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			fill.mNormalOut = (F32*) norm.get();
 		}
 		
 		if (rebuild_tangent)
 		{
 			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_TANGENT);
 			mVertexBuffer->getTangentStrider(tangent, mGeomIndex, mGeomCount, map_range);
-			F32* tangents = (F32*) tangent.get();
+			fill.mTangentOut = (F32*) tangent.get();
 			
 			mVObjp->getVolume()->genTangents(f);
-			
-			LLVector4Logical mask;
-			mask.clear();
-			mask.setElement<3>();
-
-			LLVector4a* src = vf.mTangents;
-			LLVector4a* end = vf.mTangents+num_vertices;
+			fill.mTangents = vf.mTangents;
+		}
 
-			while (src < end)
-			{
-				LLVector4a tangent_out;
-				mat_normal.rotate(*src, tangent_out);
-				tangent_out.normalize3fast();
-				tangent_out.setSelectWithMask(mask, *src, tangent_out);
-				tangent_out.store4a(tangents);
-				
-				src++;
-				tangents += 4;
+		if (fill.mVertexOut || fill.mNormalOut || fill.mTangentOut)
+		{
+			if (sDeferVertexFill && !map_range)
+			{ //buffers stay mapped until the caller flushes them after endVertexFill()
+				sVertexFills.push_back(fill);
 			}
-
-			if (map_range)
+			else
 			{
-				mVertexBuffer->flush();
+				fillVertices(fill);
+				if (map_range)
+				{
+					mVertexBuffer->flush();
+				}
 			}
 		}
 	
@@ -32,6 +32,7 @@
 #include "v2math.h"
 #include "v3math.h"
 #include "v4math.h"
+#include "m3math.h"
 #include "m4math.h"
 #include "v4coloru.h"
 #include "llquaternion.h"
@@ -84,6 +85,31 @@ public:
 
 	static void cacheFaceInVRAM(const LLVolumeFace& vf);
 
+	// The position, normal and tangent transforms of getGeometryVolume().  They only read
+	// the volume face and write to vertex buffer memory that is already mapped, so they
+	// may run off the main thread.
+	struct VertexFill
+	{
+		LLMatrix4			mMatVert;
+		LLMatrix3			mMatNormal;
+		const LLVector4a*	mPositions;
+		const LLVector4a*	mNormals;
+		const LLVector4a*	mTangents;
+		F32*				mVertexOut;		// NULL if positions are not rebuilt
+		F32*				mNormalOut;		// NULL if normals are not rebuilt
+		F32*				mTangentOut;	// NULL if tangents are not rebuilt
+		S32					mNumVertices;
+		S32					mGeomCount;
+		S32					mTextureIndex;
+	};
+
+	// Between these getGeometryVolume() only maps the buffers and queues its VertexFill,
+	// endVertexFill() then runs the queue on the thread pool.  Call endVertexFill()
+	// before flushing any of the buffers.
+	static void beginVertexFill();
+	static void endVertexFill();
+	static void fillVertices(const VertexFill& fill);
+
 public:
 	LLFace(LLDrawable* drawablep, LLViewerObject* objp)
 	:	LLTrace::MemTrackableNonVirtual<LLFace, 16>("LLFace")
@@ -297,6 +323,8 @@ private:
 	
 protected:
 	static BOOL	sSafeRenderSelect;
+	static std::vector<VertexFill> sVertexFills;
+	static bool sDeferVertexFill;
 	
 public:
 	struct CompareDistanceGreater
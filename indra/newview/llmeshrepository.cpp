@@ -68,9 +68,11 @@
 #include "llviewerparcelmgr.h"
 #include "lluploadfloaterobservers.h"
 #include "bufferarray.h"
+#include "httpstats.h"
 #include "bufferstream.h"
 #include "llfasttimer.h"
 #include "llcorehttputil.h"
+#include "llmemorystream.h"
 #include "lltrans.h"
 #include "llstatusbar.h"
 #include "llinventorypanel.h"
@@ -1727,8 +1729,7 @@ bool LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_params, S32 lod, U
 	}
 
 	LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
-	std::string mesh_string((char*) data, data_size);
-	std::istringstream stream(mesh_string);
+	LLMemoryStream stream(data, data_size);
 
 	if (volume->unpackVolumeFaces(stream, data_size))
 	{
@@ -1752,9 +1753,7 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
 
 	if (data_size > 0)
 	{
-		std::string res_str((char*) data, data_size);
-
-		std::istringstream stream(res_str);
+		LLMemoryStream stream(data, data_size);
 
 		if (!unzip_llsd(skin, stream, data_size))
 		{
@@ -1784,9 +1783,7 @@ bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S3
 
 	if (data_size > 0)
 	{ 
-		std::string res_str((char*) data, data_size);
-
-		std::istringstream stream(res_str);
+		LLMemoryStream stream(data, data_size);
 
 		if (!unzip_llsd(decomp, stream, data_size))
 		{
@@ -1825,8 +1822,7 @@ bool LLMeshRepoThread::physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32
 		volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
 		volume_params.setSculptID(mesh_id, LL_SCULPT_TYPE_MESH);
 		LLPointer<LLVolume> volume = new LLVolume(volume_params,0);
-		std::string mesh_string((char*) data, data_size);
-		std::istringstream stream(mesh_string);
+		LLMemoryStream stream(data, data_size);
 
 		if (volume->unpackVolumeFaces(stream, data_size))
 		{
@@ -2861,6 +2857,7 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 		LLCore::BufferArray * body(response->getBody());
 		S32 body_offset(0);
 		U8 * data(NULL);
+		U8 * data_copy(NULL);
 		S32 data_size(body ? body->size() : 0);
 
 		if (data_size > 0)
@@ -2913,19 +2910,28 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 				goto common_exit;
 			}
 			
-			// *TODO: Try to get rid of data copying and add interfaces
-			// that support BufferArray directly.  Introduce a two-phase
-			// handler, optional first that takes a body, fallback second
-			// that requires a temporary allocation and data copy.
+			// Bodies with a known length arrive in a single block and
+			// are handed to the handler in place.  The handlers only
+			// read the data and the body outlives processData().
 			body_offset = mOffset - offset;
-			data = new U8[data_size - body_offset];
-			body->read(body_offset, (char *) data, data_size - body_offset);
+			const char * contiguous(body->contiguousData());
+			if (contiguous)
+			{
+				data = (U8 *) contiguous + body_offset;
+				LLCore::HTTPStats::instance().recordBodyInPlace(data_size - body_offset);
+			}
+			else
+			{
+				data = data_copy = new U8[data_size - body_offset];
+				body->read(body_offset, (char *) data, data_size - body_offset);
+				LLCore::HTTPStats::instance().recordBodyCopied(data_size - body_offset);
+			}
 			LLMeshRepository::sBytesReceived += data_size;
 		}
 
 		processData(body, body_offset, data, data_size - body_offset);
 
-		delete [] data;
+		delete [] data_copy;
 	}
 
 	// Release handler
@@ -36,6 +36,8 @@
 #include "llphysicsmotion.h"
 #include "llagent.h"
 #include "llcharacter.h"
+#include "lldriverparam.h"
+#include "llmutex.h"
 #include "llviewercontrol.h"
 #include "llviewervisualparam.h"
 #include "llvoavatarself.h"
@@ -44,14 +46,6 @@ typedef std::map<std::string, std::string> controller_map_t;
 typedef std::map<std::string, F32> default_controller_map_t;
 
 #define MIN_REQUIRED_PIXEL_AREA_AVATAR_PHYSICS_MOTION 0.f
-#define TIME_ITERATION_STEP 0.1f
-
-inline F64 llsgn(const F64 a)
-{
-        if (a >= 0)
-                return 1;
-        return -1;
-}
 
 /* 
    At a high level, this works by setting temporary parameters that are not stored
@@ -103,18 +97,20 @@ public:
                 mJointName(joint_name),
                 mMotionDirectionVec(motion_direction_vec),
                 mParamDriver(NULL),
+                mDriverParam(NULL),
+                mDriverHidden(FALSE),
                 mParamControllers(controllers),
                 mCharacter(character),
+                mIsSelf(FALSE),
                 mLastTime(0),
-                mPosition_local(0),
-                mVelocityJoint_local(0),
-                mPositionLastUpdate_local(0)
+                mUpdateTime(0)
         {
                 mJointState = new LLJointState;
 
 				for (U32 i = 0; i < NUM_PARAMS; ++i)
 				{
 					mParamCache[i] = NULL;
+					mParamDefault[i] = 0.f;
 				}
         }
 
@@ -122,7 +118,17 @@ public:
 
         ~LLPhysicsMotion() {}
 
-        BOOL onUpdate(F32 time);
+        // Reads this frame's joint motion and settings into the lane, returns
+        // TRUE when the lane has to be integrated before endUpdate().
+        BOOL beginUpdate(F32 time, BOOL& update_visuals);
+        // Sets the driven params from the integrated lane, returns TRUE if
+        // the character has to update its visual params.
+        BOOL endUpdate();
+
+        LLPhysicsMotionBatch::Lane* getLane()
+        {
+                return &mLane;
+        }
 
         LLPointer<LLJointState> getJointState() 
         {
@@ -132,37 +138,7 @@ protected:
 
 		F32 getParamValue(eParamName param)
 		{
-			static std::string controller_key[] = 
-			{
-				"Smoothing",
-				"Mass",
-				"Gravity",
-				"Spring",
-				"Gain",
-				"Damping",
-				"Drag",
-				"MaxEffect"
-			};
-
-			if (!mParamCache[param])
-			{
-				const controller_map_t::const_iterator& entry = mParamControllers.find(controller_key[param]);
-                if (entry == mParamControllers.end())
-                {
-                        return sDefaultController[controller_key[param]];
-                }
-                const std::string& param_name = (*entry).second.c_str();
-                mParamCache[param] = mCharacter->getVisualParam(param_name.c_str());
-			}
-				
-			if (mParamCache[param])
-			{
-				return mParamCache[param]->getWeight();
-			}
-			else
-			{
-				return sDefaultController[controller_key[param]];
-			}
+			return mParamCache[param] ? mParamCache[param]->getWeight() : mParamDefault[param];
 		}
 
         
@@ -170,32 +146,31 @@ protected:
                            const F32 new_value_local,
                                                    F32 behavior_maxeffect);
 
-        F32 toLocal(const LLVector3 &world);
-        F32 calculateVelocity_local(const F32 time_delta);
-        F32 calculateAcceleration_local(F32 velocity_local, const F32 time_delta);
 private:
         const std::string mParamDriverName;
         const std::string mParamControllerName;
         const LLVector3 mMotionDirectionVec;
         const std::string mJointName;
 
-        F32 mPosition_local;
-        F32 mVelocityJoint_local; // How fast the joint is moving
-        F32 mAccelerationJoint_local; // Acceleration on the joint
-
-        F32 mVelocity_local; // How fast the param is moving
-        F32 mPositionLastUpdate_local;
+        LLPhysicsMotionBatch::Lane mLane; // settings, state and results of the integration
         LLVector3 mPosition_world;
 
         LLViewerVisualParam *mParamDriver;
+        LLDriverParam *mDriverParam;
+        BOOL mDriverHidden; // one of our "hidden" driver params, kept at its default
         const controller_map_t mParamControllers;
         
         LLPointer<LLJointState> mJointState;
         LLCharacter *mCharacter;
+        BOOL mIsSelf;
 
         F32 mLastTime;
+        F32 mUpdateTime; // of the frame being integrated
+        LLVector3 mUpdatePosition_world;
         
+		// resolved by name in initialize()
 		LLVisualParam* mParamCache[NUM_PARAMS];
+		F32 mParamDefault[NUM_PARAMS];
 
         static default_controller_map_t sDefaultController;
 };
@@ -228,18 +203,60 @@ BOOL LLPhysicsMotion::initialize()
                 return FALSE;
         }
 
+        mDriverParam = dynamic_cast<LLDriverParam *>(mParamDriver);
+        if (mDriverParam == NULL)
+        {
+                LL_WARNS() << "Physics param [ " << mParamDriverName << " ] is not a driver param" << LL_ENDL;
+                return FALSE;
+        }
+        mDriverHidden = (mDriverParam->getGroup() != VISUAL_PARAM_GROUP_TWEAKABLE) &&
+                        (mDriverParam->getGroup() != VISUAL_PARAM_GROUP_TWEAKABLE_NO_TRANSMIT);
+        mIsSelf = (dynamic_cast<LLVOAvatarSelf *>(mCharacter) != NULL);
+
+        // Look up the controller params once, the weights are read every frame.
+        static const std::string controller_key[] = 
+        {
+                "Smoothing",
+                "Mass",
+                "Gravity",
+                "Spring",
+                "Gain",
+                "Damping",
+                "Drag",
+                "MaxEffect"
+        };
+        for (U32 i = 0; i < NUM_PARAMS; ++i)
+        {
+                default_controller_map_t::const_iterator default_entry = sDefaultController.find(controller_key[i]);
+                mParamDefault[i] = default_entry != sDefaultController.end() ? default_entry->second : 0.f;
+
+                mParamCache[i] = NULL;
+                controller_map_t::const_iterator entry = mParamControllers.find(controller_key[i]);
+                if (entry != mParamControllers.end())
+                {
+                        mParamCache[i] = mCharacter->getVisualParam(entry->second.c_str());
+                }
+        }
+
         return TRUE;
 }
 
 LLPhysicsMotionController::LLPhysicsMotionController(const LLUUID &id) : 
         LLMotion(id),
-        mCharacter(NULL)
+        mCharacter(NULL),
+        mUpdateVisuals(FALSE)
 {
         mName = "breast_motion";
 }
 
 LLPhysicsMotionController::~LLPhysicsMotionController()
 {
+        if (!mSteppingMotions.empty() && sBatchMutex)
+        {
+                LLMutexLock lock(sBatchMutex);
+                sBatchControllers.erase(std::remove(sBatchControllers.begin(), sBatchControllers.end(), this),
+                                        sBatchControllers.end());
+        }
         for (motion_vec_t::iterator iter = mMotions.begin();
              iter != mMotions.end();
              ++iter)
@@ -414,69 +431,134 @@ F32 LLPhysicsMotionController::getMinPixelArea()
         return MIN_REQUIRED_PIXEL_AREA_AVATAR_PHYSICS_MOTION;
 }
 
-// Local space means "parameter space".
-F32 LLPhysicsMotion::toLocal(const LLVector3 &world)
-{
-        LLJoint *joint = mJointState->getJoint();
-        const LLQuaternion rotation_world = joint->getWorldRotation();
-        
-        LLVector3 dir_world = mMotionDirectionVec * rotation_world;
-        dir_world.normalize();
-        return world * dir_world;
-}
+static LLTrace::BlockTimerStatHandle FTM_PHYSICS_MOTION_BATCH("Avatar Physics");
 
-F32 LLPhysicsMotion::calculateVelocity_local(const F32 time_delta)
-{
-	const F32 world_to_model_scale = 100.0f;
-        LLJoint *joint = mJointState->getJoint();
-        const LLVector3 position_world = joint->getWorldPosition();
-        const LLVector3 last_position_world = mPosition_world;
-	const LLVector3 positionchange_world = (position_world-last_position_world) * world_to_model_scale;
-        const F32 velocity_local = toLocal(positionchange_world) / time_delta;
-        return velocity_local;
-}
-
-F32 LLPhysicsMotion::calculateAcceleration_local(const F32 velocity_local, const F32 time_delta)
-{
-//        const F32 smoothing = getParamValue("Smoothing");
-        static const F32 smoothing = 3.0f; // Removed smoothing param since it's probably not necessary
-        const F32 acceleration_local = (velocity_local - mVelocityJoint_local) / time_delta;
-        
-        const F32 smoothed_acceleration_local = 
-                acceleration_local * 1.0/smoothing + 
-                mAccelerationJoint_local * (smoothing-1.0)/smoothing;
-        
-        return smoothed_acceleration_local;
-}
+bool LLPhysicsMotionController::sEnabled = true;
+bool LLPhysicsMotionController::sBatchOpen = false;
+LLMutex* LLPhysicsMotionController::sBatchMutex = NULL;
+std::vector<LLPhysicsMotionController*> LLPhysicsMotionController::sBatchControllers;
+LLPhysicsMotionBatch LLPhysicsMotionController::sBatch;
 
 BOOL LLPhysicsMotionController::onUpdate(F32 time, U8* joint_mask)
 {
         // Skip if disabled globally.
-        if (!gSavedSettings.getBOOL("AvatarPhysics"))
+        if (!sEnabled)
         {
                 return TRUE;
         }
         
-        BOOL update_visuals = FALSE;
+        mUpdateVisuals = FALSE;
+        mSteppingMotions.clear();
         for (motion_vec_t::iterator iter = mMotions.begin();
              iter != mMotions.end();
              ++iter)
         {
                 LLPhysicsMotion *motion = (*iter);
-                update_visuals |= motion->onUpdate(time);
+                if (motion->beginUpdate(time, mUpdateVisuals))
+                {
+                        mSteppingMotions.push_back(motion);
+                }
         }
-                
-        if (update_visuals)
-                mCharacter->updateVisualParams();
+
+        if (!mSteppingMotions.empty() && sBatchOpen)
+        {
+                // endBatch() integrates these with the motions of the other avatars
+                LLMutexLock lock(sBatchMutex);
+                sBatchControllers.push_back(this);
+                return TRUE;
+        }
+
+        if (!mSteppingMotions.empty())
+        {
+                for (motion_vec_t::iterator iter = mSteppingMotions.begin();
+                     iter != mSteppingMotions.end();
+                     ++iter)
+                {
+                        mBatch.addLane((*iter)->getLane());
+                }
+                mBatch.integrate();
+                mBatch.clear();
+        }
+        endUpdate();
         
         return TRUE;
 }
 
-// Return TRUE if character has to update visual params.
-BOOL LLPhysicsMotion::onUpdate(F32 time)
+void LLPhysicsMotionController::endUpdate()
+{
+        for (motion_vec_t::iterator iter = mSteppingMotions.begin();
+             iter != mSteppingMotions.end();
+             ++iter)
+        {
+                mUpdateVisuals |= (*iter)->endUpdate();
+        }
+        mSteppingMotions.clear();
+                
+        if (mUpdateVisuals)
+        {
+                mUpdateVisuals = FALSE;
+                mCharacter->updateVisualParams();
+        }
+}
+
+//static
+void LLPhysicsMotionController::updateEnabled()
+{
+        static LLCachedControl<bool> avatar_physics(gSavedSettings, "AvatarPhysics");
+        sEnabled = avatar_physics;
+}
+
+//static
+void LLPhysicsMotionController::beginBatch()
+{
+        llassert(!sBatchOpen);
+        if (!sBatchMutex)
+        {
+                sBatchMutex = new LLMutex(NULL);
+        }
+        sBatchOpen = true;
+}
+
+//static
+void LLPhysicsMotionController::endBatch()
+{
+        llassert(sBatchOpen);
+        sBatchOpen = false;
+
+        if (sBatchControllers.empty())
+        {
+                return;
+        }
+
+        LL_RECORD_BLOCK_TIME(FTM_PHYSICS_MOTION_BATCH);
+        for (std::vector<LLPhysicsMotionController*>::iterator iter = sBatchControllers.begin();
+             iter != sBatchControllers.end();
+             ++iter)
+        {
+                motion_vec_t& motions = (*iter)->mSteppingMotions;
+                for (motion_vec_t::iterator motion_iter = motions.begin();
+                     motion_iter != motions.end();
+                     ++motion_iter)
+                {
+                        sBatch.addLane((*motion_iter)->getLane());
+                }
+        }
+        sBatch.integrate();
+        sBatch.clear();
+
+        for (std::vector<LLPhysicsMotionController*>::iterator iter = sBatchControllers.begin();
+             iter != sBatchControllers.end();
+             ++iter)
+        {
+                (*iter)->endUpdate();
+        }
+        sBatchControllers.clear();
+}
+
+// Returns TRUE if the lane has to be integrated, sets update_visuals if the
+// character has to update visual params anyway.
+BOOL LLPhysicsMotion::beginUpdate(F32 time, BOOL& update_visuals)
 {
-        // static FILE *mFileWrite = fopen("c:\\temp\\avatar_data.txt","w");
-        
         if (!mParamDriver)
                 return FALSE;
 
@@ -510,245 +592,88 @@ BOOL LLPhysicsMotion::onUpdate(F32 time)
         const F32 lod_factor = LLVOAvatar::sPhysicsLODFactor;
         if (lod_factor == 0)
         {
-                return TRUE;
+                update_visuals = TRUE;
+                return FALSE;
         }
 
         LLJoint *joint = mJointState->getJoint();
 
-		const F32 behavior_mass = getParamValue(MASS);
-		const F32 behavior_gravity = getParamValue(GRAVITY);
-		const F32 behavior_spring = getParamValue(SPRING);
-		const F32 behavior_gain = getParamValue(GAIN);
-		const F32 behavior_damping = getParamValue(DAMPING);
-		const F32 behavior_drag = getParamValue(DRAG);
-		F32 behavior_maxeffect = getParamValue(MAX_EFFECT);
-		
-		const BOOL physics_test = FALSE; // Enable this to simulate bouncing on all parts.
-        
-        if (physics_test)
-                behavior_maxeffect = 1.0f;
+	mLane.mTimeDelta = time_delta;
+	mLane.mMass = getParamValue(MASS);
+	mLane.mGravity = getParamValue(GRAVITY);
+	mLane.mSpring = getParamValue(SPRING);
+	mLane.mGain = getParamValue(GAIN);
+	mLane.mDamping = getParamValue(DAMPING);
+	mLane.mDrag = getParamValue(DRAG);
+	mLane.mMaxEffect = getParamValue(MAX_EFFECT);
 
 	// Normalize the param position to be from [0,1].
 	// We have to use normalized values because there may be more than one driven param,
 	// and each of these driven params may have its own range.
 	// This means we'll do all our calculations in normalized [0,1] local coordinates.
-	const F32 position_user_local = (mParamDriver->getWeight() - mParamDriver->getMinWeight()) / (mParamDriver->getMaxWeight() - mParamDriver->getMinWeight());
-       	
-	//
-	// End parameters and settings
-	////////////////////////////////////////////////////////////////////////////////
-	
-	
-	////////////////////////////////////////////////////////////////////////////////
-	// Calculate velocity and acceleration in parameter space.
-	//
-        
-    const F32 joint_local_factor = 30.0;
-    const F32 velocity_joint_local = calculateVelocity_local(time_delta * joint_local_factor);
-    const F32 acceleration_joint_local = calculateAcceleration_local(velocity_joint_local, time_delta * joint_local_factor);
-	
-	//
-	// End velocity and acceleration
-	////////////////////////////////////////////////////////////////////////////////
-	
-	BOOL update_visuals = FALSE;
-	
-	// Break up the physics into a bunch of iterations so that differing framerates will show
-	// roughly the same behavior.
-	for (F32 time_iteration = 0; time_iteration <= time_delta; time_iteration += TIME_ITERATION_STEP)
-	{
-		F32 time_iteration_step = TIME_ITERATION_STEP;
-		if (time_iteration + TIME_ITERATION_STEP > time_delta)
-		{
-			time_iteration_step = time_delta-time_iteration;
-		}
-		
-		// mPositon_local should be in normalized 0,1 range already.  Just making sure...
-		const F32 position_current_local = llclamp(mPosition_local,
-							   0.0f,
-							   1.0f);
-		// If the effect is turned off then don't process unless we need one more update
-		// to set the position to the default (i.e. user) position.
-		if ((behavior_maxeffect == 0) && (position_current_local == position_user_local))
-		{
-			return update_visuals;
-		}
-
-		////////////////////////////////////////////////////////////////////////////////
-		// Calculate the total force 
-		//
+	mLane.mPositionUser = (mParamDriver->getWeight() - mParamDriver->getMinWeight()) / (mParamDriver->getMaxWeight() - mParamDriver->getMinWeight());
 
-		// Spring force is a restoring force towards the original user-set breast position.
-		// F = kx
-		const F32 spring_length = position_current_local - position_user_local;
-		const F32 force_spring = -spring_length * behavior_spring;
+	// The motion direction in world space.  Local space means "parameter space",
+	// the movement of the joint and gravity count along this direction.
+	LLVector3 dir_world = mMotionDirectionVec * joint->getWorldRotation();
+	dir_world.normalize();
 
-		// Acceleration is the force that comes from the change in velocity of the torso.
-		// F = ma
-		const F32 force_accel = behavior_gain * (acceleration_joint_local * behavior_mass);
-
-		// Gravity always points downward in world space.
-		// F = mg
-		const LLVector3 gravity_world(0,0,1);
-		const F32 force_gravity = (toLocal(gravity_world) * behavior_gravity * behavior_mass);
-                
-		// Damping is a restoring force that opposes the current velocity.
-		// F = -kv
-		const F32 force_damping = -behavior_damping * mVelocity_local;
-                
-		// Drag is a force imparted by velocity (intuitively it is similar to wind resistance)
-		// F = .5kv^2
-		const F32 force_drag = .5*behavior_drag*velocity_joint_local*velocity_joint_local*llsgn(velocity_joint_local);
-
-		const F32 force_net = (force_accel + 
-				       force_gravity +
-				       force_spring + 
-				       force_damping + 
-				       force_drag);
-
-		//
-		// End total force
-		////////////////////////////////////////////////////////////////////////////////
-
-        
-		////////////////////////////////////////////////////////////////////////////////
-		// Calculate new params
-		//
-
-		// Calculate the new acceleration based on the net force.
-		// a = F/m
-		const F32 acceleration_new_local = force_net / behavior_mass;
-		static const F32 max_velocity = 100.0f; // magic number, used to be customizable.
-		F32 velocity_new_local = mVelocity_local + acceleration_new_local*time_iteration_step;
-		velocity_new_local = llclamp(velocity_new_local, 
-					     -max_velocity, max_velocity);
+	const F32 world_to_model_scale = 100.0f;
+	mUpdatePosition_world = joint->getWorldPosition();
+	mLane.mJointMotion = ((mUpdatePosition_world - mPosition_world) * world_to_model_scale) * dir_world;
+	// Gravity always points downward in world space.
+	mLane.mUp = dir_world.mV[VZ];
+
+	// Updating the visual params (i.e. what the user sees) is fairly expensive.
+	// So only update if the params have changed enough, and also take into account
+	// the graphics LOD settings.
         
-		// Temporary debugging setting to cause all avatars to move, for profiling purposes.
-		if (physics_test)
-		{
-			velocity_new_local = sin(time*4.0);
-		}
-		// Calculate the new parameters, or remain unchanged if max speed is 0.
-		F32 position_new_local = position_current_local + velocity_new_local*time_iteration_step;
-		if (behavior_maxeffect == 0)
-			position_new_local = position_user_local;
-
-		// Zero out the velocity if the param is being pushed beyond its limits.
-		if ((position_new_local < 0 && velocity_new_local < 0) || 
-		    (position_new_local > 1 && velocity_new_local > 0))
-		{
-			velocity_new_local = 0;
-		}
-	
-		// Check for NaN values.  A NaN value is detected if the variables doesn't equal itself.  
-		// If NaN, then reset everything.
-		if ((mPosition_local != mPosition_local) ||
-		    (mVelocity_local != mVelocity_local) ||
-		    (position_new_local != position_new_local))
-		{
-			position_new_local = 0;
-			mVelocity_local = 0;
-			mVelocityJoint_local = 0;
-			mAccelerationJoint_local = 0;
-			mPosition_local = 0;
-			mPosition_world = LLVector3(0,0,0);
-		}
+	// For non-self, if the avatar is small enough visually, then don't update.
+	const F32 area_for_max_settings = 0.0;
+	const F32 area_for_min_settings = 1400.0;
+	const F32 area_for_this_setting = area_for_max_settings + (area_for_min_settings-area_for_max_settings)*(1.0-lod_factor);
+	const F32 pixel_area = sqrtf(mCharacter->getPixelArea());
+	if ((pixel_area > area_for_this_setting) || mIsSelf)
+	{
+		mLane.mMinDelta = (1.0001f-lod_factor)*0.4f;
+	}
+	else
+	{
+		mLane.mMinDelta = F32_MAX;
+	}
 
-		const F32 position_new_local_clamped = llclamp(position_new_local,
-							       0.0f,
-							       1.0f);
+	mUpdateTime = time;
+	return TRUE;
+}
 
-		LLDriverParam *driver_param = dynamic_cast<LLDriverParam *>(mParamDriver);
-		llassert_always(driver_param);
-		if (driver_param)
+// Return TRUE if character has to update visual params.
+BOOL LLPhysicsMotion::endUpdate()
+{
+	const U32 flags = mLane.mFlags;
+	if (flags & LLPhysicsMotionBatch::STEPPED)
+	{
+		// If this is one of our "hidden" driver params, then make sure it's
+		// the default value.
+		if (mDriverHidden)
 		{
-			// If this is one of our "hidden" driver params, then make sure it's
-			// the default value.
-			if ((driver_param->getGroup() != VISUAL_PARAM_GROUP_TWEAKABLE) &&
-			    (driver_param->getGroup() != VISUAL_PARAM_GROUP_TWEAKABLE_NO_TRANSMIT))
-			{
-				mCharacter->setVisualParamWeight(driver_param, 0);
-			}
-			S32 num_driven = driver_param->getDrivenParamsCount();
-			for (S32 i = 0; i < num_driven; ++i)
-			{
-				const LLViewerVisualParam *driven_param = driver_param->getDrivenParam(i);
-				setParamValue(driven_param,position_new_local_clamped, behavior_maxeffect);
-			}
+			mCharacter->setVisualParamWeight(mDriverParam, 0);
 		}
-        
-		//
-		// End calculate new params
-		////////////////////////////////////////////////////////////////////////////////
-
-		////////////////////////////////////////////////////////////////////////////////
-		// Conditionally update the visual params
-		//
-        
-		// Updating the visual params (i.e. what the user sees) is fairly expensive.
-		// So only update if the params have changed enough, and also take into account
-		// the graphics LOD settings.
-        
-		// For non-self, if the avatar is small enough visually, then don't update.
-		const F32 area_for_max_settings = 0.0;
-		const F32 area_for_min_settings = 1400.0;
-		const F32 area_for_this_setting = area_for_max_settings + (area_for_min_settings-area_for_max_settings)*(1.0-lod_factor);
-	        const F32 pixel_area = sqrtf(mCharacter->getPixelArea());
-        
-		const BOOL is_self = (dynamic_cast<LLVOAvatarSelf *>(mCharacter) != NULL);
-		if ((pixel_area > area_for_this_setting) || is_self)
+		S32 num_driven = mDriverParam->getDrivenParamsCount();
+		for (S32 i = 0; i < num_driven; ++i)
 		{
-			const F32 position_diff_local = llabs(mPositionLastUpdate_local-position_new_local_clamped);
-			const F32 min_delta = (1.0001f-lod_factor)*0.4f;
-			if (llabs(position_diff_local) > min_delta)
-			{
-				update_visuals = TRUE;
-				mPositionLastUpdate_local = position_new_local;
-			}
+			const LLViewerVisualParam *driven_param = mDriverParam->getDrivenParam(i);
+			setParamValue(driven_param, mLane.mValue, mLane.mMaxEffect);
 		}
-
-		//
-		// End update visual params
-		////////////////////////////////////////////////////////////////////////////////
-
-		mVelocity_local = velocity_new_local;
-		mAccelerationJoint_local = acceleration_joint_local;
-		mPosition_local = position_new_local;
 	}
-	mLastTime = time;
-	mPosition_world = joint->getWorldPosition();
-	mVelocityJoint_local = velocity_joint_local;
-
 
-        /*
-          // Write out debugging info into a spreadsheet.
-          if (mFileWrite != NULL && is_self)
-          {
-          fprintf(mFileWrite,"%f\t%f\t%f \t\t%f \t\t%f\t%f\t%f\t \t\t%f\t%f\t%f\t%f\t%f \t\t%f\t%f\t%f\n",
-          position_new_local,
-          velocity_new_local,
-          acceleration_new_local,
-
-          time_delta,
-
-          mPosition_world[0],
-          mPosition_world[1],
-          mPosition_world[2],
-
-          force_net,
-          force_spring,
-          force_accel,
-          force_damping,
-          force_drag,
-
-          spring_length,
-          velocity_joint_local,
-          acceleration_joint_local
-          );
-          }
-        */
+	// The frame stays open while the param rests at its default with no effect.
+	if (flags & LLPhysicsMotionBatch::FINISHED)
+	{
+		mLastTime = mUpdateTime;
+		mPosition_world = mUpdatePosition_world;
+	}
 
-        return update_visuals;
+	return (flags & LLPhysicsMotionBatch::UPDATE_VISUALS) != 0;
 }
 
 // Range of new_value_local is assumed to be [0 , 1] normalized.
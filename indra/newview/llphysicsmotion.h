@@ -32,10 +32,12 @@
 //-----------------------------------------------------------------------------
 #include "llmotion.h"
 #include "llframetimer.h"
+#include "llphysicsmotionbatch.h"
 
 #define PHYSICS_MOTION_FADEIN_TIME 1.0f
 #define PHYSICS_MOTION_FADEOUT_TIME 1.0f
 
+class LLMutex;
 class LLPhysicsMotion;
 
 //-----------------------------------------------------------------------------
@@ -105,13 +107,34 @@ public:
 
 	LLCharacter* getCharacter() { return mCharacter; }
 
+	// Between these the physics of the avatars whose motions are updated,
+	// on any thread, is queued and integrated in one batch by endBatch().
+	// Otherwise each avatar integrates its own motions in onUpdate().
+	static void beginBatch();
+	static void endBatch();
+
+	// Reads the AvatarPhysics setting for onUpdate(), which may run on a
+	// pool thread, call on the main thread before the motions are updated.
+	static void updateEnabled();
+
 protected:
 	void addMotion(LLPhysicsMotion *motion);
+	// sets the params from the integrated motions
+	void endUpdate();
 private:
 	LLCharacter*		mCharacter;
 
 	typedef std::vector<LLPhysicsMotion *> motion_vec_t;
 	motion_vec_t mMotions;
+	motion_vec_t mSteppingMotions;	// with lanes to integrate this frame
+	BOOL mUpdateVisuals;
+	LLPhysicsMotionBatch mBatch;
+
+	static bool sEnabled;
+	static bool sBatchOpen;
+	static LLMutex* sBatchMutex;
+	static std::vector<LLPhysicsMotionController*> sBatchControllers;
+	static LLPhysicsMotionBatch sBatch;
 };
 
 #endif // LL_LLPHYSICSMOTION_H
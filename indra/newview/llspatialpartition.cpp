@@ -67,6 +67,7 @@ static F32 sLastMaxTexPriority = 1.f;
 static F32 sCurMaxTexPriority = 1.f;
 
 BOOL LLSpatialPartition::sTeleportRequested = FALSE;
+U32 LLSpatialPartition::sCullPass = 0;
 
 //static counter for frame to switch LOD on
 
@@ -1106,6 +1107,18 @@ public:
 		return res;
 	}
 
+	virtual void frustumCheckBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results)
+	{
+		AABBInFrustumNoFarClipGroupBoundsBatch(groups, count, results);
+		for (U32 i = 0; i < count; i++)
+		{
+			if (results[i] != 0)
+			{
+				results[i] = llmin(results[i], AABBSphereIntersectGroupExtents(groups[i]));
+			}
+		}
+	}
+
 	virtual void processGroup(LLViewerOctreeGroup* base_group)
 	{
 		LLSpatialGroup* group = (LLSpatialGroup*)base_group;
@@ -1134,6 +1147,11 @@ public:
 		S32 res = AABBInFrustumNoFarClipObjectBounds(group);
 		return res;
 	}
+
+	virtual void frustumCheckBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results)
+	{
+		AABBInFrustumNoFarClipGroupBoundsBatch(groups, count, results);
+	}
 };
 
 class LLOctreeCullShadow : public LLOctreeCull
@@ -1151,6 +1169,11 @@ public:
 	{
 		return AABBInFrustumObjectBounds(group);
 	}
+
+	virtual void frustumCheckBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results)
+	{
+		AABBInFrustumGroupBoundsBatch(groups, count, results);
+	}
 };
 
 class LLOctreeCullVisExtents: public LLOctreeCullShadow
@@ -1514,26 +1537,28 @@ S32 LLSpatialPartition::cull(LLCamera &camera, bool do_occlusion)
 	((LLSpatialGroup*)mOctree->getListener(0))->validate();
 #endif
 
-	if (LLPipeline::sShadowRender)
 	{
 		LL_RECORD_BLOCK_TIME(FTM_FRUSTUM_CULL);
-		LLOctreeCullShadow culler(&camera);
-		culler.traverse(mOctree);
+		LLViewerOctreeCull* culler = createCuller(camera);
+		culler->setCullPass(sCullPass);
+		culler->traverse(mOctree);
+		delete culler;
 	}
-	else if (mInfiniteFarClip || !LLPipeline::sUseFarClip)
+	
+	return 0;
+}
+
+LLViewerOctreeCull* LLSpatialPartition::createCuller(LLCamera& camera)
+{
+	if (LLPipeline::sShadowRender)
 	{
-		LL_RECORD_BLOCK_TIME(FTM_FRUSTUM_CULL);		
-		LLOctreeCullNoFarClip culler(&camera);
-		culler.traverse(mOctree);
+		return new LLOctreeCullShadow(&camera);
 	}
-	else
+	else if (mInfiniteFarClip || !LLPipeline::sUseFarClip)
 	{
-		LL_RECORD_BLOCK_TIME(FTM_FRUSTUM_CULL);		
-		LLOctreeCull culler(&camera);
-		culler.traverse(mOctree);
+		return new LLOctreeCullNoFarClip(&camera);
 	}
-	
-	return 0;
+	return new LLOctreeCull(&camera);
 }
 
 void pushVerts(LLDrawInfo* params, U32 mask)
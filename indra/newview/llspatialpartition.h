@@ -408,6 +408,9 @@ public:
 	BOOL visibleObjectsInFrustum(LLCamera& camera);
 	/*virtual*/ S32 cull(LLCamera &camera, bool do_occlusion=false); // Cull on arbitrary frustum
 	S32 cull(LLCamera &camera, std::vector<LLDrawable *>* results, BOOL for_select); // Cull on arbitrary frustum
+
+	// The culler cull(camera) uses for the current render pass, caller deletes it
+	LLViewerOctreeCull* createCuller(LLCamera& camera);
 	
 	BOOL isVisible(const LLVector3& v);
 	bool isHUDPartition() ;
@@ -436,6 +439,7 @@ public:
 	BOOL mDepthMask; //if TRUE, objects in this partition will be written to depth during alpha rendering
 
 	static BOOL sTeleportRequested; //started to issue a teleport request
+	static U32 sCullPass; //precull pass cull() reuses frustum tests from, 0 for none (see LLPipeline::precull)
 };
 
 // class for creating bridges between spatial partitions
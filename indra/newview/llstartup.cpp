@@ -47,6 +47,7 @@
 #include "llaudioengine_openal.h"
 #endif
 
+#include "llavatardefinitioncache.h"
 #include "llavatarnamecache.h"
 #include "llexperiencecache.h"
 #include "lllandmark.h"
@@ -1238,7 +1239,13 @@ bool idle_startup()
 		LLPostProcess::initClass();
 		display_startup();
 
+		LLTimer avatar_timer;
+		LLAvatarAppearance::getDefinitionCache().load(gSavedSettings.getBOOL("AvatarDefinitionCache")
+			? gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_definitions.bin") : LLStringUtil::null);
         LLAvatarAppearance::initClass("avatar_lad.xml","avatar_skeleton.xml");
+		LL_INFOS("AppInit") << "Avatar definitions loaded in " << avatar_timer.getElapsedTimeF32() * 1000.f << " ms, "
+							<< (LLAvatarAppearance::getDefinitionCache().isEnabled() ? "with" : "without")
+							<< " the avatar definition cache" << LL_ENDL;
 		display_startup();
 
 		LLViewerObject::initVOClasses();
@@ -58,6 +58,7 @@
 #include "httphandler.h"
 #include "httpresponse.h"
 #include "bufferarray.h"
+#include "httpstats.h"
 #include "bufferstream.h"
 #include "llcorehttputil.h"
 
@@ -1786,7 +1787,10 @@ bool LLTextureFetchWorker::doWork(S32 param)
 			{
 				memcpy(buffer, mFormattedImage->getData(), cur_size);
 			}
+			// The image owns its pool-allocated buffer so this is the one
+			// copy the body goes through on its way in.
 			mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+			LLCore::HTTPStats::instance().recordBodyCopied(append_size);
 
 			// NOTE: setData releases current data and owns new data (buffer)
 			mFormattedImage->setData(buffer, total_size);
@@ -551,7 +551,7 @@ void LLViewerJointMesh::dump()
 {
 	if (mValid)
 	{
-		LL_INFOS() << "Usable LOD " << mName << LL_ENDL;
+		LL_INFOS() << "Usable LOD " << getName() << LL_ENDL;
 	}
 }
 
@@ -895,6 +895,8 @@ void LLViewerObjectList::update(LLAgent &agent)
 	}
 	else
 	{
+		// evaluate the motions of other avatars together once everything has had its idle update
+		LLVOAvatar::beginMotionUpdate();
 		for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
 			idle_iter != idle_end; idle_iter++)
 		{
@@ -902,6 +904,7 @@ void LLViewerObjectList::update(LLAgent &agent)
 			llassert(objectp->isActive());
 			objectp->idleUpdate(agent, frame_time);
 		}
+		LLVOAvatar::endMotionUpdate(agent);
 
 		//update flexible objects
 		LLVolumeImplFlexible::updateClass();
@@ -461,7 +461,10 @@ LLViewerOctreeGroup::LLViewerOctreeGroup(OctreeNode* node)
 :	LLTrace::MemTrackable<LLViewerOctreeGroup, 16>("LLViewerOctreeGroup"),
 	mOctreeNode(node),
 	mAnyVisible(0),
-	mState(CLEAN)
+	mState(CLEAN),
+	mCullPass(0),
+	mCullRes(0),
+	mCullObjectsRes(-1)
 {
 	LLVector4a tmp;
 	tmp.splat(0.f);
@@ -1373,7 +1376,7 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
 	}
 	else
 	{
-		mRes = frustumCheck(group);
+		mRes = cachedFrustumCheck(group);
 				
 		if (mRes)
 		{ //at least partially in, run on down
@@ -1383,7 +1386,89 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
 		mRes = 0;
 	}
 }
+
+S32 LLViewerOctreeCull::precull(const OctreeNode* n, U32 pass, bool recurse)
+{
+	LLViewerOctreeGroup* group = (LLViewerOctreeGroup*) n->getListener(0);
+
+	S32 res = frustumCheck(group);
+	storePrecull(n, res, pass);
+
+	if (res == 1 && recurse)
+	{ //partially in, test the children too.  outside or fully in, nothing below gets tested
+		precullChildren(n, pass);
+	}
+	return res;
+}
+
+void LLViewerOctreeCull::precullChildren(const OctreeNode* n, U32 pass)
+{
+	U32 count = n->getChildCount();
+	if (!count)
+	{
+		return;
+	}
+
+	//an octree node has at most 8 children, test them together
+	LLViewerOctreeGroup* groups[8];
+	S32 results[8];
+	llassert(count <= 8);
+	for (U32 i = 0; i < count; i++)
+	{
+		groups[i] = (LLViewerOctreeGroup*) n->getChild(i)->getListener(0);
+	}
+	frustumCheckBatch(groups, count, results);
+
+	for (U32 i = 0; i < count; i++)
+	{
+		storePrecull(n->getChild(i), results[i], pass);
+		if (results[i] == 1)
+		{
+			precullChildren(n->getChild(i), pass);
+		}
+	}
+}
+
+void LLViewerOctreeCull::storePrecull(const OctreeNode* n, S32 res, U32 pass)
+{
+	LLViewerOctreeGroup* group = (LLViewerOctreeGroup*) n->getListener(0);
+	group->mCullPass = pass;
+	group->mCullRes = (S8)res;
+	group->mCullObjectsRes = -1;
+
+	if (res == 1 && n->getElementCount() && n->getChildCount())
+	{ //checkObjects() tests the objects of partially visible branches
+		group->mCullObjectsRes = (S8)frustumCheckObjects(group);
+	}
+}
+
+S32 LLViewerOctreeCull::cachedFrustumCheck(const LLViewerOctreeGroup* group)
+{
+	if (mCullPass && group->mCullPass == mCullPass)
+	{
+		return group->mCullRes;
+	}
+	return frustumCheck(group);
+}
+
+S32 LLViewerOctreeCull::cachedFrustumCheckObjects(const LLViewerOctreeGroup* group)
+{
+	if (mCullPass && group->mCullPass == mCullPass && group->mCullObjectsRes >= 0)
+	{
+		return group->mCullObjectsRes;
+	}
+	return frustumCheckObjects(group);
+}
 	
+//virtual
+void LLViewerOctreeCull::frustumCheckBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results)
+{
+	for (U32 i = 0; i < count; i++)
+	{
+		results[i] = frustumCheck(groups[i]);
+	}
+}
+
 //------------------------------------------
 //agent space group culling
 S32 LLViewerOctreeCull::AABBInFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
@@ -1400,6 +1485,33 @@ S32 LLViewerOctreeCull::AABBInFrustumGroupBounds(const LLViewerOctreeGroup* grou
 {
 	return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
 }
+
+void LLViewerOctreeCull::AABBInFrustumNoFarClipGroupBoundsBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results)
+{
+	groupBoundsBatch(groups, count, results, true);
+}
+
+void LLViewerOctreeCull::AABBInFrustumGroupBoundsBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results)
+{
+	groupBoundsBatch(groups, count, results, false);
+}
+
+void LLViewerOctreeCull::groupBoundsBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results, bool no_far_clip)
+{
+	const U32 BATCH = 8;
+	LL_ALIGN_16(LLVector4a centers[BATCH]);
+	LL_ALIGN_16(LLVector4a radii[BATCH]);
+	for (U32 base = 0; base < count; base += BATCH)
+	{
+		U32 num = llmin(count - base, BATCH);
+		for (U32 i = 0; i < num; i++)
+		{
+			centers[i] = groups[base + i]->mBounds[0];
+			radii[i] = groups[base + i]->mBounds[1];
+		}
+		mCamera->AABBInFrustumBatch(centers, radii, num, results + base, no_far_clip);
+	}
+}
 //------------------------------------------
 
 //------------------------------------------
@@ -1490,7 +1602,7 @@ bool LLViewerOctreeCull::checkObjects(const OctreeNode* branch, const LLViewerOc
 	{
 		return true;
 	}
-	else if (mRes == 1 && !frustumCheckObjects(group)) //no objects in frustum
+	else if (mRes == 1 && !cachedFrustumCheckObjects(group)) //no objects in frustum
 	{
 		return false;
 	}
@@ -267,6 +267,11 @@ protected:
 	S32         mAnyVisible; //latest visible to any camera
 	S32         mVisible[LLViewerCamera::NUM_CAMERAS];	
 
+	// frustum test results of cull pass mCullPass, see LLViewerOctreeCull::precull()
+	U32         mCullPass;
+	S8          mCullRes;
+	S8          mCullObjectsRes; //-1 if not tested
+
 };//LL_ALIGN_POSTFIX(16);
 
 //octree group which has capability to support occlusion culling
@@ -365,12 +370,25 @@ class LLViewerOctreeCull : public OctreeTraveler
 {
 public:
 	LLViewerOctreeCull(LLCamera* camera)
-		: mCamera(camera), mRes(0) { }
+		: mCamera(camera), mRes(0), mCullPass(0) { }
+	virtual ~LLViewerOctreeCull() { }
 	
 	virtual void traverse(const OctreeNode* n);
 
+	//run the frustum tests traverse() will need on the subtree at n ahead of time and keep
+	//the results in its groups, tagged with pass.  traverse() reuses them when the culler is
+	//set to the same pass.  Only reads the camera and writes the groups under n, so disjoint
+	//subtrees can be precomputed on different threads.  Returns the result for n.
+	S32 precull(const OctreeNode* n, U32 pass, bool recurse = true);
+	void setCullPass(U32 pass) { mCullPass = pass; }
+
 protected:
 	virtual bool earlyFail(LLViewerOctreeGroup* group);	
+
+	S32 cachedFrustumCheck(const LLViewerOctreeGroup* group);
+	S32 cachedFrustumCheckObjects(const LLViewerOctreeGroup* group);
+	void precullChildren(const OctreeNode* n, U32 pass);
+	void storePrecull(const OctreeNode* n, S32 res, U32 pass);
 	
 	//agent space group cull
 	S32 AABBInFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group);	
@@ -395,6 +413,15 @@ protected:
 	virtual S32 frustumCheck(const LLViewerOctreeGroup* group) = 0;
 	virtual S32 frustumCheckObjects(const LLViewerOctreeGroup* group) = 0;
 
+	//frustumCheck() for count groups at once, used by precull() on the children of a node.
+	//Overrides must give the same results as frustumCheck(), the default just loops over it.
+	virtual void frustumCheckBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results);
+
+	//agent space group cull of several groups at once with LLCamera::AABBInFrustumBatch()
+	void AABBInFrustumNoFarClipGroupBoundsBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results);
+	void AABBInFrustumGroupBoundsBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results);
+	void groupBoundsBatch(LLViewerOctreeGroup* const* groups, U32 count, S32* results, bool no_far_clip);
+
 	bool checkProjectionArea(const LLVector4a& center, const LLVector4a& size, const LLVector3& shift, F32 pixel_threshold, F32 near_radius);
 	virtual bool checkObjects(const OctreeNode* branch, const LLViewerOctreeGroup* group);
 	virtual void preprocess(LLViewerOctreeGroup* group);
@@ -404,6 +431,7 @@ protected:
 protected:
 	LLCamera *mCamera;
 	S32 mRes;
+	U32 mCullPass; //0 for no precomputed results
 };
 
 //scan the octree, output the info of each node for debug use.
@@ -143,6 +143,8 @@ LLTrace::SampleStatHandle<>	FPS_SAMPLE("fpssample"),
 							ENABLE_VBO("enablevbo", "Vertex Buffers Enabled"),
 							LIGHTING_DETAIL("lightingdetail", "Lighting Detail"),
 							VISIBLE_AVATARS("visibleavatars", "Visible Avatars"),
+							MOTIONS_EVALUATED("motionsevaluated", "Avatar motions evaluated per frame"),
+							MOTIONS_SKIPPED("motionsskipped", "Avatar motions left idle per frame"),
 							SHADER_OBJECTS("shaderobjects", "Object Shaders"),
 							DRAW_DISTANCE("drawdistance", "Draw Distance"),
 							PENDING_VFS_OPERATIONS("vfspendingoperations"),
@@ -195,6 +197,8 @@ LLTrace::EventStatHandle<F64Milliseconds >	REGION_CROSSING_TIME("regioncrossingt
 																NETWORK_STACKTIME("networkstacktime", "NETWORK_SECS"),
 																IMAGE_STACKTIME("imagestacktime", "IMAGE_SECS"),
 																REBUILD_STACKTIME("rebuildstacktime", "REBUILD_SECS"),
+																GEOM_UPDATE_STACKTIME("geomupdatestacktime", "GEOM_UPDATE_SECS"),
+																PRIORITY_REBUILD_STACKTIME("priorityrebuildstacktime", "PRIORITY_REBUILD_SECS"),
 																RENDER_STACKTIME("renderstacktime", "RENDER_SECS");
 	
 LLTrace::EventStatHandle<F64Seconds >	AVATAR_EDIT_TIME("avataredittime", "Seconds in Edit Appearance"),
@@ -357,6 +361,8 @@ void update_statistics()
 	record(LLStatViewer::NETWORK_STACKTIME, network_secs);
 	record(LLStatViewer::IMAGE_STACKTIME, last_frame_recording.getSum(*stat_type_t::getInstance("Update Images")));
 	record(LLStatViewer::REBUILD_STACKTIME, last_frame_recording.getSum(*stat_type_t::getInstance("Sort Draw State")));
+	record(LLStatViewer::GEOM_UPDATE_STACKTIME, last_frame_recording.getSum(*stat_type_t::getInstance("Geo Update")));
+	record(LLStatViewer::PRIORITY_REBUILD_STACKTIME, last_frame_recording.getSum(*stat_type_t::getInstance("Rebuild Priority Groups")));
 	record(LLStatViewer::RENDER_STACKTIME, last_frame_recording.getSum(*stat_type_t::getInstance("Render Geometry")));
 		
 	LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit(gAgent.getRegion()->getHost());
@@ -394,6 +400,9 @@ void update_statistics()
 	}
 	
 	sample(LLStatViewer::VISIBLE_AVATARS, LLVOAvatar::sNumVisibleAvatars);
+	sample(LLStatViewer::MOTIONS_EVALUATED, LLMotionController::getFrameMotionsEvaluated());
+	sample(LLStatViewer::MOTIONS_SKIPPED, LLMotionController::getFrameMotionsSkipped());
+	LLMotionController::resetFrameStats();
 	LLWorld::getInstance()->updateNetStats();
 	LLWorld::getInstance()->requestCacheMisses();
 	
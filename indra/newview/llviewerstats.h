@@ -184,6 +184,8 @@ extern LLTrace::SampleStatHandle<>		FPS_SAMPLE,
 										ENABLE_VBO,
 										LIGHTING_DETAIL,
 										VISIBLE_AVATARS,
+										MOTIONS_EVALUATED,
+										MOTIONS_SKIPPED,
 										SHADER_OBJECTS,
 										DRAW_DISTANCE,
 										PENDING_VFS_OPERATIONS,
@@ -231,6 +233,8 @@ extern LLTrace::EventStatHandle<F64Milliseconds >	REGION_CROSSING_TIME,
 														NETWORK_STACKTIME,
 														IMAGE_STACKTIME,
 														REBUILD_STACKTIME,
+														GEOM_UPDATE_STACKTIME,
+														PRIORITY_REBUILD_STACKTIME,
 														RENDER_STACKTIME;
 
 extern LLTrace::EventStatHandle<F64Seconds >	AVATAR_EDIT_TIME,
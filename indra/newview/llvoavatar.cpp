@@ -108,6 +108,7 @@
 #include "llsdserialize.h"
 #include "llcallstack.h"
 #include "llrendersphere.h"
+#include "llthreadpool.h"
 
 extern F32 SPEED_ADJUST_MAX;
 extern F32 SPEED_ADJUST_MAX_SEC;
@@ -597,6 +598,8 @@ F32 LLVOAvatar::sLODFactor = 1.f;
 F32 LLVOAvatar::sPhysicsLODFactor = 1.f;
 bool LLVOAvatar::sUseImpostors = false; // overwridden by RenderAvatarMaxNonImpostors
 BOOL LLVOAvatar::sJointDebug = FALSE;
+bool LLVOAvatar::sDeferMotionUpdate = false;
+std::vector<LLPointer<LLVOAvatar> > LLVOAvatar::sMotionUpdates;
 F32 LLVOAvatar::sUnbakedTime = 0.f;
 F32 LLVOAvatar::sUnbakedUpdateTime = 0.f;
 F32 LLVOAvatar::sGreyTime = 0.f;
@@ -647,6 +650,11 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	mNeedsSkin(FALSE),
 	mLastSkinTime(0.f),
 	mUpdatePeriod(1),
+	mUpdateTime(0.f),
+	mUpdateCost(0.f),
+	mDeferVisualParamUpdate(FALSE),
+	mVisualParamUpdatePending(FALSE),
+	mWasSitGroundConstrained(false),
 	mVisualComplexityStale(true),
 	mVisuallyMuteSetting(AV_RENDER_NORMALLY),
 	mMutedAVColor(LLColor4::white /* used for "uninitialize" */),
@@ -2285,6 +2293,14 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
 		return;
 	}	
 
+	// appearance messages since the last frame, before anything returns
+	// early, so that the shape is current even when avatars aren't drawn
+	if (mVisualParamUpdatePending)
+	{
+		mVisualParamUpdatePending = FALSE;
+		updateVisualParams();
+	}
+
 	if (!(gPipeline.hasRenderType(LLPipeline::RENDER_TYPE_AVATAR))
 		&& !(gSavedSettings.getBOOL("DisableAllRenderTypes")) && !isSelf())
 	{
@@ -2292,6 +2308,8 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
 	}
 
     LLScopedContextString str("avatar_idle_update " + getFullname());
+
+	LLTimer update_timer;
     
 	checkTextureLoading() ;
 	
@@ -2354,7 +2372,32 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
 	// animate the character
 	// store off last frame's root position to be consistent with camera position
 	mLastRootPos = mRoot->getWorldPosition();
+
+	if (sDeferMotionUpdate && !isSelf())
+	{
+		// endMotionUpdate() evaluates the motions with those of the other
+		// avatars and then finishes the update
+		if (beginCharacterUpdate(agent))
+		{
+			mUpdateTime = update_timer.getElapsedTimeF32();
+			sMotionUpdates.push_back(this);
+			return;
+		}
+		idleUpdateFinish(agent, FALSE, update_timer.getElapsedTimeF32());
+		return;
+	}
+
 	BOOL detailed_update = updateCharacter(agent);
+	idleUpdateFinish(agent, detailed_update, update_timer.getElapsedTimeF32());
+}
+
+//------------------------------------------------------------------------
+// idleUpdateFinish()
+// what idleUpdate() does once the skeleton is posed for this frame
+//------------------------------------------------------------------------
+void LLVOAvatar::idleUpdateFinish(LLAgent &agent, BOOL detailed_update, F32 update_time)
+{
+	LLTimer update_timer;
 
 	static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
 	bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
@@ -2372,9 +2415,86 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
 	}
 		
 	idleUpdateNameTag( mLastRootPos );
+
+	// per avatar cost for the render info display, averaged over a few frames
+	update_time += update_timer.getElapsedTimeF32();
+	mUpdateCost = lerp(mUpdateCost, update_time, 0.1f);
+
 	idleUpdateRenderComplexity();
 }
 
+static LLTrace::BlockTimerStatHandle FTM_AVATAR_MOTION_UPDATE("Avatar Motions");
+
+//static
+void LLVOAvatar::beginMotionUpdate()
+{
+	llassert(!sDeferMotionUpdate);
+	sDeferMotionUpdate = true;
+}
+
+//static
+void LLVOAvatar::updateDeferredMotion(U32 index)
+{
+	LLVOAvatar* avatar = sMotionUpdates[index];
+	if (avatar->isDead())
+	{
+		return;
+	}
+
+	LLTimer update_timer;
+	avatar->updateCharacterMotion();
+	avatar->mUpdateTime += update_timer.getElapsedTimeF32();
+}
+
+//static
+void LLVOAvatar::endMotionUpdate(LLAgent &agent)
+{
+	llassert(sDeferMotionUpdate);
+	sDeferMotionUpdate = false;
+
+	if (sMotionUpdates.empty())
+	{
+		return;
+	}
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_AVATAR_MOTION_UPDATE);
+		// the avatar physics of all of them is integrated together afterwards
+		LLPhysicsMotionController::beginBatch();
+		LLThreadPool* pool = LLThreadPool::getInstance();
+		if (LLPipeline::sParallelAvatarUpdate && pool && sMotionUpdates.size() > 1)
+		{
+			pool->parallelFor(sMotionUpdates.size(), boost::bind(&LLVOAvatar::updateDeferredMotion, _1));
+		}
+		else
+		{
+			for (U32 i = 0; i < sMotionUpdates.size(); ++i)
+			{
+				updateDeferredMotion(i);
+			}
+		}
+		LLPhysicsMotionController::endBatch();
+	}
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_AVATAR_UPDATE);
+		for (U32 i = 0; i < sMotionUpdates.size(); ++i)
+		{
+			LLVOAvatar* avatar = sMotionUpdates[i];
+			if (avatar->isDead())
+			{
+				continue;
+			}
+
+			LLTimer update_timer;
+			avatar->endCharacterUpdate();
+			avatar->idleUpdateFinish(agent, TRUE, avatar->mUpdateTime + update_timer.getElapsedTimeF32());
+		}
+	}
+
+	sMotionUpdates.clear();
+}
+
 void LLVOAvatar::idleUpdateVoiceVisualizer(bool voice_enabled)
 {
 	bool render_visualizer = voice_enabled;
@@ -2490,7 +2610,7 @@ void LLVOAvatar::idleUpdateMisc(bool detailed_update)
 {
 	if (LLVOAvatar::sJointDebug)
 	{
-		LL_INFOS() << getFullname() << ": joint touches: " << LLJoint::sNumTouches << " updates: " << LLJoint::sNumUpdates << LL_ENDL;
+		LL_INFOS() << getFullname() << ": joint touches: " << LLJoint::sNumTouches.CurrentValue() << " updates: " << LLJoint::sNumUpdates.CurrentValue() << LL_ENDL;
 	}
 
 	LLJoint::sNumUpdates = 0;
@@ -2643,12 +2763,14 @@ void LLVOAvatar::idleUpdateAppearanceAnimation()
 			}
 
 			// apply all params
+			beginMorphBatch();
 			for (param = getFirstVisualParam();
 				 param;
 				 param = getNextVisualParam())
 			{
 				param->apply(avatar_sex);
 			}
+			endMorphBatch();
 
 			mLastAppearanceBlendTime = appearance_anim_time;
 		}
@@ -3304,7 +3426,7 @@ void LLVOAvatar::slamPosition()
 	{
 		gPipeline.updateMoveNormalAsync(mDrawable);
 	}
-	mRoot->updateWorldMatrixChildren();
+	mJointHierarchy.update(mRoot);
 }
 
 bool LLVOAvatar::isVisuallyMuted()
@@ -3427,6 +3549,15 @@ void LLVOAvatar::updateDebugText()
 		if (!mBakedTextureDebugText.empty())
 			addDebugText(mBakedTextureDebugText);
 	}
+	if (gSavedSettings.getBOOL("DebugAvatarVisualParamMemory"))
+	{
+		LLVisualParamMemory memory;
+		getVisualParamMemory(memory);
+		const U32 bytes_per_param = memory.mNumParams ? (memory.mParamBaseBytes + memory.mWeightBytes) / memory.mNumParams : 0;
+		addDebugText(llformat("Visual params: %d, %d bytes each, weights %d %.1f KB, param base classes %.1f KB, index %.1f KB",
+							  memory.mNumParams, bytes_per_param, memory.mNumWeights, memory.mWeightBytes / 1024.f,
+							  memory.mParamBaseBytes / 1024.f, memory.mIndexBytes / 1024.f));
+	}
 
 	if (LLVOAvatar::sShowAnimationDebug)
 	{
@@ -3526,8 +3657,28 @@ void LLVOAvatar::updateDebugText()
 // called on both your avatar and other avatars
 //------------------------------------------------------------------------
 BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
+{
+	if (!beginCharacterUpdate(agent))
+	{
+		return FALSE;
+	}
+
+	updateCharacterMotion();
+	endCharacterUpdate();
+	return TRUE;
+}
+
+//------------------------------------------------------------------------
+// beginCharacterUpdate()
+// the part of updateCharacter() before the motions are evaluated,
+// returns FALSE where updateCharacter() would
+//------------------------------------------------------------------------
+BOOL LLVOAvatar::beginCharacterUpdate(LLAgent &agent)
 {	
 	updateDebugText();
+
+	// the motions may be updated on the thread pool, which must not read settings
+	LLPhysicsMotionController::updateEnabled();
 	
 	if (!mIsBuilt)
 	{
@@ -3609,6 +3760,16 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 		F32 time_quantum = clamp_rescale((F32)sInstances.size(), 10.f, 35.f, 0.f, 0.25f);
 		F32 pixel_area_scale = clamp_rescale(mPixelArea, 100, 5000, 1.f, 0.f);
 		F32 time_step = time_quantum * pixel_area_scale;
+		if (LLPipeline::sAvatarMotionLOD)
+		{
+			// distant avatars evaluate their motions less often, and fewer of them
+			mMotionController.updateLOD(mPixelArea);
+		}
+		else
+		{
+			mMotionController.setLOD(LLMotionController::LOD_FULL);
+		}
+		time_step = llmax(time_step, mMotionController.getLODTimeStep());
 		if (time_step != 0.f)
 		{
 			// disable walk motion servo controller as it doesn't work with motion timesteps
@@ -3639,7 +3800,7 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 	speed = xyVel.length();
 	// remembering the value here prevents a display glitch if the
 	// animation gets toggled during this update.
-	bool was_sit_ground_constrained = isMotionActive(ANIM_AGENT_SIT_GROUND_CONSTRAINED);
+	mWasSitGroundConstrained = isMotionActive(ANIM_AGENT_SIT_GROUND_CONSTRAINED);
 	
 	if (!(mIsSitting && getParent()))
 	{
@@ -3707,7 +3868,7 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 		// correct for the fact that the pelvis is not necessarily the center 
 		// of the agent's physical representation
 		root_pos.mdV[VZ] -= (0.5f * mBodySize.mV[VZ]) - mPelvisToFoot;
-		if (!mIsSitting && !was_sit_ground_constrained)
+		if (!mIsSitting && !mWasSitGroundConstrained)
 		{
 			root_pos += LLVector3d(getHoverOffset());
 		}
@@ -3896,15 +4057,31 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 	// update animations
 	if (mSpecialRenderMode == 1) // Animation Preview
 	{
-		updateMotions(LLCharacter::FORCE_UPDATE);
+		beginUpdateMotions(LLCharacter::FORCE_UPDATE);
 	}
 	else
 	{
-		updateMotions(LLCharacter::NORMAL_UPDATE);
+		beginUpdateMotions(LLCharacter::NORMAL_UPDATE);
 	}
 
+	return TRUE;
+}
+
+//------------------------------------------------------------------------
+// updateCharacterMotion()
+// evaluates the motions and poses the skeleton.  Only touches this avatar,
+// its motions and joints, so endMotionUpdate() runs it for many avatars
+// at once on the thread pool.  Visual parameter updates requested by the
+// motions are held until endCharacterUpdate().
+//------------------------------------------------------------------------
+void LLVOAvatar::updateCharacterMotion()
+{
+	mDeferVisualParamUpdate = TRUE;
+	evaluateMotions();
+	mDeferVisualParamUpdate = FALSE;
+
 	// Special handling for sitting on ground.
-	if (!getParent() && (mIsSitting || was_sit_ground_constrained))
+	if (!getParent() && (mIsSitting || mWasSitGroundConstrained))
 	{
 		
 		F32 off_z = LLVector3d(getHoverOffset()).mdV[VZ];
@@ -3918,9 +4095,26 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 		}
 	}
 
+	mJointHierarchy.update(mRoot);
+}
+
+//------------------------------------------------------------------------
+// endCharacterUpdate()
+// the part of updateCharacter() after the motions, on the main thread
+//------------------------------------------------------------------------
+void LLVOAvatar::endCharacterUpdate()
+{
+	if (mVisualParamUpdatePending)
+	{
+		mVisualParamUpdatePending = FALSE;
+		updateVisualParams();
+	}
+
 	// update head position
 	updateHeadOffset();
 
+	LLVector3 normal;
+
 	//-------------------------------------------------------------------------
 	// Find the ground under each foot, these are used for a variety
 	// of things that follow
@@ -3999,11 +4193,8 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 		}
 	}
 
-	mRoot->updateWorldMatrixChildren();
-
 	//mesh vertices need to be reskinned
 	mNeedsSkin = TRUE;
-	return TRUE;
 }
 //-----------------------------------------------------------------------------
 // updateHeadOffset()
@@ -4102,7 +4293,7 @@ void LLVOAvatar::debugBodySize() const
 //------------------------------------------------------------------------
 void LLVOAvatar::postPelvisSetRecalc()
 {		
-	mRoot->updateWorldMatrixChildren();			
+	mJointHierarchy.update(mRoot);			
 	computeBodySize();
 	dirtyMesh(2);
 }
@@ -6089,18 +6280,31 @@ void LLVOAvatar::initAttachmentPoints(bool ignore_hud_joints)
 //-----------------------------------------------------------------------------
 void LLVOAvatar::updateVisualParams()
 {
+	if (mDeferVisualParamUpdate)
+	{
+		// motions evaluated off the main thread, see updateCharacterMotion()
+		mVisualParamUpdatePending = TRUE;
+		return;
+	}
+
 	setSex( (getVisualParamWeight( "male" ) > 0.5f) ? SEX_MALE : SEX_FEMALE );
 
-	LLCharacter::updateVisualParams();
+	// only the params whose weights changed, see LLCharacter::markVisualParamDirty()
+	beginMorphBatch();
+	S32 applied = applyVisualParams();
+	endMorphBatch();
 
 	if (mLastSkeletonSerialNum != mSkeletonSerialNum)
 	{
 		computeBodySize();
 		mLastSkeletonSerialNum = mSkeletonSerialNum;
-		mRoot->updateWorldMatrixChildren();
+		mJointHierarchy.update(mRoot);
 	}
 
-	dirtyMesh();
+	if (applied > 0)
+	{
+		dirtyMesh();
+	}
 	updateHeadOffset();
 }
 //-----------------------------------------------------------------------------
@@ -6652,7 +6856,7 @@ void LLVOAvatar::sitOnObject(LLViewerObject *sit_object)
 	mRoot->getXform()->setParent(&sit_object->mDrawable->mXform); // LLVOAvatar::sitOnObject
 	// SL-315
 	mRoot->setPosition(getPosition());
-	mRoot->updateWorldMatrixChildren();
+	mJointHierarchy.update(mRoot);
 
 	stopMotion(ANIM_AGENT_BODY_NOISE);
 
@@ -8130,7 +8334,11 @@ void LLVOAvatar::applyParsedAppearanceMessage(LLAppearanceMessageContents& conte
 			{
 				startAppearanceAnimation();
 			}
-			updateVisualParams();
+			// Crowds can send several appearance messages a frame, the
+			// changed params are applied once at the start of idleUpdate().
+			// The sex is needed now for the layer sets.
+			setSex( (getVisualParamWeight( "male" ) > 0.5f) ? SEX_MALE : SEX_FEMALE );
+			mVisualParamUpdatePending = TRUE;
 
 			ESex new_sex = getSex();
 			if( old_sex != new_sex )
@@ -9057,6 +9265,16 @@ void LLVOAvatar::idleUpdateRenderComplexity()
 		}
 		mText->addLine(info_line, info_color, info_style);
 
+		// CPU time of the avatar's idle update, motions and skeleton included
+		info_line = llformat("%.2f ms update", mUpdateCost * 1000.f);
+		mText->addLine(info_line, LLColor4::grey, LLFontGL::NORMAL);
+
+		// motion LOD, and how many motions its last update ran
+		static const char* lod_names[LLMotionController::NUM_LODS] = { "full", "reduced", "core" };
+		info_line = llformat("motion LOD %s, %d run %d idle", lod_names[mMotionController.getLOD()],
+							 mMotionController.getMotionsEvaluated(), mMotionController.getMotionsSkipped());
+		mText->addLine(info_line, LLColor4::grey, LLFontGL::NORMAL);
+
 		updateText(); // corrects position
 	}
 }
@@ -40,6 +40,7 @@
 #include "lldrawpoolalpha.h"
 #include "llviewerobject.h"
 #include "llcharacter.h"
+#include "lljointhierarchy.h"
 #include "llcontrol.h"
 #include "llviewerjointmesh.h"
 #include "llviewerjointattachment.h"
@@ -242,6 +243,18 @@ private: //aligned members
 public:
 	void			updateDebugText();
 	virtual BOOL 	updateCharacter(LLAgent &agent);
+	BOOL			beginCharacterUpdate(LLAgent &agent);
+	void			updateCharacterMotion();
+	void			endCharacterUpdate();
+	void			idleUpdateFinish(LLAgent &agent, BOOL detailed_update, F32 update_time);
+
+	// Between these the idleUpdate() of other avatars stops before their motions are
+	// evaluated, endMotionUpdate() then runs updateCharacterMotion() for all of them on
+	// the thread pool and finishes their updates on the main thread.
+	static void		beginMotionUpdate();
+	static void		endMotionUpdate(LLAgent &agent);
+
+	F32				getUpdateCost() const			{ return mUpdateCost;			};		// seconds per frame in idleUpdate(), smoothed
 	void 			idleUpdateVoiceVisualizer(bool voice_enabled);
 	void 			idleUpdateMisc(bool detailed_update);
 	virtual void	idleUpdateAppearanceAnimation();
@@ -277,6 +290,19 @@ public:
 
 	void 			idleUpdateBelowWater();
 
+private:
+	static void		updateDeferredMotion(U32 index);
+
+	static bool		sDeferMotionUpdate;
+	static std::vector<LLPointer<LLVOAvatar> > sMotionUpdates;
+
+	F32				mUpdateTime;		// spent in this frame's update so far
+	F32				mUpdateCost;
+	BOOL			mDeferVisualParamUpdate;
+	BOOL			mVisualParamUpdatePending;	// applied once per frame, see idleUpdate()
+	bool			mWasSitGroundConstrained;
+	LLJointHierarchy	mJointHierarchy;	// world transforms of the skeleton under mRoot
+
 	//--------------------------------------------------------------------
 	// Static preferences (controlled by user settings/menus)
 	//--------------------------------------------------------------------
@@ -55,6 +55,7 @@
 #include "llhudmanager.h"
 #include "llflexibleobject.h"
 #include "llskinningutil.h"
+#include "llskinningkernel.h"
 #include "llsky.h"
 #include "lltexturefetch.h"
 #include "llvector4a.h"
@@ -77,6 +78,7 @@
 #include "llviewershadermgr.h"
 #include "llvoavatar.h"
 #include "llvocache.h"
+#include "llthreadpool.h"
 #include "llmaterialmgr.h"
 
 const F32 FORCE_SIMPLE_RENDER_AREA = 512.f;
@@ -90,6 +92,8 @@ F32 LLVOVolume::sLODFactor = 1.f;
 F32	LLVOVolume::sLODSlopDistanceFactor = 0.5f; //Changing this to zero, effectively disables the LOD transition slop 
 F32 LLVOVolume::sDistanceFactor = 1.0f;
 S32 LLVOVolume::sNumLODChanges = 0;
+LLVOVolume::pending_lod_set_t LLVOVolume::sPendingLODVolumes;
+U32 LLVOVolume::sLastGeneratedCount = 0;
 S32 LLVOVolume::mRenderComplexity_last = 0;
 S32 LLVOVolume::mRenderComplexity_current = 0;
 LLPointer<LLObjectMediaDataClient> LLVOVolume::sObjectMediaClient = NULL;
@@ -228,6 +232,8 @@ LLVOVolume::LLVOVolume(const LLUUID &id, const LLPCode pcode, LLViewerRegion *re
 
 LLVOVolume::~LLVOVolume()
 {
+	sPendingLODVolumes.erase(this);
+
 	delete mTextureAnimp;
 	mTextureAnimp = NULL;
 	delete mVolumeImpl;
@@ -266,6 +272,8 @@ void LLVOVolume::markDead()
 		{
 			mSculptTexture->removeVolume(this);
 		}
+
+		sPendingLODVolumes.erase(this);
 	}
 	
 	LLViewerObject::markDead();
@@ -997,6 +1005,17 @@ BOOL LLVOVolume::setVolume(const LLVolumeParams &params_in, const S32 detail, bo
 
 	}
 
+	// A plain LOD change keeps drawing the current LOD while the new one is
+	// generated in the background, see updatePendingLODs()
+	if (mVolumep.notNull() && lod != last_lod && !mSculptChanged
+		&& !(mVolumeImpl && mVolumeImpl->isVolumeUnique())
+		&& volume_params == mVolumep->getParams()
+		&& !LLPrimitive::getVolumeManager()->requestLOD(volume_params, lod))
+	{
+		sPendingLODVolumes.insert(this);
+		return FALSE;
+	}
+
 	if ((LLPrimitive::setVolume(volume_params, lod, (mVolumeImpl && mVolumeImpl->isVolumeUnique()))) || mSculptChanged)
 	{
 		mFaceMappingChanged = TRUE;
@@ -3700,6 +3719,35 @@ U32 LLVOVolume::getHighLODTriangleCount()
 void LLVOVolume::preUpdateGeom()
 {
 	sNumLODChanges = 0;
+	updatePendingLODs();
+}
+
+//static
+void LLVOVolume::updatePendingLODs()
+{
+	LLVolumeMgr* volume_mgr = LLPrimitive::getVolumeManager();
+	if (sPendingLODVolumes.empty() || volume_mgr->getGeneratedCount() == sLastGeneratedCount)
+	{
+		return;
+	}
+	sLastGeneratedCount = volume_mgr->getGeneratedCount();
+
+	for (pending_lod_set_t::iterator iter = sPendingLODVolumes.begin(); iter != sPendingLODVolumes.end(); )
+	{
+		pending_lod_set_t::iterator cur_iter = iter++;
+		LLVOVolume* vobj = *cur_iter;
+		if (vobj->mDrawable.isNull() || vobj->getVolume() == NULL)
+		{
+			sPendingLODVolumes.erase(cur_iter);
+		}
+		else if (volume_mgr->isLODReady(vobj->getVolume()->getParams(), vobj->mLOD))
+		{
+			// Swap the new LOD in on the next geometry update
+			vobj->mLODChanged = TRUE;
+			gPipeline.markRebuild(vobj->mDrawable, LLDrawable::REBUILD_VOLUME, FALSE);
+			sPendingLODVolumes.erase(cur_iter);
+		}
+	}
 }
 
 void LLVOVolume::parameterChanged(U16 param_type, bool local_origin)
@@ -4187,67 +4235,77 @@ void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, cons
 	U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
     LLSkinningUtil::initSkinningMatrixPalette((LLMatrix4*)mat, maxJoints, skin, avatar);
 
-	for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
+	//faces are independent once the palette is built, spread them over the thread pool
+	LLThreadPool* pool = LLThreadPool::getInstance();
+	if (pool && volume->getNumVolumeFaces() > 1)
 	{
-		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
-		
-		LLVolumeFace& dst_face = mVolumeFaces[i];
-		
-		LLVector4a* weight = vol_face.mWeights;
-
-		if ( weight )
+		pool->parallelFor(volume->getNumVolumeFaces(), boost::bind(&LLRiggedVolume::updateFace, this, skin, mat, volume, _1));
+	}
+	else
+	{
+		for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
 		{
-            LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
-			LLMatrix4a bind_shape_matrix;
-			bind_shape_matrix.loadu(skin->mBindShapeMatrix);
+			updateFace(skin, mat, volume, i);
+		}
+	}
+}
 
-			LLVector4a* pos = dst_face.mPositions;
+void LLRiggedVolume::updateFace(const LLMeshSkinInfo* skin, const LLMatrix4a* mat, const LLVolume* volume, U32 i)
+{
+	const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+	
+	LLVolumeFace& dst_face = mVolumeFaces[i];
+	
+	LLVector4a* weight = vol_face.mWeights;
 
-			if( pos && weight && dst_face.mExtents )
-			{
-				LL_RECORD_BLOCK_TIME(FTM_SKIN_RIGGED);
+	if ( weight )
+	{
+        LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
+		LLMatrix4a bind_shape_matrix;
+		bind_shape_matrix.loadu(skin->mBindShapeMatrix);
 
-                U32 max_joints = LLSkinningUtil::getMaxJointCount();
-				for (U32 j = 0; j < dst_face.mNumVertices; ++j)
-				{
-					LLMatrix4a final_mat;
-                    LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
-				
-					LLVector4a& v = vol_face.mPositions[j];
-					LLVector4a t;
-					LLVector4a dst;
-					bind_shape_matrix.affineTransform(v, t);
-					final_mat.affineTransform(t, dst);
-					pos[j] = dst;
-				}
+		LLVector4a* pos = dst_face.mPositions;
 
-				//update bounding box
-				LLVector4a& min = dst_face.mExtents[0];
-				LLVector4a& max = dst_face.mExtents[1];
+		if( pos && weight && dst_face.mExtents )
+		{
+			LL_RECORD_BLOCK_TIME(FTM_SKIN_RIGGED);
 
-				min = pos[0];
-				max = pos[1];
+            U32 max_joints = LLSkinningUtil::getMaxJointCount();
+			LLSkinningKernel::skinVertices(mat, max_joints, bind_shape_matrix, weight, vol_face.mPositions, NULL,
+										   dst_face.mNumVertices, pos, NULL);
 
-				for (U32 j = 1; j < dst_face.mNumVertices; ++j)
-				{
-					min.setMin(min, pos[j]);
-					max.setMax(max, pos[j]);
-				}
+			//update bounding box
+			LLVector4a& min = dst_face.mExtents[0];
+			LLVector4a& max = dst_face.mExtents[1];
 
-				dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
-				dst_face.mCenter->mul(0.5f);
+			min = pos[0];
+			max = pos[1];
 
+			for (U32 j = 1; j < dst_face.mNumVertices; ++j)
+			{
+				min.setMin(min, pos[j]);
+				max.setMax(max, pos[j]);
 			}
 
-			{
-				LL_RECORD_BLOCK_TIME(FTM_RIGGED_OCTREE);
-				delete dst_face.mOctree;
-				dst_face.mOctree = NULL;
+			dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
+			dst_face.mCenter->mul(0.5f);
+
+		}
 
+		{
+			LL_RECORD_BLOCK_TIME(FTM_RIGGED_OCTREE);
+			delete dst_face.mOctree;
+			dst_face.mOctree = NULL;
+			dst_face.destroyBVH();
+
+			// the pick BVH is built by the first pick that needs it, and
+			// the octree only when picking falls back to it
+			if (!LLVolume::sUsePickBVH)
+			{
 				LLVector4a size;
 				size.setSub(dst_face.mExtents[1], dst_face.mExtents[0]);
 				size.splat(size.getLength3().getF32()*0.5f);
-			
+
 				dst_face.createOctree(1.f);
 			}
 		}
@@ -5262,6 +5320,8 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 		
 		U32 buffer_count = 0;
 
+		LLFace::beginVertexFill();
+
 		for (LLSpatialGroup::element_iter drawable_iter = group->getDataBegin(); drawable_iter != group->getDataEnd(); ++drawable_iter)
 		{
 			LLDrawable* drawablep = (LLDrawable*)(*drawable_iter)->getDrawable();
@@ -5312,6 +5372,9 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 				drawablep->clearState(LLDrawable::REBUILD_ALL);
 			}
 		}
+
+		//transform the queued faces while every buffer is still mapped
+		LLFace::endVertexFill();
 		
 		{
 			LL_RECORD_BLOCK_TIME(FTM_REBUILD_MESH_FLUSH);
@@ -5663,6 +5726,8 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 		U32 indices_index = 0;
 		U16 index_offset = 0;
 
+		LLFace::beginVertexFill();
+
 		while (face_iter < i)
 		{
 			//update face indices for new buffer
@@ -5999,6 +6064,8 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 			++face_iter;
 		}
 
+		LLFace::endVertexFill();
+
 		if (buffer)
 		{
 			buffer->flush();
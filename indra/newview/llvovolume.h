@@ -35,6 +35,7 @@
 #include "m3math.h"		// LLMatrix3
 #include "m4math.h"		// LLMatrix4
 #include <map>
+#include <set>
 
 class LLViewerTextureAnim;
 class LLDrawPool;
@@ -62,6 +63,10 @@ public:
 	}
 
 	void update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, const LLVolume* src_volume);
+
+private:
+	//skins face i of src_volume into face i of this volume, may run on the thread pool
+	void updateFace(const LLMeshSkinInfo* skin, const LLMatrix4a* mat, const LLVolume* src_volume, U32 i);
 };
 
 // Base class for implementations of the volume - Primitive, Flexible Object, etc.
@@ -387,6 +392,13 @@ public:
 protected:
 	static S32 sNumLODChanges;
 
+	// Objects still drawing their old LOD while LLVolumeMgr generates the
+	// new one in the background
+	typedef std::set<LLVOVolume*> pending_lod_set_t;
+	static pending_lod_set_t sPendingLODVolumes;
+	static U32 sLastGeneratedCount;
+	static void updatePendingLODs();
+
 	friend class LLVolumeImplFlexible;
 
 public:
@@ -43,6 +43,7 @@
 #include "llui.h" 
 #include "llglheaders.h"
 #include "llrender.h"
+#include "llthreadpool.h"
 #include "llwindow.h"	// swapBuffers()
 
 // newview includes
@@ -382,6 +383,10 @@ bool	LLPipeline::sBakeSunlight = false;
 bool	LLPipeline::sNoAlpha = false;
 bool	LLPipeline::sUseTriStrips = true;
 bool	LLPipeline::sUseFarClip = true;
+bool	LLPipeline::sParallelCull = true;
+bool	LLPipeline::sParallelVertexFill = true;
+bool	LLPipeline::sParallelAvatarUpdate = true;
+bool	LLPipeline::sAvatarMotionLOD = true;
 bool	LLPipeline::sShadowRender = false;
 bool	LLPipeline::sWaterReflections = false;
 bool	LLPipeline::sRenderGlow = false;
@@ -569,6 +574,10 @@ void LLPipeline::init()
 	connectRefreshCachedSettingsSafe("RenderAutoMaskAlphaDeferred");
 	connectRefreshCachedSettingsSafe("RenderAutoMaskAlphaNonDeferred");
 	connectRefreshCachedSettingsSafe("RenderUseFarClip");
+	connectRefreshCachedSettingsSafe("RenderParallelCull");
+	connectRefreshCachedSettingsSafe("RenderParallelVertexFill");
+	connectRefreshCachedSettingsSafe("RenderParallelAvatarUpdate");
+	connectRefreshCachedSettingsSafe("RenderAvatarMotionLOD");
 	connectRefreshCachedSettingsSafe("RenderAvatarMaxNonImpostors");
 	connectRefreshCachedSettingsSafe("RenderDelayVBUpdate");
 	connectRefreshCachedSettingsSafe("UseOcclusion");
@@ -1081,6 +1090,10 @@ void LLPipeline::refreshCachedSettings()
 	LLPipeline::sAutoMaskAlphaDeferred = gSavedSettings.getBOOL("RenderAutoMaskAlphaDeferred");
 	LLPipeline::sAutoMaskAlphaNonDeferred = gSavedSettings.getBOOL("RenderAutoMaskAlphaNonDeferred");
 	LLPipeline::sUseFarClip = gSavedSettings.getBOOL("RenderUseFarClip");
+	LLPipeline::sParallelCull = gSavedSettings.getBOOL("RenderParallelCull");
+	LLPipeline::sParallelVertexFill = gSavedSettings.getBOOL("RenderParallelVertexFill");
+	LLPipeline::sParallelAvatarUpdate = gSavedSettings.getBOOL("RenderParallelAvatarUpdate");
+	LLPipeline::sAvatarMotionLOD = gSavedSettings.getBOOL("RenderAvatarMotionLOD");
 	LLVOAvatar::sMaxNonImpostors = gSavedSettings.getU32("RenderAvatarMaxNonImpostors");
 	LLVOAvatar::updateImpostorRendering(LLVOAvatar::sMaxNonImpostors);
 	LLPipeline::sDelayVBUpdate = gSavedSettings.getBOOL("RenderDelayVBUpdate");
@@ -2395,6 +2408,112 @@ bool LLPipeline::getVisibleExtents(LLCamera& camera, LLVector3& min, LLVector3&
 }
 
 static LLTrace::BlockTimerStatHandle FTM_CULL("Object Culling");
+static LLTrace::BlockTimerStatHandle FTM_PRECULL("Parallel Frustum Cull");
+
+// Per partition type breakdown of culling, on whichever thread does it
+static LLTrace::BlockTimerStatHandle FTM_CULL_HUD("Cull HUD");
+static LLTrace::BlockTimerStatHandle FTM_CULL_TERRAIN("Cull Terrain");
+static LLTrace::BlockTimerStatHandle FTM_CULL_VOIDWATER("Cull Void Water");
+static LLTrace::BlockTimerStatHandle FTM_CULL_WATER("Cull Water");
+static LLTrace::BlockTimerStatHandle FTM_CULL_TREE("Cull Trees");
+static LLTrace::BlockTimerStatHandle FTM_CULL_PARTICLE("Cull Particles");
+static LLTrace::BlockTimerStatHandle FTM_CULL_GRASS("Cull Grass");
+static LLTrace::BlockTimerStatHandle FTM_CULL_VOLUME("Cull Volumes");
+static LLTrace::BlockTimerStatHandle FTM_CULL_BRIDGE("Cull Bridges");
+static LLTrace::BlockTimerStatHandle FTM_CULL_HUD_PARTICLE("Cull HUD Particles");
+
+static LLTrace::BlockTimerStatHandle* const sCullPartitionTimers[LLViewerRegion::PARTITION_VO_CACHE] =
+{
+	&FTM_CULL_HUD,
+	&FTM_CULL_TERRAIN,
+	&FTM_CULL_VOIDWATER,
+	&FTM_CULL_WATER,
+	&FTM_CULL_TREE,
+	&FTM_CULL_PARTICLE,
+	&FTM_CULL_GRASS,
+	&FTM_CULL_VOLUME,
+	&FTM_CULL_BRIDGE,
+	&FTM_CULL_HUD_PARTICLE
+};
+
+static U32 sLastCullPass = 0;
+
+// A subtree of one partition for the frustum pre-pass
+struct LLPrecullItem
+{
+	LLViewerOctreeCull*	mCuller;
+	const OctreeNode*	mNode;
+	U32					mPartitionType;
+};
+
+// Runs on the thread pool with RenderParallelCull
+static void precull_item(const std::vector<LLPrecullItem>* items, U32 pass, U32 index)
+{
+	const LLPrecullItem& item = (*items)[index];
+	LL_RECORD_BLOCK_TIME(*sCullPartitionTimers[item.mPartitionType]);
+	item.mCuller->precull(item.mNode, pass);
+}
+
+void LLPipeline::precull(LLCamera& camera)
+{
+	LL_RECORD_BLOCK_TIME(FTM_PRECULL);
+
+	if (++sLastCullPass == 0)
+	{ //0 means no precull
+		++sLastCullPass;
+	}
+
+	//test each partition root here, then split the work by the roots' children
+	std::vector<LLViewerOctreeCull*> cullers;
+	std::vector<LLPrecullItem> items;
+	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
+			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+	{
+		LLViewerRegion* region = *iter;
+		for (U32 i = 0; i < LLViewerRegion::PARTITION_VO_CACHE; i++)
+		{
+			LLSpatialPartition* part = region->getSpatialPartition(i);
+			if (!part || !hasRenderType(part->mDrawableType))
+			{
+				continue;
+			}
+
+			//same as cull() does first, bounds must be up to date before testing them
+			((LLSpatialGroup*) part->mOctree->getListener(0))->rebound();
+
+			LLViewerOctreeCull* culler = part->createCuller(camera);
+			cullers.push_back(culler);
+			if (culler->precull(part->mOctree, sLastCullPass, false) == 1)
+			{
+				for (U32 c = 0; c < part->mOctree->getChildCount(); c++)
+				{
+					LLPrecullItem item = { culler, part->mOctree->getChild(c), i };
+					items.push_back(item);
+				}
+			}
+		}
+	}
+
+	LLThreadPool* pool = LLThreadPool::getInstance();
+	if (sParallelCull && pool)
+	{
+		pool->parallelFor(items.size(), boost::bind(precull_item, &items, sLastCullPass, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < items.size(); i++)
+		{
+			precull_item(&items, sLastCullPass, i);
+		}
+	}
+
+	for (U32 i = 0; i < cullers.size(); i++)
+	{
+		delete cullers[i];
+	}
+
+	LLSpatialPartition::sCullPass = sLastCullPass;
+}
 
 void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_clip, LLPlane* planep)
 {
@@ -2494,6 +2613,13 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 		}
 		mCubeVB->setBuffer(LLVertexBuffer::MAP_VERTEX);
 	}
+
+	if (water_clip == 0)
+	{ //batched frustum tests first, on the thread pool with RenderParallelCull, the walk below only
+		//does occlusion and bookkeeping (with a water clip plane the camera changes per region)
+		camera.disableUserClipPlane();
+		precull(camera);
+	}
 	
 	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
 			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
@@ -2516,6 +2642,7 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 			{
 				if (hasRenderType(part->mDrawableType))
 				{
+					LL_RECORD_BLOCK_TIME(*sCullPartitionTimers[i]);
 					part->cull(camera);
 				}
 			}
@@ -2530,6 +2657,8 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 		}
 	}
 
+	LLSpatialPartition::sCullPass = 0;
+
 	if (bound_shader)
 	{
 		gOcclusionCubeProgram.unbind();
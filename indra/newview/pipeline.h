@@ -238,6 +238,7 @@ public:
 	bool getVisibleExtents(LLCamera& camera, LLVector3 &min, LLVector3& max);
 	bool getVisiblePointCloud(LLCamera& camera, LLVector3 &min, LLVector3& max, std::vector<LLVector3>& fp, LLVector3 light_dir = LLVector3(0,0,0));
 	void updateCull(LLCamera& camera, LLCullResult& result, S32 water_clip = 0, LLPlane* plane = NULL);  //if water_clip is 0, ignore water plane, 1, cull to above plane, -1, cull to below plane
+	void precull(LLCamera& camera); //batched frustum tests of updateCull's partition culls, optionally spread over the thread pool
 	void createObjects(F32 max_dtime);
 	void createObject(LLViewerObject* vobj);
 	void processPartitionQ();
@@ -569,6 +570,10 @@ public:
 	static bool				sNoAlpha;
 	static bool				sUseTriStrips;
 	static bool				sUseFarClip;
+	static bool				sParallelCull;
+	static bool				sParallelVertexFill;
+	static bool				sParallelAvatarUpdate;
+	static bool				sAvatarMotionLOD;
 	static bool				sShadowRender;
 	static bool				sWaterReflections;
 	static bool				sDynamicLOD;
@@ -31,6 +31,7 @@
 
 #include "is_approx_equal_fraction.h" // instead of llmath.h
 #include <cstring>
+#include <cstdlib>
 
 class LLDate;
 class LLSD;
@@ -154,6 +155,13 @@ namespace tut
 	{
 		ensure_not_equals(NULL, actual, expected);
 	}
+
+	// Timing loops run only when LL_TEST_BENCHMARK is set in the environment,
+	// so that test builds neither wait for them nor print their numbers
+	inline bool benchmarks_enabled()
+	{
+		return getenv("LL_TEST_BENCHMARK") != NULL;
+	}
 }
 
 #endif // LL_LLTUT_H